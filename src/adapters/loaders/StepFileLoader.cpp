@@ -2,14 +2,104 @@
 #include <algorithm>
 #include <stdexcept>
 #include <cctype>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 #include <STEPControl_Reader.hxx>
 #include <TopoDS_Shape.hxx>
 #include <IFSelect_ReturnStatus.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
+#include <IMeshTools_Parameters.hxx>
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressScope.hxx>
+#include <BRep_Tool.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
 
 namespace adapters {
 
+    // Part colours, cycled per solid.
+    static const domain::ColorRGBA kPartPalette[] = {
+        { 0.70f, 0.72f, 0.76f, 1.0f },
+        { 0.55f, 0.68f, 0.82f, 1.0f },
+        { 0.80f, 0.66f, 0.50f, 1.0f },
+        { 0.58f, 0.76f, 0.58f, 1.0f },
+        { 0.78f, 0.58f, 0.62f, 1.0f },
+        { 0.68f, 0.62f, 0.80f, 1.0f },
+    };
+
+    // STEP translation goes through OCCT's global interface parameters, so
+    // loads running side by side read their files one at a time; meshing
+    // and building the geometry need no lock.
+    static std::mutex s_stepReadMutex;
+
+    // Reports the progress of a long OCCT step (transfer, meshing) through
+    // the loader's callback, mapped to [from, to] percent. The callback
+    // throws to cancel a load; OCCT cannot unwind that, so the exception is
+    // kept, UserBreak() stops the step, and rethrow() raises it once the
+    // step has returned.
+    class StepProgress : public Message_ProgressIndicator {
+    public:
+        StepProgress(const ports::ProgressCallback& callback, const std::string& message, float from, float to)
+            : m_callback(callback), m_message(message), m_from(from), m_to(to) {}
+
+        Standard_Boolean UserBreak() override { return m_error != nullptr; }
+
+        void rethrow() const {
+            if (m_error) std::rethrow_exception(m_error);
+        }
+
+    protected:
+        void Show(const Message_ProgressScope& /*scope*/, const Standard_Boolean /*isForce*/) override {
+            if (m_error || !m_callback) return;
+            try {
+                m_callback(m_message, m_from + (m_to - m_from) * static_cast<float>(GetPosition()));
+            }
+            catch (...) {
+                m_error = std::current_exception();
+            }
+        }
+
+    private:
+        const ports::ProgressCallback& m_callback;
+        std::string m_message;
+        float m_from;
+        float m_to;
+        std::exception_ptr m_error;
+    };
+
+    // Appends the triangulation of every face of `shape`. Each face gets its
+    // own vertices, so normals are smooth across a face but edges stay sharp.
+    static void appendFaces(const TopoDS_Shape& shape, domain::Geometry& geometry) {
+        for (TopExp_Explorer ex(shape, TopAbs_FACE); ex.More(); ex.Next()) {
+            const TopoDS_Face& face = TopoDS::Face(ex.Current());
+            TopLoc_Location location;
+            Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, location);
+            if (triangulation.IsNull()) continue;
+
+            const gp_Trsf& trsf = location.Transformation();
+            const size_t base = geometry.getVertices().size();
+            for (Standard_Integer i = 1; i <= triangulation->NbNodes(); ++i) {
+                const gp_Pnt p = triangulation->Node(i).Transformed(trsf);
+                geometry.addVertex({ (float)p.X(), (float)p.Y(), (float)p.Z() });
+            }
+
+            const bool reversed = face.Orientation() == TopAbs_REVERSED;
+            for (Standard_Integer i = 1; i <= triangulation->NbTriangles(); ++i) {
+                Standard_Integer n1, n2, n3;
+                triangulation->Triangle(i).Get(n1, n2, n3);
+                if (reversed) std::swap(n2, n3);
+                geometry.addTriangle({ base + n1 - 1, base + n2 - 1, base + n3 - 1 });
+            }
+        }
+    }
+
     std::shared_ptr<domain::Model> StepFileLoader::load(
         const std::string& filepath,
         ports::ProgressCallback progressCallback)
@@ -18,29 +108,36 @@ namespace adapters {
             progressCallback("Reading STEP file...", 10.0f);
         }
 
-        STEPControl_Reader reader;
+        TopoDS_Shape shape;
+        {
+            std::lock_guard<std::mutex> lock(s_stepReadMutex);
+            STEPControl_Reader reader;
 
-        IFSelect_ReturnStatus status = reader.ReadFile(filepath.c_str());
+            IFSelect_ReturnStatus status = reader.ReadFile(filepath.c_str());
 
-        if (status != IFSelect_RetDone) {
-            throw std::runtime_error("Failed to read STEP file: " + filepath);
-        }
+            if (status != IFSelect_RetDone) {
+                throw std::runtime_error("Failed to read STEP file: " + filepath);
+            }
 
-        if (progressCallback) {
-            progressCallback("Transferring shapes...", 40.0f);
-        }
+            if (progressCallback) {
+                progressCallback("Transferring shapes...", 40.0f);
+            }
 
-        Standard_Integer nbRoots = reader.TransferRoots();
-        if (nbRoots == 0) {
-            throw std::runtime_error("No shapes found in STEP file");
+            // ReadFile takes no progress, so a load stops at the earliest here.
+            Handle(StepProgress) progress = new StepProgress(progressCallback, "Transferring shapes...", 40.0f, 60.0f);
+            Standard_Integer nbRoots = reader.TransferRoots(progress->Start());
+            progress->rethrow();
+            if (nbRoots == 0) {
+                throw std::runtime_error("No shapes found in STEP file");
+            }
+
+            shape = reader.OneShape();
         }
 
         if (progressCallback) {
             progressCallback("Building geometry...", 60.0f);
         }
 
-        TopoDS_Shape shape = reader.OneShape();
-
         if (shape.IsNull()) {
             throw std::runtime_error("Loaded shape is null");
         }
@@ -52,15 +149,34 @@ namespace adapters {
             progressCallback("Generating mesh...", 80.0f);
         }
 
+        Handle(StepProgress) meshProgress = new StepProgress(progressCallback, "Generating mesh...", 80.0f, 100.0f);
         try {
-            BRepMesh_IncrementalMesh mesh(shape, 0.1);
+            IMeshTools_Parameters parameters;
+            parameters.Deflection = 0.1;
+            BRepMesh_IncrementalMesh mesh(shape, parameters, meshProgress->Start());
             if (mesh.IsDone()) {
-                // Mesh generated successfully
+                // One geometry per solid so parts can be told apart; a file
+                // of loose faces or shells becomes a single geometry.
+                std::vector<TopoDS_Shape> parts;
+                for (TopExp_Explorer ex(shape, TopAbs_SOLID); ex.More(); ex.Next()) {
+                    parts.push_back(ex.Current());
+                }
+                if (parts.empty()) parts.push_back(shape);
+
+                for (const TopoDS_Shape& part : parts) {
+                    auto geometry = std::make_shared<domain::Geometry>();
+                    appendFaces(part, *geometry);
+                    if (geometry->isEmpty()) continue;
+                    geometry->computeNormals();
+                    geometry->setColor(kPartPalette[model->getGeometryCount() % std::size(kPartPalette)]);
+                    model->addGeometry(geometry);
+                }
             }
         }
         catch (...) {
             // Meshing failed, but we still have the shape
         }
+        meshProgress->rethrow();
 
         if (progressCallback) {
             progressCallback("Complete!", 100.0f);
@@ -80,6 +80,9 @@ namespace adapters::persistence::dto {
         bool selectable{ true };
         std::vector<domain::sketch::Vec2> controlPoints;
         bool closed{ false };
+        int degree{ 3 };
+        std::vector<double> knots;   // empty: uniform
+        std::vector<double> weights; // empty: non-rational
     };
 
     using EntityDto = std::variant<PointDto, LineDto, CircleDto, ArcDto, EllipseDto, CurveDto>;
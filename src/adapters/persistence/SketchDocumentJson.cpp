@@ -138,11 +138,17 @@ namespace adapters::persistence::dto {
         headerToJson(j, e.id, e.name, e.construction, e.visible, e.selectable);
         j["controlPoints"] = e.controlPoints;
         j["closed"] = e.closed;
+        j["degree"] = e.degree;
+        if (!e.knots.empty()) j["knots"] = e.knots;
+        if (!e.weights.empty()) j["weights"] = e.weights;
     }
     void from_json(const json& j, CurveDto& e) {
         headerFromJson(j, e.id, e.name, e.construction, e.visible, e.selectable);
         e.controlPoints = j.value("controlPoints", std::vector<domain::sketch::Vec2>{});
         e.closed = j.value("closed", false);
+        e.degree = j.value("degree", 3);
+        e.knots = j.value("knots", std::vector<double>{});
+        e.weights = j.value("weights", std::vector<double>{});
     }
 
     // --- Constraints ---
@@ -47,8 +47,10 @@ namespace adapters::persistence {
             sd.name = s.name;
             sd.visible = s.visible;
 
-            // Entities - flatten typed vectors into a single list.
-            for (const auto& p : s.entities.points()) {
+            // Entities - flatten typed columns into a single list.
+            const EntityStore& store = s.entities;
+            for (std::uint32_t i = 0; i < store.count(EntityKind::Point); ++i) {
+                const Point2D p = store.point(i);
                 dto::PointDto e;
                 e.id = p.h.id;
                 e.name = p.h.name;
@@ -58,7 +60,8 @@ namespace adapters::persistence {
                 e.p = p.p;
                 sd.entities.emplace_back(e);
             }
-            for (const auto& l : s.entities.lines()) {
+            for (std::uint32_t i = 0; i < store.count(EntityKind::Line); ++i) {
+                const Line2D l = store.line(i);
                 dto::LineDto e;
                 e.id = l.h.id;
                 e.name = l.h.name;
@@ -69,7 +72,8 @@ namespace adapters::persistence {
                 e.b = l.b;
                 sd.entities.emplace_back(e);
             }
-            for (const auto& c : s.entities.circles()) {
+            for (std::uint32_t i = 0; i < store.count(EntityKind::Circle); ++i) {
+                const Circle2D c = store.circle(i);
                 dto::CircleDto e;
                 e.id = c.h.id;
                 e.name = c.h.name;
@@ -80,7 +84,8 @@ namespace adapters::persistence {
                 e.radius = c.radius;
                 sd.entities.emplace_back(e);
             }
-            for (const auto& a : s.entities.arcs()) {
+            for (std::uint32_t i = 0; i < store.count(EntityKind::Arc); ++i) {
+                const Arc2D a = store.arc(i);
                 dto::ArcDto e;
                 e.id = a.h.id;
                 e.name = a.h.name;
@@ -94,7 +99,8 @@ namespace adapters::persistence {
                 e.ccw = a.ccw;
                 sd.entities.emplace_back(e);
             }
-            for (const auto& e0 : s.entities.ellipses()) {
+            for (std::uint32_t i = 0; i < store.count(EntityKind::Ellipse); ++i) {
+                const Ellipse2D e0 = store.ellipse(i);
                 dto::EllipseDto e;
                 e.id = e0.h.id;
                 e.name = e0.h.name;
@@ -107,15 +113,19 @@ namespace adapters::persistence {
                 e.rotation = e0.rotation;
                 sd.entities.emplace_back(e);
             }
-            for (const auto& cv : s.entities.curves()) {
+            for (std::uint32_t i = 0; i < store.count(EntityKind::Curve); ++i) {
+                Curve2D cv = store.curve(i);
                 dto::CurveDto e;
                 e.id = cv.h.id;
                 e.name = cv.h.name;
                 e.construction = cv.h.construction;
                 e.visible = cv.h.visible;
                 e.selectable = cv.h.selectable;
-                e.controlPoints = cv.controlPoints;
+                e.controlPoints = std::move(cv.controlPoints);
                 e.closed = cv.closed;
+                e.degree = cv.degree;
+                e.knots = std::move(cv.knots);
+                e.weights = std::move(cv.weights);
                 sd.entities.emplace_back(e);
             }
 
@@ -236,6 +246,9 @@ namespace adapters::persistence {
                         cv.h.selectable = e.selectable;
                         cv.controlPoints = e.controlPoints;
                         cv.closed = e.closed;
+                        cv.degree = e.degree;
+                        cv.knots = e.knots;
+                        cv.weights = e.weights;
                         sk.entities.addCurve(std::move(cv));
                     }
                 }, ent);
@@ -0,0 +1,32 @@
+#include "adapters/rendering/GlFunctions.h"
+
+#define PISTACHIO_GL_DEFINE(ret, name, params) \
+    ret (PISTACHIO_GL_APIENTRY* pistachio_gl##name) params = nullptr;
+PISTACHIO_GL_FUNCTIONS(PISTACHIO_GL_DEFINE)
+PISTACHIO_GL_OPTIONAL_FUNCTIONS(PISTACHIO_GL_DEFINE)
+#undef PISTACHIO_GL_DEFINE
+
+namespace adapters {
+
+    namespace {
+
+        template <class F>
+        bool load(F& function, const char* name) {
+            function = reinterpret_cast<F>(glfwGetProcAddress(name));
+            return function != nullptr;
+        }
+
+    } // namespace
+
+    bool LoadGlFunctions() {
+        bool ok = true;
+#define PISTACHIO_GL_LOAD(ret, name, params) ok = load(pistachio_gl##name, "gl" #name) && ok;
+        PISTACHIO_GL_FUNCTIONS(PISTACHIO_GL_LOAD)
+#undef PISTACHIO_GL_LOAD
+#define PISTACHIO_GL_LOAD_OPTIONAL(ret, name, params) load(pistachio_gl##name, "gl" #name);
+        PISTACHIO_GL_OPTIONAL_FUNCTIONS(PISTACHIO_GL_LOAD_OPTIONAL)
+#undef PISTACHIO_GL_LOAD_OPTIONAL
+        return ok;
+    }
+
+} // namespace adapters
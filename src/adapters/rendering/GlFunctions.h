@@ -0,0 +1,184 @@
+#pragma once
+
+// The OpenGL entry points the embedded OpenGL backend uses beyond GL 1.1.
+//
+// <GL/gl.h> (pulled in by GLFW) declares GL 1.1 and the system GL library
+// exports it; everything newer has to be looked up at run time, once a
+// context is current. ImGui's loader only covers what ImGui itself draws
+// with (no framebuffers, instancing, syncs or buffer storage), so the
+// backend loads its own set, the way glad does: a pointer per function,
+// with a macro giving it the usual gl name.
+
+#include <cstddef>
+#include <cstdint>
+
+#include <GLFW/glfw3.h>
+
+#if defined(_WIN32)
+#define PISTACHIO_GL_APIENTRY __stdcall
+#else
+#define PISTACHIO_GL_APIENTRY
+#endif
+
+// Types and enums of GL 1.5 - 4.4. Where <GL/gl.h> brings glext.h along
+// (Mesa) they are defined already; Windows' stops at 1.1.
+#ifndef GL_VERSION_4_4
+typedef char GLchar;
+typedef std::ptrdiff_t GLsizeiptr;
+typedef std::ptrdiff_t GLintptr;
+typedef std::uint64_t GLuint64;
+typedef struct __GLsync* GLsync;
+
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_STREAM_DRAW 0x88E0
+#define GL_STATIC_DRAW 0x88E4
+#define GL_DYNAMIC_DRAW 0x88E8
+#define GL_MAP_WRITE_BIT 0x0002
+#define GL_MAP_INVALIDATE_RANGE_BIT 0x0004
+#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_VERTEX_SHADER 0x8B31
+#define GL_COMPILE_STATUS 0x8B81
+#define GL_LINK_STATUS 0x8B82
+#define GL_INFO_LOG_LENGTH 0x8B84
+#define GL_FRAMEBUFFER 0x8D40
+#define GL_RENDERBUFFER 0x8D41
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#define GL_DEPTH_STENCIL_ATTACHMENT 0x821A
+#define GL_DEPTH24_STENCIL8 0x88F0
+#define GL_MAJOR_VERSION 0x821B
+#define GL_MINOR_VERSION 0x821C
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_TIMEOUT_EXPIRED 0x911B
+#define GL_CONDITION_SATISFIED 0x911C
+#define GL_WAIT_FAILED 0x911D
+#endif
+
+// X(return type, name without the gl prefix, parameter list)
+#define PISTACHIO_GL_FUNCTIONS(X) \
+    X(void, AttachShader, (GLuint program, GLuint shader)) \
+    X(void, BindBuffer, (GLenum target, GLuint buffer)) \
+    X(void, BindFramebuffer, (GLenum target, GLuint framebuffer)) \
+    X(void, BindRenderbuffer, (GLenum target, GLuint renderbuffer)) \
+    X(void, BindVertexArray, (GLuint array)) \
+    X(void, BufferData, (GLenum target, GLsizeiptr size, const void* data, GLenum usage)) \
+    X(void, BufferSubData, (GLenum target, GLintptr offset, GLsizeiptr size, const void* data)) \
+    X(GLenum, CheckFramebufferStatus, (GLenum target)) \
+    X(GLenum, ClientWaitSync, (GLsync sync, GLbitfield flags, GLuint64 timeout)) \
+    X(void, CompileShader, (GLuint shader)) \
+    X(GLuint, CreateProgram, ()) \
+    X(GLuint, CreateShader, (GLenum type)) \
+    X(void, DeleteBuffers, (GLsizei n, const GLuint* buffers)) \
+    X(void, DeleteFramebuffers, (GLsizei n, const GLuint* framebuffers)) \
+    X(void, DeleteProgram, (GLuint program)) \
+    X(void, DeleteRenderbuffers, (GLsizei n, const GLuint* renderbuffers)) \
+    X(void, DeleteShader, (GLuint shader)) \
+    X(void, DeleteSync, (GLsync sync)) \
+    X(void, DeleteVertexArrays, (GLsizei n, const GLuint* arrays)) \
+    X(void, DisableVertexAttribArray, (GLuint index)) \
+    X(void, DrawArraysInstanced, (GLenum mode, GLint first, GLsizei count, GLsizei instances)) \
+    X(void, EnableVertexAttribArray, (GLuint index)) \
+    X(GLsync, FenceSync, (GLenum condition, GLbitfield flags)) \
+    X(void, FramebufferRenderbuffer, (GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer)) \
+    X(void, FramebufferTexture2D, (GLenum target, GLenum attachment, GLenum texTarget, GLuint texture, GLint level)) \
+    X(void, GenBuffers, (GLsizei n, GLuint* buffers)) \
+    X(void, GenFramebuffers, (GLsizei n, GLuint* framebuffers)) \
+    X(void, GenRenderbuffers, (GLsizei n, GLuint* renderbuffers)) \
+    X(void, GenVertexArrays, (GLsizei n, GLuint* arrays)) \
+    X(void, GetProgramInfoLog, (GLuint program, GLsizei bufSize, GLsizei* length, GLchar* log)) \
+    X(void, GetProgramiv, (GLuint program, GLenum pname, GLint* params)) \
+    X(void, GetShaderInfoLog, (GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* log)) \
+    X(void, GetShaderiv, (GLuint shader, GLenum pname, GLint* params)) \
+    X(GLint, GetUniformLocation, (GLuint program, const GLchar* name)) \
+    X(void, LinkProgram, (GLuint program)) \
+    X(void*, MapBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)) \
+    X(void, RenderbufferStorage, (GLenum target, GLenum format, GLsizei width, GLsizei height)) \
+    X(void, ShaderSource, (GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)) \
+    X(void, Uniform1f, (GLint location, GLfloat v0)) \
+    X(void, Uniform1i, (GLint location, GLint v0)) \
+    X(void, Uniform2f, (GLint location, GLfloat v0, GLfloat v1)) \
+    X(void, Uniform3f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2)) \
+    X(void, Uniform4f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)) \
+    X(void, UniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)) \
+    X(GLboolean, UnmapBuffer, (GLenum target)) \
+    X(void, UseProgram, (GLuint program)) \
+    X(void, VertexAttrib4f, (GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w)) \
+    X(void, VertexAttribDivisor, (GLuint index, GLuint divisor)) \
+    X(void, VertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer))
+
+// Optional: null when the context lacks them (GL_ARB_buffer_storage, 4.4).
+#define PISTACHIO_GL_OPTIONAL_FUNCTIONS(X) \
+    X(void, BufferStorage, (GLenum target, GLsizeiptr size, const void* data, GLbitfield flags))
+
+#define PISTACHIO_GL_DECLARE(ret, name, params) \
+    extern ret (PISTACHIO_GL_APIENTRY* pistachio_gl##name) params;
+PISTACHIO_GL_FUNCTIONS(PISTACHIO_GL_DECLARE)
+PISTACHIO_GL_OPTIONAL_FUNCTIONS(PISTACHIO_GL_DECLARE)
+#undef PISTACHIO_GL_DECLARE
+
+#define glAttachShader pistachio_glAttachShader
+#define glBindBuffer pistachio_glBindBuffer
+#define glBindFramebuffer pistachio_glBindFramebuffer
+#define glBindRenderbuffer pistachio_glBindRenderbuffer
+#define glBindVertexArray pistachio_glBindVertexArray
+#define glBufferData pistachio_glBufferData
+#define glBufferStorage pistachio_glBufferStorage
+#define glBufferSubData pistachio_glBufferSubData
+#define glCheckFramebufferStatus pistachio_glCheckFramebufferStatus
+#define glClientWaitSync pistachio_glClientWaitSync
+#define glCompileShader pistachio_glCompileShader
+#define glCreateProgram pistachio_glCreateProgram
+#define glCreateShader pistachio_glCreateShader
+#define glDeleteBuffers pistachio_glDeleteBuffers
+#define glDeleteFramebuffers pistachio_glDeleteFramebuffers
+#define glDeleteProgram pistachio_glDeleteProgram
+#define glDeleteRenderbuffers pistachio_glDeleteRenderbuffers
+#define glDeleteShader pistachio_glDeleteShader
+#define glDeleteSync pistachio_glDeleteSync
+#define glDeleteVertexArrays pistachio_glDeleteVertexArrays
+#define glDisableVertexAttribArray pistachio_glDisableVertexAttribArray
+#define glDrawArraysInstanced pistachio_glDrawArraysInstanced
+#define glEnableVertexAttribArray pistachio_glEnableVertexAttribArray
+#define glFenceSync pistachio_glFenceSync
+#define glFramebufferRenderbuffer pistachio_glFramebufferRenderbuffer
+#define glFramebufferTexture2D pistachio_glFramebufferTexture2D
+#define glGenBuffers pistachio_glGenBuffers
+#define glGenFramebuffers pistachio_glGenFramebuffers
+#define glGenRenderbuffers pistachio_glGenRenderbuffers
+#define glGenVertexArrays pistachio_glGenVertexArrays
+#define glGetProgramInfoLog pistachio_glGetProgramInfoLog
+#define glGetProgramiv pistachio_glGetProgramiv
+#define glGetShaderInfoLog pistachio_glGetShaderInfoLog
+#define glGetShaderiv pistachio_glGetShaderiv
+#define glGetUniformLocation pistachio_glGetUniformLocation
+#define glLinkProgram pistachio_glLinkProgram
+#define glMapBufferRange pistachio_glMapBufferRange
+#define glRenderbufferStorage pistachio_glRenderbufferStorage
+#define glShaderSource pistachio_glShaderSource
+#define glUniform1f pistachio_glUniform1f
+#define glUniform1i pistachio_glUniform1i
+#define glUniform2f pistachio_glUniform2f
+#define glUniform3f pistachio_glUniform3f
+#define glUniform4f pistachio_glUniform4f
+#define glUniformMatrix4fv pistachio_glUniformMatrix4fv
+#define glUnmapBuffer pistachio_glUnmapBuffer
+#define glUseProgram pistachio_glUseProgram
+#define glVertexAttrib4f pistachio_glVertexAttrib4f
+#define glVertexAttribDivisor pistachio_glVertexAttribDivisor
+#define glVertexAttribPointer pistachio_glVertexAttribPointer
+
+namespace adapters {
+
+    // Looks every function up through GLFW; needs a current context. False
+    // if a required one is missing (the context is older than 3.3).
+    bool LoadGlFunctions();
+
+} // namespace adapters
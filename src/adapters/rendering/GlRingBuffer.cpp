@@ -0,0 +1,110 @@
+#include "adapters/rendering/GlRingBuffer.h"
+
+#include <algorithm>
+
+namespace adapters {
+
+    static constexpr std::size_t kMinRegionSize = 64 * 1024;
+    static constexpr GLuint64 kFenceTimeoutNs = 1000000000ull;
+
+    GlRingBuffer::~GlRingBuffer() {
+        destroy();
+    }
+
+    void GlRingBuffer::destroy() {
+        clearFences();
+        if (m_buffer) {
+            if (m_mapped) {
+                glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+                glUnmapBuffer(GL_ARRAY_BUFFER);
+            }
+            glDeleteBuffers(1, &m_buffer);
+        }
+        m_buffer = 0;
+        m_mapped = nullptr;
+        m_regionSize = 0;
+        m_region = -1;
+    }
+
+    void* GlRingBuffer::begin(std::size_t bytes, std::size_t& offset) {
+        if (!m_buffer || bytes > m_regionSize) {
+            // Room for half as much again, so a growing scene doesn't reallocate every time.
+            std::size_t size = std::max(kMinRegionSize, bytes + bytes / 2);
+            size = (size + 255) & ~std::size_t(255);
+            allocate(size);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+
+        if (m_mapped) {
+            m_region = (m_region + 1) % kRegions;
+            if (GLsync f = m_fences[m_region]) {
+                while (glClientWaitSync(f, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeoutNs) == GL_TIMEOUT_EXPIRED) {
+                }
+                glDeleteSync(f);
+                m_fences[m_region] = nullptr;
+            }
+            offset = (std::size_t)m_region * m_regionSize;
+            return static_cast<char*>(m_mapped) + offset;
+        }
+
+        // Orphan: the draws still in flight keep the old storage.
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_regionSize, nullptr, GL_STREAM_DRAW);
+        offset = 0;
+        return glMapBufferRange(GL_ARRAY_BUFFER, 0, (GLsizeiptr)std::max<std::size_t>(bytes, 1),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    }
+
+    void GlRingBuffer::commit() {
+        // A coherent persistent mapping needs nothing; writes are visible to
+        // commands issued after this point.
+        if (m_mapped) return;
+        glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+
+    void GlRingBuffer::fence() {
+        if (!m_mapped || m_region < 0) return;
+        if (m_fences[m_region]) glDeleteSync(m_fences[m_region]);
+        m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    void GlRingBuffer::allocate(std::size_t regionSize) {
+        destroy();
+        m_regionSize = regionSize;
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+
+        if (SupportsBufferStorage()) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            const GLsizeiptr total = (GLsizeiptr)(m_regionSize * kRegions);
+            glBufferStorage(GL_ARRAY_BUFFER, total, nullptr, flags);
+            m_mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, total, flags);
+            if (m_mapped) return;
+
+            // Immutable storage can't be orphaned; start over with a plain buffer.
+            glDeleteBuffers(1, &m_buffer);
+            glGenBuffers(1, &m_buffer);
+            glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        }
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_regionSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    void GlRingBuffer::clearFences() {
+        for (GLsync& f : m_fences) {
+            if (f) glDeleteSync(f);
+            f = nullptr;
+        }
+    }
+
+    bool GlRingBuffer::SupportsBufferStorage() {
+        // Some drivers hand out entry points the context doesn't support, so
+        // the version decides, not just the pointer.
+        if (!glBufferStorage) return false;
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        return major > 4 || (major == 4 && minor >= 4);
+    }
+
+} // namespace adapters
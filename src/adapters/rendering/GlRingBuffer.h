@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+
+#include "adapters/rendering/GlFunctions.h"
+
+namespace adapters {
+
+    // A vertex buffer for data the CPU rewrites while the GPU may still be
+    // drawing the previous version.
+    //
+    // With GL 4.4 buffer storage it is mapped once, persistently and
+    // coherently, and split into kRegions regions written in turn; a fence
+    // per region keeps a write from overtaking the draws still reading it.
+    // Without it every write orphans the buffer (glBufferData with no data)
+    // and maps the fresh storage, which lets the driver do the same renaming.
+    class GlRingBuffer {
+    public:
+        static constexpr int kRegions = 3;
+
+        GlRingBuffer() = default;
+        ~GlRingBuffer();
+        GlRingBuffer(const GlRingBuffer&) = delete;
+        GlRingBuffer& operator=(const GlRingBuffer&) = delete;
+
+        // Needs a current context; the buffer itself is created by the first begin().
+        void destroy();
+
+        // Writable memory for `bytes` bytes, which start at `offset` in
+        // buffer(). Finish with commit() before drawing from it.
+        void* begin(std::size_t bytes, std::size_t& offset);
+        void commit();
+
+        // Call once a frame after the draws that read the buffer: the region
+        // last written is not reused before the GPU is past them.
+        void fence();
+
+        GLuint buffer() const { return m_buffer; }
+        bool persistent() const { return m_mapped != nullptr; }
+
+    private:
+        GLuint m_buffer = 0;
+        std::size_t m_regionSize = 0;
+        int m_region = -1;
+        void* m_mapped = nullptr;    // persistent mapping of all regions
+        GLsync m_fences[kRegions]{};
+
+        void allocate(std::size_t regionSize);
+        void clearFences();
+        static bool SupportsBufferStorage();
+    };
+
+} // namespace adapters
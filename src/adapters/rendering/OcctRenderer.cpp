@@ -5,6 +5,7 @@
 #endif
 
 #include "adapters/rendering/OcctRenderer.h"
+#include "adapters/rendering/OcctSketchOverlay.h"
 #include "domain/Model.h"
 
 // OpenCASCADE includes
@@ -36,6 +37,8 @@
 #include <WNT_Window.hxx>
 #include "adapters/rendering/RendererRouter.h"
 
+#include <cmath>
+
  
 namespace adapters {
 
@@ -104,6 +107,7 @@ namespace adapters {
             }
 
             std::cout << "Native window created: HWND = " << hwnd << std::endl;
+            m_nativeWindow = hwnd;
 
             // Show the window AFTER creation
             ShowWindow(hwnd, SW_SHOWNORMAL);
@@ -378,126 +382,6 @@ namespace adapters {
 
     //    return comp;
     //}
-    static TopoDS_Shape BuildSketchOverlayShape(const core::rendering::RenderScene& s)
-    {
-        BRep_Builder builder;
-        TopoDS_Compound comp;
-        builder.MakeCompound(comp);
-
-        bool hasGeometry = false;
-
-        // ---- Lines ----
-        for (auto const& ln : s.lines)
-        {
-            //if (!ln.h.visible) continue;
-
-            gp_Pnt a(ln.a.x, ln.a.y, ln.a.z);
-            gp_Pnt b(ln.b.x, ln.b.y, ln.b.z);
-            if (a.Distance(b) < 1e-9) continue;
-
-            builder.Add(comp, BRepBuilderAPI_MakeEdge(a, b));
-            hasGeometry = true;
-        }
-
-        // ---- Polylines (curves temp / debug) ----
-        for (auto const& pl : s.polylines)
-        {
-            if (pl.points.size() < 2) continue;
-            for (size_t i = 1; i < pl.points.size(); ++i)
-            {
-                const auto& p0 = pl.points[i - 1];
-                const auto& p1 = pl.points[i];
-                gp_Pnt a(p0.x, p0.y, p0.z);
-                gp_Pnt b(p1.x, p1.y, p1.z);
-                if (a.Distance(b) < 1e-9) continue;
-
-                builder.Add(comp, BRepBuilderAPI_MakeEdge(a, b));
-                hasGeometry = true;
-            }
-        }
-
-        // ---- Circles ----
-        for (auto const& c : s.circles)
-        {
-            try {
-                gp_Pnt center(c.center.x, c.center.y, c.center.z);
-                gp_Dir normal(c.normal.x, c.normal.y, c.normal.z);
-                gp_Ax2 ax2(center, normal);
-
-                Handle(Geom_Circle) gc = new Geom_Circle(ax2, c.radius);
-                builder.Add(comp, BRepBuilderAPI_MakeEdge(gc));
-                hasGeometry = true;
-            }
-            catch (...) {
-                // Skip invalid circles
-            }
-        }
-
-        // ---- Arcs ----
-        for (auto const& a : s.arcs)
-        {
-            try {
-                gp_Pnt center(a.center.x, a.center.y, a.center.z);
-                gp_Dir normal(a.normal.x, a.normal.y, a.normal.z);
-                gp_Ax2 ax2(center, normal);
-
-                Handle(Geom_Circle) gc = new Geom_Circle(ax2, a.radius);
-
-                gp_Pnt p0(a.start.x, a.start.y, a.start.z);
-                gp_Pnt p1(a.end.x, a.end.y, a.end.z);
-
-                Standard_Real u0 = ElCLib::Parameter(gc->Circ(), p0);
-                Standard_Real u1 = ElCLib::Parameter(gc->Circ(), p1);
-
-                // If you want CW, swap.
-                if (!a.ccw) std::swap(u0, u1);
-
-                Handle(Geom_TrimmedCurve) arc = new Geom_TrimmedCurve(gc, u0, u1, Standard_True);
-                builder.Add(comp, BRepBuilderAPI_MakeEdge(arc));
-                hasGeometry = true;
-            }
-            catch (...) {
-                // Skip invalid arcs
-            }
-        }
-
-        // ---- Ellipses ----
-        for (auto const& e : s.ellipses)
-        {
-            try {
-                gp_Pnt center(e.center.x, e.center.y, e.center.z);
-                gp_Dir normal(e.normal.x, e.normal.y, e.normal.z);
-                gp_Ax2 ax2(center, normal);
-
-                // rotate the in-plane axes by rotationRad
-                const double cr = std::cos((double)e.rotationRad);
-                const double sr = std::sin((double)e.rotationRad);
-
-                gp_Dir xdir = ax2.XDirection();
-                gp_Dir ydir = ax2.YDirection();
-
-                gp_Vec xv(xdir.X(), xdir.Y(), xdir.Z());
-                gp_Vec yv(ydir.X(), ydir.Y(), ydir.Z());
-
-                gp_Vec xr = xv * cr + yv * sr;
-                gp_Vec yr = yv * cr - xv * sr;
-
-                ax2.SetXDirection(gp_Dir(xr));
-                ax2.SetYDirection(gp_Dir(yr));
-
-                Handle(Geom_Ellipse) ge = new Geom_Ellipse(ax2, e.rx, e.ry);
-                builder.Add(comp, BRepBuilderAPI_MakeEdge(ge));
-                hasGeometry = true;
-            }
-            catch (...) {
-                // Skip invalid ellipses
-            }
-        }
-
-        // Return empty compound if no geometry was added
-        return comp;
-    }
-
     void OcctRenderer::createExampleCube() {
         if (m_context.IsNull()) return;
 
@@ -559,6 +443,7 @@ namespace adapters {
         }
 
         m_currentShape.Nullify();
+        m_nativeWindow = nullptr;
         m_initialized = false;
     }
 
@@ -677,64 +562,29 @@ namespace adapters {
             m_context->DisplayedObjects(allObjects);
             std::cout << "Objects in context: " << allObjects.Size() << std::endl;
 
-            // Update sketch overlay (only when changed)
-            if (m_sketchOverlayDirty && !m_context.IsNull())
+            // Update sketch overlay: curves are re-tessellated for the current
+            // zoom, changed vertices are written in place, and only a new
+            // layout needs the presentation recomputed.
+            if (!m_sketchOverlayAis.IsNull() && !m_context.IsNull())
             {
-                std::cout << "\n--- Building sketch overlay ---" << std::endl;
-                std::cout << "Scene has:" << std::endl;
-                std::cout << "  Lines: " << m_sketchOverlay.lines.size() << std::endl;
-                std::cout << "  Circles: " << m_sketchOverlay.circles.size() << std::endl;
-                std::cout << "  Arcs: " << m_sketchOverlay.arcs.size() << std::endl;
-                std::cout << "  Ellipses: " << m_sketchOverlay.ellipses.size() << std::endl;
-                std::cout << "  Polylines: " << m_sketchOverlay.polylines.size() << std::endl;
-
-                TopoDS_Shape overlay = BuildSketchOverlayShape(m_sketchOverlay);
-
-                if (overlay.IsNull()) {
-                    std::cout << "WARNING: Built overlay shape is NULL!" << std::endl;
+                if (m_curveTessellator.update(m_sketchScene, m_sketchDelta, viewCamera())) {
+                    core::rendering::MergeSceneDelta(m_sketchDelta, m_curveTessellator.delta());
                 }
-                else {
-                    std::cout << "Overlay shape built: NOT NULL" << std::endl;
-
-                    // Check if compound has any content
-                    TopExp_Explorer exp(overlay, TopAbs_EDGE);
-                    int edgeCount = 0;
-                    for (; exp.More(); exp.Next()) edgeCount++;
-                    std::cout << "Edges in overlay shape: " << edgeCount << std::endl;
-                }
-
-                if (m_sketchOverlayAis.IsNull())
-                {
-                    std::cout << "Creating NEW AIS_Shape for overlay" << std::endl;
-                    m_sketchOverlayAis = new AIS_Shape(overlay);
 
-                    // Set appearance - make it very visible
-                    m_sketchOverlayAis->SetColor(Quantity_NOC_RED);  // Bright red for testing
-                    m_sketchOverlayAis->SetWidth(5.0);  // Very thick
-                    m_sketchOverlayAis->SetDisplayMode(AIS_WireFrame);
-                    m_sketchOverlayAis->SetZLayer(Graphic3d_ZLayerId_Top);
+                if (!m_sketchDelta.empty()) {
+                    m_sketchOverlayAis->update(m_sketchScene, m_sketchDelta, m_curveTessellator);
+                    m_sketchDelta.clear();
 
-                    std::cout << "Calling m_context->Display()..." << std::endl;
-                    m_context->Display(m_sketchOverlayAis, Standard_True);
-                    std::cout << "Display complete" << std::endl;
-
-                    // Check if it's actually displayed
-                    if (m_context->IsDisplayed(m_sketchOverlayAis)) {
-                        std::cout << "[OK] Overlay IS displayed in context" << std::endl;
+                    if (!m_context->IsDisplayed(m_sketchOverlayAis)) {
+                        m_context->Display(m_sketchOverlayAis, 0, -1, Standard_False);
+                    }
+                    else if (m_sketchOverlayAis->needsLayout()) {
+                        m_context->Redisplay(m_sketchOverlayAis, Standard_False);
                     }
                     else {
-                        std::cout << "[X] Overlay NOT displayed in context!" << std::endl;
+                        m_view->Invalidate();
                     }
                 }
-                else
-                {
-                    std::cout << "UPDATING existing AIS_Shape overlay" << std::endl;
-                    m_sketchOverlayAis->SetShape(overlay);
-                    m_context->Redisplay(m_sketchOverlayAis, Standard_True);
-                    std::cout << "Redisplay complete" << std::endl;
-                }
-
-                m_sketchOverlayDirty = false;
             }
 
             std::cout << "\nCalling m_view->Redraw()..." << std::endl;
@@ -807,20 +657,83 @@ namespace adapters {
         return nullptr;
     }
 
-    void OcctRenderer::setScene(const ports::RenderScene& scene) {
+    void OcctRenderer::setScene(ports::RenderSceneSnapshot scene) {
         // For now we keep the scene for future sketch overlay rendering.
         // OCCT renderer currently renders via AIS and ignores the generic primitives.
-        m_scene = scene;
+        m_scene = std::move(scene);
     }
 
     void OcctRenderer::setCameraState(const ports::CameraState& camera) {
         // We store the camera state, and will later map it onto V3d_View camera.
         m_camera = camera;
     }
-    void adapters::OcctRenderer::setSketchOverlay(const core::rendering::RenderScene& scene)
+    void adapters::OcctRenderer::setSketchOverlay(const core::rendering::RenderScene& scene,
+        const core::rendering::SceneDelta& delta)
     {
-        m_sketchOverlay = scene;
-        m_sketchOverlayDirty = true;
+        if (delta.empty()) return;
+        if (m_sketchOverlayAis.IsNull()) m_sketchOverlayAis = new OcctSketchOverlay();
+
+        // render() tessellates and uploads what changed, for the camera of that frame.
+        core::rendering::ApplySceneDelta(m_sketchScene, scene, delta);
+        core::rendering::MergeSceneDelta(m_sketchDelta, delta);
+    }
+
+    void OcctRenderer::setSketchOverlay(const core::rendering::ScenePatch& patch)
+    {
+        if (patch.delta.empty()) return;
+        if (m_sketchOverlayAis.IsNull()) m_sketchOverlayAis = new OcctSketchOverlay();
+
+        core::rendering::ApplyScenePatch(m_sketchScene, patch);
+        core::rendering::MergeSceneDelta(m_sketchDelta, patch.delta);
+    }
+
+    core::rendering::CameraState OcctRenderer::viewCamera() const
+    {
+        core::rendering::CameraState state;
+        const Handle(Graphic3d_Camera)& camera = m_view->Camera();
+        const gp_Pnt eye = camera->Eye();
+        const gp_Pnt center = camera->Center();
+        const gp_Dir up = camera->Up();
+
+        state.position = glm::vec3(static_cast<float>(eye.X()), static_cast<float>(eye.Y()), static_cast<float>(eye.Z()));
+        state.target = glm::vec3(static_cast<float>(center.X()), static_cast<float>(center.Y()), static_cast<float>(center.Z()));
+        state.up = glm::vec3(static_cast<float>(up.X()), static_cast<float>(up.Y()), static_cast<float>(up.Z()));
+        state.projection = camera->IsOrthographic() ? core::rendering::ProjectionType::Orthographic
+                                                    : core::rendering::ProjectionType::Perspective;
+        state.fovYDegrees = static_cast<float>(camera->FOVy());
+        state.orthoScale = static_cast<float>(camera->Scale() * 0.5); // Scale() is the view height
+        state.nearPlane = static_cast<float>(camera->ZNear());
+        state.farPlane = static_cast<float>(camera->ZFar());
+
+        // The native window's pixels, not the ImGui panel's that resize() gets:
+        // the view draws into that window.
+        state.viewportWidth = m_width;
+        state.viewportHeight = m_height;
+        if (!m_view->Window().IsNull()) {
+            Standard_Integer width = 0, height = 0;
+            m_view->Window()->Size(width, height);
+            state.viewportWidth = width;
+            state.viewportHeight = height;
+        }
+        return state;
+    }
+
+    bool OcctRenderer::screenToPlane(int px, int py, float planeZ, glm::vec3& out) const {
+        if (!m_initialized || m_view.IsNull()) return false;
+
+        // Eye ray through the pixel, intersected with the plane z = planeZ.
+        Standard_Real x, y, z, dx, dy, dz;
+        m_view->ConvertWithProj(px, py, x, y, z, dx, dy, dz);
+        if (std::abs(dz) < 1e-9) return false;
+
+        const Standard_Real t = (planeZ - z) / dz;
+        out = glm::vec3(static_cast<float>(x + t * dx), static_cast<float>(y + t * dy), planeZ);
+        return true;
+    }
+
+    double OcctRenderer::pixelsToWorld(int pixels) const {
+        if (!m_initialized || m_view.IsNull()) return 0.0;
+        return m_view->Convert(pixels);
     }
 
     ports::CameraState OcctRenderer::getCameraState() const {
@@ -10,7 +10,10 @@
 #include <AIS_Shape.hxx>
 #include <AIS_ViewCube.hxx>
 #include <AIS_Trihedron.hxx>
+#include "core/rendering/CameraState.h"
+#include "core/rendering/CurveTessellator.h"
 #include "core/rendering/RenderScene.h"
+#include "adapters/rendering/OcctSketchOverlay.h"
 #include <AIS_Shape.hxx>
 
 namespace adapters {
@@ -29,7 +32,7 @@ namespace adapters {
         void resize(int width, int height) override;
 
         // Renderer-agnostic scene + camera (sketch overlays, gizmos)
-        void setScene(const ports::RenderScene& scene) override;
+        void setScene(ports::RenderSceneSnapshot scene) override;
         void setCameraState(const ports::CameraState& camera) override;
         ports::CameraState getCameraState() const override;
         ports::RendererCapabilities getCapabilities() const override;
@@ -41,17 +44,34 @@ namespace adapters {
         void zoom(float delta);
         void setViewDirection(int direction);
 
-        void setSketchOverlay(const core::rendering::RenderScene& scene);
+        // Updates the overlay with the parts of `scene` listed in `delta`; an
+        // empty delta leaves the overlay (and the view) untouched.
+        void setSketchOverlay(const core::rendering::RenderScene& scene, const core::rendering::SceneDelta& delta);
+        // The same from a patch, for callers that do not share the scene.
+        void setSketchOverlay(const core::rendering::ScenePatch& patch);
 
-    private:
-        core::rendering::RenderScene m_sketchOverlay;
-        bool m_sketchOverlayDirty{ false };
+        // Picking helpers for sketch interaction. Pixel coordinates are relative
+        // to the native window's client area.
+        bool screenToPlane(int px, int py, float planeZ, glm::vec3& out) const;
+        double pixelsToWorld(int pixels) const;
+
+        // The view's camera, with the native window's size as the viewport,
+        // for picking elsewhere with the same results. Needs initialize().
+        core::rendering::CameraState viewCamera() const;
 
-        Handle(AIS_Shape) m_sketchOverlayAis;
+        // The native window the view presents into (an HWND on Windows), or
+        // null before initialize(). Input to it never reaches the UI.
+        void* nativeWindow() const { return m_nativeWindow; }
+
+    private:
+        Handle(OcctSketchOverlay) m_sketchOverlayAis;
+        core::rendering::RenderScene m_sketchScene;       // the overlay's scene, kept by deltas
+        core::rendering::SceneDelta m_sketchDelta;        // changes not yet shown
+        core::rendering::CurveTessellator m_curveTessellator;
 
         std::shared_ptr<domain::Model> m_currentModel;
 
-        ports::RenderScene m_scene;
+        ports::RenderSceneSnapshot m_scene;
         ports::CameraState m_camera;
         
          
@@ -62,6 +82,7 @@ namespace adapters {
         opencascade::handle<AIS_ViewCube> m_viewCube;
         opencascade::handle<AIS_Trihedron> m_trihedron;
 
+        void* m_nativeWindow = nullptr;
         int m_width;
         int m_height;
         bool m_initialized;
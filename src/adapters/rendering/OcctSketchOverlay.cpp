@@ -0,0 +1,430 @@
+#include "adapters/rendering/OcctSketchOverlay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <Graphic3d_AspectLine3d.hxx>
+#include <Graphic3d_AspectMarker3d.hxx>
+#include <Graphic3d_AttribBuffer.hxx>
+#include <Graphic3d_Group.hxx>
+#include <Prs3d_Presentation.hxx>
+#include <Quantity_Color.hxx>
+
+namespace adapters {
+
+    namespace
+    {
+        using core::rendering::PrimitiveKind;
+        using Vertex = OcctSketchOverlay::Vertex;
+
+        constexpr std::size_t kSegmentSlack = 16; // extra vertices per run, on top of a quarter
+
+        template <typename F>
+        void WithArray(const core::rendering::RenderScene& s, PrimitiveKind kind, F&& f)
+        {
+            switch (kind)
+            {
+            case PrimitiveKind::Point:    f(s.points); break;
+            case PrimitiveKind::Line:     f(s.lines); break;
+            case PrimitiveKind::Polyline: f(s.polylines); break;
+            case PrimitiveKind::Circle:   f(s.circles); break;
+            case PrimitiveKind::Arc:      f(s.arcs); break;
+            case PrimitiveKind::Ellipse:  f(s.ellipses); break;
+            }
+        }
+
+        std::size_t ArraySize(const core::rendering::RenderScene& s, PrimitiveKind kind)
+        {
+            std::size_t n = 0;
+            WithArray(s, kind, [&n](const auto& items) { n = items.size(); });
+            return n;
+        }
+
+        std::size_t ChunkCount(std::size_t size)
+        {
+            return (size + OcctSketchOverlay::kChunkSize - 1) / OcctSketchOverlay::kChunkSize;
+        }
+
+        // ---- fingerprints ----
+
+        void HashInto(std::uint64_t& h, float v)
+        {
+            std::uint32_t bits;
+            std::memcpy(&bits, &v, sizeof bits);
+            h = (h ^ bits) * 0x100000001b3ull;
+        }
+
+        void HashInto(std::uint64_t& h, const glm::vec3& v)
+        {
+            HashInto(h, v.x);
+            HashInto(h, v.y);
+            HashInto(h, v.z);
+        }
+
+        void HashInto(std::uint64_t& h, const core::rendering::Color& c)
+        {
+            HashInto(h, c.r);
+            HashInto(h, c.g);
+            HashInto(h, c.b);
+            HashInto(h, c.a);
+        }
+
+        void HashPrimitive(std::uint64_t& h, const core::rendering::Point3D& p)
+        {
+            HashInto(h, p.p);
+            HashInto(h, p.color);
+        }
+
+        void HashPrimitive(std::uint64_t& h, const core::rendering::Line3D& ln)
+        {
+            HashInto(h, ln.a);
+            HashInto(h, ln.b);
+            HashInto(h, ln.color);
+            HashInto(h, ln.construction ? 1.0f : 0.0f);
+        }
+
+        void HashPrimitive(std::uint64_t& h, const core::rendering::Polyline3D& pl)
+        {
+            HashInto(h, static_cast<float>(pl.points.size()));
+            for (const auto& p : pl.points) HashInto(h, p);
+            HashInto(h, pl.color);
+            HashInto(h, pl.construction ? 1.0f : 0.0f);
+        }
+
+        void HashPrimitive(std::uint64_t& h, const core::rendering::Circle3D& c)
+        {
+            HashInto(h, c.center);
+            HashInto(h, c.normal);
+            HashInto(h, c.radius);
+            HashInto(h, c.color);
+            HashInto(h, c.construction ? 1.0f : 0.0f);
+        }
+
+        void HashPrimitive(std::uint64_t& h, const core::rendering::Arc3D& a)
+        {
+            HashInto(h, a.center);
+            HashInto(h, a.normal);
+            HashInto(h, a.radius);
+            HashInto(h, a.start);
+            HashInto(h, a.end);
+            HashInto(h, a.ccw ? 1.0f : 0.0f);
+            HashInto(h, a.color);
+            HashInto(h, a.construction ? 1.0f : 0.0f);
+        }
+
+        void HashPrimitive(std::uint64_t& h, const core::rendering::Ellipse3D& e)
+        {
+            HashInto(h, e.center);
+            HashInto(h, e.normal);
+            HashInto(h, e.rx);
+            HashInto(h, e.ry);
+            HashInto(h, e.rotationRad);
+            HashInto(h, e.color);
+            HashInto(h, e.construction ? 1.0f : 0.0f);
+        }
+
+        // ---- tessellation ----
+
+        Graphic3d_Vec4ub ToRgba8(const core::rendering::Color& c)
+        {
+            auto channel = [](float v) { return static_cast<Standard_Byte>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f)); };
+            return Graphic3d_Vec4ub(channel(c.r), channel(c.g), channel(c.b), channel(c.a));
+        }
+
+        Vertex MakeVertex(const glm::vec3& p, const Graphic3d_Vec4ub& color)
+        {
+            return { Graphic3d_Vec3(p.x, p.y, p.z), color };
+        }
+
+        std::vector<Vertex>& LinesOf(std::vector<Vertex>* streams, bool construction)
+        {
+            return streams[construction ? OcctSketchOverlay::Construction : OcctSketchOverlay::Solid];
+        }
+
+        // Lines, polylines and points carry their own vertices; curves come
+        // as a line strip from the CurveTessellator.
+        void Tessellate(const core::rendering::Point3D& p, const glm::vec3*, std::uint32_t, std::vector<Vertex>* streams)
+        {
+            streams[OcctSketchOverlay::Points].push_back(MakeVertex(p.p, ToRgba8(p.color)));
+        }
+
+        void Tessellate(const core::rendering::Line3D& ln, const glm::vec3*, std::uint32_t, std::vector<Vertex>* streams)
+        {
+            auto& out = LinesOf(streams, ln.construction);
+            const Graphic3d_Vec4ub color = ToRgba8(ln.color);
+            out.push_back(MakeVertex(ln.a, color));
+            out.push_back(MakeVertex(ln.b, color));
+        }
+
+        void AppendStrip(std::vector<Vertex>& out, const glm::vec3* points, std::size_t count, const Graphic3d_Vec4ub& color)
+        {
+            for (std::size_t i = 1; i < count; ++i)
+            {
+                out.push_back(MakeVertex(points[i - 1], color));
+                out.push_back(MakeVertex(points[i], color));
+            }
+        }
+
+        void Tessellate(const core::rendering::Polyline3D& pl, const glm::vec3*, std::uint32_t, std::vector<Vertex>* streams)
+        {
+            AppendStrip(LinesOf(streams, pl.construction), pl.points.data(), pl.points.size(), ToRgba8(pl.color));
+        }
+
+        template <typename Curve>
+        void Tessellate(const Curve& c, const glm::vec3* strip, std::uint32_t count, std::vector<Vertex>* streams)
+        {
+            AppendStrip(LinesOf(streams, c.construction), strip, count, ToRgba8(c.color));
+        }
+
+        // Line width and point size of the scene; the renderer styles all
+        // sketch primitives alike, so the first of each kind stands for all.
+        void SceneStyle(const core::rendering::RenderScene& s, float& lineWidth, float& pointSize)
+        {
+            if (!s.lines.empty()) lineWidth = s.lines.front().thickness;
+            else if (!s.circles.empty()) lineWidth = s.circles.front().thickness;
+            else if (!s.arcs.empty()) lineWidth = s.arcs.front().thickness;
+            else if (!s.ellipses.empty()) lineWidth = s.ellipses.front().thickness;
+            else if (!s.polylines.empty()) lineWidth = s.polylines.front().thickness;
+            if (!s.points.empty()) pointSize = s.points.front().size;
+        }
+    }
+
+    OcctSketchOverlay::OcctSketchOverlay()
+    {
+        SetDisplayMode(0);
+        SetZLayer(Graphic3d_ZLayerId_Top);
+        SetMutable(Standard_True);
+    }
+
+    void OcctSketchOverlay::update(const core::rendering::RenderScene& scene, const core::rendering::SceneDelta& delta,
+        const core::rendering::CurveTessellator& curves)
+    {
+        if (delta.empty()) return;
+
+        float lineWidth = m_lineWidth, pointSize = m_pointSize;
+        SceneStyle(scene, lineWidth, pointSize);
+        if (lineWidth != m_lineWidth || pointSize != m_pointSize)
+        {
+            m_lineWidth = lineWidth;
+            m_pointSize = pointSize;
+            m_needsLayout = true;
+        }
+
+        markDirty(scene, delta);
+
+        for (std::size_t k = 0; k < core::rendering::kPrimitiveKindCount; ++k)
+        {
+            auto& chunks = m_chunks[k];
+            for (std::size_t c = 0; c < chunks.size(); ++c)
+            {
+                Chunk& chunk = chunks[c];
+                if (!chunk.dirty) continue;
+                chunk.dirty = false;
+                if (!rebuildChunk(scene, static_cast<PrimitiveKind>(k), c, curves)) continue;
+                if (!m_needsLayout && !writeInPlace(chunk)) m_needsLayout = true;
+            }
+        }
+    }
+
+    void OcctSketchOverlay::markDirty(const core::rendering::RenderScene& scene, const core::rendering::SceneDelta& delta)
+    {
+        for (std::size_t k = 0; k < core::rendering::kPrimitiveKindCount; ++k)
+        {
+            const auto kind = static_cast<PrimitiveKind>(k);
+            auto& chunks = m_chunks[k];
+            const std::size_t size = ArraySize(scene, kind);
+            const std::size_t count = ChunkCount(size);
+
+            // A resized array changes the chunk holding its old or new end;
+            // points are packed exactly, so their array is laid out again.
+            std::size_t from = chunks.size();
+            if (delta.full) from = 0;
+            else if (size != m_sizes[k]) from = (std::min)(size, m_sizes[k]) / kChunkSize;
+            if (count != chunks.size() || (kind == PrimitiveKind::Point && size != m_sizes[k])) m_needsLayout = true;
+
+            chunks.resize(count);
+            for (std::size_t c = from; c < count; ++c) chunks[c].dirty = true;
+            m_sizes[k] = size;
+        }
+
+        for (const auto& r : delta.ranges)
+        {
+            auto& chunks = m_chunks[static_cast<std::size_t>(r.kind)];
+            if (r.count == 0) continue;
+            const std::size_t last = (std::min<std::size_t>)((r.first + r.count - 1) / kChunkSize + 1, chunks.size());
+            for (std::size_t c = r.first / kChunkSize; c < last; ++c) chunks[c].dirty = true;
+        }
+    }
+
+    bool OcctSketchOverlay::rebuildChunk(const core::rendering::RenderScene& scene, PrimitiveKind kind, std::size_t index,
+        const core::rendering::CurveTessellator& curves)
+    {
+        Chunk& chunk = m_chunks[static_cast<std::size_t>(kind)][index];
+        bool changed = false;
+
+        WithArray(scene, kind, [&](const auto& items)
+        {
+            const std::size_t first = index * kChunkSize;
+            const std::size_t last = (std::min)(first + kChunkSize, items.size());
+
+            std::uint64_t fingerprint = 0xcbf29ce484222325ull;
+            HashInto(fingerprint, static_cast<float>(last - first));
+            for (std::size_t i = first; i < last; ++i)
+            {
+                HashPrimitive(fingerprint, items[i]);
+                HashInto(fingerprint, static_cast<float>(curves.span(kind, i).count)); // re-tessellated on zoom
+            }
+            if (chunk.built && fingerprint == chunk.fingerprint) return;
+
+            chunk.fingerprint = fingerprint;
+            chunk.built = true;
+            changed = true;
+
+            std::vector<Vertex> streams[kStreamCount];
+            for (std::size_t s = 0; s < kStreamCount; ++s)
+            {
+                streams[s].swap(chunk.runs[s].vertices);
+                streams[s].clear();
+            }
+            for (std::size_t i = first; i < last; ++i)
+                Tessellate(items[i], curves.strip(kind, i), curves.span(kind, i).count, streams);
+            for (std::size_t s = 0; s < kStreamCount; ++s) chunk.runs[s].vertices.swap(streams[s]);
+        });
+
+        return changed;
+    }
+
+    bool OcctSketchOverlay::writeInPlace(Chunk& chunk)
+    {
+        for (std::size_t s = 0; s < kStreamCount; ++s)
+        {
+            const Run& run = chunk.runs[s];
+            const bool fits = s == Points ? run.vertices.size() == run.capacity : run.vertices.size() <= run.capacity;
+            if (!fits || (run.capacity > 0 && m_arrays[s].IsNull())) return false;
+        }
+
+        for (std::size_t s = 0; s < kStreamCount; ++s)
+        {
+            const Run& run = chunk.runs[s];
+            if (run.capacity == 0) continue;
+
+            // Unused capacity holds zero-length segments, which draw nothing.
+            const Graphic3d_Vec4ub none(0, 0, 0, 0);
+            for (std::size_t i = 0; i < run.capacity; ++i)
+            {
+                const Standard_Integer index = static_cast<Standard_Integer>(run.offset + i + 1);
+                if (i < run.vertices.size())
+                {
+                    const Vertex& v = run.vertices[i];
+                    m_arrays[s]->SetVertice(index, v.p.x(), v.p.y(), v.p.z());
+                    m_arrays[s]->SetVertexColor(index, v.color);
+                }
+                else
+                {
+                    m_arrays[s]->SetVertice(index, 0.0f, 0.0f, 0.0f);
+                    m_arrays[s]->SetVertexColor(index, none);
+                }
+            }
+
+            Handle(Graphic3d_AttribBuffer) attribs = Handle(Graphic3d_AttribBuffer)::DownCast(m_arrays[s]->Attributes());
+            if (!attribs.IsNull())
+            {
+                attribs->Invalidate(static_cast<Standard_Integer>(run.offset),
+                    static_cast<Standard_Integer>(run.offset + run.capacity - 1));
+            }
+        }
+        return true;
+    }
+
+    void OcctSketchOverlay::layout()
+    {
+        for (std::size_t s = 0; s < kStreamCount; ++s)
+        {
+            std::size_t offset = 0;
+            for (auto& chunks : m_chunks)
+            {
+                for (Chunk& chunk : chunks)
+                {
+                    Run& run = chunk.runs[s];
+                    const std::size_t n = run.vertices.size();
+                    run.offset = offset;
+                    run.capacity = s == Points || n == 0 ? n : (n + n / 4 + kSegmentSlack) & ~std::size_t(1);
+                    offset += run.capacity;
+                }
+            }
+            m_capacity[s] = offset;
+
+            m_arrays[s].Nullify();
+            if (offset == 0) continue;
+
+            const Graphic3d_ArrayFlags flags = Graphic3d_ArrayFlags_VertexColor | Graphic3d_ArrayFlags_AttribsMutable;
+            if (s == Points) m_arrays[s] = new Graphic3d_ArrayOfPoints(static_cast<Standard_Integer>(offset), flags);
+            else m_arrays[s] = new Graphic3d_ArrayOfSegments(static_cast<Standard_Integer>(offset), 0, flags);
+
+            const Graphic3d_Vec4ub none(0, 0, 0, 0);
+            for (auto& chunks : m_chunks)
+            {
+                for (const Chunk& chunk : chunks)
+                {
+                    const Run& run = chunk.runs[s];
+                    for (std::size_t i = 0; i < run.capacity; ++i)
+                    {
+                        const bool used = i < run.vertices.size();
+                        const Vertex v = used ? run.vertices[i] : Vertex{ Graphic3d_Vec3(0.0f), none };
+                        const Standard_Integer index = m_arrays[s]->AddVertex(v.p.x(), v.p.y(), v.p.z());
+                        m_arrays[s]->SetVertexColor(index, v.color);
+                    }
+                }
+            }
+        }
+    }
+
+    void OcctSketchOverlay::Compute(const Handle(PrsMgr_PresentationManager)&, const Handle(Prs3d_Presentation)& prs,
+        const Standard_Integer mode)
+    {
+        if (mode != 0) return;
+
+        layout();
+
+        for (Stream s : { Solid, Construction })
+        {
+            if (m_arrays[s].IsNull()) continue;
+            Handle(Graphic3d_Group) group = prs->NewGroup();
+            group->SetGroupPrimitivesAspect(new Graphic3d_AspectLine3d(Quantity_NOC_WHITE,
+                s == Solid ? Aspect_TOL_SOLID : Aspect_TOL_DASH, m_lineWidth));
+            group->AddPrimitiveArray(m_arrays[s]);
+        }
+
+        if (!m_arrays[Points].IsNull())
+        {
+            Handle(Graphic3d_Group) group = prs->NewGroup();
+            group->SetGroupPrimitivesAspect(new Graphic3d_AspectMarker3d(Aspect_TOM_POINT, Quantity_NOC_WHITE, m_pointSize));
+            group->AddPrimitiveArray(m_arrays[Points]);
+        }
+
+        m_needsLayout = false;
+    }
+
+    std::size_t OcctSketchOverlay::segmentCount() const
+    {
+        std::size_t n = 0;
+        for (const auto& chunks : m_chunks)
+        {
+            for (const Chunk& chunk : chunks)
+                n += (chunk.runs[Solid].vertices.size() + chunk.runs[Construction].vertices.size()) / 2;
+        }
+        return n;
+    }
+
+    std::size_t OcctSketchOverlay::pointCount() const
+    {
+        std::size_t n = 0;
+        for (const auto& chunks : m_chunks)
+        {
+            for (const Chunk& chunk : chunks) n += chunk.runs[Points].vertices.size();
+        }
+        return n;
+    }
+
+} // namespace adapters
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "core/rendering/CurveTessellator.h"
+#include "core/rendering/RenderScene.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <AIS_InteractiveObject.hxx>
+#include <Graphic3d_ArrayOfPoints.hxx>
+#include <Graphic3d_ArrayOfSegments.hxx>
+#include <Graphic3d_Vec3.hxx>
+#include <Graphic3d_Vec4.hxx>
+
+namespace adapters {
+
+    // Draws a sketch RenderScene straight from vertex arrays: lines, polylines
+    // and the curve strips of a CurveTessellator become segments with per-
+    // vertex colour (solid and dashed construction geometry in their own
+    // groups), points go into a point array. No B-rep edges and no AIS
+    // meshing are involved.
+    //
+    // Primitives are handled in chunks of kChunkSize of one kind. Each chunk
+    // owns a run of vertices, with some slack, in the arrays; update()
+    // rebuilds only the chunks a delta touches and whose geometry, colour or
+    // curve tessellation actually changed, and writes them into the arrays
+    // in place (the changed range is re-uploaded on the next redraw). Only when a run
+    // outgrows its slack, or the number of points or chunks changes, is the
+    // presentation laid out again (needsLayout(); Compute() does it).
+    class OcctSketchOverlay : public AIS_InteractiveObject {
+        DEFINE_STANDARD_RTTI_INLINE(OcctSketchOverlay, AIS_InteractiveObject)
+    public:
+        static constexpr std::size_t kChunkSize = 256;
+
+        OcctSketchOverlay();
+
+        // Brings the arrays up to date with `scene`; `delta` says what changed
+        // since the last call, including the curves `curves` re-tessellated.
+        void update(const core::rendering::RenderScene& scene, const core::rendering::SceneDelta& delta,
+            const core::rendering::CurveTessellator& curves);
+
+        // The presentation must be recomputed (Redisplay) rather than just redrawn.
+        bool needsLayout() const { return m_needsLayout; }
+
+        std::size_t segmentCount() const;
+        std::size_t pointCount() const;
+
+        Standard_Boolean AcceptDisplayMode(const Standard_Integer mode) const override { return mode == 0; }
+
+        enum Stream { Solid, Construction, Points, kStreamCount };
+
+        struct Vertex
+        {
+            Graphic3d_Vec3 p;
+            Graphic3d_Vec4ub color;
+        };
+
+    private:
+        // A chunk's vertices in one stream and where they sit in its array.
+        struct Run
+        {
+            std::vector<Vertex> vertices;
+            std::size_t offset{ 0 };
+            std::size_t capacity{ 0 };
+        };
+
+        struct Chunk
+        {
+            std::uint64_t fingerprint{ 0 };
+            bool dirty{ true };
+            bool built{ false };
+            Run runs[kStreamCount];
+        };
+
+        std::vector<Chunk> m_chunks[core::rendering::kPrimitiveKindCount];
+        std::size_t m_sizes[core::rendering::kPrimitiveKindCount]{};
+
+        Handle(Graphic3d_ArrayOfPrimitives) m_arrays[kStreamCount];
+        std::size_t m_capacity[kStreamCount]{};
+        bool m_needsLayout{ true };
+
+        float m_lineWidth{ 2.0f };
+        float m_pointSize{ 6.0f };
+
+        void Compute(const Handle(PrsMgr_PresentationManager)& prsMgr, const Handle(Prs3d_Presentation)& prs,
+            const Standard_Integer mode) override;
+        void ComputeSelection(const Handle(SelectMgr_Selection)&, const Standard_Integer) override {}
+
+        void markDirty(const core::rendering::RenderScene& scene, const core::rendering::SceneDelta& delta);
+        bool rebuildChunk(const core::rendering::RenderScene& scene, core::rendering::PrimitiveKind kind,
+            std::size_t index, const core::rendering::CurveTessellator& curves);
+        bool writeInPlace(Chunk& chunk);
+        void layout();
+    };
+
+} // namespace adapters
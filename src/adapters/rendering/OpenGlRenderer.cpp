@@ -2,10 +2,195 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace adapters {
 
+    // Curve resolution on the GPU, as for CPU tessellation.
+    static constexpr float kCurvePixelError = 0.5f;
+    static constexpr int kCurveMinSegments = 8;
+    static constexpr int kCurveMaxSegments = 256;
+
+    // A line segment as the line shader reads it: its neighbours are the
+    // ends themselves where the line ends. `distance` is the length of the
+    // line before `a`, in world units.
+    struct LineSegment {
+        glm::vec3 prev;
+        glm::vec3 a;
+        glm::vec3 b;
+        glm::vec3 next;
+        uint32_t rgba;
+        float distance;
+    };
+
+    // A model mesh vertex as uploaded.
+    struct MeshVertex {
+        glm::vec3 position;
+        glm::vec3 normal;    // zero when the geometry has none
+    };
+
+    // Edges between faces bent further than this (30 degrees) are drawn.
+    static constexpr float kCreaseCos = 0.8660254f;
+
+    // Edge colour, as a fraction of the part colour.
+    static constexpr float kEdgeShade = 0.35f;
+
+    // Appends to `indices`, after the triangle indices it holds, the index
+    // pairs of the feature edges: edges not shared by exactly two triangles
+    // (boundaries; a BRep mesh has separate vertices per face, so these
+    // include every face edge) and creases sharper than kCreaseCos.
+    static void appendFeatureEdges(const std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices) {
+        struct EdgeUse {
+            glm::vec3 normal;
+            int count;
+            bool crease;
+        };
+        const size_t triangleIndices = indices.size();
+        std::unordered_map<uint64_t, EdgeUse> edges;
+        edges.reserve(triangleIndices);
+
+        for (size_t t = 0; t + 2 < triangleIndices; t += 3) {
+            const glm::vec3& a = vertices[indices[t]].position;
+            const glm::vec3& b = vertices[indices[t + 1]].position;
+            const glm::vec3& c = vertices[indices[t + 2]].position;
+            glm::vec3 n = glm::cross(b - a, c - a);
+            const float len = glm::length(n);
+            if (len <= 0.0f) continue;
+            n = n / len;
+
+            for (size_t e = 0; e < 3; ++e) {
+                const uint32_t i = indices[t + e];
+                const uint32_t j = indices[t + (e + 1) % 3];
+                const uint64_t key = (uint64_t(std::min(i, j)) << 32) | std::max(i, j);
+                auto [it, inserted] = edges.try_emplace(key, EdgeUse{ n, 0, false });
+                EdgeUse& use = it->second;
+                if (!inserted && use.count == 1 && glm::dot(use.normal, n) < kCreaseCos) use.crease = true;
+                ++use.count;
+            }
+        }
+
+        for (const auto& [key, use] : edges) {
+            if (use.count == 2 && !use.crease) continue;
+            indices.push_back(uint32_t(key >> 32));
+            indices.push_back(uint32_t(key & 0xffffffffu));
+        }
+    }
+
+    // Finest grid decade shown: cells at least this many pixels wide.
+    static constexpr float kGridMinCellPixels = 12.0f;
+
+    // Dash pattern of construction lines, in pixels at width 2.
+    static constexpr float kDashOn = 8.0f;
+    static constexpr float kDashOff = 6.0f;
+
+    // Screen-space expansion of a line segment into a quad, shared by the
+    // line and curve vertex shaders. Corners 0..3 run A-, B-, A+, B+ (a
+    // triangle strip). With round joins (uJoin 0) the quad reaches a half
+    // width past each end and the fragment shader rounds it off, so
+    // consecutive segments overlap in round joins; with miter joins (uJoin
+    // 1) the corners at a shared end meet the neighbouring segment's edges
+    // on the bisector, up to a miter limit. Open ends get caps either way.
+    // vLocal is the fragment's position in pixels along and across the
+    // segment; vDash its distance along the whole line, for dashing.
+    static const char* kLineVsHeader = R"GLSL(
+        #version 330 core
+        uniform mat4 uMVP;
+        uniform vec2 uViewport;
+        uniform float uWidth;
+        uniform int uJoin;
+        out vec4 vColor;
+        out vec2 vLocal;
+        out float vDash;
+        flat out float vLength;
+        flat out float vHalfWidth;
+
+        vec2 pixels(vec4 clip) {
+            return clip.xy / max(abs(clip.w), 1e-6) * 0.5 * uViewport;
+        }
+
+        void expandSegment(vec3 prev, vec3 a, vec3 b, vec3 next, float distance, int corner) {
+            vec4 ca = uMVP * vec4(a, 1.0);
+            vec4 cb = uMVP * vec4(b, 1.0);
+            vec2 pa = pixels(ca);
+            vec2 pb = pixels(cb);
+            vec2 d = pb - pa;
+            float len = length(d);
+            d = len > 1e-6 ? d / len : vec2(1.0, 0.0);
+            vec2 n = vec2(-d.y, d.x);
+
+            float hw = max(0.5 * uWidth, 0.5);
+            float r = hw + 1.0; // room for the anti-aliased rim
+            bool atB = (corner & 1) != 0;
+            float side = (corner & 2) != 0 ? 1.0 : -1.0;
+            bool open = atB ? next == b : prev == a;
+
+            vec2 offset = side * r * n;
+            bool mitered = false;
+            if (uJoin == 1 && !open) {
+                vec2 other = atB ? pixels(uMVP * vec4(next, 1.0)) - pb : pa - pixels(uMVP * vec4(prev, 1.0));
+                float ol = length(other);
+                if (ol > 1e-6) {
+                    vec2 t = normalize(d + other / ol);
+                    vec2 m = vec2(-t.y, t.x);
+                    float k = dot(m, n);
+                    if (k > 0.25) { // miter limit 4
+                        offset = side * r / k * m;
+                        mitered = true;
+                    }
+                }
+            }
+            if (!mitered)
+                offset += (atB ? r : -r) * d;
+
+            vec4 clip = atB ? cb : ca;
+            vec2 p = (atB ? pb : pa) + offset;
+            gl_Position = vec4(p / (0.5 * uViewport) * clip.w, clip.z, clip.w);
+
+            vLocal = vec2((atB ? len : 0.0) + dot(offset, d), dot(offset, n));
+            vLength = len;
+            vHalfWidth = hw;
+            float worldLength = length(b - a);
+            vDash = distance * (worldLength > 0.0 ? len / worldLength : 0.0) + vLocal.x;
+        }
+    )GLSL";
+
+    // Coverage of a line fragment: distance to the segment (a capsule) for
+    // round joins, across it only for mitered ones, blended over a pixel.
+    static const char* kLineFsSrc = R"GLSL(
+        #version 330 core
+        in vec4 vColor;
+        in vec2 vLocal;
+        in float vDash;
+        flat in float vLength;
+        flat in float vHalfWidth;
+        uniform int uJoin;
+        uniform int uDashed;
+        uniform vec2 uDash; // on, off in pixels
+        out vec4 FragColor;
+        void main() {
+            float dist = abs(vLocal.y);
+            if (uJoin == 0) {
+                float along = vLocal.x < 0.0 ? -vLocal.x : max(vLocal.x - vLength, 0.0);
+                dist = length(vec2(along, vLocal.y));
+            }
+            float coverage = clamp(vHalfWidth + 0.5 - dist, 0.0, 1.0);
+            if (uDashed != 0) {
+                float phase = mod(vDash, uDash.x + uDash.y);
+                coverage *= clamp(min(phase + 0.5, uDash.x + 0.5 - phase), 0.0, 1.0);
+            }
+            if (coverage <= 0.0) discard;
+            FragColor = vec4(vColor.rgb, vColor.a * coverage);
+        }
+    )GLSL";
+
     static GLuint compileShader(GLenum type, const char* src) {
         GLuint s = glCreateShader(type);
         glShaderSource(s, 1, &src, nullptr);
@@ -51,11 +236,16 @@ namespace adapters {
 
     bool OpenGlRenderer::initialize() {
         // Assumes an OpenGL context is current (created by the UI adapter).
+        if (m_initialized) return true;
+        if (!LoadGlFunctions()) return false;
         try {
             ensureProgram();
 
-            glGenVertexArrays(1, &m_vao);
-            glGenBuffers(1, &m_vbo);
+            glGenVertexArrays(1, &m_pointVao);
+            glGenVertexArrays(1, &m_lineVao);
+            glGenVertexArrays(1, &m_curveVao);
+            glGenVertexArrays(1, &m_gridVao);
+            glGenBuffers(1, &m_curveVbo);
 
             recreateFramebuffer();
 
@@ -69,18 +259,55 @@ namespace adapters {
 
     void OpenGlRenderer::shutdown() {
         destroyFramebuffer();
+        destroyMeshes();
         destroyDrawResources();
         m_initialized = false;
     }
 
     void OpenGlRenderer::setModel(std::shared_ptr<domain::Model> model) {
-        // This renderer currently ignores OCCT shapes. We'll add meshing later.
+        // OCCT shapes are ignored; the geometries' meshes are uploaded by the next render().
+        std::lock_guard<std::mutex> lock(m_modelMutex);
         m_model = std::move(model);
     }
 
     void OpenGlRenderer::fitAll() {
-        // Minimal: reset camera to a reasonable default.
-        m_camera = ports::CameraState{};
+        // The camera belongs to the render thread; it is fitted there.
+        m_fitPending = true;
+    }
+
+    void OpenGlRenderer::fitToModel() {
+        glm::vec3 lo(FLT_MAX, FLT_MAX, FLT_MAX);
+        glm::vec3 hi(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        bool any = false;
+        if (m_renderModel) {
+            for (const auto& geometry : m_renderModel->getGeometries()) {
+                if (!geometry) continue;
+                for (const domain::Point3D& p : geometry->getVertices()) {
+                    lo = glm::vec3(std::min(lo.x, p[0]), std::min(lo.y, p[1]), std::min(lo.z, p[2]));
+                    hi = glm::vec3(std::max(hi.x, p[0]), std::max(hi.y, p[1]), std::max(hi.z, p[2]));
+                    any = true;
+                }
+            }
+        }
+        if (!any) {
+            m_camera = ports::CameraState{};
+            return;
+        }
+
+        // Keep the view direction and fit the bounding sphere into the
+        // narrower of the two fields of view.
+        const glm::vec3 center = (lo + hi) * 0.5f;
+        const float radius = std::max(glm::length(hi - lo) * 0.5f, 1e-3f);
+        const float aspect = (m_height > 0) ? (float)m_width / (float)m_height : 1.0f;
+        glm::vec3 dir = m_camera.position - m_camera.target;
+        dir = glm::length(dir) > 1e-6f ? glm::normalize(dir) : glm::vec3(0.0f, 0.0f, 1.0f);
+
+        const float halfFov = std::atan(std::tan(0.5f * m_camera.fovYRadians) * std::min(aspect, 1.0f));
+        const float distance = radius / std::sin(halfFov);
+        m_camera.target = center;
+        m_camera.position = center + dir * distance;
+        m_camera.orthoScale = radius / std::min(aspect, 1.0f);
+        m_camera.farPlane = std::max(m_camera.farPlane, 2.0f * (distance + radius));
     }
 
     void* OpenGlRenderer::getFramebufferTexture() {
@@ -94,8 +321,9 @@ namespace adapters {
         if (m_initialized) recreateFramebuffer();
     }
 
-    void OpenGlRenderer::setScene(const ports::RenderScene& scene) {
-        m_scene = scene;
+    void OpenGlRenderer::setScene(ports::RenderSceneSnapshot scene) {
+        // The arena is uploaded on the next render() if the revision changed.
+        m_scene = std::move(scene);
     }
 
     void OpenGlRenderer::setCameraState(const ports::CameraState& camera) {
@@ -118,9 +346,15 @@ namespace adapters {
         return ports::RendererBackend::OpenGL;
     }
 
-    void OpenGlRenderer::render() {
+    void OpenGlRenderer::render(GLFWwindow* /*window*/) {
         if (!m_initialized || m_fbo == 0) return;
 
+        {
+            std::lock_guard<std::mutex> lock(m_modelMutex);
+            m_renderModel = m_model;
+        }
+        if (m_fitPending.exchange(false)) fitToModel();
+
         glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
         glViewport(0, 0, m_width, m_height);
         glEnable(GL_DEPTH_TEST);
@@ -128,10 +362,15 @@ namespace adapters {
         glClearColor(0.12f, 0.12f, 0.12f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Basic grid + scene
+        // Opaque model first, so the grid and sketch blend over it.
+        drawModel();
         drawWorkplaneGrid();
         drawScenePrimitives();
 
+        // Leave the state the UI draws with as it was.
+        glDisable(GL_DEPTH_TEST);
+        glBindVertexArray(0);
+        glUseProgram(0);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
@@ -242,46 +481,278 @@ namespace adapters {
     }
 
     void OpenGlRenderer::destroyDrawResources() {
-        if (m_program) {
-            glDeleteProgram(m_program);
-            m_program = 0;
+        for (GLuint* program : { &m_gridProgram, &m_pointProgram, &m_lineProgram, &m_curveProgram, &m_meshProgram }) {
+            if (*program) {
+                glDeleteProgram(*program);
+                *program = 0;
+            }
         }
-        if (m_vbo) {
-            glDeleteBuffers(1, &m_vbo);
-            m_vbo = 0;
+        m_sceneBuffer.destroy();
+        m_batches.clear();
+        if (m_curveVbo) {
+            glDeleteBuffers(1, &m_curveVbo);
+            m_curveVbo = 0;
         }
-        if (m_vao) {
-            glDeleteVertexArrays(1, &m_vao);
-            m_vao = 0;
+        m_curveCapacity = 0;
+        m_curveRuns.clear();
+        m_uploadedRevision = 0;
+        m_uploadedCurves = 0;
+        m_gridRevision = 0;
+        for (GLuint* vao : { &m_gridVao, &m_pointVao, &m_lineVao, &m_curveVao }) {
+            if (*vao) {
+                glDeleteVertexArrays(1, vao);
+                *vao = 0;
+            }
         }
     }
 
+    static GLuint buildProgram(const char* vsSrc, const char* fsSrc) {
+        GLuint vs = compileShader(GL_VERTEX_SHADER, vsSrc);
+        GLuint fs = 0;
+        try {
+            fs = compileShader(GL_FRAGMENT_SHADER, fsSrc);
+        } catch (...) {
+            glDeleteShader(vs);
+            throw;
+        }
+        GLuint p = 0;
+        try {
+            p = linkProgram(vs, fs);
+        } catch (...) {
+            glDeleteShader(vs);
+            glDeleteShader(fs);
+            throw;
+        }
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        return p;
+    }
+
     void OpenGlRenderer::ensureProgram() {
-        if (m_program) return;
+        if (m_gridProgram) return;
 
-        const char* vsSrc = R"GLSL(
+        // The grid: a triangle covering the screen, made from gl_VertexID.
+        const char* gridVsSrc = R"GLSL(
             #version 330 core
-            layout(location=0) in vec3 aPos;
+            out vec2 vNdc;
+            void main() {
+                vNdc = vec2(float((gl_VertexID & 1) << 2) - 1.0, float((gl_VertexID & 2) << 1) - 1.0);
+                gl_Position = vec4(vNdc, 0.0, 1.0);
+            }
+        )GLSL";
+
+        // Casts the pixel's view ray onto the workplane and draws the lines
+        // of the plane's UV grid there, anti-aliased over the pixel's
+        // footprint. The spacing steps by decades so lines stay at least
+        // uMinCellPixels apart, the finer decade fading out as it gets
+        // dense; the whole grid fades with distance from the focus.
+        const char* gridFsSrc = R"GLSL(
+            #version 330 core
+            in vec2 vNdc;
+            uniform mat4 uViewProj;
+            uniform mat4 uInvViewProj;
+            uniform mat4 uWorldToPlane;
+            uniform vec3 uPlaneOrigin;
+            uniform vec3 uPlaneNormal;
+            uniform vec3 uFocus;
+            uniform float uSpacing;
+            uniform float uFadeDistance;
+            uniform float uMinCellPixels;
+            uniform vec4 uMinorColor;
+            uniform vec4 uMajorColor;
+            out vec4 FragColor;
+
+            float gridLines(vec2 uv, float spacing) {
+                vec2 w = fwidth(uv) / spacing;
+                vec2 g = abs(fract(uv / spacing - 0.5) - 0.5) / max(w, vec2(1e-6));
+                return 1.0 - min(min(g.x, g.y), 1.0);
+            }
+
+            void main() {
+                vec4 n4 = uInvViewProj * vec4(vNdc, -1.0, 1.0);
+                vec4 f4 = uInvViewProj * vec4(vNdc, 1.0, 1.0);
+                vec3 nearP = n4.xyz / n4.w;
+                vec3 dir = f4.xyz / f4.w - nearP;
+
+                // Derivatives need every pixel of a quad to get this far, so
+                // misses are only discarded once the grid is evaluated.
+                float denom = dot(dir, uPlaneNormal);
+                float t = dot(uPlaneOrigin - nearP, uPlaneNormal) / (abs(denom) < 1e-9 ? 1e-9 : denom);
+                bool hit = abs(denom) >= 1e-9 && t >= 0.0 && t <= 1.0;
+                vec3 p = nearP + clamp(t, 0.0, 1.0) * dir;
+                vec2 uv = (uWorldToPlane * vec4(p, 1.0)).xy;
+
+                // Pixels per grid cell, from the UV footprint of this pixel.
+                float footprint = max(length(fwidth(uv)), 1e-9);
+                float lod = max(log(uMinCellPixels * footprint / uSpacing) / log(10.0), 0.0);
+                float minor = uSpacing * pow(10.0, floor(lod));
+                float major = minor * 10.0;
+
+                float minorLine = gridLines(uv, minor) * (1.0 - fract(lod));
+                float majorLine = gridLines(uv, major);
+                vec4 color = mix(uMinorColor, uMajorColor, majorLine);
+                color.a *= max(minorLine, majorLine);
+                color.a *= 1.0 - smoothstep(0.5 * uFadeDistance, uFadeDistance, length(p - uFocus));
+                if (!hit || color.a <= 0.0) discard;
+
+                vec4 clip = uViewProj * vec4(p, 1.0);
+                gl_FragDepth = 0.5 * clip.z / clip.w + 0.5;
+                FragColor = color;
+            }
+        )GLSL";
+
+        m_gridProgram = buildProgram(gridVsSrc, gridFsSrc);
+
+        // Screen-aligned quad per point instance, a pixel larger than the
+        // point for the anti-aliased rim; the corner comes from gl_VertexID.
+        const char* pointVsSrc = R"GLSL(
+            #version 330 core
+            layout(location=0) in vec3 iPos;
+            layout(location=1) in vec4 iColor;
             uniform mat4 uMVP;
+            uniform vec2 uViewport;
+            uniform float uPointSize;
+            out vec4 vColor;
+            out vec2 vCorner;
             void main() {
-                gl_Position = uMVP * vec4(aPos, 1.0);
+                vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1)) * 2.0 - 1.0;
+                float r = 0.5 * uPointSize + 1.0;
+                vec4 clip = uMVP * vec4(iPos, 1.0);
+                clip.xy += corner * r / (0.5 * uViewport) * clip.w;
+                gl_Position = clip;
+                vColor = iColor;
+                vCorner = corner * r;
             }
         )GLSL";
 
-        const char* fsSrc = R"GLSL(
+        const char* pointFsSrc = R"GLSL(
             #version 330 core
+            in vec4 vColor;
+            in vec2 vCorner;
+            uniform float uPointSize;
             out vec4 FragColor;
+            void main() {
+                float coverage = clamp(0.5 * uPointSize + 0.5 - length(vCorner), 0.0, 1.0);
+                if (coverage <= 0.0) discard;
+                FragColor = vec4(vColor.rgb, vColor.a * coverage);
+            }
+        )GLSL";
+
+        m_pointProgram = buildProgram(pointVsSrc, pointFsSrc);
+
+        // One segment instance (with its neighbours, for the joins) per quad.
+        const std::string lineVsSrc = std::string(kLineVsHeader) + R"GLSL(
+            layout(location=0) in vec3 iPrev;
+            layout(location=1) in vec3 iA;
+            layout(location=2) in vec3 iB;
+            layout(location=3) in vec3 iNext;
+            layout(location=4) in vec4 iColor;
+            layout(location=5) in float iDistance;
+            void main() {
+                vColor = iColor;
+                expandSegment(iPrev, iA, iB, iNext, iDistance, gl_VertexID);
+            }
+        )GLSL";
+
+        m_lineProgram = buildProgram(lineVsSrc.c_str(), kLineFsSrc);
+
+        // Elliptical arc per instance, drawn as uMaxSegments quads of which
+        // the first n are used: n keeps the chords within uPixelError pixels
+        // of the curve at its projected size, the rest are moved outside the
+        // clip volume. Each quad is expanded like a line segment, with the
+        // neighbouring points of the curve for its joins.
+        const std::string curveVsSrc = std::string(kLineVsHeader) + R"GLSL(
+            layout(location=0) in vec3 iCenter;
+            layout(location=1) in float iStart;
+            layout(location=2) in vec3 iAxisU;
+            layout(location=3) in float iEnd;
+            layout(location=4) in vec3 iAxisV;
+            layout(location=5) in vec4 iColor;
+            uniform float uPixelError;
+            uniform int uMinSegments;
+            uniform int uMaxSegments;
+
+            float sweep;
+            float n;
+
+            vec3 at(float k) {
+                float t = iStart + sweep * k / n;
+                return iCenter + cos(t) * iAxisU + sin(t) * iAxisV;
+            }
+
+            void main() {
+                vec2 c = pixels(uMVP * vec4(iCenter, 1.0));
+                float r = max(length(pixels(uMVP * vec4(iCenter + iAxisU, 1.0)) - c),
+                              length(pixels(uMVP * vec4(iCenter + iAxisV, 1.0)) - c));
+
+                sweep = iEnd - iStart;
+                float turns = min(abs(sweep) / 6.28318530718, 1.0);
+                float lo = max(1.0, ceil(float(uMinSegments) * turns));
+                float hi = max(lo, ceil(float(uMaxSegments) * turns));
+                n = lo;
+                if (r > uPixelError)
+                    n = clamp(ceil(abs(sweep) / (2.0 * acos(1.0 - uPixelError / r))), lo, hi);
+
+                int segment = gl_VertexID / 6;
+                vColor = iColor;
+                if (float(segment) >= n) {
+                    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+                    return;
+                }
+
+                // Two triangles over the strip corners 0 1 2 3.
+                const int corners[6] = int[6](0, 1, 2, 2, 1, 3);
+                float k = float(segment);
+                bool closed = abs(sweep) > 6.2831;
+                vec3 a = at(k);
+                vec3 b = at(k + 1.0);
+                vec3 prev = k > 0.0 ? at(k - 1.0) : (closed ? at(n - 1.0) : a);
+                vec3 next = k + 2.0 <= n ? at(k + 2.0) : (closed ? at(1.0) : b);
+                expandSegment(prev, a, b, next, k * length(b - a), corners[gl_VertexID % 6]);
+            }
+        )GLSL";
+
+        m_curveProgram = buildProgram(curveVsSrc.c_str(), kLineFsSrc);
+
+        // Model meshes. The model transform is the identity, and the view
+        // is rigid, so its upper 3x3 turns normals into view space.
+        const char* meshVsSrc = R"GLSL(
+            #version 330 core
+            layout(location=0) in vec3 aPos;
+            layout(location=1) in vec3 aNormal;
+            uniform mat4 uViewProj;
+            uniform mat4 uView;
+            out vec3 vViewPos;
+            out vec3 vNormal;
+            void main() {
+                vViewPos = (uView * vec4(aPos, 1.0)).xyz;
+                vNormal = mat3(uView) * aNormal;
+                gl_Position = uViewProj * vec4(aPos, 1.0);
+            }
+        )GLSL";
+
+        // Lambert under a headlight along the view axis, two-sided so open
+        // shells and flipped faces still read, over some ambient. Meshes
+        // without normals are shaded per face. Edges (uLit 0) are flat.
+        const char* meshFsSrc = R"GLSL(
+            #version 330 core
+            in vec3 vViewPos;
+            in vec3 vNormal;
             uniform vec4 uColor;
+            uniform int uLit;
+            out vec4 FragColor;
             void main() {
-                FragColor = uColor;
+                vec3 faceNormal = cross(dFdx(vViewPos), dFdy(vViewPos));
+                if (uLit == 0) {
+                    FragColor = uColor;
+                    return;
+                }
+                vec3 n = normalize(dot(vNormal, vNormal) > 1e-12 ? vNormal : faceNormal);
+                FragColor = vec4(uColor.rgb * (0.3 + 0.7 * abs(n.z)), uColor.a);
             }
         )GLSL";
 
-        GLuint vs = compileShader(GL_VERTEX_SHADER, vsSrc);
-        GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSrc);
-        m_program = linkProgram(vs, fs);
-        glDeleteShader(vs);
-        glDeleteShader(fs);
+        m_meshProgram = buildProgram(meshVsSrc, meshFsSrc);
     }
 
     glm::mat4 OpenGlRenderer::makeView(const ports::CameraState& c) {
@@ -297,101 +768,447 @@ namespace adapters {
     }
 
     void OpenGlRenderer::drawWorkplaneGrid() {
-        if (!m_scene.hasWorkplane) return;
+        if (!m_scene || !m_scene->hasWorkplane) return;
+        const ports::RenderScene& scene = *m_scene;
 
-        // Build a simple grid in plane UV, transform to world.
-        const int lines = std::max(1, m_scene.workplaneGridLines);
-        const float spacing = m_scene.workplaneGridSpacing;
-        const float half = lines * spacing;
+        if (m_gridRevision != scene.revision || scene.revision == 0) {
+            m_worldToPlane = glm::inverse(scene.workplaneToWorld);
+            m_gridRevision = scene.revision;
+        }
 
-        std::vector<glm::vec3> verts;
-        verts.reserve((size_t)(lines * 4 + 4));
+        float aspect = (m_height > 0) ? (float)m_width / (float)m_height : 1.0f;
+        glm::mat4 viewProj = makeProj(m_camera, aspect) * makeView(m_camera);
+        glm::mat4 invViewProj = glm::inverse(viewProj);
 
-        auto xform = m_scene.workplaneToWorld;
         // Offset slightly along plane normal to reduce z-fighting.
-        glm::vec3 n = glm::normalize(glm::vec3(xform[2]));
-        glm::vec3 bias = n * m_scene.workplaneDepthBias;
+        const glm::vec3 normal = glm::normalize(glm::vec3(scene.workplaneToWorld[2]));
+        const glm::vec3 origin = glm::vec3(scene.workplaneToWorld[3]) + normal * scene.workplaneDepthBias;
+
+        // Fade where the old fixed grid ended, or further out when the view is wider.
+        const float view = m_camera.orthographic ? m_camera.orthoScale * std::max(aspect, 1.0f)
+                                                 : glm::length(m_camera.position - m_camera.target);
+        const float extent = std::max(1, scene.workplaneGridLines) * scene.workplaneGridSpacing;
+        const float fade = std::max(extent, 3.0f * view);
+
+        GLuint p = m_gridProgram;
+        glUseProgram(p);
+        glBindVertexArray(m_gridVao);
+        glUniformMatrix4fv(glGetUniformLocation(p, "uViewProj"), 1, GL_FALSE, &viewProj[0][0]);
+        glUniformMatrix4fv(glGetUniformLocation(p, "uInvViewProj"), 1, GL_FALSE, &invViewProj[0][0]);
+        glUniformMatrix4fv(glGetUniformLocation(p, "uWorldToPlane"), 1, GL_FALSE, &m_worldToPlane[0][0]);
+        glUniform3f(glGetUniformLocation(p, "uPlaneOrigin"), origin.x, origin.y, origin.z);
+        glUniform3f(glGetUniformLocation(p, "uPlaneNormal"), normal.x, normal.y, normal.z);
+        glUniform3f(glGetUniformLocation(p, "uFocus"), m_camera.target.x, m_camera.target.y, m_camera.target.z);
+        glUniform1f(glGetUniformLocation(p, "uSpacing"), std::max(scene.workplaneGridSpacing, 1e-6f));
+        glUniform1f(glGetUniformLocation(p, "uFadeDistance"), fade);
+        glUniform1f(glGetUniformLocation(p, "uMinCellPixels"), kGridMinCellPixels);
+        glUniform4f(glGetUniformLocation(p, "uMinorColor"), 0.3f, 0.3f, 0.3f, 0.6f);
+        glUniform4f(glGetUniformLocation(p, "uMajorColor"), 0.45f, 0.45f, 0.45f, 1.0f);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
+    }
+
+    void OpenGlRenderer::uploadScene() {
+        const ports::RenderScene& scene = *m_scene;
+        m_batches.clear();
+
+        // One batch per draw state, in the order the states first appear.
+        std::vector<int> batchOf(scene.ranges.size(), -1);
+        for (size_t i = 0; i < scene.ranges.size(); ++i) {
+            const ports::DrawRange& r = scene.ranges[i];
+            GLsizei n = 0;
+            switch (r.kind) {
+            case ports::RenderPrimitiveKind::PointList: n = GLsizei(r.count); break;
+            case ports::RenderPrimitiveKind::LineList: n = GLsizei(r.count / 2); break;
+            case ports::RenderPrimitiveKind::LineStrip: n = r.count > 1 ? GLsizei(r.count - 1) : 0; break;
+            }
+            if (n == 0) continue;
+
+            const GLenum mode = r.kind == ports::RenderPrimitiveKind::PointList ? GL_POINTS : GL_LINES;
+            auto it = std::find_if(m_batches.begin(), m_batches.end(), [&](const Batch& b) {
+                return b.mode == mode && b.size == r.size && b.flags == r.flags;
+            });
+            if (it == m_batches.end()) {
+                Batch b;
+                b.mode = mode;
+                b.size = r.size;
+                b.flags = r.flags;
+                it = m_batches.insert(m_batches.end(), b);
+            }
+            it->count += n;
+            batchOf[i] = int(it - m_batches.begin());
+        }
+
+        std::vector<size_t> cursor(m_batches.size());
+        size_t total = 0;
+        for (size_t b = 0; b < m_batches.size(); ++b) {
+            m_batches[b].offset = total;
+            cursor[b] = total;
+            const size_t stride = m_batches[b].mode == GL_POINTS ? sizeof(ports::RenderVertex) : sizeof(LineSegment);
+            total += size_t(m_batches[b].count) * stride;
+        }
+
+        size_t offset = 0;
+        auto* out = static_cast<char*>(m_sceneBuffer.begin(total, offset));
+        if (!out) {
+            m_batches.clear();
+            return;
+        }
+        for (Batch& b : m_batches) b.offset += offset;
+
+        for (size_t i = 0; i < scene.ranges.size(); ++i) {
+            if (batchOf[i] < 0) continue;
+            const ports::DrawRange& r = scene.ranges[i];
+            const ports::RenderVertex* v = scene.vertices.data() + r.first;
+            size_t& at = cursor[batchOf[i]];
 
-        auto toWorld = [&](float u, float v) {
-            glm::vec4 p = xform * glm::vec4(u, v, 0.0f, 1.0f);
-            return glm::vec3(p) + bias;
+            if (r.kind == ports::RenderPrimitiveKind::PointList) {
+                std::memcpy(out + at, v, r.count * sizeof(ports::RenderVertex));
+                at += r.count * sizeof(ports::RenderVertex);
+            }
+            else if (r.kind == ports::RenderPrimitiveKind::LineList) {
+                for (uint32_t k = 0; k + 1 < r.count; k += 2) {
+                    const LineSegment seg{ v[k].position, v[k].position, v[k + 1].position, v[k + 1].position, v[k].rgba, 0.0f };
+                    std::memcpy(out + at, &seg, sizeof(seg));
+                    at += sizeof(seg);
+                }
+            }
+            else {
+                // A strip that ends where it starts is closed: its ends join too.
+                const uint32_t n = r.count;
+                const glm::vec3& first = v[0].position;
+                const glm::vec3& last = v[n - 1].position;
+                const bool closed = n > 2 && first.x == last.x && first.y == last.y && first.z == last.z;
+                float distance = 0.0f;
+                for (uint32_t k = 0; k + 1 < n; ++k) {
+                    LineSegment seg;
+                    seg.a = v[k].position;
+                    seg.b = v[k + 1].position;
+                    seg.prev = k > 0 ? v[k - 1].position : (closed ? v[n - 2].position : seg.a);
+                    seg.next = k + 2 < n ? v[k + 2].position : (closed ? v[1].position : seg.b);
+                    seg.rgba = v[k].rgba;
+                    seg.distance = distance;
+                    distance += glm::length(seg.b - seg.a);
+                    std::memcpy(out + at, &seg, sizeof(seg));
+                    at += sizeof(seg);
+                }
+            }
+        }
+
+        m_sceneBuffer.commit();
+    }
+
+    void OpenGlRenderer::uploadCurves() {
+        const ports::RenderScene& scene = *m_scene;
+        const GLsizeiptr stride = (GLsizeiptr)sizeof(ports::CurveInstance);
+        glBindBuffer(GL_ARRAY_BUFFER, m_curveVbo);
+
+        // Holding the snapshot the changes are relative to: patch just those.
+        if (scene.curveBase != 0 && scene.curveBase == m_uploadedCurves && scene.curves.size() <= m_curveCapacity) {
+            bool restyled = false;
+            for (const ports::InstanceRange& r : scene.changedCurves) {
+                glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(r.first * stride), (GLsizeiptr)(r.count * stride),
+                    scene.curves.data() + r.first);
+
+                // Runs only need rebuilding if a changed instance left its run's style.
+                for (uint32_t i = r.first; i < r.first + r.count && !restyled; ++i) {
+                    auto next = std::upper_bound(m_curveRuns.begin(), m_curveRuns.end(), GLint(i),
+                        [](GLint at, const CurveRun& run) { return at < run.first; });
+                    const ports::CurveInstance& c = scene.curves[i];
+                    restyled = next == m_curveRuns.begin() || GLint(i) >= (next - 1)->first + (next - 1)->count
+                        || (next - 1)->size != c.size || (next - 1)->flags != c.flags;
+                }
+            }
+            if (restyled) buildCurveRuns();
+            m_uploadedCurves = scene.revision;
+            return;
+        }
+
+        if (scene.curves.size() > m_curveCapacity) {
+            m_curveCapacity = scene.curves.size() + scene.curves.size() / 2;
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_curveCapacity * stride, nullptr, GL_DYNAMIC_DRAW);
+        }
+        if (!scene.curves.empty())
+            glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)scene.curves.size() * stride, scene.curves.data());
+        buildCurveRuns();
+        m_uploadedCurves = scene.revision;
+    }
+
+    void OpenGlRenderer::buildCurveRuns() {
+        m_curveRuns.clear();
+        const auto& curves = m_scene->curves;
+        for (size_t i = 0; i < curves.size(); ++i) {
+            const ports::CurveInstance& c = curves[i];
+            if (m_curveRuns.empty() || m_curveRuns.back().size != c.size || m_curveRuns.back().flags != c.flags) {
+                CurveRun run;
+                run.size = c.size;
+                run.flags = c.flags;
+                run.first = GLint(i);
+                m_curveRuns.push_back(run);
+            }
+            ++m_curveRuns.back().count;
+        }
+    }
+
+    void OpenGlRenderer::setLineUniforms(GLuint program, const glm::mat4& mvp, float width, uint8_t flags) {
+        const float dashScale = std::max(1.0f, 0.5f * width);
+        glUniformMatrix4fv(glGetUniformLocation(program, "uMVP"), 1, GL_FALSE, &mvp[0][0]);
+        glUniform2f(glGetUniformLocation(program, "uViewport"), (float)m_width, (float)m_height);
+        glUniform1f(glGetUniformLocation(program, "uWidth"), width);
+        glUniform1i(glGetUniformLocation(program, "uJoin"), (GLint)m_lineJoin);
+        glUniform1i(glGetUniformLocation(program, "uDashed"), (flags & ports::RenderRangeConstruction) ? 1 : 0);
+        glUniform2f(glGetUniformLocation(program, "uDash"), kDashOn * dashScale, kDashOff * dashScale);
+
+        if (flags & ports::RenderRangeDepthTest) glEnable(GL_DEPTH_TEST);
+        else glDisable(GL_DEPTH_TEST);
+    }
+
+    void OpenGlRenderer::drawPoints(const Batch& b, const glm::mat4& mvp) {
+        glUseProgram(m_pointProgram);
+        glBindVertexArray(m_pointVao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_sceneBuffer.buffer());
+
+        // Per-instance attributes start at the batch, so the quad's vertices index from 0.
+        const GLsizei stride = (GLsizei)sizeof(ports::RenderVertex);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)(b.offset + offsetof(ports::RenderVertex, position)));
+        glVertexAttribDivisor(0, 1);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(b.offset + offsetof(ports::RenderVertex, rgba)));
+        glVertexAttribDivisor(1, 1);
+
+        glUniformMatrix4fv(glGetUniformLocation(m_pointProgram, "uMVP"), 1, GL_FALSE, &mvp[0][0]);
+        glUniform2f(glGetUniformLocation(m_pointProgram, "uViewport"), (float)m_width, (float)m_height);
+        glUniform1f(glGetUniformLocation(m_pointProgram, "uPointSize"), std::max(1.0f, b.size));
+
+        if (b.flags & ports::RenderRangeDepthTest) glEnable(GL_DEPTH_TEST);
+        else glDisable(GL_DEPTH_TEST);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, b.count);
+    }
+
+    void OpenGlRenderer::drawLines(const Batch& b, const glm::mat4& mvp) {
+        glUseProgram(m_lineProgram);
+        glBindVertexArray(m_lineVao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_sceneBuffer.buffer());
+
+        const GLsizei stride = (GLsizei)sizeof(LineSegment);
+        auto attrib = [&](GLuint loc, GLint n, GLenum type, GLboolean norm, size_t offset) {
+            glEnableVertexAttribArray(loc);
+            glVertexAttribPointer(loc, n, type, norm, stride, (void*)(b.offset + offset));
+            glVertexAttribDivisor(loc, 1);
         };
+        attrib(0, 3, GL_FLOAT, GL_FALSE, offsetof(LineSegment, prev));
+        attrib(1, 3, GL_FLOAT, GL_FALSE, offsetof(LineSegment, a));
+        attrib(2, 3, GL_FLOAT, GL_FALSE, offsetof(LineSegment, b));
+        attrib(3, 3, GL_FLOAT, GL_FALSE, offsetof(LineSegment, next));
+        attrib(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(LineSegment, rgba));
+        attrib(5, 1, GL_FLOAT, GL_FALSE, offsetof(LineSegment, distance));
+
+        setLineUniforms(m_lineProgram, mvp, b.size, b.flags);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, b.count);
+    }
+
+    void OpenGlRenderer::drawCurves(const glm::mat4& mvp) {
+        if (m_curveRuns.empty()) return;
+
+        glUseProgram(m_curveProgram);
+        glBindVertexArray(m_curveVao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_curveVbo);
+
+        glUniform1f(glGetUniformLocation(m_curveProgram, "uPixelError"), kCurvePixelError);
+        glUniform1i(glGetUniformLocation(m_curveProgram, "uMinSegments"), kCurveMinSegments);
+        glUniform1i(glGetUniformLocation(m_curveProgram, "uMaxSegments"), kCurveMaxSegments);
+
+        const GLsizei stride = (GLsizei)sizeof(ports::CurveInstance);
+        for (const CurveRun& run : m_curveRuns) {
+            // No base instance before GL 4.2: point the attributes at the run instead.
+            const size_t base = size_t(run.first) * sizeof(ports::CurveInstance);
+            auto attrib = [&](GLuint loc, GLint n, GLenum type, GLboolean norm, size_t offset) {
+                glEnableVertexAttribArray(loc);
+                glVertexAttribPointer(loc, n, type, norm, stride, (void*)(base + offset));
+                glVertexAttribDivisor(loc, 1);
+            };
+            attrib(0, 3, GL_FLOAT, GL_FALSE, offsetof(ports::CurveInstance, center));
+            attrib(1, 1, GL_FLOAT, GL_FALSE, offsetof(ports::CurveInstance, startAngle));
+            attrib(2, 3, GL_FLOAT, GL_FALSE, offsetof(ports::CurveInstance, axisU));
+            attrib(3, 1, GL_FLOAT, GL_FALSE, offsetof(ports::CurveInstance, endAngle));
+            attrib(4, 3, GL_FLOAT, GL_FALSE, offsetof(ports::CurveInstance, axisV));
+            attrib(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(ports::CurveInstance, rgba));
+
+            setLineUniforms(m_curveProgram, mvp, run.size, run.flags);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 6 * kCurveMaxSegments, run.count);
+        }
+    }
 
-        for (int i = -lines; i <= lines; ++i) {
-            float t = i * spacing;
-            // vertical
-            verts.push_back(toWorld(t, -half));
-            verts.push_back(toWorld(t, +half));
-            // horizontal
-            verts.push_back(toWorld(-half, t));
-            verts.push_back(toWorld(+half, t));
+    void OpenGlRenderer::syncMeshes() {
+        for (auto& entry : m_meshes) entry.second.live = false;
+
+        if (m_renderModel) {
+            for (const auto& geometry : m_renderModel->getGeometries()) {
+                if (!geometry || geometry->getTriangles().empty()) continue;
+                GpuMesh& mesh = m_meshes[geometry.get()];
+                // An expired source is a geometry freed since, its address now another's.
+                if (mesh.vao == 0 || mesh.source.expired() || mesh.version != geometry->getVersion()) {
+                    mesh.source = geometry;
+                    uploadMesh(*geometry, mesh);
+                }
+                mesh.live = true;
+            }
+        }
+
+        for (auto it = m_meshes.begin(); it != m_meshes.end();) {
+            if (it->second.live) {
+                ++it;
+                continue;
+            }
+            GpuMesh& mesh = it->second;
+            glDeleteBuffers(1, &mesh.vbo);
+            glDeleteBuffers(1, &mesh.ibo);
+            glDeleteVertexArrays(1, &mesh.vao);
+            it = m_meshes.erase(it);
         }
+    }
+
+    void OpenGlRenderer::uploadMesh(const domain::Geometry& geometry, GpuMesh& mesh) {
+        const std::vector<domain::Point3D>& positions = geometry.getVertices();
+        const std::vector<domain::Normal3D>& normals = geometry.getNormals();
+        const bool hasNormals = normals.size() == positions.size();
+
+        std::vector<MeshVertex> vertices(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            const domain::Point3D& p = positions[i];
+            vertices[i].position = glm::vec3(p[0], p[1], p[2]);
+            vertices[i].normal = hasNormals ? glm::vec3(normals[i][0], normals[i][1], normals[i][2]) : glm::vec3(0.0f);
+        }
+
+        std::vector<uint32_t> indices;
+        indices.reserve(geometry.getTriangles().size() * 4);
+        for (const domain::Triangle& t : geometry.getTriangles()) {
+            if (t[0] >= positions.size() || t[1] >= positions.size() || t[2] >= positions.size()) continue;
+            indices.insert(indices.end(), { uint32_t(t[0]), uint32_t(t[1]), uint32_t(t[2]) });
+        }
+        const size_t triangleIndices = indices.size();
+        appendFeatureEdges(vertices, indices);
+
+        if (!mesh.vao) {
+            glGenVertexArrays(1, &mesh.vao);
+            glGenBuffers(1, &mesh.vbo);
+            glGenBuffers(1, &mesh.ibo);
+        }
+
+        // The element buffer binding is part of the VAO.
+        glBindVertexArray(mesh.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(vertices.size() * sizeof(MeshVertex)), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indices.size() * sizeof(uint32_t)), indices.data(), GL_STATIC_DRAW);
 
-        glUseProgram(m_program);
-        glBindVertexArray(m_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(verts.size() * sizeof(glm::vec3)), verts.data(), GL_DYNAMIC_DRAW);
+        const GLsizei stride = (GLsizei)sizeof(MeshVertex);
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MeshVertex, position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MeshVertex, normal));
+        glBindVertexArray(0);
+
+        const domain::ColorRGBA& c = geometry.getColor();
+        mesh.color = glm::vec4(c[0], c[1], c[2], c[3]);
+        mesh.triangleIndices = (GLsizei)triangleIndices;
+        mesh.edgeIndices = (GLsizei)(indices.size() - triangleIndices);
+        mesh.version = geometry.getVersion();
+    }
+
+    void OpenGlRenderer::destroyMeshes() {
+        for (auto& entry : m_meshes) {
+            GpuMesh& mesh = entry.second;
+            glDeleteBuffers(1, &mesh.vbo);
+            glDeleteBuffers(1, &mesh.ibo);
+            glDeleteVertexArrays(1, &mesh.vao);
+        }
+        m_meshes.clear();
+    }
+
+    void OpenGlRenderer::drawModel() {
+        syncMeshes();
+        if (m_meshes.empty()) return;
 
         float aspect = (m_height > 0) ? (float)m_width / (float)m_height : 1.0f;
-        glm::mat4 mvp = makeProj(m_camera, aspect) * makeView(m_camera);
-        GLint locMVP = glGetUniformLocation(m_program, "uMVP");
-        glUniformMatrix4fv(locMVP, 1, GL_FALSE, &mvp[0][0]);
+        const glm::mat4 view = makeView(m_camera);
+        const glm::mat4 viewProj = makeProj(m_camera, aspect) * view;
+
+        const GLuint p = m_meshProgram;
+        glUseProgram(p);
+        glUniformMatrix4fv(glGetUniformLocation(p, "uViewProj"), 1, GL_FALSE, &viewProj[0][0]);
+        glUniformMatrix4fv(glGetUniformLocation(p, "uView"), 1, GL_FALSE, &view[0][0]);
+        const GLint colorLoc = glGetUniformLocation(p, "uColor");
+        const GLint litLoc = glGetUniformLocation(p, "uLit");
 
-        // Grey grid
-        GLint locColor = glGetUniformLocation(m_program, "uColor");
-        glUniform4f(locColor, 0.3f, 0.3f, 0.3f, 1.0f);
+        glEnable(GL_DEPTH_TEST);
 
-        glLineWidth(1.0f);
-        glDrawArrays(GL_LINES, 0, (GLsizei)verts.size());
+        // Faces pushed back a little, so their edges win the depth test.
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.0f, 1.0f);
+        glUniform1i(litLoc, 1);
+        for (const auto& entry : m_meshes) {
+            const GpuMesh& mesh = entry.second;
+            glBindVertexArray(mesh.vao);
+            glUniform4f(colorLoc, mesh.color.x, mesh.color.y, mesh.color.z, mesh.color.w);
+            glDrawElements(GL_TRIANGLES, mesh.triangleIndices, GL_UNSIGNED_INT, nullptr);
+        }
+        glDisable(GL_POLYGON_OFFSET_FILL);
+
+        glUniform1i(litLoc, 0);
+        for (const auto& entry : m_meshes) {
+            const GpuMesh& mesh = entry.second;
+            if (mesh.edgeIndices == 0) continue;
+            const glm::vec3 edge = glm::vec3(mesh.color.x, mesh.color.y, mesh.color.z) * kEdgeShade;
+            glBindVertexArray(mesh.vao);
+            glUniform4f(colorLoc, edge.x, edge.y, edge.z, 1.0f);
+            glDrawElements(GL_LINES, mesh.edgeIndices, GL_UNSIGNED_INT,
+                (void*)(size_t(mesh.triangleIndices) * sizeof(uint32_t)));
+        }
+        glBindVertexArray(0);
     }
 
     void OpenGlRenderer::drawScenePrimitives() {
-        if (m_scene.primitives.empty()) return;
+        if (!m_scene) return;
+
+        // Re-batched and uploaded once per change of the arena, not per frame;
+        // curve instances are patched where the snapshot allows.
+        if (m_uploadedRevision != m_scene->vertexRevision || m_scene->vertexRevision == 0) {
+            uploadScene();
+            m_uploadedRevision = m_scene->vertexRevision;
+        }
+        if (m_uploadedCurves != m_scene->revision || m_scene->revision == 0)
+            uploadCurves();
 
         float aspect = (m_height > 0) ? (float)m_width / (float)m_height : 1.0f;
         glm::mat4 mvp = makeProj(m_camera, aspect) * makeView(m_camera);
 
-        glUseProgram(m_program);
-        glBindVertexArray(m_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-
-        GLint locMVP = glGetUniformLocation(m_program, "uMVP");
-        glUniformMatrix4fv(locMVP, 1, GL_FALSE, &mvp[0][0]);
-
-        GLint locColor = glGetUniformLocation(m_program, "uColor");
-
-        for (const auto& prim : m_scene.primitives) {
-            if (prim.positions.empty()) continue;
-            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(prim.positions.size() * sizeof(glm::vec3)), prim.positions.data(), GL_DYNAMIC_DRAW);
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
-
-            float r = ((prim.rgba >> 24) & 0xFF) / 255.0f;
-            float g = ((prim.rgba >> 16) & 0xFF) / 255.0f;
-            float b = ((prim.rgba >> 8) & 0xFF) / 255.0f;
-            float a = ((prim.rgba >> 0) & 0xFF) / 255.0f;
-            glUniform4f(locColor, r, g, b, a);
-
-            if (!prim.depthTest) glDisable(GL_DEPTH_TEST);
-            else glEnable(GL_DEPTH_TEST);
-
-            switch (prim.kind) {
-            case ports::RenderPrimitiveKind::PointList:
-                glPointSize(std::max(1.0f, prim.size));
-                glDrawArrays(GL_POINTS, 0, (GLsizei)prim.positions.size());
-                break;
-            case ports::RenderPrimitiveKind::LineStrip:
-                glLineWidth(std::max(1.0f, prim.size));
-                glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)prim.positions.size());
-                break;
-            default:
-                glLineWidth(std::max(1.0f, prim.size));
-                glDrawArrays(GL_LINES, 0, (GLsizei)prim.positions.size());
-                break;
-            }
+        // Anti-aliased edges blend over what is behind them and must not
+        // hide it in the depth buffer.
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE);
+
+        drawCurves(mvp);
+        for (const Batch& b : m_batches) {
+            if (b.mode != GL_POINTS) drawLines(b, mvp);
+        }
+        // Points last, on top of the lines they sit on.
+        for (const Batch& b : m_batches) {
+            if (b.mode == GL_POINTS) drawPoints(b, mvp);
         }
+
+        glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+
+        if (!m_batches.empty()) m_sceneBuffer.fence();
     }
 
 } // namespace adapters
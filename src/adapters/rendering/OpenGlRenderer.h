@@ -1,20 +1,28 @@
 #pragma once
 
 #include "ports/IRendererPort.h"
+#include "adapters/rendering/GlFunctions.h"
+#include "adapters/rendering/GlRingBuffer.h"
 
+#include <atomic>
 #include <cstdint>
-
-// Use ImGui's OpenGL loader so we don't add a second GL loader to the build.
-#include <imgui_impl_opengl3_loader.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace adapters {
 
     // A lightweight, embedded OpenGL renderer that draws a renderer-agnostic RenderScene
     // into an FBO texture for display in the ImGui viewport.
     //
-    // This is intentionally minimal: it does not render OCCT BReps yet. The goal is to
+    // It does not render OCCT BReps itself: the model is drawn from the triangle meshes
+    // of its domain::Geometry, shaded with their feature edges on top. The goal is to
     // provide a second renderer adapter behind the same port so you can feature-toggle
     // between OCCT (native CAD view) and OpenGL (embedded view).
+    //
+    // Everything but setModel() and fitAll() runs on the thread whose GL context
+    // it draws with (the UI's); those two are called by loader threads too, and
+    // only take effect on the next render().
     class OpenGlRenderer final : public ports::IRendererPort {
     public:
         OpenGlRenderer();
@@ -22,7 +30,7 @@ namespace adapters {
 
         bool initialize() override;
         void shutdown() override;
-        void render() override;
+        void render(GLFWwindow* window) override;
 
         void setModel(std::shared_ptr<domain::Model> model) override;
         void fitAll() override;
@@ -30,7 +38,7 @@ namespace adapters {
         void* getFramebufferTexture() override;
         void resize(int width, int height) override;
 
-        void setScene(const ports::RenderScene& scene) override;
+        void setScene(ports::RenderSceneSnapshot scene) override;
         void setCameraState(const ports::CameraState& camera) override;
         ports::CameraState getCameraState() const override;
         ports::RendererCapabilities getCapabilities() const override;
@@ -41,22 +49,86 @@ namespace adapters {
         void zoom(float delta) override;
         void setViewDirection(int direction) override;
 
+        // How consecutive segments of a polyline or curve meet.
+        enum class LineJoin : uint8_t { Round = 0, Miter = 1 };
+        void setLineJoin(LineJoin join) { m_lineJoin = join; }
+
     private:
         bool m_initialized = false;
         int m_width = 800;
         int m_height = 600;
 
+        std::mutex m_modelMutex;
         std::shared_ptr<domain::Model> m_model;
-        ports::RenderScene m_scene;
+        std::shared_ptr<domain::Model> m_renderModel; // m_model as of the current render()
+        std::atomic<bool> m_fitPending{ false };
+        ports::RenderSceneSnapshot m_scene;
+        uint64_t m_uploadedRevision = 0; // vertexRevision the ring buffer holds
+        uint64_t m_uploadedCurves = 0;   // revision whose curves the curve buffer holds
         ports::CameraState m_camera;
 
         // GL resources
         GLuint m_fbo = 0;
         GLuint m_colorTex = 0;
         GLuint m_depthRbo = 0;
-        GLuint m_vao = 0;
-        GLuint m_vbo = 0;
-        GLuint m_program = 0;
+        GLuint m_gridVao = 0;      // no attributes: the grid is a full-screen triangle
+        GLuint m_gridProgram = 0;
+        glm::mat4 m_worldToPlane{ 1.0f }; // inverse workplaneToWorld, per scene revision
+        uint64_t m_gridRevision = 0;
+        GlRingBuffer m_sceneBuffer;
+
+        // Scene primitives with the same draw state, contiguous in the ring
+        // buffer and drawn with one instanced call: points as sprites (one
+        // RenderVertex each), lines and strips as segment quads.
+        struct Batch {
+            GLenum mode = GL_LINES;
+            float size = 1.0f;
+            uint8_t flags = 0;
+            size_t offset = 0;     // bytes into the ring buffer
+            GLsizei count = 0;     // instances
+        };
+        std::vector<Batch> m_batches;
+
+        GLuint m_lineVao = 0;
+        GLuint m_lineProgram = 0;
+        LineJoin m_lineJoin = LineJoin::Round;
+
+        // Point sprites: one quad per point, read from the ring buffer as instance data.
+        GLuint m_pointVao = 0;
+        GLuint m_pointProgram = 0;
+
+        // Curve instances, kept in their own buffer and patched by the
+        // snapshot's changedCurves. Runs are consecutive instances with the
+        // same width and flags, one instanced draw each.
+        struct CurveRun {
+            float size = 1.0f;
+            uint8_t flags = 0;
+            GLint first = 0;
+            GLsizei count = 0;
+        };
+        GLuint m_curveVao = 0;
+        GLuint m_curveVbo = 0;
+        GLuint m_curveProgram = 0;
+        size_t m_curveCapacity = 0;      // instances
+        std::vector<CurveRun> m_curveRuns;
+
+        // A Geometry of the model as uploaded: position/normal vertices,
+        // then in one index buffer its triangles followed by the line pairs
+        // of its feature edges. Cached by the Geometry's address, and
+        // uploaded again only when its version changes.
+        struct GpuMesh {
+            std::weak_ptr<const domain::Geometry> source; // tells a reused address from the same geometry
+            uint64_t version = 0;
+            GLuint vao = 0;
+            GLuint vbo = 0;
+            GLuint ibo = 0;
+            GLsizei triangleIndices = 0;
+            GLsizei edgeIndices = 0;
+            glm::vec4 color{ 1.0f };
+            bool live = false;             // still in the model, as of the last sync
+        };
+        std::unordered_map<const domain::Geometry*, GpuMesh> m_meshes;
+        GLuint m_meshProgram = 0;
 
         void recreateFramebuffer();
         void destroyFramebuffer();
@@ -65,6 +137,18 @@ namespace adapters {
         void ensureProgram();
         void drawWorkplaneGrid();
         void drawScenePrimitives();
+        void uploadScene();
+        void uploadCurves();
+        void buildCurveRuns();
+        void drawPoints(const Batch& b, const glm::mat4& mvp);
+        void drawLines(const Batch& b, const glm::mat4& mvp);
+        void setLineUniforms(GLuint program, const glm::mat4& mvp, float width, uint8_t flags);
+        void drawCurves(const glm::mat4& mvp);
+        void syncMeshes();
+        void fitToModel();
+        void uploadMesh(const domain::Geometry& geometry, GpuMesh& mesh);
+        void destroyMeshes();
+        void drawModel();
         static glm::mat4 makeView(const ports::CameraState& c);
         static glm::mat4 makeProj(const ports::CameraState& c, float aspect);
     };
@@ -0,0 +1,356 @@
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "adapters/rendering/RenderThread.h"
+#include "adapters/rendering/OcctRenderer.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace adapters {
+
+    // How long the render thread sleeps between frames before it looks at
+    // its window messages again.
+    static constexpr std::chrono::milliseconds kMessagePumpInterval{ 20 };
+
+    static void pumpWindowMessages(void* nativeWindow, const std::function<void()>& onInput) {
+#ifdef _WIN32
+        // The backend's native window was created on this thread, so its
+        // messages are queued here rather than for the UI's event loop.
+        MSG msg;
+        bool input = false;
+        while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            if (msg.hwnd == static_cast<HWND>(nativeWindow)
+                && msg.message >= WM_MOUSEFIRST && msg.message <= WM_MOUSELAST) {
+                input = true;
+            }
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+        if (input && onInput) onInput();
+#else
+        (void)nativeWindow;
+        (void)onInput;
+#endif
+    }
+
+    RenderThread::RenderThread(std::unique_ptr<ports::IRendererPort> backend)
+        : m_backend(std::move(backend)),
+        m_occt(dynamic_cast<OcctRenderer*>(m_backend.get())),
+        m_capabilities(m_backend->getCapabilities()),
+        m_backendKind(m_backend->getBackend()) {
+    }
+
+    RenderThread::~RenderThread() {
+        shutdown();
+    }
+
+    bool RenderThread::initialize() {
+        if (m_running) return true;
+
+        std::promise<bool> initialized;
+        std::future<bool> result = initialized.get_future();
+        m_stop = false;
+        m_thread = std::thread(&RenderThread::threadMain, this, &initialized);
+
+        if (result.get()) {
+            m_running = true;
+            return true;
+        }
+        m_thread.join();
+        return false;
+    }
+
+    void RenderThread::shutdown() {
+        if (!m_running) return;
+
+        m_stop = true;
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+        }
+        m_wake.notify_one();
+        m_thread.join();
+        m_running = false;
+    }
+
+    void RenderThread::threadMain(std::promise<bool>* initialized) {
+        bool ok = false;
+        try {
+            ok = m_backend->initialize();
+        }
+        catch (const std::exception& e) {
+            std::cout << "Render thread: backend initialization failed: " << e.what() << std::endl;
+        }
+        if (ok && m_occt) m_nativeWindow = m_occt->nativeWindow();
+        // `initialized` belongs to the waiting thread and is gone after this.
+        initialized->set_value(ok);
+
+        while (ok) {
+            {
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wake.wait_for(lock, kMessagePumpInterval, [this] { return m_stop.load() || m_frames.fresh(); });
+            }
+            pumpWindowMessages(m_nativeWindow, m_onNativeInput);
+            if (m_stop) break;
+            if (m_frames.update()) renderFrame(m_frames.front());
+        }
+
+        m_backend->shutdown();
+    }
+
+    void RenderThread::renderFrame(const Frame& frame) {
+        if (frame.model != m_appliedModel) {
+            m_backend->setModel(frame.model);
+            m_appliedModel = frame.model;
+        }
+        m_backend->setScene(frame.scene);
+        if (frame.width > 0 && frame.height > 0
+            && (frame.width != m_appliedWidth || frame.height != m_appliedHeight)) {
+            m_backend->resize(frame.width, frame.height);
+            m_appliedWidth = frame.width;
+            m_appliedHeight = frame.height;
+        }
+
+        // Patches build on each other, so each goes to the overlay once, in order.
+        if (m_occt) {
+            for (const SketchChange& c : frame.sketch) {
+                if (c.frame > m_applied) m_occt->setSketchOverlay(*c.patch);
+            }
+        }
+
+        for (const CameraCommand& c : frame.camera) {
+            if (c.frame <= m_applied) continue;
+            switch (c.op) {
+            case CameraOp::Rotate: m_backend->rotate(c.x, c.y); break;
+            case CameraOp::Pan: m_backend->pan(c.x, c.y); break;
+            case CameraOp::Zoom: m_backend->zoom(c.x); break;
+            case CameraOp::ViewDirection: m_backend->setViewDirection(c.direction); break;
+            case CameraOp::FitAll: m_backend->fitAll(); break;
+            case CameraOp::SetState: m_backend->setCameraState(c.state); break;
+            }
+        }
+        m_applied = frame.number;
+
+        // No window: the GLFW context stays with the UI thread.
+        m_backend->render(nullptr);
+
+        Feedback& feedback = m_feedback.back();
+        feedback.frame = frame.number;
+        feedback.camera = m_backend->getCameraState();
+        feedback.hasView = m_occt != nullptr;
+        if (m_occt) feedback.view = m_occt->viewCamera();
+        m_feedback.publish();
+    }
+
+    void RenderThread::render(GLFWwindow* /*window*/) {
+        if (!m_running) return;
+
+        // Whatever the render thread has finished need not be sent again.
+        m_feedback.update();
+        const uint64_t rendered = m_feedback.front().frame;
+
+        {
+            std::lock_guard<std::mutex> lock(m_pendingMutex);
+            auto done = [rendered](const auto& entry) { return entry.frame <= rendered; };
+            m_cameraCommands.erase(std::remove_if(m_cameraCommands.begin(), m_cameraCommands.end(), done),
+                m_cameraCommands.end());
+            m_sketchChanges.erase(std::remove_if(m_sketchChanges.begin(), m_sketchChanges.end(), done),
+                m_sketchChanges.end());
+
+            // The slot comes back with an old frame in it; assigning over it
+            // keeps the capacity of its vectors.
+            Frame& frame = m_frames.back();
+            frame.number = ++m_published;
+            frame.model = m_model;
+            frame.scene = m_scene;
+            frame.sketch.assign(m_sketchChanges.begin(), m_sketchChanges.end());
+            frame.camera.assign(m_cameraCommands.begin(), m_cameraCommands.end());
+            frame.width = m_width;
+            frame.height = m_height;
+            m_frames.publish();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+        }
+        m_wake.notify_one();
+    }
+
+    void RenderThread::setModel(std::shared_ptr<domain::Model> model) {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        m_model = std::move(model);
+    }
+
+    void RenderThread::fitAll() {
+        CameraCommand command;
+        command.op = CameraOp::FitAll;
+        recordCamera(command);
+    }
+
+    void* RenderThread::getFramebufferTexture() {
+        return nullptr;
+    }
+
+    void RenderThread::resize(int width, int height) {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        m_width = width;
+        m_height = height;
+    }
+
+    void RenderThread::setScene(ports::RenderSceneSnapshot scene) {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        m_scene = std::move(scene);
+    }
+
+    void RenderThread::setCameraState(const ports::CameraState& camera) {
+        CameraCommand command;
+        command.op = CameraOp::SetState;
+        command.state = camera;
+        recordCamera(command);
+    }
+
+    ports::CameraState RenderThread::getCameraState() const {
+        m_feedback.update();
+        return m_feedback.front().camera;
+    }
+
+    ports::RendererCapabilities RenderThread::getCapabilities() const {
+        ports::RendererCapabilities caps = m_capabilities;
+        caps.supportsFramebufferTexture = false;
+        return caps;
+    }
+
+    ports::RendererBackend RenderThread::getBackend() const {
+        return m_backendKind;
+    }
+
+    void RenderThread::rotate(float dx, float dy) {
+        CameraCommand command;
+        command.op = CameraOp::Rotate;
+        command.x = dx;
+        command.y = dy;
+        recordCamera(command);
+    }
+
+    void RenderThread::pan(float dx, float dy) {
+        CameraCommand command;
+        command.op = CameraOp::Pan;
+        command.x = dx;
+        command.y = dy;
+        recordCamera(command);
+    }
+
+    void RenderThread::zoom(float delta) {
+        CameraCommand command;
+        command.op = CameraOp::Zoom;
+        command.x = delta;
+        recordCamera(command);
+    }
+
+    void RenderThread::setViewDirection(int direction) {
+        CameraCommand command;
+        command.op = CameraOp::ViewDirection;
+        command.direction = direction;
+        recordCamera(command);
+    }
+
+    void RenderThread::recordCamera(CameraCommand command) {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        command.frame = m_published + 1;
+
+        // A drag sends a rotation or pan per UI frame; within one published
+        // frame they add up to a single command.
+        if (!m_cameraCommands.empty()) {
+            CameraCommand& last = m_cameraCommands.back();
+            if (last.frame == command.frame && last.op == command.op
+                && (command.op == CameraOp::Rotate || command.op == CameraOp::Pan)) {
+                last.x += command.x;
+                last.y += command.y;
+                return;
+            }
+        }
+        m_cameraCommands.push_back(command);
+    }
+
+    void RenderThread::setSketchOverlay(const core::rendering::RenderScene& scene,
+        const core::rendering::SceneDelta& delta) {
+        if (!m_occt || delta.empty()) return;
+
+        // The builder keeps changing its scene, so the frame gets a copy of
+        // what changed; a drag moves a few elements, not the whole sketch.
+        auto patch = std::make_shared<core::rendering::ScenePatch>();
+        core::rendering::MakeScenePatch(*patch, scene, delta);
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        m_sketchChanges.push_back({ m_published + 1, std::move(patch) });
+    }
+
+    bool RenderThread::screenToPlane(int px, int py, float planeZ, glm::vec3& out) const {
+        m_feedback.update();
+        const Feedback& feedback = m_feedback.front();
+        if (!feedback.hasView) return false;
+
+        // Eye ray through the pixel (origin top left), intersected with the plane z = planeZ.
+        const core::rendering::CameraState& c = feedback.view;
+        const float w = (float)(std::max)(c.viewportWidth, 1);
+        const float h = (float)(std::max)(c.viewportHeight, 1);
+        const float aspect = w / h;
+        const glm::mat4 view = glm::lookAt(c.position, c.target, c.up);
+        const glm::mat4 proj = c.projection == core::rendering::ProjectionType::Orthographic
+            ? glm::ortho(-c.orthoScale * aspect, c.orthoScale * aspect, -c.orthoScale, c.orthoScale, c.nearPlane, c.farPlane)
+            : glm::perspective(c.fovYDegrees * 0.01745329252f, aspect, c.nearPlane, c.farPlane);
+        const glm::mat4 inv = glm::inverse(proj * view);
+
+        const float x = 2.0f * (float)px / w - 1.0f;
+        const float y = 1.0f - 2.0f * (float)py / h;
+        const glm::vec4 n4 = inv * glm::vec4(x, y, -1.0f, 1.0f);
+        const glm::vec4 f4 = inv * glm::vec4(x, y, 1.0f, 1.0f);
+        const glm::vec3 nearP = glm::vec3(n4) / n4.w;
+        const glm::vec3 dir = glm::vec3(f4) / f4.w - nearP;
+        if (std::abs(dir.z) < 1e-9f) return false;
+
+        const float t = (planeZ - nearP.z) / dir.z;
+        out = glm::vec3(nearP.x + t * dir.x, nearP.y + t * dir.y, planeZ);
+        return true;
+    }
+
+    bool RenderThread::nativePointer(NativePointer& out) const {
+#ifdef _WIN32
+        HWND hwnd = static_cast<HWND>(m_nativeWindow);
+        if (!hwnd) return false;
+
+        POINT cursor;
+        if (!GetCursorPos(&cursor)) return false;
+        out.overWindow = WindowFromPoint(cursor) == hwnd;
+        ScreenToClient(hwnd, &cursor);
+        out.x = cursor.x;
+        out.y = cursor.y;
+
+        // The physical button, so swapped mouse buttons need mapping back.
+        const int primary = GetSystemMetrics(SM_SWAPBUTTON) ? VK_RBUTTON : VK_LBUTTON;
+        out.primaryDown = (GetAsyncKeyState(primary) & 0x8000) != 0;
+        return true;
+#else
+        (void)out;
+        return false;
+#endif
+    }
+
+    double RenderThread::pixelsToWorld(int pixels) const {
+        m_feedback.update();
+        const Feedback& feedback = m_feedback.front();
+        if (!feedback.hasView) return 0.0;
+
+        // The view's height in world units at the focus, as OCCT measures it.
+        const core::rendering::CameraState& c = feedback.view;
+        const double height = c.projection == core::rendering::ProjectionType::Orthographic
+            ? 2.0 * c.orthoScale
+            : 2.0 * glm::length(c.target - c.position) * std::tan(0.5 * c.fovYDegrees * 0.017453292519943295);
+        return pixels * height / (std::max)(c.viewportHeight, 1);
+    }
+
+} // namespace adapters
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "ports/IRendererPort.h"
+#include "core/rendering/CameraState.h"
+#include "core/rendering/RenderScene.h"
+#include "core/rendering/TripleBuffer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace adapters {
+
+    class OcctRenderer;
+
+    // Runs a renderer on a thread of its own, which creates and owns its
+    // contexts (for OCCT: the native window, its GL context and the V3d
+    // view), so a slow frame of a large model never holds up the UI.
+    //
+    // The IRendererPort calls only record what changed. render() publishes
+    // it as the next frame through a lock-free triple buffer and returns;
+    // the render thread draws the newest frame when it gets to it, skipping
+    // any it was too slow for. Frames are immutable snapshots: the model and
+    // scenes by shared pointer, and camera commands and sketch overlay
+    // patches (only the ranges that changed) as everything since the last
+    // frame the render thread took, so none is lost when frames are skipped. The
+    // view's camera comes back the same way, for getCameraState() and
+    // picking on the UI thread.
+    //
+    // For backends that present into their own window: a texture for the
+    // UI to draw would also need a shared context and synchronisation.
+    class RenderThread final : public ports::IRendererPort {
+    public:
+        explicit RenderThread(std::unique_ptr<ports::IRendererPort> backend);
+        ~RenderThread() override;
+
+        // Starts the thread and initializes the backend on it; waits for that.
+        bool initialize() override;
+        void shutdown() override;
+        // Publishes the frame; `window` is not used, the backend has its own.
+        void render(GLFWwindow* window) override;
+
+        // Any thread; applied with the next published frame.
+        void setModel(std::shared_ptr<domain::Model> model) override;
+        void fitAll() override;
+
+        void* getFramebufferTexture() override;
+        void resize(int width, int height) override;
+
+        void setScene(ports::RenderSceneSnapshot scene) override;
+        void setCameraState(const ports::CameraState& camera) override;
+        // As of the last frame rendered.
+        ports::CameraState getCameraState() const override;
+        ports::RendererCapabilities getCapabilities() const override;
+        ports::RendererBackend getBackend() const override;
+
+        void rotate(float dx, float dy) override;
+        void pan(float dx, float dy) override;
+        void zoom(float delta) override;
+        void setViewDirection(int direction) override;
+
+        // The OCCT sketch overlay (see OcctRenderer::setSketchOverlay); a
+        // no-op for other backends.
+        void setSketchOverlay(const core::rendering::RenderScene& scene, const core::rendering::SceneDelta& delta);
+
+        // Picking against the view as last rendered, like OcctRenderer's.
+        bool screenToPlane(int px, int py, float planeZ, glm::vec3& out) const;
+        double pixelsToWorld(int pixels) const;
+
+        // The mouse as seen by the backend's native window: the cursor in its
+        // client pixels (what screenToPlane takes), whether the window is the
+        // one under it, and the primary button. Read from the OS on the
+        // calling thread, since that window's input never reaches the UI.
+        // False when there is no native window.
+        struct NativePointer {
+            int x = 0;
+            int y = 0;
+            bool overWindow = false;
+            bool primaryDown = false;
+        };
+        bool nativePointer(NativePointer& out) const;
+
+        // Called on the render thread for mouse input to the native window,
+        // which does not wake the UI's event loop. Set before initialize().
+        void setNativeInputHandler(std::function<void()> onInput) { m_onNativeInput = std::move(onInput); }
+
+    private:
+        enum class CameraOp : uint8_t { Rotate, Pan, Zoom, ViewDirection, FitAll, SetState };
+
+        struct CameraCommand {
+            uint64_t frame = 0;          // published with this frame first
+            CameraOp op = CameraOp::FitAll;
+            float x = 0.0f;
+            float y = 0.0f;
+            int direction = 0;
+            ports::CameraState state;
+        };
+
+        struct SketchChange {
+            uint64_t frame = 0;          // published with this frame first
+            std::shared_ptr<const core::rendering::ScenePatch> patch;
+        };
+
+        // Camera commands and overlay changes are all those not known to be
+        // rendered when the frame was published; some may be applied already.
+        struct Frame {
+            uint64_t number = 0;
+            std::shared_ptr<domain::Model> model;
+            ports::RenderSceneSnapshot scene;
+            std::vector<SketchChange> sketch;
+            std::vector<CameraCommand> camera;
+            int width = 0;
+            int height = 0;
+        };
+
+        // What the render thread reports back after each frame.
+        struct Feedback {
+            uint64_t frame = 0;
+            ports::CameraState camera;
+            core::rendering::CameraState view;
+            bool hasView = false;
+        };
+
+        std::unique_ptr<ports::IRendererPort> m_backend;
+        OcctRenderer* m_occt = nullptr;    // m_backend, if it is one
+        void* m_nativeWindow = nullptr;    // set before initialize() returns
+        std::function<void()> m_onNativeInput;
+        ports::RendererCapabilities m_capabilities;
+        ports::RendererBackend m_backendKind;
+
+        // Producer side. The loader thread sets models too, so this state
+        // has a mutex; the exchange with the render thread does not.
+        std::mutex m_pendingMutex;
+        uint64_t m_published = 0;
+        std::shared_ptr<domain::Model> m_model;
+        ports::RenderSceneSnapshot m_scene;
+        std::vector<SketchChange> m_sketchChanges;
+        std::vector<CameraCommand> m_cameraCommands;
+        int m_width = 0;
+        int m_height = 0;
+
+        core::rendering::TripleBuffer<Frame> m_frames;
+        mutable core::rendering::TripleBuffer<Feedback> m_feedback;
+
+        std::thread m_thread;
+        std::atomic<bool> m_stop{ false };
+        std::mutex m_wakeMutex;            // only for sleeping between frames
+        std::condition_variable m_wake;
+        bool m_running = false;
+
+        void recordCamera(CameraCommand command);
+        void threadMain(std::promise<bool>* initialized);
+        void renderFrame(const Frame& frame);
+
+        // Render thread state: what the backend has been given.
+        uint64_t m_applied = 0;
+        std::shared_ptr<domain::Model> m_appliedModel;
+        int m_appliedWidth = 0;
+        int m_appliedHeight = 0;
+    };
+
+} // namespace adapters
@@ -7,10 +7,8 @@ namespace adapters {
         : m_occt(std::move(occt)), m_openGl(std::move(openGl)) {
     }
 
-    // In RendererRouter.h - add to public methods:
-    ports::IRendererPort* getOcctRenderer() { return m_occt.get(); }
-    ports::IRendererPort* getOpenGlRenderer() { return m_openGl.get(); }
-
+    ports::IRendererPort* RendererRouter::getOcctRenderer() { return m_occt.get(); }
+    ports::IRendererPort* RendererRouter::getOpenGlRenderer() { return m_openGl.get(); }
 
     ports::IRendererPort* RendererRouter::active() {
         return (m_active == ports::RendererBackend::OpenGL) ? m_openGl.get() : m_occt.get();
@@ -23,7 +21,12 @@ namespace adapters {
     void RendererRouter::pushStateTo(ports::IRendererPort* r) {
         if (!r) return;
         r->resize(m_width, m_height);
-        if (m_model) r->setModel(m_model);
+        std::shared_ptr<domain::Model> model;
+        {
+            std::lock_guard<std::mutex> lock(m_modelMutex);
+            model = m_model;
+        }
+        if (model) r->setModel(model);
         r->setScene(m_scene);
         r->setCameraState(m_camera);
     }
@@ -32,9 +35,9 @@ namespace adapters {
         bool ok = true;
         if (m_occt) ok = ok && m_occt->initialize();
         if (m_openGl) ok = ok && m_openGl->initialize();
-        // Push state to both after init (important for OpenGL FBO sizing)
-        pushStateTo(m_occt.get());
-        pushStateTo(m_openGl.get());
+        // The active backend starts with its own camera; the other one picks
+        // it up (and the FBO size) when it is switched to.
+        if (auto* r = active()) m_camera = r->getCameraState();
         return ok;
     }
 
@@ -43,17 +46,19 @@ namespace adapters {
         if (m_occt) m_occt->shutdown();
     }
 
-    void RendererRouter::render() {
-        if (auto* r = active()) r->render();
+    void RendererRouter::render(GLFWwindow* window) {
+        if (auto* r = active()) r->render(window);
     }
 
     void RendererRouter::setModel(std::shared_ptr<domain::Model> model) {
+        std::lock_guard<std::mutex> lock(m_modelMutex);
         m_model = std::move(model);
         if (m_occt) m_occt->setModel(m_model);
         if (m_openGl) m_openGl->setModel(m_model);
     }
 
     void RendererRouter::fitAll() {
+        // Both: a loader may finish while the other backend is shown.
         if (m_occt) m_occt->fitAll();
         if (m_openGl) m_openGl->fitAll();
     }
@@ -66,20 +71,18 @@ namespace adapters {
     void RendererRouter::resize(int width, int height) {
         m_width = width;
         m_height = height;
-        if (m_occt) m_occt->resize(width, height);
-        if (m_openGl) m_openGl->resize(width, height);
+        if (auto* r = active()) r->resize(width, height);
     }
 
-    void RendererRouter::setScene(const ports::RenderScene& scene) {
-        m_scene = scene;
-        if (m_occt) m_occt->setScene(m_scene);
-        if (m_openGl) m_openGl->setScene(m_scene);
+    void RendererRouter::setScene(ports::RenderSceneSnapshot scene) {
+        if (scene == m_scene) return;
+        m_scene = std::move(scene);
+        if (auto* r = active()) r->setScene(m_scene);
     }
 
     void RendererRouter::setCameraState(const ports::CameraState& camera) {
         m_camera = camera;
-        if (m_occt) m_occt->setCameraState(m_camera);
-        if (m_openGl) m_openGl->setCameraState(m_camera);
+        if (auto* r = active()) r->setCameraState(m_camera);
     }
 
     ports::CameraState RendererRouter::getCameraState() const {
@@ -115,6 +118,9 @@ namespace adapters {
 
     void RendererRouter::setActiveBackend(ports::RendererBackend backend) {
         if (backend == m_active) return;
+        if (!(backend == ports::RendererBackend::OpenGL ? m_openGl : m_occt)) return;
+        // Keep looking at the same thing: the camera moves with the switch.
+        if (auto* r = active()) m_camera = r->getCameraState();
         m_active = backend;
         // Ensure the newly active renderer has up-to-date state.
         pushStateTo(active());
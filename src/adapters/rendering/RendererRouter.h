@@ -3,17 +3,19 @@
 #include "ports/IRendererPort.h"
 
 #include <memory>
+#include <mutex>
 
 namespace adapters {
 
     // A thin adapter that routes all IRendererPort calls to the currently active backend.
     // This lets you feature-toggle between multiple renderer implementations at runtime.
+    // setModel() and fitAll() may come from loader threads, like on any renderer;
+    // the rest is the UI thread's.
     class RendererRouter final : public ports::IRendererPort {
     public:
         RendererRouter(std::unique_ptr<ports::IRendererPort> occt,
                        std::unique_ptr<ports::IRendererPort> openGl);
 
-        // In RendererRouter.h - add to public methods:
         ports::IRendererPort* getOcctRenderer();
         ports::IRendererPort* getOpenGlRenderer();
 
@@ -24,7 +26,7 @@ namespace adapters {
         void fitAll() override;
         void* getFramebufferTexture() override;
         void resize(int width, int height) override;
-        void setScene(const ports::RenderScene& scene) override;
+        void setScene(ports::RenderSceneSnapshot scene) override;
         void setCameraState(const ports::CameraState& camera) override;
         ports::CameraState getCameraState() const override;
         ports::RendererCapabilities getCapabilities() const override;
@@ -45,8 +47,9 @@ namespace adapters {
         ports::RendererBackend m_active = ports::RendererBackend::Occt;
 
         // Sticky data we forward to both backends so switching is seamless
+        std::mutex m_modelMutex;
         std::shared_ptr<domain::Model> m_model;
-        ports::RenderScene m_scene;
+        ports::RenderSceneSnapshot m_scene;
         ports::CameraState m_camera;
         int m_width = 800;
         int m_height = 600;
@@ -22,7 +22,7 @@
 #include "UI.h"
 
 #include "core/rendering/SketchRenderBuilder.h"
-#include "adapters/rendering/OcctRenderer.h"
+#include "adapters/rendering/RenderThread.h"
 #include "adapters/rendering/RendererRouter.h"
 
 #include "../../../Walnut-Icon.embed"
@@ -30,8 +30,40 @@
 
 namespace adapters {
 
+static void RequestRedraw(GLFWwindow* window, std::uint32_t reasons) {
+    if (auto* app = static_cast<core::Application*>(glfwGetWindowUserPointer(window))) {
+        app->redraw().request(reasons);
+    }
+}
+
+// Every window event asks for a frame; with nothing to do the main loop
+// sleeps in waitEvents(). ImGui_ImplGlfw chains its input callbacks to
+// ones already set, so these go in before it initializes.
+static void InstallRedrawCallbacks(GLFWwindow* window) {
+    using core::rendering::RedrawInput;
+    using core::rendering::RedrawWindow;
+    glfwSetCursorPosCallback(window, [](GLFWwindow* w, double, double) { RequestRedraw(w, RedrawInput); });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow* w, int, int, int) { RequestRedraw(w, RedrawInput); });
+    glfwSetScrollCallback(window, [](GLFWwindow* w, double, double) { RequestRedraw(w, RedrawInput); });
+    glfwSetKeyCallback(window, [](GLFWwindow* w, int, int, int, int) { RequestRedraw(w, RedrawInput); });
+    glfwSetCharCallback(window, [](GLFWwindow* w, unsigned int) { RequestRedraw(w, RedrawInput); });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow* w, int) { RequestRedraw(w, RedrawInput); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow* w, int) { RequestRedraw(w, RedrawInput); });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* w, int, int) { RequestRedraw(w, RedrawWindow); });
+    glfwSetWindowIconifyCallback(window, [](GLFWwindow* w, int) { RequestRedraw(w, RedrawWindow); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow* w) { RequestRedraw(w, RedrawWindow); });
+}
+
+// The OCCT view, behind its render thread, whether or not a router sits in front.
+static adapters::RenderThread* OcctView(ports::IRendererPort* renderer) {
+    if (auto* router = dynamic_cast<adapters::RendererRouter*>(renderer)) {
+        renderer = router->getOcctRenderer();
+    }
+    return dynamic_cast<adapters::RenderThread*>(renderer);
+}
+
 ImGuiAdapter::ImGuiAdapter(core::Application* app)
-    : m_window(nullptr), m_app(app), m_isRotating(false), m_isPanning(false) {
+    : m_window(nullptr), m_app(app), m_isRotating(false), m_isPanning(false), m_nativePrimaryWasDown(false) {
     std::memset(m_filePathBuffer, 0, sizeof(m_filePathBuffer));
     std::memset(m_exportPathBuffer, 0, sizeof(m_exportPathBuffer));
     m_lastMousePos = ImVec2(0, 0);
@@ -63,6 +95,19 @@ bool ImGuiAdapter::initialize() {
     
     glfwMakeContextCurrent(m_window);
     glfwSwapInterval(1);
+
+    glfwSetWindowUserPointer(m_window, m_app);
+    InstallRedrawCallbacks(m_window);
+    if (m_app) {
+        // Thread-safe: loader threads wake the main loop this way.
+        m_app->redraw().setWakeUp([] { glfwPostEmptyEvent(); });
+
+        // Sketch drags happen in the OCCT window, whose input the UI polls.
+        if (auto* occt = OcctView(m_app->getRenderer())) {
+            core::Application* app = m_app;
+            occt->setNativeInputHandler([app] { app->redraw().request(core::rendering::RedrawInput); });
+        }
+    }
     
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -136,6 +181,9 @@ bool ImGuiAdapter::initialize() {
 
 void ImGuiAdapter::shutdown() {
     if (m_window) {
+        if (m_app) {
+            m_app->redraw().setWakeUp(nullptr);
+        }
         ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplGlfw_Shutdown();
         ImGui::DestroyContext();
@@ -150,8 +198,16 @@ bool ImGuiAdapter::shouldClose() {
     return m_window && glfwWindowShouldClose(m_window);
 }
 
+void ImGuiAdapter::waitEvents(double timeoutSeconds) {
+    if (timeoutSeconds > 0.0) {
+        glfwWaitEventsTimeout(timeoutSeconds);
+    }
+    else {
+        glfwPollEvents();
+    }
+}
+
 void ImGuiAdapter::beginFrame() {
-    glfwPollEvents();
     glfwMakeContextCurrent(m_window);
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
@@ -445,10 +501,27 @@ void ImGuiAdapter::DrawViewport()
         return;
     }
 
-    // Direct cast (no router)
-    auto* occt = dynamic_cast<adapters::OcctRenderer*>(renderer);
-    if (occt) {
-        ImGui::TextColored(ImVec4(0, 1, 0, 1), "[OK] OcctRenderer active");
+    auto* router = dynamic_cast<adapters::RendererRouter*>(renderer);
+    if (router && router->getOpenGlRenderer()) {
+        int backend = router->getActiveBackend() == ports::RendererBackend::OpenGL ? 1 : 0;
+        ImGui::Text("Backend:");
+        ImGui::SameLine();
+        bool switched = ImGui::RadioButton("OCCT", &backend, 0);
+        ImGui::SameLine();
+        switched |= ImGui::RadioButton("OpenGL", &backend, 1);
+        if (switched) {
+            router->setActiveBackend(backend == 1 ? ports::RendererBackend::OpenGL : ports::RendererBackend::Occt);
+            m_app->redraw().request(core::rendering::RedrawWindow);
+        }
+    }
+
+    auto* occt = OcctView(renderer);
+    const bool openGl = renderer->getBackend() == ports::RendererBackend::OpenGL;
+    if (openGl) {
+        ImGui::TextColored(ImVec4(0, 1, 0, 1), "[OK] OpenGlRenderer active (embedded view)");
+    }
+    else if (occt) {
+        ImGui::TextColored(ImVec4(0, 1, 0, 1), "[OK] OcctRenderer active (render thread)");
     }
     else {
         ImGui::TextColored(ImVec4(1, 0, 0, 1), "[X] Not OcctRenderer!");
@@ -507,8 +580,23 @@ void ImGuiAdapter::DrawViewport()
         return;
     }
 
-    // Build render scene
-    auto scene = core::rendering::BuildRenderSceneFromSketch(sketch);
+    // Build render scene, coloured by constraint state when sketch 0 has been analysed
+    core::rendering::SketchRenderOptions renderOptions;
+    renderOptions.analysis = m_app->sketchAnalysis(0);
+    renderOptions.curveCache = m_app->sketchCurveCache(0);
+    auto* builder = m_app->sketchRenderBuilder(0);
+    if (!builder) {
+        ImGui::End();
+        return;
+    }
+    const auto& scene = builder->update(sketch, renderOptions);
+
+    if (renderOptions.analysis) {
+        ImGui::Text("DOF: %zu  (redundant %zu, conflicting %zu)",
+            renderOptions.analysis->totalDof(),
+            renderOptions.analysis->redundant().size(),
+            renderOptions.analysis->conflicting().size());
+    }
 
     ImGui::Spacing();
     ImGui::Text("Render scene:");
@@ -549,19 +637,35 @@ void ImGuiAdapter::DrawViewport()
     ImGui::Text("ACTIONS");
     ImGui::Separator();
 
-    // Set overlay
-    occt->setSketchOverlay(scene);
-    ImGui::TextColored(ImVec4(0, 1, 0, 1), "[OK] Overlay set");
+    // Hand the sketch to the active view. The builder's delta covers one
+    // frame, so a view that sat out while the other was shown starts over.
+    const ports::RendererBackend fed = openGl ? ports::RendererBackend::OpenGL : ports::RendererBackend::Occt;
+    core::rendering::SceneDelta delta = builder->delta();
+    if (fed != m_sketchFedBackend) {
+        delta.clear();
+        delta.full = true;
+        m_sketchFedBackend = fed;
+    }
+    if (openGl) {
+        renderer->setScene(m_glScenePacker.update(scene, delta));
+        ImGui::TextColored(ImVec4(0, 1, 0, 1), "[OK] Scene set");
+    }
+    else {
+        occt->setSketchOverlay(scene, delta);
+        ImGui::TextColored(ImVec4(0, 1, 0, 1), "[OK] Overlay set");
+    }
 
     if (ImGui::Button("Force Render & Update View", ImVec2(200, 0))) {
         std::cout << "\n>>> MANUAL RENDER TRIGGERED <<<\n" << std::endl;
-        occt->render(m_window);
-        occt->fitAll();
+        renderer->fitAll();
+        renderer->render(m_window);
+        cameraChanged();
     }
 
     ImGui::SameLine();
     if (ImGui::Button("Fit All", ImVec2(100, 0))) {
-        occt->fitAll();
+        renderer->fitAll();
+        cameraChanged();
     }
 
     ImGui::Spacing();
@@ -569,9 +673,15 @@ void ImGuiAdapter::DrawViewport()
     ImGui::Text("AUTO RENDER");
     ImGui::Separator();
 
-    // Automatic render call
-    occt->render(m_window);
-    ImGui::Text("[OK] Render called automatically");
+    // Automatic render call, when the scene, camera, model or viewport changed.
+    // This only hands the frame to the render thread.
+    if (m_app->redraw().takeViewRedraw()) {
+        renderer->render(m_window);
+        ImGui::Text(openGl ? "[OK] Frame drawn" : "[OK] Frame sent to render thread");
+    }
+    else {
+        ImGui::Text("[OK] View up to date");
+    }
 
     ImGui::End();
 }
@@ -627,20 +737,19 @@ void ImGuiAdapter::renderMainMenu() {
     //ImGui::SeparatorText("Load File");
     ImGui::InputTextWithHint("##filepath", "Enter STEP file path...", m_filePathBuffer, sizeof(m_filePathBuffer));
     
-    bool isLoading = m_app && m_app->isLoading();
-    if (isLoading) {
-        ImGui::BeginDisabled();
-    }
-
+    // Loads run side by side, so another may be started at any time.
     if (ImGui::Button("Load STEP File", ImVec2(150, 0))) {
         if (m_app && std::strlen(m_filePathBuffer) > 0) {
             m_app->loadFile(m_filePathBuffer);
         }
     }
-    if (isLoading) {
-        ImGui::EndDisabled();
+    if (m_app && m_app->isLoading()) {
         ImGui::SameLine();
         ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Loading...");
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Cancel")) {
+            m_app->cancelLoading();
+        }
     }
 
     ImGui::TextDisabled("Supported: .step, .stp");
@@ -670,6 +779,7 @@ void ImGuiAdapter::renderMainMenu() {
     if (ImGui::Button("Fit All", ImVec2(150, 0))) {
         if (m_app && m_app->getRenderer()) {
             m_app->getRenderer()->fitAll();
+            cameraChanged();
         }
     }
     
@@ -741,56 +851,91 @@ void ImGuiAdapter::render3DView() {
         static ImVec2 lastSize = ImVec2(0, 0);
         if (viewportSize.x != lastSize.x || viewportSize.y != lastSize.y) {
             m_app->getRenderer()->resize((int)viewportSize.x, (int)viewportSize.y);
+            m_app->redraw().request(core::rendering::RedrawWindow);
             lastSize = viewportSize;
         }
 
         void* texture = m_app->getRenderer()->getFramebufferTexture();
         if (texture) {
-            ImGui::Image(texture, viewportSize);
+            // GL textures start at the bottom row.
+            ImGui::Image(texture, viewportSize, ImVec2(0, 1), ImVec2(1, 0));
         }
         else {
             // Placeholder - OpenCASCADE renders to its own window
             ImGui::TextWrapped("3D View Active");
             ImGui::TextDisabled("OpenCASCADE rendering to native window");
 
-            // Mouse interaction for camera control
-            if (ImGui::IsWindowHovered()) {
-                ImGuiIO& io = ImGui::GetIO();
-
-                // Right mouse button - rotate
-                if (ImGui::IsMouseDown(ImGuiMouseButton_Right)) {
-                    ImVec2 mousePos = ImGui::GetMousePos();
-                    if (m_isRotating) {
-                        float dx = (mousePos.x - m_lastMousePos.x) * 0.01f;
-                        float dy = (mousePos.y - m_lastMousePos.y) * 0.01f;
-                        m_app->getRenderer()->rotate(dx, dy);
+            // Left mouse button in the OCCT window - drag sketch geometry through
+            // the constraint solver. That window's clicks never reach ImGui, so the
+            // pointer is read in its own client pixels, which picking expects.
+            adapters::RenderThread::NativePointer pointer;
+            auto* occt = OcctView(m_app->getRenderer());
+            if (occt && occt->nativePointer(pointer)) {
+                const bool pressed = pointer.primaryDown && !m_nativePrimaryWasDown;
+                m_nativePrimaryWasDown = pointer.primaryDown;
+                const float sketchZ = core::rendering::SketchRenderOptions{}.z;
+                glm::vec3 onPlane;
+
+                if (!m_app->isDraggingSketch()) {
+                    if (pressed && pointer.overWindow
+                        && occt->screenToPlane(pointer.x, pointer.y, sketchZ, onPlane)) {
+                        const double pickRadius = occt->pixelsToWorld(8);
+                        m_app->beginSketchDrag(0, { onPlane.x, onPlane.y }, pickRadius);
                     }
-                    m_isRotating = true;
-                    m_lastMousePos = mousePos;
-                }
-                else {
-                    m_isRotating = false;
                 }
-
-                // Middle mouse button - pan
-                if (ImGui::IsMouseDown(ImGuiMouseButton_Middle)) {
-                    ImVec2 mousePos = ImGui::GetMousePos();
-                    if (m_isPanning) {
-                        float dx = mousePos.x - m_lastMousePos.x;
-                        float dy = mousePos.y - m_lastMousePos.y;
-                        m_app->getRenderer()->pan(dx, dy);
+                else if (pointer.primaryDown) {
+                    if (occt->screenToPlane(pointer.x, pointer.y, sketchZ, onPlane)) {
+                        m_app->dragSketchTo({ onPlane.x, onPlane.y });
                     }
-                    m_isPanning = true;
-                    m_lastMousePos = mousePos;
+                    // The window gets no moves once the cursor leaves it; keep polling.
+                    m_app->redraw().request(core::rendering::RedrawInput);
                 }
                 else {
-                    m_isPanning = false;
+                    m_app->endSketchDrag();
                 }
+            }
+        }
+
+        // Mouse interaction for camera control, in either view
+        if (ImGui::IsWindowHovered()) {
+            ImGuiIO& io = ImGui::GetIO();
+
+            // Right mouse button - rotate
+            if (ImGui::IsMouseDown(ImGuiMouseButton_Right)) {
+                ImVec2 mousePos = ImGui::GetMousePos();
+                if (m_isRotating) {
+                    float dx = (mousePos.x - m_lastMousePos.x) * 0.01f;
+                    float dy = (mousePos.y - m_lastMousePos.y) * 0.01f;
+                    m_app->getRenderer()->rotate(dx, dy);
+                    cameraChanged();
+                }
+                m_isRotating = true;
+                m_lastMousePos = mousePos;
+            }
+            else {
+                m_isRotating = false;
+            }
 
-                // Mouse wheel - zoom
-                if (io.MouseWheel != 0.0f) {
-                    m_app->getRenderer()->zoom(io.MouseWheel * 0.1f);
+            // Middle mouse button - pan
+            if (ImGui::IsMouseDown(ImGuiMouseButton_Middle)) {
+                ImVec2 mousePos = ImGui::GetMousePos();
+                if (m_isPanning) {
+                    float dx = mousePos.x - m_lastMousePos.x;
+                    float dy = mousePos.y - m_lastMousePos.y;
+                    m_app->getRenderer()->pan(dx, dy);
+                    cameraChanged();
                 }
+                m_isPanning = true;
+                m_lastMousePos = mousePos;
+            }
+            else {
+                m_isPanning = false;
+            }
+
+            // Mouse wheel - zoom
+            if (io.MouseWheel != 0.0f) {
+                m_app->getRenderer()->zoom(io.MouseWheel * 0.1f);
+                cameraChanged();
             }
         }
 
@@ -826,31 +971,44 @@ void ImGuiAdapter::renderCameraGizmo() {
 
     if (ImGui::Button("Front", ImVec2(90, 0))) {
         m_app->getRenderer()->setViewDirection(0);
+        cameraChanged();
     }
     if (ImGui::Button("Back", ImVec2(90, 0))) {
         m_app->getRenderer()->setViewDirection(1);
+        cameraChanged();
     }
     if (ImGui::Button("Top", ImVec2(90, 0))) {
         m_app->getRenderer()->setViewDirection(2);
+        cameraChanged();
     }
     if (ImGui::Button("Bottom", ImVec2(90, 0))) {
         m_app->getRenderer()->setViewDirection(3);
+        cameraChanged();
     }
     if (ImGui::Button("Left", ImVec2(90, 0))) {
         m_app->getRenderer()->setViewDirection(4);
+        cameraChanged();
     }
     if (ImGui::Button("Right", ImVec2(90, 0))) {
         m_app->getRenderer()->setViewDirection(5);
+        cameraChanged();
     }
 
     ImGui::Separator();
     if (ImGui::Button("Fit All", ImVec2(90, 0))) {
         m_app->getRenderer()->fitAll();
+        cameraChanged();
     }
 
     ImGui::End();
 }
 
+void ImGuiAdapter::cameraChanged() {
+    if (m_app) {
+        m_app->redraw().request(core::rendering::RedrawCamera);
+    }
+}
+
 
 static bool PointInConvexPoly(const ImVec2* pts, int count, ImVec2 p)
 {
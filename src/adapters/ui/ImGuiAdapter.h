@@ -3,6 +3,7 @@
 #include <memory>
 #include "imgui.h" 
 #include "../../ImGui/Image.h"
+#include "core/rendering/ScenePacker.h"
 struct GLFWwindow;
 
 namespace core {
@@ -21,6 +22,7 @@ public:
     bool initialize() override;
     void shutdown() override;
     bool shouldClose() override;
+    void waitEvents(double timeoutSeconds) override;
     void beginFrame() override;
     void endFrame() override;
     void render() override;
@@ -43,6 +45,7 @@ private:
     void renderCameraGizmo();
     void UI_DrawTitlebar(float& outTitlebarHeight);
     void DrawViewport();
+    void cameraChanged();
 
     char m_filePathBuffer[512];
     char m_exportPathBuffer[512];
@@ -51,6 +54,13 @@ private:
     bool m_isRotating;
     bool m_isPanning;
     ImVec2 m_lastMousePos;
+    bool m_nativePrimaryWasDown;
+
+    // Sketch 0 as the embedded OpenGL view draws it; the OCCT view keeps its
+    // own overlay. Only the active backend is fed, so the other one gets a
+    // full delta when it takes over.
+    core::rendering::ScenePacker m_glScenePacker;
+    ports::RendererBackend m_sketchFedBackend = ports::RendererBackend::Occt;
     
     bool HexButtonTrueHit(const char* label, float radius, bool pointy_top = false);
     bool ParallelogramButtonTrueHit(const char* label, ImVec2 size, float skew_x = 18.0f);
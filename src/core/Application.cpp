@@ -2,21 +2,39 @@
 #include <algorithm>
 #include "adapters/persistence/JsonSketchDocumentAdapter.h"
 #include <iostream>
+#include <stdexcept>
+#include <variant>
 
 namespace core {
 
-    Application::Application()
-        : m_statusMessage("Ready"),
-        m_isLoading(false),
-        m_loadingProgress(0.0f) {
+    namespace {
+        // Lends the task scheduler to the sketch solver, so solves and
+        // background jobs run on the same threads.
+        class SchedulerExecutor final : public domain::solver::ParallelExecutor {
+        public:
+            explicit SchedulerExecutor(tasks::TaskScheduler& tasks) : m_tasks(tasks) {}
+
+            unsigned slotCount() const override { return m_tasks.slotCount(); }
+            void parallelFor(std::size_t count, std::size_t grain,
+                const std::function<void(std::size_t, unsigned)>& fn) override {
+                m_tasks.parallelFor(count, grain, fn);
+            }
+
+        private:
+            tasks::TaskScheduler& m_tasks;
+        };
     }
 
-    Application::~Application() {
-        if (m_loadingThread.joinable()) {
-            m_loadingThread.join();
-        }
+    Application::Application()
+        : m_statusMessage("Ready") {
+        m_solverPool = std::make_unique<SchedulerExecutor>(m_tasks);
+        m_sketchSolver.setThreadPool(m_solverPool.get());
+        m_tasks.setOnChange([this] { m_redraw.request(rendering::RedrawProgress); });
     }
 
+    // m_tasks goes first and takes its jobs with it.
+    Application::~Application() = default;
+
     void Application::setUIAdapter(std::unique_ptr<ports::IUIPort> uiAdapter) {
         m_uiAdapter = std::move(uiAdapter);
     }
@@ -75,6 +93,13 @@ namespace core {
         std::cout << "Starting main loop...\n" << std::endl;
 
         while (!m_uiAdapter->shouldClose()) {
+            // Sleep until input or a redraw request arrives; input requests
+            // a redraw itself, from the UI adapter's event callbacks.
+            m_uiAdapter->waitEvents(m_redraw.waitTimeout());
+            if (m_redraw.beginFrame() == 0) {
+                continue;
+            }
+
             m_uiAdapter->beginFrame();
 
             // UI adapter will call renderer in DrawViewport()
@@ -85,9 +110,9 @@ namespace core {
     }
 
     void Application::shutdown() {
-        if (m_loadingThread.joinable()) {
-            m_loadingThread.join();
-        }
+        // Jobs talk to the renderer and the UI, so they end first.
+        m_tasks.cancelAll();
+        m_tasks.waitIdle();
 
         if (m_renderer) {
             m_renderer->shutdown();
@@ -101,8 +126,11 @@ namespace core {
     }
 
     void Application::updateStatus(const std::string& message) {
-        std::lock_guard<std::mutex> lock(m_statusMutex);
-        m_statusMessage = message;
+        {
+            std::lock_guard<std::mutex> lock(m_statusMutex);
+            m_statusMessage = message;
+        }
+        m_redraw.request(rendering::RedrawProgress);
     }
 
     bool Application::loadFile(const std::string& filepath) {
@@ -110,93 +138,124 @@ namespace core {
     }
 
     bool Application::loadFileAsync(const std::string& filepath) {
-        if (m_isLoading) {
-            updateStatus("Error: Already loading a file");
+        auto loader = findLoaderForFile(filepath);
+        if (!loader) {
+            updateStatus("Error: No loader found for file: " + filepath);
             return false;
         }
 
-        // Join previous thread if it exists
-        if (m_loadingThread.joinable()) {
-            m_loadingThread.join();
-        }
+        updateStatus("Loading file...");
 
-        // Start loading in background thread
-        m_loadingThread = std::thread(&Application::loadFileThreaded, this, filepath);
+        tasks::TaskOptions options;
+        options.name = "Load " + filepath;
+        {
+            std::lock_guard<std::mutex> lock(m_loadMutex);
+            m_loads.erase(std::remove_if(m_loads.begin(), m_loads.end(),
+                [](const tasks::TaskHandle& load) { return load.done(); }), m_loads.end());
 
+            const std::uint64_t sequence = ++m_loadSequence;
+            m_loads.push_back(m_tasks.submit(std::move(options),
+                [this, loader, filepath, sequence](tasks::TaskContext& context) {
+                    loadFileTask(*loader, filepath, sequence, context);
+                }));
+        }
         return true;
     }
 
-    void Application::loadFileThreaded(const std::string& filepath) {
-        m_isLoading = true;
-        m_loadingProgress = 0.0f;
-
-        auto loader = findLoaderForFile(filepath);
-        if (!loader) {
-            updateStatus("Error: No loader found for file: " + filepath);
-            m_isLoading = false;
-            return;
-        }
-
+    void Application::loadFileTask(ports::IFileLoaderPort& loader, const std::string& filepath, std::uint64_t sequence,
+        tasks::TaskContext& context) {
+        // Loaders report progress between their steps, which is where a
+        // cancelled load stops.
+        auto progressCallback = [this, &context](const std::string& message, float progress) {
+            context.throwIfCancelled();
+            context.setProgress(progress / 100.0f, message);
+            updateStatus(message);
+            };
+
+        std::shared_ptr<domain::Model> model;
         try {
-            updateStatus("Loading file...");
-
-            // Progress callback
-            auto progressCallback = [this](const std::string& message, float progress) {
-                m_loadingProgress = progress;
-                updateStatus(message);
-                };
-
-            auto model = loader->load(filepath, progressCallback);
-
-            if (model && !model->isEmpty()) {
-                m_currentModel = model;
-
-                if (m_renderer) {
-                    m_renderer->setModel(m_currentModel);
-                    m_renderer->fitAll();
-                }
-
-                updateStatus("Loaded: " + filepath);
-            }
-            else {
-                updateStatus("Error: Failed to load model");
+            model = loader.load(filepath, progressCallback);
+            context.throwIfCancelled();
+            if (!model || model->isEmpty()) {
+                throw std::runtime_error("Failed to load model");
             }
-
+        }
+        catch (const tasks::TaskCancelled&) {
+            updateStatus("Cancelled: " + filepath);
+            throw;
         }
         catch (const std::exception& e) {
             updateStatus("Error loading file: " + std::string(e.what()));
+            throw;
         }
 
-        m_loadingProgress = 100.0f;
-        m_isLoading = false;
-    }
+        {
+            std::lock_guard<std::mutex> lock(m_modelMutex);
+            // Loads finish in any order; one asked for earlier than the
+            // model shown is dropped.
+            if (sequence < m_shownLoad) {
+                return;
+            }
+            m_shownLoad = sequence;
+            m_currentModel = model;
 
-    bool Application::exportFile(const std::string& filepath, const std::string& format) {
-        if (!m_currentModel || m_currentModel->isEmpty()) {
-            m_statusMessage = "Error: No model to export";
-            return false;
+            if (m_renderer) {
+                m_renderer->setModel(model);
+                m_renderer->fitAll();
+            }
         }
+        m_redraw.request(rendering::RedrawModel | rendering::RedrawCamera);
+        updateStatus("Loaded: " + filepath);
+    }
 
+    bool Application::exportFile(const std::string& filepath, const std::string& format) {
         auto exporter = findExporterForFormat(format);
         if (!exporter) {
-            m_statusMessage = "Error: No exporter found for format: " + format;
+            updateStatus("Error: No exporter found for format: " + format);
             return false;
         }
 
-        try {
-            if (exporter->exportModel(*m_currentModel, filepath)) {
-                m_statusMessage = "Exported: " + filepath;
-                return true;
+        tasks::TaskOptions options;
+        options.name = "Export " + filepath;
+        {
+            // Export what is being loaded, not what it replaces.
+            std::lock_guard<std::mutex> lock(m_loadMutex);
+            for (const auto& load : m_loads) {
+                if (!load.done()) options.dependencies.push_back(load);
             }
         }
-        catch (const std::exception& e) {
-            m_statusMessage = "Error exporting file: " + std::string(e.what());
+        if (options.dependencies.empty()) {
+            auto model = getCurrentModel();
+            if (!model || model->isEmpty()) {
+                updateStatus("Error: No model to export");
+                return false;
+            }
         }
 
-        return false;
+        updateStatus("Exporting " + filepath + "...");
+        m_tasks.submit(std::move(options), [this, exporter, filepath](tasks::TaskContext&) {
+            auto model = getCurrentModel();
+            if (!model || model->isEmpty()) {
+                updateStatus("Error: No model to export");
+                return;
+            }
+
+            try {
+                if (!exporter->exportModel(*model, filepath)) {
+                    throw std::runtime_error("Failed to write " + filepath);
+                }
+                updateStatus("Exported: " + filepath);
+            }
+            catch (const std::exception& e) {
+                updateStatus("Error exporting file: " + std::string(e.what()));
+                throw;
+            }
+            });
+        return true;
     }
 
     std::shared_ptr<domain::Model> Application::getCurrentModel() const {
+        std::lock_guard<std::mutex> lock(m_modelMutex);
         return m_currentModel;
     }
 
@@ -210,11 +269,28 @@ namespace core {
     }
 
     bool Application::isLoading() const {
-        return m_isLoading;
+        std::lock_guard<std::mutex> lock(m_loadMutex);
+        return std::any_of(m_loads.begin(), m_loads.end(),
+            [](const tasks::TaskHandle& load) { return !load.done(); });
     }
 
     float Application::getLoadingProgress() const {
-        return m_loadingProgress;
+        std::lock_guard<std::mutex> lock(m_loadMutex);
+        float sum = 0.0f;
+        int count = 0;
+        for (const auto& load : m_loads) {
+            if (load.done()) continue;
+            sum += load.progress();
+            ++count;
+        }
+        return count > 0 ? 100.0f * sum / count : 100.0f;
+    }
+
+    void Application::cancelLoading() {
+        std::lock_guard<std::mutex> lock(m_loadMutex);
+        for (const auto& load : m_loads) {
+            load.cancel();
+        }
     }
 
     ports::IFileLoaderPort* Application::findLoaderForFile(const std::string& filepath) {
@@ -241,6 +317,13 @@ namespace core {
         std::cout << "File: " << filepath << std::endl;
 
         adapters::persistence::JsonSketchDocumentAdapter io;
+        endSketchDrag();
+        m_sketchIndices.clear();
+        m_dofAnalyzers.clear();
+        m_snapEngines.clear();
+        m_regionDetectors.clear();
+        m_curveCaches.clear();
+        m_renderBuilders.clear();
         m_sketchDoc = io.loadDocument(filepath);
 
         if (m_sketchDoc) {
@@ -257,19 +340,261 @@ namespace core {
                 std::cout << "    Ellipses: " << sketch.entities.ellipses().size() << std::endl;
                 std::cout << "    Curves: " << sketch.entities.curves().size() << std::endl;
             }
+
+            m_dofAnalyzers.resize(m_sketchDoc->sketches.size());
+
+            // One sketch after another; each spreads its clusters over the
+            // scheduler's workers and this thread, which does whatever the
+            // workers are too busy (say, with a STEP load) to take.
+            const std::size_t count = m_sketchDoc->sketches.size();
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto result = solveSketch(i);
+                std::cout << "  Sketch " << i << " solve: "
+                    << (result.status == domain::solver::SolveStatus::Converged ? "converged" :
+                        result.status == domain::solver::SolveStatus::NothingToSolve ? "nothing to solve" : "NOT converged")
+                    << " (" << result.clusterCount << " clusters, " << result.equationCount << " equations, " << result.iterations << " iterations, residual "
+                    << result.residualNorm << ")" << std::endl;
+                if (!result.unsupported.empty()) {
+                    std::cout << "  [!] Unsupported constraints: " << result.unsupported.size() << std::endl;
+                }
+
+                const auto* analysis = analyzeSketch(i);
+                std::cout << "  Sketch " << i << " DOF: " << analysis->totalDof()
+                    << " (redundant " << analysis->redundant().size()
+                    << ", conflicting " << analysis->conflicting().size() << ")" << std::endl;
+            }
+
+            // After solving, so the boxes match the solved geometry.
+            m_sketchIndices.resize(m_sketchDoc->sketches.size());
+            m_snapEngines.resize(m_sketchDoc->sketches.size());
+            m_regionDetectors.resize(m_sketchDoc->sketches.size());
+            m_curveCaches.resize(m_sketchDoc->sketches.size());
+            m_renderBuilders.resize(m_sketchDoc->sketches.size());
+            for (std::size_t i = 0; i < m_sketchIndices.size(); ++i) {
+                m_sketchIndices[i].build(m_sketchDoc->sketches[i].entities);
+                m_snapEngines[i].build(m_sketchDoc->sketches[i].entities);
+            }
         }
         else {
             std::cout << "[X] Failed to load sketch document" << std::endl;
         }
         std::cout << "===============================\n" << std::endl;
 
+        m_redraw.request(rendering::RedrawScene);
         updateStatus("Loaded sketch: " + filepath);
         return (m_sketchDoc != nullptr);
     }
 
+    bool Application::saveSketchDocument(const std::string& filepath)
+    {
+        if (!m_sketchDoc) {
+            updateStatus("Error: No sketch document to save");
+            return false;
+        }
+
+        // Editing goes on while the file is written, so the task gets a copy.
+        auto document = std::make_shared<const domain::sketch::Document>(*m_sketchDoc);
+
+        tasks::TaskOptions options;
+        options.name = "Save " + filepath;
+        updateStatus("Saving sketch...");
+        m_tasks.submit(std::move(options), [this, document, filepath](tasks::TaskContext&) {
+            adapters::persistence::JsonSketchDocumentAdapter io;
+            try {
+                io.saveDocument(*document, filepath);
+                updateStatus("Saved sketch: " + filepath);
+            }
+            catch (const std::exception& e) {
+                updateStatus("Error saving sketch: " + std::string(e.what()));
+                throw;
+            }
+            });
+        return true;
+    }
+
     std::shared_ptr<domain::sketch::Document> Application::getSketchDocument() const
     {
         return m_sketchDoc;
     }
 
-} // namespace core
\ No newline at end of file
+    domain::solver::SolveResult Application::solveSketch(std::size_t sketchIndex)
+    {
+        if (!m_sketchDoc || sketchIndex >= m_sketchDoc->sketches.size()) {
+            return {};
+        }
+        m_redraw.request(rendering::RedrawScene);
+        return m_sketchSolver.solve(m_sketchDoc->sketches[sketchIndex]);
+    }
+
+    bool Application::beginSketchDrag(std::size_t sketchIndex, const domain::sketch::Vec2& at, double pickRadius)
+    {
+        if (!m_sketchDoc || sketchIndex >= m_sketchDoc->sketches.size()) {
+            return false;
+        }
+
+        auto& sketch = m_sketchDoc->sketches[sketchIndex];
+        domain::solver::DragHandle handle;
+        const bool picked = sketchIndex < m_sketchIndices.size()
+            ? domain::solver::pickDragHandle(sketch.entities, m_sketchIndices[sketchIndex], at, pickRadius, handle)
+            : domain::solver::pickDragHandle(sketch.entities, at, pickRadius, handle);
+        if (!picked) {
+            return false;
+        }
+
+        m_dragSketchIndex = sketchIndex;
+        return m_dragSolver.begin(sketch, handle, m_dragOptions);
+    }
+
+    domain::solver::SolveResult Application::dragSketchTo(const domain::sketch::Vec2& target)
+    {
+        if (!m_dragSolver.active() || !m_sketchDoc || m_dragSketchIndex >= m_sketchDoc->sketches.size()) {
+            return {};
+        }
+        auto& sketch = m_sketchDoc->sketches[m_dragSketchIndex];
+        auto result = m_dragSolver.drag(sketch, target);
+        m_redraw.request(rendering::RedrawScene);
+
+        if (m_dragSketchIndex < m_sketchIndices.size()) {
+            auto& index = m_sketchIndices[m_dragSketchIndex];
+            auto& snaps = m_snapEngines[m_dragSketchIndex];
+            for (const auto& [id, params] : m_dragSolver.parameters().entities()) {
+                index.refresh(sketch.entities, id);
+                snaps.refresh(sketch.entities, id);
+            }
+        }
+        return result;
+    }
+
+    void Application::endSketchDrag()
+    {
+        if (!m_dragSolver.active()) {
+            return;
+        }
+        m_dragSolver.end();
+
+        // The drag moved geometry, so the old linearisation is stale.
+        if (sketchAnalysis(m_dragSketchIndex)) {
+            analyzeSketch(m_dragSketchIndex);
+        }
+    }
+
+    const domain::solver::DofAnalyzer* Application::analyzeSketch(std::size_t sketchIndex)
+    {
+        if (!m_sketchDoc || sketchIndex >= m_dofAnalyzers.size()) {
+            return nullptr;
+        }
+        auto& analyzer = m_dofAnalyzers[sketchIndex];
+        analyzer.analyze(m_sketchDoc->sketches[sketchIndex]);
+        m_redraw.request(rendering::RedrawScene); // the sketch is coloured by it
+        return &analyzer;
+    }
+
+    void Application::addSketchConstraint(std::size_t sketchIndex, const domain::sketch::Constraint& constraint)
+    {
+        if (!m_sketchDoc || sketchIndex >= m_sketchDoc->sketches.size()) {
+            return;
+        }
+
+        auto& sketch = m_sketchDoc->sketches[sketchIndex];
+        sketch.constraints.push_back(constraint);
+
+        if (sketchAnalysis(sketchIndex)) {
+            m_dofAnalyzers[sketchIndex].addConstraint(sketch, sketch.constraints.size() - 1);
+        }
+        m_redraw.request(rendering::RedrawScene);
+    }
+
+    const domain::solver::DofAnalyzer* Application::sketchAnalysis(std::size_t sketchIndex) const
+    {
+        return sketchIndex < m_dofAnalyzers.size() && m_dofAnalyzers[sketchIndex].revision() != 0
+            ? &m_dofAnalyzers[sketchIndex] : nullptr;
+    }
+
+    const domain::sketch::SpatialIndex* Application::sketchSpatialIndex(std::size_t sketchIndex) const
+    {
+        return sketchIndex < m_sketchIndices.size() ? &m_sketchIndices[sketchIndex] : nullptr;
+    }
+
+    const domain::sketch::SnapEngine* Application::sketchSnapEngine(std::size_t sketchIndex) const
+    {
+        return sketchIndex < m_snapEngines.size() ? &m_snapEngines[sketchIndex] : nullptr;
+    }
+
+    const std::vector<domain::sketch::Region>& Application::sketchRegions(std::size_t sketchIndex)
+    {
+        static const std::vector<domain::sketch::Region> none;
+        if (!m_sketchDoc || sketchIndex >= m_regionDetectors.size()) {
+            return none;
+        }
+        return m_regionDetectors[sketchIndex].update(m_sketchDoc->sketches[sketchIndex].entities);
+    }
+
+    domain::sketch::CurveTessellationCache* Application::sketchCurveCache(std::size_t sketchIndex)
+    {
+        return sketchIndex < m_curveCaches.size() ? &m_curveCaches[sketchIndex] : nullptr;
+    }
+
+    rendering::SketchRenderBuilder* Application::sketchRenderBuilder(std::size_t sketchIndex)
+    {
+        return sketchIndex < m_renderBuilders.size() ? &m_renderBuilders[sketchIndex] : nullptr;
+    }
+
+    std::size_t Application::acceptSnap(std::size_t sketchIndex, const domain::sketch::SnapCandidate& snap,
+        const domain::sketch::EntityRef& subject)
+    {
+        if (!m_sketchDoc || sketchIndex >= m_sketchDoc->sketches.size()) {
+            return 0;
+        }
+
+        auto& sketch = m_sketchDoc->sketches[sketchIndex];
+        if (!sketch.entities.contains(subject.id) || !sketch.entities.contains(snap.target.id)) {
+            return 0;
+        }
+
+        domain::sketch::ConstraintId next = 0;
+        for (const auto& constraint : sketch.constraints) {
+            next = std::max(next, std::visit([](const auto& c) { return c.meta.id; }, constraint));
+        }
+
+        auto constraints = domain::sketch::SnapEngine::constraintsFor(sketch.entities, snap, subject);
+        for (auto& c : constraints) {
+            c.meta.id = ++next;
+            addSketchConstraint(sketchIndex, c);
+        }
+        return constraints.size();
+    }
+
+    bool Application::deleteSketchEntity(std::size_t sketchIndex, domain::sketch::EntityId id)
+    {
+        if (!m_sketchDoc || sketchIndex >= m_sketchDoc->sketches.size()) {
+            return false;
+        }
+
+        endSketchDrag();
+
+        auto& sketch = m_sketchDoc->sketches[sketchIndex];
+        if (!sketch.entities.remove(id)) {
+            return false;
+        }
+        if (sketchIndex < m_sketchIndices.size()) {
+            m_sketchIndices[sketchIndex].remove(id);
+            m_snapEngines[sketchIndex].refresh(sketch.entities, id);
+        }
+
+        auto references = [id](const domain::sketch::Constraint& constraint) {
+            return std::visit([id](const auto& c) {
+                return std::any_of(c.refs.begin(), c.refs.end(), [id](const auto& r) { return r.id == id; });
+            }, constraint);
+        };
+        sketch.constraints.erase(
+            std::remove_if(sketch.constraints.begin(), sketch.constraints.end(), references),
+            sketch.constraints.end());
+
+        if (sketchAnalysis(sketchIndex)) {
+            analyzeSketch(sketchIndex);
+        }
+        m_redraw.request(rendering::RedrawScene);
+        return true;
+    }
+
+} // namespace core
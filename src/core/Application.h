@@ -2,15 +2,25 @@
 #include <memory>
 #include <vector>
 #include <string>
-#include <thread>
-#include <atomic>
+#include <cstdint>
 #include <mutex>
 #include "ports/IUIPort.h"
 #include "ports/IFileLoaderPort.h"
 #include "ports/IExporterPort.h"
 #include "ports/IRendererPort.h"
+#include "core/rendering/RedrawScheduler.h"
+#include "core/rendering/SketchRenderBuilder.h"
+#include "core/tasks/TaskScheduler.h"
 #include "domain/Model.h"
 #include "domain/SketchModel.h"
+#include "domain/SketchRegions.h"
+#include "domain/SketchSnap.h"
+#include "domain/SketchSpline.h"
+#include "domain/SketchSpatialIndex.h"
+#include "domain/solver/DofAnalyzer.h"
+#include "domain/solver/DragSolver.h"
+#include "domain/solver/SketchSolver.h"
+#include "domain/solver/ParallelExecutor.h"
 
 namespace core {
 
@@ -35,14 +45,25 @@ namespace core {
         void shutdown();
 
         bool loadFile(const std::string& filepath);
+        // Loads run as tasks, several at once; the file asked for last is
+        // the one shown. False if no loader handles the file.
         bool loadFileAsync(const std::string& filepath);
+        // Queues the export of the current model, after any load in flight.
         bool exportFile(const std::string& filepath, const std::string& format);
         std::shared_ptr<domain::Model> getCurrentModel() const;
         ports::IRendererPort* getRenderer() const;
 
         std::string getStatus() const;
         bool isLoading() const;
+        // Mean of the loads in flight, 0-100.
         float getLoadingProgress() const;
+        void cancelLoading();
+
+        // Frames are drawn only when something asked for one here.
+        rendering::RedrawScheduler& redraw() { return m_redraw; }
+
+        // Background jobs: loading, exporting, saving, solving.
+        tasks::TaskScheduler& tasks() { return m_tasks; }
 
     private:
         std::unique_ptr<ports::IUIPort> m_uiAdapter;
@@ -50,26 +71,97 @@ namespace core {
         std::vector<std::unique_ptr<ports::IFileLoaderPort>> m_loaders;
         std::vector<std::unique_ptr<ports::IExporterPort>> m_exporters;
         std::shared_ptr<domain::Model> m_currentModel;
+        std::uint64_t m_shownLoad{ 0 };      // sequence number of the load m_currentModel came from
+        mutable std::mutex m_modelMutex;     // guards both
 
         std::string m_statusMessage;
-        std::atomic<bool> m_isLoading;
-        std::atomic<float> m_loadingProgress;
         mutable std::mutex m_statusMutex;
-        std::thread m_loadingThread;
+        rendering::RedrawScheduler m_redraw;
+
+        std::vector<tasks::TaskHandle> m_loads; // not yet known to be done
+        std::uint64_t m_loadSequence{ 0 };
+        mutable std::mutex m_loadMutex;
 
         void updateStatus(const std::string& message);
-        void loadFileThreaded(const std::string& filepath);
+        void loadFileTask(ports::IFileLoaderPort& loader, const std::string& filepath, std::uint64_t sequence,
+            tasks::TaskContext& context);
 
         ports::IFileLoaderPort* findLoaderForFile(const std::string& filepath);
         ports::IExporterPort* findExporterForFormat(const std::string& format);
 
     public:
         bool loadSketchDocument(const std::string& filepath);
+        // Queues writing a copy of the document as it is now.
+        bool saveSketchDocument(const std::string& filepath);
         std::shared_ptr<domain::sketch::Document> getSketchDocument() const;
 
+        // Solves the constraints of one sketch in the loaded document.
+        domain::solver::SolveResult solveSketch(std::size_t sketchIndex);
+
+        // Interactive dragging: picks the handle nearest `at` (within pickRadius,
+        // sketch units) and re-solves its constraint cluster on every dragSketchTo().
+        bool beginSketchDrag(std::size_t sketchIndex, const domain::sketch::Vec2& at, double pickRadius);
+        domain::solver::SolveResult dragSketchTo(const domain::sketch::Vec2& target);
+        void endSketchDrag();
+        bool isDraggingSketch() const { return m_dragSolver.active(); }
+
+        domain::solver::DragOptions& dragOptions() { return m_dragOptions; }
+
+        // Degrees-of-freedom / redundancy analysis of one sketch at its current
+        // geometry. nullptr if the index is out of range.
+        const domain::solver::DofAnalyzer* analyzeSketch(std::size_t sketchIndex);
+        // Appends a constraint; an analysed sketch's analysis is updated incrementally.
+        void addSketchConstraint(std::size_t sketchIndex, const domain::sketch::Constraint& constraint);
+        // nullptr until that sketch has been analysed.
+        const domain::solver::DofAnalyzer* sketchAnalysis(std::size_t sketchIndex) const;
+
+        // Removes an entity in place, together with the constraints that reference it.
+        bool deleteSketchEntity(std::size_t sketchIndex, domain::sketch::EntityId id);
+
+        // Spatial index of one sketch for picking and box selection; kept in
+        // step with drags and deletions. nullptr if the index is out of range.
+        const domain::sketch::SpatialIndex* sketchSpatialIndex(std::size_t sketchIndex) const;
+
+        // Snap/inference engine of one sketch, kept in step like the spatial
+        // index. nullptr if the index is out of range.
+        const domain::sketch::SnapEngine* sketchSnapEngine(std::size_t sketchIndex) const;
+        // Records the constraints implied by an accepted snap of `subject`
+        // (see SnapEngine::constraintsFor). Returns how many were added.
+        std::size_t acceptSnap(std::size_t sketchIndex, const domain::sketch::SnapCandidate& snap,
+            const domain::sketch::EntityRef& subject);
+
+        // Closed profiles of one sketch, brought up to date with its entities
+        // (only what changed since the last call is redone). Empty if the
+        // index is out of range; valid until the next call for that sketch.
+        const std::vector<domain::sketch::Region>& sketchRegions(std::size_t sketchIndex);
+
+        // Curve tessellations of one sketch for rendering (see
+        // SketchRenderOptions::curveCache). nullptr if the index is out of range.
+        domain::sketch::CurveTessellationCache* sketchCurveCache(std::size_t sketchIndex);
+
+        // Render scene builder of one sketch, kept across frames so that only
+        // entities changed since the last frame are rebuilt. nullptr if the
+        // index is out of range.
+        rendering::SketchRenderBuilder* sketchRenderBuilder(std::size_t sketchIndex);
+
     private:
         std::shared_ptr<domain::sketch::Document> m_sketchDoc;
-
+        std::unique_ptr<domain::solver::ParallelExecutor> m_solverPool; // m_tasks, lent to the solver
+        domain::solver::SketchSolver m_sketchSolver;
+
+        domain::solver::DragSolver m_dragSolver;
+        domain::solver::DragOptions m_dragOptions;
+        std::size_t m_dragSketchIndex{ 0 };
+
+        std::vector<domain::sketch::SpatialIndex> m_sketchIndices; // one per sketch in m_sketchDoc
+        std::vector<domain::solver::DofAnalyzer> m_dofAnalyzers;   // likewise; revision() 0 until analysed
+        std::vector<domain::sketch::SnapEngine> m_snapEngines;     // likewise
+        std::vector<domain::sketch::RegionDetector> m_regionDetectors; // likewise, updated on demand
+        std::vector<domain::sketch::CurveTessellationCache> m_curveCaches; // likewise, filled by rendering
+        std::vector<rendering::SketchRenderBuilder> m_renderBuilders;      // likewise
+
+        // Last, so its workers stop before anything its jobs use is gone.
+        tasks::TaskScheduler m_tasks;
     };
 
 } // namespace core
\ No newline at end of file
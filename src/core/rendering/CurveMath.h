@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "core/rendering/RenderScene.h"
+
+namespace core::rendering
+{
+    inline constexpr float kTwoPi = 6.28318530717958647692f;
+
+    // Orthonormal in-plane axes; u follows +X where the plane allows.
+    inline void PlaneBasis(const glm::vec3& normal, glm::vec3& u, glm::vec3& v)
+    {
+        const glm::vec3 n = glm::length(normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0, 0, 1);
+        const glm::vec3 ref = std::abs(n.x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+        u = glm::normalize(ref - n * glm::dot(ref, n));
+        v = glm::cross(n, u);
+    }
+
+    // Angle of the arc's start in the (u, v) basis of PlaneBasis, and its
+    // signed sweep: positive counter-clockwise, in (0, 2 pi] either way.
+    inline void ArcAngles(const Arc3D& a, const glm::vec3& u, const glm::vec3& v, float& start, float& sweep)
+    {
+        const glm::vec3 s = a.start - a.center;
+        const glm::vec3 e = a.end - a.center;
+        start = std::atan2(glm::dot(s, v), glm::dot(s, u));
+        sweep = std::atan2(glm::dot(e, v), glm::dot(e, u)) - start;
+        if (a.ccw) { while (sweep <= 0.0f) sweep += kTwoPi; }
+        else { while (sweep >= 0.0f) sweep -= kTwoPi; }
+    }
+
+    // Major and minor semi-axes of an ellipse, rotated in its plane.
+    inline void EllipseAxes(const Ellipse3D& e, glm::vec3& major, glm::vec3& minor)
+    {
+        glm::vec3 u, v;
+        PlaneBasis(e.normal, u, v);
+        const float cr = std::cos(e.rotationRad), sr = std::sin(e.rotationRad);
+        major = (cr * u + sr * v) * e.rx;
+        minor = (cr * v - sr * u) * e.ry;
+    }
+}
@@ -0,0 +1,251 @@
+#include "core/rendering/CurveTessellator.h"
+#include "core/rendering/CurveMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    using core::rendering::PrimitiveKind;
+    using core::rendering::kTwoPi;
+
+    constexpr std::size_t kMinCompaction = 4096; // stale vertices before compacting is worth it
+
+    static inline int CurveIndex(PrimitiveKind kind)
+    {
+        switch (kind)
+        {
+        case PrimitiveKind::Circle:  return 0;
+        case PrimitiveKind::Arc:     return 1;
+        case PrimitiveKind::Ellipse: return 2;
+        default:                     return -1;
+        }
+    }
+
+    static inline PrimitiveKind CurveKind(std::size_t curve)
+    {
+        return curve == 0 ? PrimitiveKind::Circle : curve == 1 ? PrimitiveKind::Arc : PrimitiveKind::Ellipse;
+    }
+
+    static std::size_t CurveCount(const core::rendering::RenderScene& s, std::size_t curve)
+    {
+        return curve == 0 ? s.circles.size() : curve == 1 ? s.arcs.size() : s.ellipses.size();
+    }
+
+    static glm::vec3 CurveCenter(const core::rendering::RenderScene& s, std::size_t curve, std::size_t i)
+    {
+        return curve == 0 ? s.circles[i].center : curve == 1 ? s.arcs[i].center : s.ellipses[i].center;
+    }
+
+    static bool SameCamera(const core::rendering::CameraState& a, const core::rendering::CameraState& b)
+    {
+        auto same = [](const glm::vec3& p, const glm::vec3& q) { return p.x == q.x && p.y == q.y && p.z == q.z; };
+        return same(a.position, b.position) && same(a.target, b.target) && same(a.up, b.up)
+            && a.projection == b.projection
+            && a.fovYDegrees == b.fovYDegrees && a.orthoScale == b.orthoScale
+            && a.nearPlane == b.nearPlane && a.farPlane == b.farPlane
+            && a.viewportWidth == b.viewportWidth && a.viewportHeight == b.viewportHeight;
+    }
+}
+
+namespace core::rendering
+{
+    CurveTessellator::CurveTessellator(const CurveTessellationOptions& options)
+        : m_options(options)
+    {
+    }
+
+    void CurveTessellator::setOptions(const CurveTessellationOptions& options)
+    {
+        m_options = options;
+        m_retessellate = true;
+    }
+
+    float CurveTessellator::PixelsPerUnit(const CameraState& camera, const glm::vec3& at)
+    {
+        const float height = static_cast<float>(std::max(camera.viewportHeight, 1));
+        if (camera.projection == ProjectionType::Orthographic)
+            return height / (2.0f * std::max(camera.orthoScale, 1e-12f));
+
+        glm::vec3 dir = camera.target - camera.position;
+        const float len = glm::length(dir);
+        dir = len > 0.0f ? dir / len : glm::vec3(0, 0, -1);
+        const float depth = std::max({ glm::dot(at - camera.position, dir), camera.nearPlane, 1e-6f });
+        const float halfFov = 0.5f * camera.fovYDegrees * kTwoPi / 360.0f;
+        return height / (2.0f * depth * std::tan(halfFov));
+    }
+
+    int CurveTessellator::SegmentCount(float radiusPixels, float sweep, const CurveTessellationOptions& options)
+    {
+        const float turns = std::min(std::abs(sweep) / kTwoPi, 1.0f);
+        const int lo = std::max(1, static_cast<int>(std::ceil(options.minSegments * turns)));
+        const int hi = std::max(lo, static_cast<int>(std::ceil(options.maxSegments * turns)));
+        if (!(radiusPixels > options.pixelError))
+            return lo;
+
+        // A chord spanning `step` radians strays r (1 - cos(step / 2)) from the arc.
+        const float step = 2.0f * std::acos(1.0f - options.pixelError / radiusPixels);
+        return std::clamp(static_cast<int>(std::ceil(std::abs(sweep) / step)), lo, hi);
+    }
+
+    bool CurveTessellator::update(const RenderScene& scene, const SceneDelta& delta, const CameraState& camera)
+    {
+        m_delta.clear();
+        const bool moved = !m_hasCamera || !SameCamera(camera, m_camera);
+        m_camera = camera;
+        m_hasCamera = true;
+
+        for (const DirtyRange& r : delta.ranges)
+        {
+            const int c = CurveIndex(r.kind);
+            if (c < 0) continue;
+            for (std::uint32_t i = 0; i < r.count; ++i) m_dirty[c].push_back(r.first + i);
+        }
+
+        for (std::size_t c = 0; c < kCurveKinds; ++c)
+        {
+            auto& slots = m_slots[c];
+            auto& dirty = m_dirty[c];
+            const std::size_t size = CurveCount(scene, c);
+
+            const std::size_t old = slots.size();
+            if (size != old) m_delta.resized = true;
+            for (std::size_t i = size; i < old; ++i) m_stale += slots[i].capacity;
+            slots.resize(size);
+            for (std::size_t i = old; i < size; ++i) dirty.push_back(static_cast<std::uint32_t>(i));
+
+            if (delta.full || m_retessellate)
+            {
+                for (std::size_t i = 0; i < size; ++i) dirty.push_back(static_cast<std::uint32_t>(i));
+            }
+            else if (moved)
+            {
+                for (std::size_t i = 0; i < std::min(old, size); ++i)
+                {
+                    const float ratio = PixelsPerUnit(camera, CurveCenter(scene, c, i)) / slots[i].scale;
+                    if (ratio > m_options.zoomThreshold || ratio * m_options.zoomThreshold < 1.0f)
+                        dirty.push_back(static_cast<std::uint32_t>(i));
+                }
+            }
+
+            std::sort(dirty.begin(), dirty.end());
+            dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+            while (!dirty.empty() && dirty.back() >= size) dirty.pop_back();
+
+            for (std::size_t k = 0; k < dirty.size();)
+            {
+                std::size_t j = k;
+                for (; j < dirty.size() && dirty[j] == dirty[k] + (j - k); ++j)
+                    tessellate(scene, c, dirty[j], PixelsPerUnit(camera, CurveCenter(scene, c, dirty[j])));
+                m_delta.ranges.push_back({ CurveKind(c), dirty[k], static_cast<std::uint32_t>(j - k) });
+                k = j;
+            }
+            dirty.clear();
+        }
+        m_retessellate = false;
+
+        if (m_stale > kMinCompaction && 2 * m_stale > m_arena.size())
+        {
+            compact();
+            m_delta.ranges.clear();
+            m_delta.full = true;
+        }
+        return !m_delta.empty();
+    }
+
+    CurveSpan CurveTessellator::span(PrimitiveKind kind, std::size_t index) const
+    {
+        const int c = CurveIndex(kind);
+        if (c < 0 || index >= m_slots[c].size())
+            return {};
+        return m_slots[c][index].span;
+    }
+
+    const glm::vec3* CurveTessellator::strip(PrimitiveKind kind, std::size_t index) const
+    {
+        const CurveSpan s = span(kind, index);
+        return s.count > 0 ? m_arena.data() + s.first : nullptr;
+    }
+
+    void CurveTessellator::tessellate(const RenderScene& scene, std::size_t curve, std::uint32_t index, float scale)
+    {
+        m_scratch.clear();
+        glm::vec3 u, v;
+
+        if (curve == 0)
+        {
+            const Circle3D& c = scene.circles[index];
+            PlaneBasis(c.normal, u, v);
+            const int n = SegmentCount(c.radius * scale, kTwoPi, m_options);
+            for (int k = 0; k <= n; ++k)
+            {
+                const float a = kTwoPi * static_cast<float>(k % n) / static_cast<float>(n);
+                m_scratch.push_back(c.center + c.radius * (std::cos(a) * u + std::sin(a) * v));
+            }
+        }
+        else if (curve == 1)
+        {
+            const Arc3D& a = scene.arcs[index];
+            PlaneBasis(a.normal, u, v);
+            float a0, sweep;
+            ArcAngles(a, u, v, a0, sweep);
+
+            const int n = SegmentCount(a.radius * scale, sweep, m_options);
+            for (int k = 0; k <= n; ++k)
+            {
+                const float ang = a0 + sweep * static_cast<float>(k) / static_cast<float>(n);
+                m_scratch.push_back(a.center + a.radius * (std::cos(ang) * u + std::sin(ang) * v));
+            }
+        }
+        else
+        {
+            const Ellipse3D& e = scene.ellipses[index];
+            glm::vec3 major, minor;
+            EllipseAxes(e, major, minor);
+
+            const int n = SegmentCount(std::max(e.rx, e.ry) * scale, kTwoPi, m_options);
+            for (int k = 0; k <= n; ++k)
+            {
+                const float ang = kTwoPi * static_cast<float>(k % n) / static_cast<float>(n);
+                m_scratch.push_back(e.center + std::cos(ang) * major + std::sin(ang) * minor);
+            }
+        }
+
+        Slot& slot = m_slots[curve][index];
+        slot.scale = std::max(scale, 1e-30f); // stays a valid divisor
+        place(slot);
+    }
+
+    void CurveTessellator::place(Slot& slot)
+    {
+        const std::size_t n = m_scratch.size();
+        if (n > slot.capacity)
+        {
+            // Moves to the end, with room to grow a little in place.
+            m_stale += slot.capacity;
+            slot.span.first = static_cast<std::uint32_t>(m_arena.size());
+            slot.capacity = static_cast<std::uint32_t>(n + n / 4);
+            m_arena.resize(m_arena.size() + slot.capacity, m_scratch.back());
+        }
+        std::copy(m_scratch.begin(), m_scratch.end(), m_arena.begin() + slot.span.first);
+        slot.span.count = static_cast<std::uint32_t>(n);
+    }
+
+    void CurveTessellator::compact()
+    {
+        std::vector<glm::vec3> arena;
+        arena.reserve(m_arena.size() - m_stale);
+        for (auto& slots : m_slots)
+        {
+            for (Slot& slot : slots)
+            {
+                const auto first = m_arena.begin() + slot.span.first;
+                const std::uint32_t at = static_cast<std::uint32_t>(arena.size());
+                arena.insert(arena.end(), first, first + slot.capacity);
+                slot.span.first = at;
+            }
+        }
+        m_arena.swap(arena);
+        m_stale = 0;
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/rendering/CameraState.h"
+#include "core/rendering/RenderScene.h"
+
+namespace core::rendering
+{
+    struct CurveTessellationOptions
+    {
+        float pixelError = 0.5f;    // max distance of a chord from the curve, in pixels
+        int minSegments = 8;        // full turn; arcs get their share
+        int maxSegments = 1024;     // full turn
+        float zoomThreshold = 1.5f; // re-tessellate once a curve's on-screen scale changes by this factor
+    };
+
+    // Vertices [first, first + count) of the arena, drawn as a line strip.
+    struct CurveSpan
+    {
+        std::uint32_t first{ 0 };
+        std::uint32_t count{ 0 };
+    };
+
+    // Screen-space tessellation of the circles, arcs and ellipses of a
+    // RenderScene, shared by the renderers.
+    //
+    // Each curve gets as many segments as keep its chords within pixelError
+    // of the curve at its projected size, so a tiny far-away circle costs
+    // minSegments and a large one on screen as many as it needs. The strips
+    // are packed into one vertex arena; a curve whose new strip fits its old
+    // place is rewritten there, otherwise it moves to the end, and the arena
+    // is compacted once more than half of it is stale.
+    //
+    // update() re-tessellates the curves a scene delta marks, new ones, and
+    // - when the camera moved - those whose scale has drifted by more than
+    // zoomThreshold since they were last tessellated. delta() lists them.
+    class CurveTessellator
+    {
+    public:
+        explicit CurveTessellator(const CurveTessellationOptions& options = {});
+
+        void setOptions(const CurveTessellationOptions& options);
+        const CurveTessellationOptions& options() const { return m_options; }
+
+        // `scene` is the current scene; `delta` what changed in it since the
+        // last call. Returns whether any strip changed.
+        bool update(const RenderScene& scene, const SceneDelta& delta, const CameraState& camera);
+
+        const std::vector<glm::vec3>& vertices() const { return m_arena; }
+        // The strip of the index-th primitive of `kind` (Circle, Arc or Ellipse).
+        CurveSpan span(PrimitiveKind kind, std::size_t index) const;
+        const glm::vec3* strip(PrimitiveKind kind, std::size_t index) const;
+
+        // Curves re-tessellated by the last update(); full if the arena was
+        // compacted, which moves every strip.
+        const SceneDelta& delta() const { return m_delta; }
+
+        // Pixels per world unit at `at` as seen by `camera`.
+        static float PixelsPerUnit(const CameraState& camera, const glm::vec3& at);
+        // Segments for `sweep` radians of a curve `radiusPixels` in size.
+        static int SegmentCount(float radiusPixels, float sweep, const CurveTessellationOptions& options);
+
+    private:
+        struct Slot
+        {
+            CurveSpan span;
+            std::uint32_t capacity{ 0 };
+            float scale{ 0.0f }; // pixels per unit it was tessellated at
+        };
+
+        static constexpr std::size_t kCurveKinds = 3; // Circle, Arc, Ellipse
+
+        CurveTessellationOptions m_options;
+        CameraState m_camera;
+        bool m_hasCamera{ false };
+        bool m_retessellate{ false }; // options changed
+
+        std::vector<Slot> m_slots[kCurveKinds];
+        std::vector<glm::vec3> m_arena;
+        std::size_t m_stale{ 0 }; // arena vertices no slot uses
+        std::vector<std::uint32_t> m_dirty[kCurveKinds];
+        SceneDelta m_delta;
+        std::vector<glm::vec3> m_scratch;
+
+        void tessellate(const RenderScene& scene, std::size_t curve, std::uint32_t index, float scale);
+        void place(Slot& slot);
+        void compact();
+    };
+}
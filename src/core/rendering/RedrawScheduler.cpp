@@ -0,0 +1,44 @@
+#include "core/rendering/RedrawScheduler.h"
+
+namespace core::rendering
+{
+    void RedrawScheduler::request(std::uint32_t reasons)
+    {
+        if (reasons == 0) return;
+
+        // Only the first request after a frame needs to wake the loop.
+        const std::uint32_t before = m_dirty.fetch_or(reasons, std::memory_order_acq_rel);
+        if (before == 0 && m_wakeUp)
+            m_wakeUp();
+    }
+
+    double RedrawScheduler::waitTimeout() const
+    {
+        if (m_settleFrames > 0 || m_dirty.load(std::memory_order_acquire) != 0)
+            return 0.0;
+        return kIdleTimeoutSeconds;
+    }
+
+    std::uint32_t RedrawScheduler::beginFrame()
+    {
+        m_frame = m_dirty.exchange(0, std::memory_order_acq_rel);
+        if (m_frame != 0)
+        {
+            m_settleFrames = kSettleFrames;
+        }
+        else if (m_settleFrames > 0)
+        {
+            --m_settleFrames;
+            m_frame = RedrawInput;
+        }
+        return m_frame;
+    }
+
+    bool RedrawScheduler::takeViewRedraw()
+    {
+        const std::uint32_t pending = m_dirty.fetch_and(~kRedrawViewReasons, std::memory_order_acq_rel);
+        const bool redraw = ((m_frame | pending) & kRedrawViewReasons) != 0;
+        m_frame &= ~kRedrawViewReasons;
+        return redraw;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace core::rendering
+{
+    // Why a frame is wanted. Any reason redraws the UI; the 3D view is
+    // rendered again only for kRedrawViewReasons.
+    enum RedrawReason : std::uint32_t
+    {
+        RedrawInput     = 1u << 0, // mouse, keyboard, focus
+        RedrawWindow    = 1u << 1, // window or viewport resized or exposed
+        RedrawScene     = 1u << 2, // sketch geometry, constraints or analysis
+        RedrawCamera    = 1u << 3,
+        RedrawModel     = 1u << 4,
+        RedrawProgress  = 1u << 5, // loader progress or status text
+        RedrawAnimation = 1u << 6,
+    };
+
+    inline constexpr std::uint32_t kRedrawViewReasons = RedrawWindow | RedrawScene | RedrawCamera | RedrawModel;
+    inline constexpr std::uint32_t kRedrawAll = 0x7f;
+
+    // Decides when the main loop draws a frame, so an idle window sleeps in
+    // its event wait instead of redrawing at the display rate.
+    //
+    // Anything that changes what is on screen request()s a redraw with its
+    // reason, from any thread; a request wakes the loop through the callback
+    // the UI installs. The loop asks waitTimeout() how long it may block,
+    // then beginFrame() whether to draw at all. An animation keeps frames
+    // coming by requesting RedrawAnimation (and whatever it changes) every
+    // frame it runs; swap interval paces it.
+    //
+    // ImGui needs a frame or two to settle after a change (hover states,
+    // closing popups), so every requested frame is followed by kSettleFrames
+    // more for the UI alone.
+    class RedrawScheduler
+    {
+    public:
+        static constexpr int kSettleFrames = 2;
+        static constexpr double kIdleTimeoutSeconds = 0.5;
+
+        // Called by request() to interrupt a blocking event wait. Install it
+        // before other threads can request.
+        void setWakeUp(std::function<void()> wakeUp) { m_wakeUp = std::move(wakeUp); }
+
+        // Any thread.
+        void request(std::uint32_t reasons);
+
+        // UI thread. How long the loop may block waiting for events: zero
+        // while a frame is due.
+        double waitTimeout() const;
+
+        // UI thread, once per loop iteration. The reasons to draw this frame,
+        // which are cleared; 0 means there is nothing to draw.
+        std::uint32_t beginFrame();
+
+        // UI thread, during a frame. Whether the 3D view needs rendering: a
+        // view reason was requested for this frame, or since it began.
+        // Consumes those reasons, so later requests go to the next frame.
+        bool takeViewRedraw();
+
+    private:
+        std::atomic<std::uint32_t> m_dirty{ kRedrawAll };
+        std::uint32_t m_frame{ 0 };  // reasons of the frame being drawn
+        int m_settleFrames{ 0 };
+        std::function<void()> m_wakeUp;
+    };
+}
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cstdint>
+#include <algorithm>
 #include <glm/glm.hpp>
 
 namespace core::rendering
@@ -21,6 +22,7 @@ namespace core::rendering
         Color color;
         float thickness{ 1.0f };
         bool selectable{ true };
+        bool construction{ false };
     };
 
     struct Point3D
@@ -39,6 +41,7 @@ namespace core::rendering
         Color color;
         float thickness{ 1.0f };
         bool selectable{ true };
+        bool construction{ false };
     };
 
     // --- NEW: true curve primitives (renderer-agnostic) ---
@@ -131,4 +134,150 @@ namespace core::rendering
             ellipses.clear();
         }
     };
+
+    // The primitive arrays of a RenderScene.
+    enum class PrimitiveKind : std::uint8_t { Point, Line, Polyline, Circle, Arc, Ellipse };
+    inline constexpr std::size_t kPrimitiveKindCount = 6;
+
+    // Elements [first, first + count) of one primitive array changed.
+    struct DirtyRange
+    {
+        PrimitiveKind kind{ PrimitiveKind::Point };
+        std::uint32_t first{ 0 };
+        std::uint32_t count{ 0 };
+    };
+
+    // What an incremental scene update changed. Arrays may also have shrunk;
+    // elements past their new size are gone.
+    struct SceneDelta
+    {
+        bool full{ false };    // everything changed; ranges is empty
+        bool resized{ false }; // some array changed size, which ranges need not show
+        std::vector<DirtyRange> ranges;
+
+        bool empty() const { return !full && !resized && ranges.empty(); }
+        void clear() { full = false; resized = false; ranges.clear(); }
+    };
+
+    // Adds the changes of `from` to `into`, for consumers that apply several
+    // deltas at once.
+    inline void MergeSceneDelta(SceneDelta& into, const SceneDelta& from)
+    {
+        into.resized = into.resized || from.resized;
+        if (into.full) return;
+        if (from.full)
+        {
+            into.full = true;
+            into.ranges.clear();
+            return;
+        }
+        into.ranges.insert(into.ranges.end(), from.ranges.begin(), from.ranges.end());
+    }
+
+    // Brings `target`, a copy of an earlier state of `source`, up to date by
+    // copying only the ranges `delta` marks (everything if delta.full).
+    inline void ApplySceneDelta(RenderScene& target, const RenderScene& source, const SceneDelta& delta)
+    {
+        if (delta.full)
+        {
+            target = source;
+            return;
+        }
+
+        auto patch = [&delta](auto& dst, const auto& src, PrimitiveKind kind)
+        {
+            dst.resize(src.size());
+            for (const DirtyRange& r : delta.ranges)
+            {
+                if (r.kind != kind) continue;
+                const std::size_t end = std::min<std::size_t>(r.first + r.count, src.size());
+                for (std::size_t i = r.first; i < end; ++i) dst[i] = src[i];
+            }
+        };
+        patch(target.points, source.points, PrimitiveKind::Point);
+        patch(target.lines, source.lines, PrimitiveKind::Line);
+        patch(target.polylines, source.polylines, PrimitiveKind::Polyline);
+        patch(target.circles, source.circles, PrimitiveKind::Circle);
+        patch(target.arcs, source.arcs, PrimitiveKind::Arc);
+        patch(target.ellipses, source.ellipses, PrimitiveKind::Ellipse);
+        target.grid = source.grid;
+        target.showGrid = source.showGrid;
+        target.ghostSolids = source.ghostSolids;
+        target.sectionActive = source.sectionActive;
+    }
+
+    // The ranges a delta marks, copied out of the scene they changed in, so a
+    // copy of the scene elsewhere can be brought up to date without the
+    // source (see ApplyScenePatch). Costs what changed, not the scene's size,
+    // except for a full delta.
+    struct ScenePatch
+    {
+        SceneDelta delta;
+        RenderScene changed;    // delta.full: the scene; else each range's elements, in range order
+        std::uint32_t sizes[kPrimitiveKindCount]{}; // array sizes after the change
+    };
+
+    inline void MakeScenePatch(ScenePatch& out, const RenderScene& source, const SceneDelta& delta)
+    {
+        out.delta = delta;
+        if (delta.full)
+        {
+            out.changed = source;
+            return;
+        }
+
+        out.changed.Clear();
+        auto copy = [&](auto& dst, const auto& src, PrimitiveKind kind)
+        {
+            out.sizes[static_cast<std::size_t>(kind)] = static_cast<std::uint32_t>(src.size());
+            for (const DirtyRange& r : delta.ranges)
+            {
+                if (r.kind != kind) continue;
+                const std::size_t end = std::min<std::size_t>(r.first + r.count, src.size());
+                for (std::size_t i = r.first; i < end; ++i) dst.push_back(src[i]);
+            }
+        };
+        copy(out.changed.points, source.points, PrimitiveKind::Point);
+        copy(out.changed.lines, source.lines, PrimitiveKind::Line);
+        copy(out.changed.polylines, source.polylines, PrimitiveKind::Polyline);
+        copy(out.changed.circles, source.circles, PrimitiveKind::Circle);
+        copy(out.changed.arcs, source.arcs, PrimitiveKind::Arc);
+        copy(out.changed.ellipses, source.ellipses, PrimitiveKind::Ellipse);
+        out.changed.grid = source.grid;
+        out.changed.showGrid = source.showGrid;
+        out.changed.ghostSolids = source.ghostSolids;
+        out.changed.sectionActive = source.sectionActive;
+    }
+
+    // Like ApplySceneDelta, from a patch of the state `target` is behind by.
+    inline void ApplyScenePatch(RenderScene& target, const ScenePatch& patch)
+    {
+        if (patch.delta.full)
+        {
+            target = patch.changed;
+            return;
+        }
+
+        auto apply = [&patch](auto& dst, const auto& src, PrimitiveKind kind)
+        {
+            dst.resize(patch.sizes[static_cast<std::size_t>(kind)]);
+            std::size_t next = 0;
+            for (const DirtyRange& r : patch.delta.ranges)
+            {
+                if (r.kind != kind) continue;
+                const std::size_t end = std::min<std::size_t>(r.first + r.count, dst.size());
+                for (std::size_t i = r.first; i < end; ++i) dst[i] = src[next++];
+            }
+        };
+        apply(target.points, patch.changed.points, PrimitiveKind::Point);
+        apply(target.lines, patch.changed.lines, PrimitiveKind::Line);
+        apply(target.polylines, patch.changed.polylines, PrimitiveKind::Polyline);
+        apply(target.circles, patch.changed.circles, PrimitiveKind::Circle);
+        apply(target.arcs, patch.changed.arcs, PrimitiveKind::Arc);
+        apply(target.ellipses, patch.changed.ellipses, PrimitiveKind::Ellipse);
+        target.grid = patch.changed.grid;
+        target.showGrid = patch.changed.showGrid;
+        target.ghostSolids = patch.changed.ghostSolids;
+        target.sectionActive = patch.changed.sectionActive;
+    }
 }
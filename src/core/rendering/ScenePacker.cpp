@@ -0,0 +1,274 @@
+#include "core/rendering/ScenePacker.h"
+#include "core/rendering/CurveMath.h"
+
+#include <algorithm>
+
+namespace
+{
+    using core::rendering::RenderId;
+    using ports::RenderPrimitiveKind;
+
+    static inline std::uint8_t ToByte(float v)
+    {
+        return static_cast<std::uint8_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    static inline std::uint32_t ToPickId(RenderId id, bool selectable)
+    {
+        return selectable ? static_cast<std::uint32_t>(id) : 0u;
+    }
+
+    static inline std::uint8_t RangeFlags(bool construction)
+    {
+        return static_cast<std::uint8_t>(ports::RenderRangeDepthTest
+            | (construction ? ports::RenderRangeConstruction : 0));
+    }
+
+    // Appends one primitive of n vertices. Point and line lists extend the
+    // last range when it has the same kind, size and flags; strips always
+    // start their own.
+    static void Append(ports::RenderScene& out, RenderPrimitiveKind kind, float size, std::uint8_t flags,
+        std::uint32_t pickId, std::uint32_t rgba, const glm::vec3* p, std::size_t n)
+    {
+        if (n == 0) return;
+
+        const ports::DrawRange* last = out.ranges.empty() ? nullptr : &out.ranges.back();
+        if (kind == RenderPrimitiveKind::LineStrip || !last
+            || last->kind != kind || last->size != size || last->flags != flags)
+        {
+            ports::DrawRange range;
+            range.first = static_cast<std::uint32_t>(out.vertices.size());
+            range.firstId = static_cast<std::uint32_t>(out.ids.size());
+            range.size = size;
+            range.kind = kind;
+            range.flags = flags;
+            out.ranges.push_back(range);
+        }
+
+        out.ranges.back().count += static_cast<std::uint32_t>(n);
+        for (std::size_t i = 0; i < n; ++i) out.vertices.push_back({ p[i], rgba });
+        out.ids.push_back(pickId);
+    }
+}
+
+namespace core::rendering
+{
+    std::uint32_t PackColor(const Color& color)
+    {
+        return ports::PackRgba(ToByte(color.r), ToByte(color.g), ToByte(color.b), ToByte(color.a));
+    }
+
+    ports::RenderSceneSnapshot ScenePacker::update(const RenderScene& scene, const SceneDelta& delta)
+    {
+        if (m_snapshot && delta.empty())
+            return m_snapshot;
+
+        const std::size_t counts[kPrimitiveKindCount] = { scene.points.size(), scene.lines.size(),
+            scene.polylines.size(), scene.circles.size(), scene.arcs.size(), scene.ellipses.size() };
+        auto resized = [&](PrimitiveKind kind) { return counts[int(kind)] != m_counts[int(kind)]; };
+        auto touched = [&](PrimitiveKind kind)
+        {
+            return resized(kind) || std::any_of(delta.ranges.begin(), delta.ranges.end(),
+                [kind](const DirtyRange& r) { return r.kind == kind && r.count > 0; });
+        };
+
+        const bool all = !m_snapshot || delta.full;
+        const bool vertices = all || touched(PrimitiveKind::Point) || touched(PrimitiveKind::Line)
+            || touched(PrimitiveKind::Polyline);
+        const bool curves = all || resized(PrimitiveKind::Circle) || resized(PrimitiveKind::Arc)
+            || resized(PrimitiveKind::Ellipse);
+
+        // Recycled storage holds some older scene: the parts that don't
+        // change come from the last snapshot. The copies reuse its capacity.
+        std::shared_ptr<ports::RenderScene> next = acquire();
+        if (m_snapshot && !vertices)
+        {
+            next->vertices = m_snapshot->vertices;
+            next->ranges = m_snapshot->ranges;
+            next->ids = m_snapshot->ids;
+            next->vertexRevision = m_snapshot->vertexRevision;
+        }
+        if (m_snapshot && !curves)
+            next->curves = m_snapshot->curves;
+
+        const std::uint64_t revision = ++m_revision;
+        if (vertices)
+        {
+            PackVertices(scene, *next);
+            next->vertexRevision = revision;
+        }
+
+        next->changedCurves.clear();
+        if (curves)
+        {
+            next->curves.resize(counts[3] + counts[4] + counts[5]);
+            for (std::size_t i = 0; i < next->curves.size(); ++i) next->curves[i] = PackCurve(scene, i);
+            next->curveBase = 0;
+        }
+        else
+        {
+            for (const DirtyRange& r : delta.ranges)
+            {
+                std::size_t base;
+                switch (r.kind)
+                {
+                case PrimitiveKind::Circle:  base = 0; break;
+                case PrimitiveKind::Arc:     base = counts[3]; break;
+                case PrimitiveKind::Ellipse: base = counts[3] + counts[4]; break;
+                default: continue;
+                }
+                const std::size_t end = std::min<std::size_t>(r.first + r.count, counts[int(r.kind)]);
+                if (end <= r.first) continue;
+                for (std::size_t i = base + r.first; i < base + end; ++i) next->curves[i] = PackCurve(scene, i);
+                next->changedCurves.push_back({ static_cast<std::uint32_t>(base + r.first),
+                    static_cast<std::uint32_t>(end - r.first) });
+            }
+            next->curveBase = revision - 1;
+        }
+
+        PackWorkplane(scene, *next);
+        next->revision = revision;
+        std::copy(std::begin(counts), std::end(counts), m_counts);
+        m_snapshot = std::move(next);
+        return m_snapshot;
+    }
+
+    void ScenePacker::Pack(const RenderScene& scene, ports::RenderScene& out)
+    {
+        PackVertices(scene, out);
+        out.curves.resize(scene.circles.size() + scene.arcs.size() + scene.ellipses.size());
+        for (std::size_t i = 0; i < out.curves.size(); ++i) out.curves[i] = PackCurve(scene, i);
+        out.curveBase = 0;
+        out.changedCurves.clear();
+        PackWorkplane(scene, out);
+    }
+
+    std::shared_ptr<ports::RenderScene> ScenePacker::acquire()
+    {
+        // A renderer holds one snapshot and the producer another; a third
+        // is only ever briefly in flight.
+        constexpr std::size_t kPooled = 2;
+
+        std::unique_ptr<ports::RenderScene> storage;
+        {
+            std::lock_guard<std::mutex> lock(m_pool->mutex);
+            if (!m_pool->free.empty())
+            {
+                storage = std::move(m_pool->free.back());
+                m_pool->free.pop_back();
+            }
+        }
+        if (!storage)
+            storage = std::make_unique<ports::RenderScene>();
+
+        std::weak_ptr<Pool> pool = m_pool;
+        return std::shared_ptr<ports::RenderScene>(storage.release(), [pool](ports::RenderScene* released)
+        {
+            std::unique_ptr<ports::RenderScene> owned(released);
+            if (auto p = pool.lock())
+            {
+                std::lock_guard<std::mutex> lock(p->mutex);
+                if (p->free.size() < kPooled) p->free.push_back(std::move(owned));
+            }
+        });
+    }
+
+    void ScenePacker::PackVertices(const RenderScene& scene, ports::RenderScene& out)
+    {
+        out.vertices.clear();
+        out.ranges.clear();
+        out.ids.clear();
+
+        std::size_t vertices = scene.points.size() + 2 * scene.lines.size();
+        for (const Polyline3D& pl : scene.polylines) vertices += pl.points.size();
+        out.vertices.reserve(vertices);
+        out.ids.reserve(scene.points.size() + scene.lines.size() + scene.polylines.size());
+
+        for (const Point3D& p : scene.points)
+        {
+            Append(out, RenderPrimitiveKind::PointList, p.size, RangeFlags(false),
+                ToPickId(p.id, p.selectable), PackColor(p.color), &p.p, 1);
+        }
+
+        // Solid lines first, then construction ones, so each style batches.
+        for (const bool construction : { false, true })
+        {
+            for (const Line3D& l : scene.lines)
+            {
+                if (l.construction != construction) continue;
+                const glm::vec3 ends[2] = { l.a, l.b };
+                Append(out, RenderPrimitiveKind::LineList, l.thickness, RangeFlags(construction),
+                    ToPickId(l.id, l.selectable), PackColor(l.color), ends, 2);
+            }
+        }
+
+        for (const Polyline3D& pl : scene.polylines)
+        {
+            Append(out, RenderPrimitiveKind::LineStrip, pl.thickness, RangeFlags(pl.construction),
+                ToPickId(pl.id, pl.selectable), PackColor(pl.color), pl.points.data(), pl.points.size());
+        }
+    }
+
+    ports::CurveInstance ScenePacker::PackCurve(const RenderScene& scene, std::size_t index)
+    {
+        ports::CurveInstance c;
+        glm::vec3 u, v;
+
+        auto style = [&c](const auto& prim)
+        {
+            c.center = prim.center;
+            c.rgba = PackColor(prim.color);
+            c.id = ToPickId(prim.id, prim.selectable);
+            c.size = prim.thickness;
+            c.flags = RangeFlags(prim.construction);
+        };
+
+        if (index < scene.circles.size())
+        {
+            const Circle3D& ci = scene.circles[index];
+            style(ci);
+            PlaneBasis(ci.normal, u, v);
+            c.axisU = u * ci.radius;
+            c.axisV = v * ci.radius;
+            c.startAngle = 0.0f;
+            c.endAngle = kTwoPi;
+            return c;
+        }
+        index -= scene.circles.size();
+
+        if (index < scene.arcs.size())
+        {
+            const Arc3D& a = scene.arcs[index];
+            style(a);
+            PlaneBasis(a.normal, u, v);
+            float start, sweep;
+            ArcAngles(a, u, v, start, sweep);
+            c.axisU = u * a.radius;
+            c.axisV = v * a.radius;
+            c.startAngle = start;
+            c.endAngle = start + sweep;
+            return c;
+        }
+        index -= scene.arcs.size();
+
+        const Ellipse3D& e = scene.ellipses[index];
+        style(e);
+        EllipseAxes(e, c.axisU, c.axisV);
+        c.startAngle = 0.0f;
+        c.endAngle = kTwoPi;
+        return c;
+    }
+
+    void ScenePacker::PackWorkplane(const RenderScene& scene, ports::RenderScene& out)
+    {
+        const GridPlane& grid = scene.grid;
+        out.hasWorkplane = scene.showGrid && grid.visible;
+        out.workplaneToWorld = glm::mat4(1.0f);
+        out.workplaneToWorld[0] = glm::vec4(grid.uAxis, 0.0f);
+        out.workplaneToWorld[1] = glm::vec4(grid.vAxis, 0.0f);
+        out.workplaneToWorld[2] = glm::vec4(glm::cross(grid.uAxis, grid.vAxis), 0.0f);
+        out.workplaneToWorld[3] = glm::vec4(grid.origin, 1.0f);
+        out.workplaneGridSpacing = grid.spacing;
+        out.workplaneGridLines = grid.lineCount;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "core/rendering/RenderScene.h"
+#include "ports/IRendererPort.h"
+
+namespace core::rendering
+{
+    // Color as ports::PackRgba, each channel clamped to [0, 1].
+    std::uint32_t PackColor(const Color& color);
+
+    // Turns the retained RenderScene of a SketchRenderBuilder into the packed
+    // ports::RenderScene the renderers share: one vertex arena with RGBA8
+    // colours, 32-bit selection ids, and draw ranges that batch points and
+    // lines of the same width and style, each polyline a strip of its own.
+    // Circles, arcs and ellipses become CurveInstances for the backends to
+    // generate on the GPU.
+    //
+    // update() packs a new snapshot only when the scene delta is non-empty,
+    // and hands back the previous one otherwise, so publishing the scene
+    // every frame costs nothing while it is unchanged. Of a changed scene it
+    // repacks the arena only if points, lines or polylines changed, and only
+    // the curve instances the delta marks (listed in changedCurves) as long
+    // as no curve array changed size. The storage of a snapshot no renderer
+    // holds any more is handed back by its deleter, on whichever thread let
+    // go of it last, and reused for the next one; the parts that did not
+    // change are copied into it from the previous snapshot.
+    class ScenePacker
+    {
+    public:
+        ports::RenderSceneSnapshot update(const RenderScene& scene, const SceneDelta& delta);
+
+        // The last snapshot packed, null before the first update().
+        const ports::RenderSceneSnapshot& snapshot() const { return m_snapshot; }
+
+        // Packs `scene` into `out` from scratch. Entity ids are narrowed to
+        // 32 bits; sketch entity ids are per-document counters.
+        static void Pack(const RenderScene& scene, ports::RenderScene& out);
+
+    private:
+        // Storage of released snapshots. Snapshots hold it weakly, so one that
+        // outlives the packer is simply freed.
+        struct Pool
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ports::RenderScene>> free;
+        };
+
+        std::shared_ptr<Pool> m_pool{ std::make_shared<Pool>() };
+        ports::RenderSceneSnapshot m_snapshot;
+        std::uint64_t m_revision{ 0 };
+        std::size_t m_counts[kPrimitiveKindCount]{}; // array sizes of the last packed scene
+
+        static void PackVertices(const RenderScene& scene, ports::RenderScene& out);
+        static void PackWorkplane(const RenderScene& scene, ports::RenderScene& out);
+        // Curve instance `index` of the concatenated circles, arcs and ellipses.
+        static ports::CurveInstance PackCurve(const RenderScene& scene, std::size_t index);
+
+        // A scene to pack into, recycled if one is free; returns to the pool
+        // once the last snapshot sharing it is gone.
+        std::shared_ptr<ports::RenderScene> acquire();
+    };
+}
@@ -1,5 +1,7 @@
 #include "core/rendering/SketchRenderBuilder.h"
 
+#include <algorithm>
+
 namespace
 {
     static inline glm::vec3 ToWorld(float x, float y, float z)
@@ -11,134 +13,357 @@ namespace
     {
         return static_cast<core::rendering::RenderId>(id);
     }
+
+    static inline core::rendering::Color EntityColor(
+        const domain::sketch::HeaderColumns& h,
+        std::size_t i,
+        const core::rendering::Color& normal,
+        const core::rendering::SketchRenderOptions& opt)
+    {
+        if (h.construction(i)) return opt.constructionColor;
+        if (opt.analysis)
+        {
+            if (opt.analysis->isOverConstrained(h.ids[i])) return opt.overConstrainedColor;
+            if (opt.analysis->dof(h.ids[i]) == 0) return opt.fullyConstrainedColor;
+        }
+        return normal;
+    }
+
+    static inline bool SameColor(const core::rendering::Color& a, const core::rendering::Color& b)
+    {
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+    }
+
+    // Whether two option sets draw every entity the same way.
+    static bool SameLook(const core::rendering::SketchRenderOptions& a, const core::rendering::SketchRenderOptions& b)
+    {
+        return a.z == b.z
+            && SameColor(a.entityColor, b.entityColor)
+            && SameColor(a.constructionColor, b.constructionColor)
+            && SameColor(a.pointColor, b.pointColor)
+            && a.analysis == b.analysis
+            && SameColor(a.fullyConstrainedColor, b.fullyConstrainedColor)
+            && SameColor(a.overConstrainedColor, b.overConstrainedColor)
+            && a.lineThickness == b.lineThickness
+            && a.pointSize == b.pointSize
+            && a.curveTolerance == b.curveTolerance
+            && a.curveCache == b.curveCache;
+    }
+
+    static inline core::rendering::PrimitiveKind PrimitiveOf(domain::sketch::EntityKind kind)
+    {
+        using domain::sketch::EntityKind;
+        using core::rendering::PrimitiveKind;
+        switch (kind)
+        {
+        case EntityKind::Point:   return PrimitiveKind::Point;
+        case EntityKind::Line:    return PrimitiveKind::Line;
+        case EntityKind::Circle:  return PrimitiveKind::Circle;
+        case EntityKind::Arc:     return PrimitiveKind::Arc;
+        case EntityKind::Ellipse: return PrimitiveKind::Ellipse;
+        case EntityKind::Curve:   return PrimitiveKind::Polyline;
+        }
+        return PrimitiveKind::Point;
+    }
+
+    // Calls f with the scene's array of the given kind.
+    template <class F>
+    static void WithArray(core::rendering::RenderScene& scene, core::rendering::PrimitiveKind kind, F&& f)
+    {
+        using core::rendering::PrimitiveKind;
+        switch (kind)
+        {
+        case PrimitiveKind::Point:    f(scene.points); break;
+        case PrimitiveKind::Line:     f(scene.lines); break;
+        case PrimitiveKind::Polyline: f(scene.polylines); break;
+        case PrimitiveKind::Circle:   f(scene.circles); break;
+        case PrimitiveKind::Arc:      f(scene.arcs); break;
+        case PrimitiveKind::Ellipse:  f(scene.ellipses); break;
+        }
+    }
 }
 
 namespace core::rendering
 {
-    RenderScene BuildRenderSceneFromSketch(const domain::sketch::Sketch& sketch, const SketchRenderOptions& opt)
-    {
-        RenderScene scene;
-        scene.Clear();
 
-        // Grid on XY plane
-        scene.grid.origin = { 0,0,opt.z };
-        scene.grid.uAxis = { 1,0,0 };
-        scene.grid.vAxis = { 0,1,0 };
-        scene.grid.spacing = 10.0f;
-        scene.grid.lineCount = 40;
-        scene.showGrid = true;
+    const RenderScene& SketchRenderBuilder::update(const domain::sketch::Sketch& sketch, const SketchRenderOptions& opt)
+    {
+        using domain::sketch::EntityKind;
 
         const auto& store = sketch.entities;
+        const std::uint64_t analysisRevision = opt.analysis ? opt.analysis->revision() : 0;
 
-        // --- Points ---
-        for (auto const& p : store.points())
-        {
-            if (!p.h.visible) continue;
+        m_delta.clear();
+        bool full = !m_built || &store != m_store || !SameLook(opt, m_options) || analysisRevision != m_analysisRevision;
+        if (!full && store.version() == m_version)
+            return m_scene;
 
-            Point3D pt;
-            pt.id = ToRenderId(p.h.id);
-            pt.p = ToWorld((float)p.p.x, (float)p.p.y, opt.z);
-            pt.size = opt.pointSize;
-            pt.color = opt.pointColor;
-            pt.selectable = p.h.selectable;
-            scene.points.push_back(pt);
-        }
+        std::vector<domain::sketch::EntityId> removed;
+        if (!full && !store.removedSince(m_version, removed))
+            full = true;
 
-        // --- Lines ---
-        for (auto const& l : store.lines())
+        auto& curves = opt.curveCache ? *opt.curveCache : m_curveCache;
+        if (full)
         {
-            if (!l.h.visible) continue;
+            rebuild(store, opt);
+            m_delta.full = true;
+            if (curves.size() > store.curves().size())
+                curves.prune(store);
+        }
+        else
+        {
+            // Removals first: an id removed and added again is placed afresh below.
+            for (auto id : removed)
+            {
+                erase(ToRenderId(id));
+                curves.erase(id);
+            }
 
-            Line3D ln;
-            ln.id = ToRenderId(l.h.id);
-            ln.a = ToWorld((float)l.a.x, (float)l.a.y, opt.z);
-            ln.b = ToWorld((float)l.b.x, (float)l.b.y, opt.z);
-            ln.thickness = opt.lineThickness;
-            ln.color = l.h.construction ? opt.constructionColor : opt.entityColor;
-            ln.selectable = l.h.selectable;
-            scene.lines.push_back(ln);
+            for (std::size_t k = 0; k < domain::sketch::kEntityKindCount; ++k)
+            {
+                const auto kind = static_cast<EntityKind>(k);
+                const auto& versions = store.headers(kind).versions;
+                for (std::size_t i = 0; i < versions.size(); ++i)
+                {
+                    if (versions[i] > m_version)
+                        place(store, kind, static_cast<std::uint32_t>(i), opt);
+                }
+            }
+            collectRanges();
         }
 
-        // --- Circles (TRUE) ---
-        for (auto const& c : store.circles())
+        m_built = true;
+        m_store = &store;
+        m_version = store.version();
+        m_options = opt;
+        m_analysisRevision = analysisRevision;
+        return m_scene;
+    }
+
+    void SketchRenderBuilder::rebuild(const domain::sketch::EntityStore& store, const SketchRenderOptions& opt)
+    {
+        using domain::sketch::EntityKind;
+
+        m_scene.Clear();
+        m_slots.clear();
+        for (auto& d : m_dirty) d.clear();
+
+        // Grid on XY plane
+        m_scene.grid.origin = { 0,0,opt.z };
+        m_scene.grid.uAxis = { 1,0,0 };
+        m_scene.grid.vAxis = { 0,1,0 };
+        m_scene.grid.spacing = 10.0f;
+        m_scene.grid.lineCount = 40;
+        m_scene.showGrid = true;
+
+        m_scene.points.reserve(store.points().size());
+        m_scene.lines.reserve(store.lines().size());
+        m_scene.circles.reserve(store.circles().size());
+        m_scene.arcs.reserve(store.arcs().size());
+        m_scene.ellipses.reserve(store.ellipses().size());
+        m_slots.reserve(store.size());
+
+        for (std::size_t k = 0; k < domain::sketch::kEntityKindCount; ++k)
         {
-            if (!c.h.visible) continue;
+            const auto kind = static_cast<EntityKind>(k);
+            const auto n = static_cast<std::uint32_t>(store.count(kind));
+            for (std::uint32_t i = 0; i < n; ++i)
+                place(store, kind, i, opt);
+        }
+        for (auto& d : m_dirty) d.clear();
+    }
+
+    void SketchRenderBuilder::place(const domain::sketch::EntityStore& store, domain::sketch::EntityKind kind,
+        std::uint32_t i, const SketchRenderOptions& opt)
+    {
+        using domain::sketch::EntityKind;
 
-            Circle3D cc;
-            cc.id = ToRenderId(c.h.id);
-            cc.center = ToWorld((float)c.center.x, (float)c.center.y, opt.z);
-            cc.normal = { 0,0,1 };
-            cc.radius = (float)c.radius;
-            cc.thickness = opt.lineThickness;
-            cc.construction = c.h.construction;
-            cc.color = c.h.construction ? opt.constructionColor : opt.entityColor;
-            cc.selectable = c.h.selectable;
+        const auto& h = store.headers(kind);
+        const RenderId id = ToRenderId(h.ids[i]);
+        const PrimitiveKind pk = PrimitiveOf(kind);
 
-            scene.circles.push_back(cc);
+        auto it = m_slots.find(id);
+        if (it != m_slots.end() && (it->second.kind != pk || !h.visible(i)))
+        {
+            erase(id);
+            it = m_slots.end();
         }
+        if (!h.visible(i))
+            return;
 
-        // --- Arcs (TRUE) ---
-        for (auto const& a : store.arcs())
+        // Writes the primitive over the entity's old one, or appends it.
+        auto put = [&](auto& array, auto&& primitive)
         {
-            if (!a.h.visible) continue;
+            std::uint32_t index;
+            if (it != m_slots.end())
+            {
+                index = it->second.index;
+                array[index] = std::move(primitive);
+            }
+            else
+            {
+                index = static_cast<std::uint32_t>(array.size());
+                array.push_back(std::move(primitive));
+                m_slots.emplace(id, Slot{ pk, index });
+            }
+            m_dirty[static_cast<std::size_t>(pk)].push_back(index);
+        };
 
+        switch (kind)
+        {
+        case EntityKind::Point:
+        {
+            const auto& pc = store.points();
+            Point3D pt;
+            pt.id = id;
+            pt.p = ToWorld((float)pc.x[i], (float)pc.y[i], opt.z);
+            pt.size = opt.pointSize;
+            pt.color = EntityColor(h, i, opt.pointColor, opt);
+            pt.selectable = h.selectable(i);
+            put(m_scene.points, pt);
+            break;
+        }
+        case EntityKind::Line:
+        {
+            const auto& lc = store.lines();
+            Line3D ln;
+            ln.id = id;
+            ln.a = ToWorld((float)lc.ax[i], (float)lc.ay[i], opt.z);
+            ln.b = ToWorld((float)lc.bx[i], (float)lc.by[i], opt.z);
+            ln.thickness = opt.lineThickness;
+            ln.color = EntityColor(h, i, opt.entityColor, opt);
+            ln.selectable = h.selectable(i);
+            ln.construction = h.construction(i);
+            put(m_scene.lines, ln);
+            break;
+        }
+        case EntityKind::Circle:
+        {
+            const auto& cc = store.circles();
+            Circle3D c;
+            c.id = id;
+            c.center = ToWorld((float)cc.cx[i], (float)cc.cy[i], opt.z);
+            c.normal = { 0,0,1 };
+            c.radius = (float)cc.r[i];
+            c.thickness = opt.lineThickness;
+            c.construction = h.construction(i);
+            c.color = EntityColor(h, i, opt.entityColor, opt);
+            c.selectable = h.selectable(i);
+            put(m_scene.circles, c);
+            break;
+        }
+        case EntityKind::Arc:
+        {
+            const auto& ac = store.arcs();
             Arc3D ar;
-            ar.id = ToRenderId(a.h.id);
-            ar.center = ToWorld((float)a.center.x, (float)a.center.y, opt.z);
+            ar.id = id;
+            ar.center = ToWorld((float)ac.cx[i], (float)ac.cy[i], opt.z);
             ar.normal = { 0,0,1 };
-            ar.radius = (float)a.radius;
-            ar.start = ToWorld((float)a.start.x, (float)a.start.y, opt.z);
-            ar.end = ToWorld((float)a.end.x, (float)a.end.y, opt.z);
-            ar.ccw = a.ccw;
+            ar.radius = (float)ac.r[i];
+            ar.start = ToWorld((float)ac.sx[i], (float)ac.sy[i], opt.z);
+            ar.end = ToWorld((float)ac.ex[i], (float)ac.ey[i], opt.z);
+            ar.ccw = ac.ccw[i] != 0;
             ar.thickness = opt.lineThickness;
-            ar.construction = a.h.construction;
-            ar.color = a.h.construction ? opt.constructionColor : opt.entityColor;
-            ar.selectable = a.h.selectable;
-
-            scene.arcs.push_back(ar);
+            ar.construction = h.construction(i);
+            ar.color = EntityColor(h, i, opt.entityColor, opt);
+            ar.selectable = h.selectable(i);
+            put(m_scene.arcs, ar);
+            break;
         }
-
-        // --- Ellipses (TRUE) ---
-        for (auto const& e : store.ellipses())
+        case EntityKind::Ellipse:
         {
-            if (!e.h.visible) continue;
-
+            const auto& ec = store.ellipses();
             Ellipse3D el;
-            el.id = ToRenderId(e.h.id);
-            el.center = ToWorld((float)e.center.x, (float)e.center.y, opt.z);
+            el.id = id;
+            el.center = ToWorld((float)ec.cx[i], (float)ec.cy[i], opt.z);
             el.normal = { 0,0,1 };
-            el.rx = (float)e.rx;
-            el.ry = (float)e.ry;
-            el.rotationRad = (float)e.rotation; // assumes your entity stores radians
+            el.rx = (float)ec.rx[i];
+            el.ry = (float)ec.ry[i];
+            el.rotationRad = (float)ec.rotation[i]; // assumes your entity stores radians
             el.thickness = opt.lineThickness;
-            el.construction = e.h.construction;
-            el.color = e.h.construction ? opt.constructionColor : opt.entityColor;
-            el.selectable = e.h.selectable;
-
-            scene.ellipses.push_back(el);
+            el.construction = h.construction(i);
+            el.color = EntityColor(h, i, opt.entityColor, opt);
+            el.selectable = h.selectable(i);
+            put(m_scene.ellipses, el);
+            break;
         }
-
-        // --- Curves (TEMP: polyline from control points) ---
-        for (auto const& cv : store.curves())
+        case EntityKind::Curve:
         {
-            if (!cv.h.visible) continue;
-            if (cv.controlPoints.size() < 2) continue;
+            if (store.curves().controlPoints[i].size() < 2)
+            {
+                if (it != m_slots.end()) erase(id);
+                break;
+            }
+
+            auto& cache = opt.curveCache ? *opt.curveCache : m_curveCache;
+            cache.setTolerance(opt.curveTolerance);
+            const auto& flat = cache.get(store, i);
 
             Polyline3D pl;
-            pl.id = ToRenderId(cv.h.id);
-            pl.color = cv.h.construction ? opt.constructionColor : opt.entityColor;
+            pl.id = id;
+            pl.color = EntityColor(h, i, opt.entityColor, opt);
             pl.thickness = opt.lineThickness;
-
-            pl.points.reserve(cv.controlPoints.size() + (cv.closed ? 1 : 0));
-            for (auto const& p : cv.controlPoints)
+            pl.selectable = h.selectable(i);
+            pl.construction = h.construction(i);
+            pl.points.reserve(flat.size());
+            for (auto const& p : flat)
                 pl.points.push_back(ToWorld((float)p.x, (float)p.y, opt.z));
+            put(m_scene.polylines, std::move(pl));
+            break;
+        }
+        }
+    }
 
-            if (cv.closed)
-                pl.points.push_back(pl.points.front());
+    void SketchRenderBuilder::erase(RenderId id)
+    {
+        auto it = m_slots.find(id);
+        if (it == m_slots.end())
+            return;
 
-            scene.polylines.push_back(std::move(pl));
+        const Slot slot = it->second;
+        m_slots.erase(it);
+        WithArray(m_scene, slot.kind, [&](auto& array)
+        {
+            // Swap-and-pop; the moved primitive's entity now lives at the gap.
+            const auto last = static_cast<std::uint32_t>(array.size() - 1);
+            if (slot.index != last)
+            {
+                array[slot.index] = std::move(array[last]);
+                m_slots[array[slot.index].id].index = slot.index;
+                m_dirty[static_cast<std::size_t>(slot.kind)].push_back(slot.index);
+            }
+            array.pop_back();
+        });
+        // The array shrank; when the last primitive went, no element changed.
+        m_delta.resized = true;
+    }
+
+    void SketchRenderBuilder::collectRanges()
+    {
+        for (std::size_t k = 0; k < kPrimitiveKindCount; ++k)
+        {
+            auto& dirty = m_dirty[k];
+            std::size_t size = 0;
+            WithArray(m_scene, static_cast<PrimitiveKind>(k), [&size](auto& array) { size = array.size(); });
+
+            std::sort(dirty.begin(), dirty.end());
+            dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+            for (std::size_t i = 0; i < dirty.size();)
+            {
+                // Indices past the end were swapped away again by a later removal.
+                if (dirty[i] >= size) break;
+                std::size_t j = i + 1;
+                while (j < dirty.size() && dirty[j] == dirty[j - 1] + 1 && dirty[j] < size) ++j;
+                m_delta.ranges.push_back({ static_cast<PrimitiveKind>(k), dirty[i], static_cast<std::uint32_t>(j - i) });
+                i = j;
+            }
+            dirty.clear();
         }
+    }
 
-        return scene;
+    RenderScene BuildRenderSceneFromSketch(const domain::sketch::Sketch& sketch, const SketchRenderOptions& opt)
+    {
+        SketchRenderBuilder builder;
+        return builder.update(sketch, opt);
     }
 }
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 #include "core/rendering/RenderScene.h"
 #include "domain/SketchModel.h"
+#include "domain/SketchSpline.h"
+#include "domain/solver/DofAnalyzer.h"
 
 namespace core::rendering
 {
@@ -13,10 +19,68 @@ namespace core::rendering
         Color constructionColor{ 0.3f, 0.3f, 0.6f, 0.6f };
         Color pointColor{ 0.9f, 0.9f, 0.9f, 1.0f };
 
+        // Optional constraint-state colouring (fully / over-constrained entities).
+        const domain::solver::DofAnalyzer* analysis = nullptr;
+        Color fullyConstrainedColor{ 0.1f, 0.75f, 0.2f, 1.0f };
+        Color overConstrainedColor{ 0.9f, 0.15f, 0.1f, 1.0f };
+
         float lineThickness = 2.0f;
         float pointSize = 6.0f;
+
+        // Curves are flattened to within curveTolerance (world units). With a
+        // cache, only curves that changed since the last build are flattened again.
+        double curveTolerance = 1e-2;
+        domain::sketch::CurveTessellationCache* curveCache = nullptr;
+    };
+
+    // Keeps a RenderScene in step with a sketch across frames.
+    //
+    // update() compares the store's version with the one it last saw: an
+    // unchanged sketch costs nothing, otherwise only the primitives of
+    // entities changed or removed since are rewritten (removal swaps the last
+    // primitive into the gap). delta() lists the touched elements as ranges,
+    // so a renderer can copy just those (see ApplySceneDelta). A different
+    // store, different options or a new constraint analysis rebuild the
+    // whole scene.
+    class SketchRenderBuilder
+    {
+    public:
+        const RenderScene& update(const domain::sketch::Sketch& sketch, const SketchRenderOptions& opt = {});
+
+        const RenderScene& scene() const { return m_scene; }
+        // Changes made by the last update().
+        const SceneDelta& delta() const { return m_delta; }
+
+        // Forces the next update() to rebuild everything.
+        void invalidate() { m_built = false; }
+
+    private:
+        struct Slot
+        {
+            PrimitiveKind kind{ PrimitiveKind::Point };
+            std::uint32_t index{ 0 };
+        };
+
+        RenderScene m_scene;
+        SceneDelta m_delta;
+        std::unordered_map<RenderId, Slot> m_slots; // entity -> its primitive
+        std::vector<std::uint32_t> m_dirty[kPrimitiveKindCount];
+
+        bool m_built{ false };
+        const domain::sketch::EntityStore* m_store{ nullptr };
+        std::uint64_t m_version{ 0 };
+        SketchRenderOptions m_options;
+        std::uint64_t m_analysisRevision{ 0 };
+        domain::sketch::CurveTessellationCache m_curveCache;
+
+        void rebuild(const domain::sketch::EntityStore& store, const SketchRenderOptions& opt);
+        void place(const domain::sketch::EntityStore& store, domain::sketch::EntityKind kind, std::uint32_t i,
+            const SketchRenderOptions& opt);
+        void erase(RenderId id);
+        void collectRanges();
     };
 
+    // One-off build of a sketch's scene.
     RenderScene BuildRenderSceneFromSketch(
         const domain::sketch::Sketch& sketch,
         const SketchRenderOptions& opt = {}
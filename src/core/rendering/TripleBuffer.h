@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace core::rendering
+{
+    // Hands the latest of a stream of values from one producer thread to
+    // one consumer thread without locks or waiting on either side.
+    //
+    // Three slots: the producer fills back() and publish()es it, swapping
+    // it with the middle slot; the consumer update()s, swapping the middle
+    // slot with front() if something was published since. Values published
+    // in between are overwritten, so the consumer only ever sees the newest.
+    // A slot comes back to the producer with its old contents, which lets
+    // it reuse their storage. Slots are never shared, so front() is stable
+    // until the next update() and back() private until publish().
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+        // Producer.
+        T& back() { return m_slots[m_back]; }
+        void publish()
+        {
+            m_back = m_middle.exchange(static_cast<std::uint8_t>(m_back | kFresh), std::memory_order_acq_rel) & kIndex;
+        }
+
+        // Consumer. Whether update() would change front().
+        bool fresh() const { return (m_middle.load(std::memory_order_acquire) & kFresh) != 0; }
+
+        // Consumer. True if front() changed.
+        bool update()
+        {
+            if (!fresh()) return false;
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & kIndex;
+            return true;
+        }
+        T& front() { return m_slots[m_front]; }
+        const T& front() const { return m_slots[m_front]; }
+
+    private:
+        static constexpr std::uint8_t kIndex = 0x3;
+        static constexpr std::uint8_t kFresh = 0x4; // middle slot published, not yet taken
+
+        T m_slots[3]{};
+        std::uint8_t m_back{ 0 };
+        std::atomic<std::uint8_t> m_middle{ 1 };
+        std::uint8_t m_front{ 2 };
+    };
+}
@@ -0,0 +1,451 @@
+#include "core/tasks/TaskScheduler.h"
+
+#include <algorithm>
+
+namespace core::tasks
+{
+    struct Task
+    {
+        std::string name;
+        TaskPriority priority{ TaskPriority::Normal };
+        CancellationToken token;
+        TaskScheduler::Job job;                // released once run
+
+        std::atomic<TaskState> state{ TaskState::Pending };
+        std::atomic<float> progress{ 0.0f };
+        std::atomic<std::size_t> blockers{ 1 }; // unfinished dependencies, plus the submission
+        std::atomic<bool> dependencyFailed{ false };
+
+        mutable std::mutex mutex;             // guards the rest
+        std::string message;
+        std::string error;
+        std::vector<std::shared_ptr<Task>> dependents;
+    };
+
+    static bool IsDone(TaskState state)
+    {
+        return state == TaskState::Completed || state == TaskState::Failed || state == TaskState::Cancelled;
+    }
+
+    // The worker running on this thread, if any.
+    static thread_local const TaskScheduler* t_scheduler = nullptr;
+    static thread_local unsigned t_slot = 0;
+
+    // ---- TaskContext ----
+
+    bool TaskContext::cancelled() const
+    {
+        return m_task.token.cancelled();
+    }
+
+    void TaskContext::throwIfCancelled() const
+    {
+        if (m_task.token.cancelled())
+            throw TaskCancelled();
+    }
+
+    void TaskContext::setProgress(float fraction, const std::string& message)
+    {
+        m_task.progress.store(std::clamp(fraction, 0.0f, 1.0f), std::memory_order_relaxed);
+        if (!message.empty())
+        {
+            std::lock_guard<std::mutex> lock(m_task.mutex);
+            m_task.message = message;
+        }
+        m_scheduler.notifyChange();
+    }
+
+    // ---- TaskHandle ----
+
+    const std::string& TaskHandle::name() const
+    {
+        static const std::string none;
+        return m_task ? m_task->name : none;
+    }
+
+    TaskState TaskHandle::state() const
+    {
+        return m_task ? m_task->state.load(std::memory_order_acquire) : TaskState::Cancelled;
+    }
+
+    bool TaskHandle::done() const
+    {
+        return IsDone(state());
+    }
+
+    float TaskHandle::progress() const
+    {
+        return m_task ? m_task->progress.load(std::memory_order_relaxed) : 0.0f;
+    }
+
+    std::string TaskHandle::message() const
+    {
+        if (!m_task) return {};
+        std::lock_guard<std::mutex> lock(m_task->mutex);
+        return m_task->message;
+    }
+
+    std::string TaskHandle::error() const
+    {
+        if (!m_task) return {};
+        std::lock_guard<std::mutex> lock(m_task->mutex);
+        return m_task->error;
+    }
+
+    void TaskHandle::cancel() const
+    {
+        if (m_task) m_task->token.cancel();
+    }
+
+    // ---- TaskScheduler ----
+
+    TaskScheduler::TaskScheduler(unsigned threadCount)
+    {
+        if (threadCount == 0)
+            threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+        m_workers.reserve(threadCount);
+        for (unsigned i = 0; i < threadCount; ++i)
+            m_workers.push_back(std::make_unique<Worker>());
+
+        m_threads.reserve(threadCount);
+        for (unsigned i = 0; i < threadCount; ++i)
+            m_threads.emplace_back(&TaskScheduler::workerLoop, this, i);
+    }
+
+    TaskScheduler::~TaskScheduler()
+    {
+        cancelAll();
+        waitIdle();
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& t : m_threads)
+        {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    TaskHandle TaskScheduler::submit(TaskOptions options, Job job)
+    {
+        auto task = std::make_shared<Task>();
+        task->name = std::move(options.name);
+        task->priority = options.priority;
+        task->token = std::move(options.token);
+        task->job = std::move(job);
+        {
+            std::lock_guard<std::mutex> lock(m_activeMutex);
+            m_active.push_back(task);
+        }
+
+        for (const TaskHandle& dependency : options.dependencies)
+        {
+            if (!dependency.m_task) continue;
+            Task& d = *dependency.m_task;
+            std::lock_guard<std::mutex> lock(d.mutex);
+            // finish() sets the state under this lock before it takes the
+            // dependents, so a dependency is either done or will release us.
+            const TaskState state = d.state.load(std::memory_order_acquire);
+            if (!IsDone(state))
+            {
+                task->blockers.fetch_add(1, std::memory_order_relaxed);
+                d.dependents.push_back(task);
+            }
+            else if (state != TaskState::Completed)
+            {
+                task->dependencyFailed.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        release(task);
+        return TaskHandle(std::move(task));
+    }
+
+    void TaskScheduler::release(const std::shared_ptr<Task>& task)
+    {
+        if (task->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            enqueue(task);
+    }
+
+    void TaskScheduler::enqueue(std::shared_ptr<Task> task)
+    {
+        // Own deque on a worker, where it is likely to run next; dealt
+        // round-robin otherwise.
+        const unsigned n = workerCount();
+        unsigned slot = currentSlot();
+        if (slot == n)
+            slot = m_nextWorker.fetch_add(1, std::memory_order_relaxed) % n;
+
+        Worker& w = *m_workers[slot];
+        {
+            std::lock_guard<std::mutex> lock(w.mutex);
+            w.tasks[static_cast<std::size_t>(task->priority)].push_back(std::move(task));
+        }
+        m_queued.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+        }
+        m_wake.notify_one();
+        // Someone helping in wait() sleeps on m_done.
+        m_done.notify_all();
+    }
+
+    bool TaskScheduler::tryPop(unsigned slot, std::shared_ptr<Task>& out)
+    {
+        const unsigned n = workerCount();
+
+        // Priority by priority: own deque first, newest task; then the oldest
+        // task of someone else.
+        for (std::size_t p = 0; p < kPriorityCount; ++p)
+        {
+            if (slot < n)
+            {
+                Worker& own = *m_workers[slot];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (!own.tasks[p].empty())
+                {
+                    out = std::move(own.tasks[p].back());
+                    own.tasks[p].pop_back();
+                    m_queued.fetch_sub(1);
+                    return true;
+                }
+            }
+
+            for (unsigned k = 1; k <= n; ++k)
+            {
+                const unsigned victim = (slot + k) % n;
+                if (victim == slot) continue;
+                Worker& w = *m_workers[victim];
+                std::lock_guard<std::mutex> lock(w.mutex);
+                if (!w.tasks[p].empty())
+                {
+                    out = std::move(w.tasks[p].front());
+                    w.tasks[p].pop_front();
+                    m_queued.fetch_sub(1);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void TaskScheduler::run(const std::shared_ptr<Task>& task)
+    {
+        Job job = std::move(task->job);
+        task->job = nullptr;
+
+        if (task->dependencyFailed.load(std::memory_order_relaxed) || task->token.cancelled())
+        {
+            finish(task, TaskState::Cancelled);
+            return;
+        }
+
+        task->state.store(TaskState::Running, std::memory_order_release);
+        TaskState state = TaskState::Completed;
+        try
+        {
+            TaskContext context(*task, *this);
+            job(context);
+        }
+        catch (const TaskCancelled&)
+        {
+            state = TaskState::Cancelled;
+        }
+        catch (const std::exception& e)
+        {
+            std::lock_guard<std::mutex> lock(task->mutex);
+            task->error = e.what();
+            state = TaskState::Failed;
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(task->mutex);
+            task->error = "unknown error";
+            state = TaskState::Failed;
+        }
+
+        // Its captures may hold the last reference to large data.
+        job = nullptr;
+        finish(task, state);
+    }
+
+    void TaskScheduler::finish(const std::shared_ptr<Task>& task, TaskState state)
+    {
+        if (state == TaskState::Completed)
+            task->progress.store(1.0f, std::memory_order_relaxed);
+
+        std::vector<std::shared_ptr<Task>> dependents;
+        {
+            std::lock_guard<std::mutex> lock(task->mutex);
+            task->state.store(state, std::memory_order_release);
+            dependents.swap(task->dependents);
+        }
+        for (const auto& dependent : dependents)
+        {
+            if (state != TaskState::Completed)
+                dependent->dependencyFailed.store(true, std::memory_order_relaxed);
+            release(dependent);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_activeMutex);
+            auto it = std::find(m_active.begin(), m_active.end(), task);
+            if (it != m_active.end())
+            {
+                *it = std::move(m_active.back());
+                m_active.pop_back();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+        }
+        m_done.notify_all();
+        notifyChange();
+    }
+
+    void TaskScheduler::workerLoop(unsigned slot)
+    {
+        t_scheduler = this;
+        t_slot = slot;
+
+        for (;;)
+        {
+            std::shared_ptr<Task> task;
+            if (tryPop(slot, task))
+            {
+                run(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wake.wait(lock, [&] { return m_stop || m_queued.load() > 0; });
+            if (m_stop && m_queued.load() == 0) return;
+        }
+    }
+
+    void TaskScheduler::wait(const TaskHandle& handle)
+    {
+        if (!handle.m_task) return;
+        const Task& task = *handle.m_task;
+        auto done = [&task] { return IsDone(task.state.load(std::memory_order_acquire)); };
+
+        // Other threads just block: running some unrelated load on the
+        // caller would only make it wait longer.
+        const unsigned slot = currentSlot();
+        if (slot == workerCount())
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_done.wait(lock, done);
+            return;
+        }
+
+        while (!done())
+        {
+            std::shared_ptr<Task> next;
+            if (tryPop(slot, next))
+            {
+                run(next);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_done.wait(lock, [&] { return done() || m_queued.load() > 0; });
+        }
+    }
+
+    void TaskScheduler::parallelFor(std::size_t count, std::size_t grain,
+        const std::function<void(std::size_t, unsigned)>& fn)
+    {
+        if (count == 0) return;
+        grain = (std::max<std::size_t>)(grain, 1);
+
+        const unsigned n = workerCount();
+        const unsigned slot = currentSlot();
+        if (count <= grain)
+        {
+            for (std::size_t i = 0; i < count; ++i) fn(i, slot);
+            return;
+        }
+
+        // Slot n is shared by every thread that is not a worker.
+        std::unique_lock<std::mutex> callerLock(m_callerMutex, std::defer_lock);
+        if (slot == n) callerLock.lock();
+
+        // Helpers may start after the loop has returned, so they share this
+        // by reference count and touch fn only for a chunk they claimed,
+        // which the caller is still waiting for.
+        struct Loop
+        {
+            const std::function<void(std::size_t, unsigned)>* fn{ nullptr };
+            std::size_t count{ 0 };
+            std::size_t grain{ 0 };
+            std::size_t chunks{ 0 };
+            std::atomic<std::size_t> next{ 0 };
+            std::atomic<std::size_t> remaining{ 0 };
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+        auto loop = std::make_shared<Loop>();
+        loop->fn = &fn;
+        loop->count = count;
+        loop->grain = grain;
+        loop->chunks = (count + grain - 1) / grain;
+        loop->remaining.store(loop->chunks);
+
+        auto work = [](Loop& l, unsigned s)
+        {
+            for (std::size_t c = l.next.fetch_add(1); c < l.chunks; c = l.next.fetch_add(1))
+            {
+                const std::size_t end = (std::min)(l.count, (c + 1) * l.grain);
+                for (std::size_t i = c * l.grain; i < end; ++i) (*l.fn)(i, s);
+                if (l.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    std::lock_guard<std::mutex> lock(l.mutex);
+                    l.done.notify_all();
+                }
+            }
+        };
+
+        // The caller takes a chunk as well, so one helper fewer.
+        const std::size_t helpers = (std::min<std::size_t>)(n, loop->chunks - 1);
+        for (std::size_t h = 0; h < helpers; ++h)
+        {
+            TaskOptions options;
+            options.name = "Parallel loop";
+            options.priority = TaskPriority::High;
+            submit(std::move(options), [this, loop, work](TaskContext&) { work(*loop, currentSlot()); });
+        }
+
+        work(*loop, slot);
+        std::unique_lock<std::mutex> lock(loop->mutex);
+        loop->done.wait(lock, [&] { return loop->remaining.load(std::memory_order_acquire) == 0; });
+    }
+
+    void TaskScheduler::cancelAll()
+    {
+        std::lock_guard<std::mutex> lock(m_activeMutex);
+        for (const auto& task : m_active)
+            task->token.cancel();
+    }
+
+    void TaskScheduler::waitIdle()
+    {
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_done.wait(lock, [this] {
+            std::lock_guard<std::mutex> active(m_activeMutex);
+            return m_active.empty();
+        });
+    }
+
+    void TaskScheduler::notifyChange() const
+    {
+        if (m_onChange)
+            m_onChange();
+    }
+
+    unsigned TaskScheduler::currentSlot() const
+    {
+        return t_scheduler == this ? t_slot : workerCount();
+    }
+}
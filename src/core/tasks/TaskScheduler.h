@@ -0,0 +1,205 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace core::tasks
+{
+    // Highest first; the scheduler runs any queued task of a higher priority
+    // before one of a lower.
+    enum class TaskPriority : std::uint8_t
+    {
+        High,   // the user is waiting on it (solves)
+        Normal, // loads, exports, saves
+        Low,    // background work
+    };
+
+    enum class TaskState : std::uint8_t
+    {
+        Pending,   // waiting for dependencies or a worker
+        Running,
+        Completed,
+        Failed,    // the job threw
+        Cancelled, // cancelled, or a dependency did not complete
+    };
+
+    // Thrown by TaskContext::throwIfCancelled(); the task ends as Cancelled.
+    class TaskCancelled : public std::exception
+    {
+    public:
+        const char* what() const noexcept override { return "task cancelled"; }
+    };
+
+    // Shared cancellation flag. Copies refer to the same flag, so one token
+    // can cancel a group of tasks.
+    class CancellationToken
+    {
+    public:
+        CancellationToken() : m_flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+        void cancel() const { m_flag->store(true, std::memory_order_release); }
+        bool cancelled() const { return m_flag->load(std::memory_order_acquire); }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> m_flag;
+    };
+
+    struct Task;
+    class TaskScheduler;
+
+    // What a running job sees of its task.
+    class TaskContext
+    {
+    public:
+        // Cancellation is cooperative: long jobs check between steps.
+        bool cancelled() const;
+        void throwIfCancelled() const;
+
+        // fraction in [0, 1]; an empty message keeps the previous one.
+        void setProgress(float fraction, const std::string& message = {});
+
+    private:
+        friend class TaskScheduler;
+        TaskContext(Task& task, const TaskScheduler& scheduler) : m_task(task), m_scheduler(scheduler) {}
+
+        Task& m_task;
+        const TaskScheduler& m_scheduler;
+    };
+
+    // Refers to a submitted task; cheap to copy. A default-constructed handle
+    // refers to nothing.
+    class TaskHandle
+    {
+    public:
+        TaskHandle() = default;
+
+        bool valid() const { return m_task != nullptr; }
+        const std::string& name() const;
+        TaskState state() const;
+        // Completed, failed or cancelled.
+        bool done() const;
+        float progress() const;
+        std::string message() const;
+        // What the job threw, if it failed.
+        std::string error() const;
+
+        // Cancels the task's token: a pending task will not run, a running
+        // one sees it at its next check.
+        void cancel() const;
+
+    private:
+        friend class TaskScheduler;
+        explicit TaskHandle(std::shared_ptr<Task> task) : m_task(std::move(task)) {}
+
+        std::shared_ptr<Task> m_task;
+    };
+
+    struct TaskOptions
+    {
+        std::string name;
+        TaskPriority priority = TaskPriority::Normal;
+        // Runs once all of these are done; cancelled instead if any of them
+        // did not complete.
+        std::vector<TaskHandle> dependencies;
+        CancellationToken token;
+    };
+
+    // Work-stealing scheduler for the application's background jobs.
+    //
+    // Each worker has its own deques, one per priority, pops its newest task
+    // and steals the oldest from the others when it runs out. A job submitted
+    // from a worker goes to that worker's deque; one submitted from elsewhere
+    // is dealt round-robin. Tasks are independent jobs: each has a state,
+    // progress and a cancellation token, and may depend on others;
+    // parallelFor() runs one loop across the workers.
+    class TaskScheduler
+    {
+    public:
+        using Job = std::function<void(TaskContext&)>;
+
+        // threadCount == 0 uses std::thread::hardware_concurrency().
+        explicit TaskScheduler(unsigned threadCount = 0);
+        // Cancels everything and waits for running jobs to return.
+        ~TaskScheduler();
+
+        TaskScheduler(const TaskScheduler&) = delete;
+        TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+        // Called on a worker whenever a task reports progress or finishes.
+        // Install it before submitting.
+        void setOnChange(std::function<void()> onChange) { m_onChange = std::move(onChange); }
+
+        // Any thread, jobs included.
+        TaskHandle submit(TaskOptions options, Job job);
+
+        // Blocks until the task is done. A worker runs other tasks meanwhile,
+        // so jobs may wait on the tasks they submit.
+        void wait(const TaskHandle& task);
+
+        // Calls fn(index, slot) for every index in [0, count), in chunks of
+        // `grain` consecutive indices taken in order, and returns when all
+        // calls have. High-priority tasks help, and the caller takes chunks
+        // itself rather than waiting for a worker busy with a load, so the
+        // loop never waits for unrelated work. Calls running at the same time
+        // get different slots below slotCount(). Any thread; callers that are
+        // not workers take turns. fn must not throw.
+        void parallelFor(std::size_t count, std::size_t grain, const std::function<void(std::size_t, unsigned)>& fn);
+        unsigned slotCount() const { return workerCount() + 1; }
+
+        // Cancels every task not yet done.
+        void cancelAll();
+        // Blocks until no task is left; not from a job.
+        void waitIdle();
+
+        unsigned workerCount() const { return static_cast<unsigned>(m_workers.size()); }
+
+    private:
+        friend class TaskContext;
+        static constexpr std::size_t kPriorityCount = 3;
+
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<std::shared_ptr<Task>> tasks[kPriorityCount];
+        };
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::vector<std::thread> m_threads;
+        std::atomic<unsigned> m_nextWorker{ 0 };
+
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        std::atomic<std::size_t> m_queued{ 0 };
+        bool m_stop{ false };
+
+        std::mutex m_callerMutex;                     // parallelFor from outside
+
+        std::mutex m_activeMutex;
+        std::vector<std::shared_ptr<Task>> m_active; // submitted, not done
+
+        std::function<void()> m_onChange;
+
+        void workerLoop(unsigned slot);
+        void enqueue(std::shared_ptr<Task> task);
+        // Drops one blocker (a dependency, or the submission itself); the
+        // task is queued when none is left.
+        void release(const std::shared_ptr<Task>& task);
+        bool tryPop(unsigned slot, std::shared_ptr<Task>& out);
+        void run(const std::shared_ptr<Task>& task);
+        void finish(const std::shared_ptr<Task>& task, TaskState state);
+        void notifyChange() const;
+        // This thread's worker slot, or workerCount() if it is not one of ours.
+        unsigned currentSlot() const;
+    };
+}
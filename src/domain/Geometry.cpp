@@ -1,13 +1,22 @@
 ﻿#include "domain/Geometry.h"
 
+#include <cmath>
+
 namespace domain {
 
     void Geometry::addVertex(const Point3D& vertex) {
         m_vertices.push_back(vertex);
+        ++m_version;
     }
 
     void Geometry::addTriangle(const Triangle& triangle) {
         m_triangles.push_back(triangle);
+        ++m_version;
+    }
+
+    void Geometry::addNormal(const Normal3D& normal) {
+        m_normals.push_back(normal);
+        ++m_version;
     }
 
     const std::vector<Point3D>& Geometry::getVertices() const {
@@ -18,9 +27,55 @@ namespace domain {
         return m_triangles;
     }
 
+    const std::vector<Normal3D>& Geometry::getNormals() const {
+        return m_normals;
+    }
+
+    void Geometry::computeNormals() {
+        m_normals.assign(m_vertices.size(), Normal3D{ 0.0f, 0.0f, 0.0f });
+        for (const Triangle& t : m_triangles) {
+            if (t[0] >= m_vertices.size() || t[1] >= m_vertices.size() || t[2] >= m_vertices.size()) continue;
+            const Point3D& a = m_vertices[t[0]];
+            const Point3D& b = m_vertices[t[1]];
+            const Point3D& c = m_vertices[t[2]];
+            const float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            const float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+            // The cross product's length is twice the area: larger triangles weigh more.
+            const Normal3D n{ e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            for (size_t corner : t) {
+                for (int k = 0; k < 3; ++k) m_normals[corner][k] += n[k];
+            }
+        }
+        for (Normal3D& n : m_normals) {
+            const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (len > 0.0f) {
+                for (float& v : n) v /= len;
+            }
+            else {
+                n = Normal3D{ 0.0f, 0.0f, 1.0f };
+            }
+        }
+        ++m_version;
+    }
+
+    void Geometry::setColor(const ColorRGBA& color) {
+        m_color = color;
+        ++m_version;
+    }
+
+    const ColorRGBA& Geometry::getColor() const {
+        return m_color;
+    }
+
+    uint64_t Geometry::getVersion() const {
+        return m_version;
+    }
+
     void Geometry::clear() {
         m_vertices.clear();
         m_triangles.clear();
+        m_normals.clear();
+        ++m_version;
     }
 
     bool Geometry::isEmpty() const {
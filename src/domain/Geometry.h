@@ -1,11 +1,15 @@
 ﻿#pragma once
 #include <vector>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 
 namespace domain {
 
     using Point3D = std::array<float, 3>;
     using Triangle = std::array<size_t, 3>;
+    using Normal3D = std::array<float, 3>;
+    using ColorRGBA = std::array<float, 4>;
 
     class Geometry {
     public:
@@ -13,9 +17,24 @@ namespace domain {
 
         void addVertex(const Point3D& vertex);
         void addTriangle(const Triangle& triangle);
+        void addNormal(const Normal3D& normal);
 
         const std::vector<Point3D>& getVertices() const;
         const std::vector<Triangle>& getTriangles() const;
+        // One per vertex, or empty.
+        const std::vector<Normal3D>& getNormals() const;
+
+        // Area-weighted vertex normals from the triangles, replacing any
+        // normals. Vertices shared by triangles are smoothed across them;
+        // duplicate a vertex to keep a crease.
+        void computeNormals();
+
+        void setColor(const ColorRGBA& color);
+        const ColorRGBA& getColor() const;
+
+        // Bumped by every change, so a cached copy (say, on the GPU) can
+        // tell it is stale without comparing contents.
+        uint64_t getVersion() const;
 
         void clear();
         bool isEmpty() const;
@@ -23,6 +42,9 @@ namespace domain {
     private:
         std::vector<Point3D> m_vertices;
         std::vector<Triangle> m_triangles;
+        std::vector<Normal3D> m_normals;
+        ColorRGBA m_color{ 0.7f, 0.7f, 0.75f, 1.0f };
+        uint64_t m_version = 0;
     };
 
 } // namespace domain
\ No newline at end of file
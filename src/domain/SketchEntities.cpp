@@ -1,61 +1,251 @@
 ﻿#include "SketchEntities.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <stdexcept>
 
+#include "SketchKernels.h"
+
 namespace domain::sketch {
 
+    constexpr std::size_t kMaxRemovals = 4096; // journal length before the oldest half is dropped
+
     static void ensureUnique(const std::unordered_map<EntityId, EntityHandle>& map, EntityId id) {
         if (map.find(id) != map.end()) {
             throw std::runtime_error("Duplicate EntityId encountered while building EntityStore");
         }
     }
 
+    static std::uint8_t packFlags(const EntityHeader& h) {
+        return static_cast<std::uint8_t>((h.construction ? flags::Construction : 0)
+            | (h.visible ? flags::Visible : 0)
+            | (h.selectable ? flags::Selectable : 0));
+    }
+
+    // Moves the last row of every column into row `hole` and drops the last row.
+    template <class Columns>
+    static void swapAndPop(Columns& columns, std::uint32_t hole) {
+        columns.forEachColumn([hole](auto& column) {
+            const std::size_t last = column.size() - 1;
+            if (hole != last) column[hole] = std::move(column[last]);
+            column.pop_back();
+        });
+    }
+
+    template <class Columns>
+    static void clearColumns(Columns& columns) {
+        columns.forEachColumn([](auto& column) { column.clear(); });
+    }
+
+    static constexpr double kPi = 3.14159265358979323846;
+
+    // Whether direction `angle` lies on the arc swept from `from` to `to`.
+    static bool onSweep(double from, double to, double angle, bool ccw) {
+        constexpr double kTwoPi = 2.0 * kPi;
+        auto wrap = [](double a) {
+            a = std::fmod(a, kTwoPi);
+            return a < 0.0 ? a + kTwoPi : a;
+        };
+        if (!ccw) std::swap(from, to);
+        return wrap(angle - from) <= wrap(to - from);
+    }
+
+    // Exact bounds of an arc: endpoints plus whichever axis extremes the sweep passes through.
+    static Box2 arcBounds(const ArcColumns& ac, std::size_t i) {
+        const double cx = ac.cx[i];
+        const double cy = ac.cy[i];
+        const double r = std::abs(ac.r[i]);
+        const double from = std::atan2(ac.sy[i] - cy, ac.sx[i] - cx);
+        const double to = std::atan2(ac.ey[i] - cy, ac.ex[i] - cx);
+        const bool ccw = ac.ccw[i] != 0;
+
+        Box2 box;
+        box.expand(Vec2{ ac.sx[i], ac.sy[i] });
+        box.expand(Vec2{ ac.ex[i], ac.ey[i] });
+        if (onSweep(from, to, 0.0, ccw))       box.expand(Vec2{ cx + r, cy });
+        if (onSweep(from, to, 0.5 * kPi, ccw)) box.expand(Vec2{ cx, cy + r });
+        if (onSweep(from, to, kPi, ccw))       box.expand(Vec2{ cx - r, cy });
+        if (onSweep(from, to, 1.5 * kPi, ccw)) box.expand(Vec2{ cx, cy - r });
+        return box;
+    }
+
+    static Box2 ellipseBounds(const EllipseColumns& ec, std::size_t i) {
+        const double cs = std::cos(ec.rotation[i]);
+        const double sn = std::sin(ec.rotation[i]);
+        const double rx = ec.rx[i];
+        const double ry = ec.ry[i];
+        const double hx = std::sqrt(rx * rx * cs * cs + ry * ry * sn * sn);
+        const double hy = std::sqrt(rx * rx * sn * sn + ry * ry * cs * cs);
+        Box2 box;
+        box.expand(Vec2{ ec.cx[i] - hx, ec.cy[i] - hy });
+        box.expand(Vec2{ ec.cx[i] + hx, ec.cy[i] + hy });
+        return box;
+    }
+
+    static double segmentDistance(const Vec2& p, const Vec2& a, const Vec2& b) {
+        const double dx = b.x - a.x;
+        const double dy = b.y - a.y;
+        const double len2 = dx * dx + dy * dy;
+        double t = len2 > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2 : 0.0;
+        t = std::clamp(t, 0.0, 1.0);
+        return std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+    }
+
+    // Distance to an axis-aligned ellipse centered at the origin, by a few
+    // fixed-point iterations on the first quadrant (converges in ~3).
+    static double ellipseDistance(double px, double py, double a, double b) {
+        a = std::abs(a);
+        b = std::abs(b);
+        if (a < 1e-12 || b < 1e-12) {
+            return segmentDistance({ px, py }, { -a, -b }, { a, b });
+        }
+        px = std::abs(px);
+        py = std::abs(py);
+
+        double tx = 0.70710678118654752;
+        double ty = 0.70710678118654752;
+        for (int k = 0; k < 3; ++k) {
+            const double x = a * tx;
+            const double y = b * ty;
+            const double ex = (a * a - b * b) * tx * tx * tx / a;
+            const double ey = (b * b - a * a) * ty * ty * ty / b;
+            const double r = std::hypot(x - ex, y - ey);
+            const double q = std::max(std::hypot(px - ex, py - ey), 1e-300);
+            tx = std::clamp(((px - ex) * r / q + ex) / a, 0.0, 1.0);
+            ty = std::clamp(((py - ey) * r / q + ey) / b, 0.0, 1.0);
+            const double t = std::hypot(tx, ty);
+            tx /= t;
+            ty /= t;
+        }
+        return std::hypot(px - a * tx, py - b * ty);
+    }
+
+    EntityHandle EntityStore::insert(const EntityHeader& header, EntityKind kind) {
+        HeaderColumns& hc = m_headers[static_cast<std::size_t>(kind)];
+        const auto dense = static_cast<std::uint32_t>(hc.size());
+        hc.ids.push_back(header.id);
+        hc.flags.push_back(packFlags(header));
+        hc.versions.push_back(++m_version);
+        if (!header.name.empty()) m_names[header.id] = header.name;
+
+        SlotTable& t = slots(kind);
+        std::uint32_t s;
+        if (t.freeHead != SlotTable::kNoSlot) {
+            s = t.freeHead;
+            t.freeHead = t.slots[s].index;
+            t.slots[s].index = dense;
+        }
+        else {
+            s = static_cast<std::uint32_t>(t.slots.size());
+            t.slots.push_back({ dense, 0 });
+        }
+        t.slotOf.push_back(s);
+
+        EntityHandle h{ kind, s, t.slots[s].generation };
+        m_idToHandle.emplace(header.id, h);
+        return h;
+    }
+
     EntityHandle EntityStore::addPoint(Point2D p) {
         ensureUnique(m_idToHandle, p.h.id);
-        EntityHandle h{ EntityKind::Point, static_cast<std::uint32_t>(m_points.size()) };
-        m_points.emplace_back(std::move(p));
-        m_idToHandle.emplace(m_points.back().h.id, h);
-        return h;
+        m_points.x.push_back(p.p.x);
+        m_points.y.push_back(p.p.y);
+        return insert(p.h, EntityKind::Point);
     }
 
     EntityHandle EntityStore::addLine(Line2D l) {
         ensureUnique(m_idToHandle, l.h.id);
-        EntityHandle h{ EntityKind::Line, static_cast<std::uint32_t>(m_lines.size()) };
-        m_lines.emplace_back(std::move(l));
-        m_idToHandle.emplace(m_lines.back().h.id, h);
-        return h;
+        m_lines.ax.push_back(l.a.x);
+        m_lines.ay.push_back(l.a.y);
+        m_lines.bx.push_back(l.b.x);
+        m_lines.by.push_back(l.b.y);
+        return insert(l.h, EntityKind::Line);
     }
 
     EntityHandle EntityStore::addCircle(Circle2D c) {
         ensureUnique(m_idToHandle, c.h.id);
-        EntityHandle h{ EntityKind::Circle, static_cast<std::uint32_t>(m_circles.size()) };
-        m_circles.emplace_back(std::move(c));
-        m_idToHandle.emplace(m_circles.back().h.id, h);
-        return h;
+        m_circles.cx.push_back(c.center.x);
+        m_circles.cy.push_back(c.center.y);
+        m_circles.r.push_back(c.radius);
+        return insert(c.h, EntityKind::Circle);
     }
 
     EntityHandle EntityStore::addArc(Arc2D a) {
         ensureUnique(m_idToHandle, a.h.id);
-        EntityHandle h{ EntityKind::Arc, static_cast<std::uint32_t>(m_arcs.size()) };
-        m_arcs.emplace_back(std::move(a));
-        m_idToHandle.emplace(m_arcs.back().h.id, h);
-        return h;
+        m_arcs.cx.push_back(a.center.x);
+        m_arcs.cy.push_back(a.center.y);
+        m_arcs.r.push_back(a.radius);
+        m_arcs.sx.push_back(a.start.x);
+        m_arcs.sy.push_back(a.start.y);
+        m_arcs.ex.push_back(a.end.x);
+        m_arcs.ey.push_back(a.end.y);
+        m_arcs.ccw.push_back(a.ccw ? 1 : 0);
+        return insert(a.h, EntityKind::Arc);
     }
 
     EntityHandle EntityStore::addEllipse(Ellipse2D e) {
         ensureUnique(m_idToHandle, e.h.id);
-        EntityHandle h{ EntityKind::Ellipse, static_cast<std::uint32_t>(m_ellipses.size()) };
-        m_ellipses.emplace_back(std::move(e));
-        m_idToHandle.emplace(m_ellipses.back().h.id, h);
-        return h;
+        m_ellipses.cx.push_back(e.center.x);
+        m_ellipses.cy.push_back(e.center.y);
+        m_ellipses.rx.push_back(e.rx);
+        m_ellipses.ry.push_back(e.ry);
+        m_ellipses.rotation.push_back(e.rotation);
+        return insert(e.h, EntityKind::Ellipse);
     }
 
     EntityHandle EntityStore::addCurve(Curve2D c) {
         ensureUnique(m_idToHandle, c.h.id);
-        EntityHandle h{ EntityKind::Curve, static_cast<std::uint32_t>(m_curves.size()) };
-        m_curves.emplace_back(std::move(c));
-        m_idToHandle.emplace(m_curves.back().h.id, h);
-        return h;
+        m_curves.controlPoints.push_back(std::move(c.controlPoints));
+        m_curves.closed.push_back(c.closed ? 1 : 0);
+        m_curves.degree.push_back(static_cast<std::uint8_t>(std::clamp(c.degree, 1, 255)));
+        m_curves.knots.push_back(std::move(c.knots));
+        m_curves.weights.push_back(std::move(c.weights));
+        return insert(c.h, EntityKind::Curve);
+    }
+
+    bool EntityStore::remove(EntityId id) {
+        auto it = m_idToHandle.find(id);
+        if (it == m_idToHandle.end()) {
+            return false;
+        }
+        const EntityHandle h = it->second;
+        m_idToHandle.erase(it);
+        m_names.erase(id);
+
+        m_removals.emplace_back(++m_version, id);
+        if (m_removals.size() > kMaxRemovals) {
+            const auto drop = m_removals.begin() + kMaxRemovals / 2;
+            m_removalsFrom = (drop - 1)->first;
+            m_removals.erase(m_removals.begin(), drop);
+        }
+
+        SlotTable& table = slots(h.kind);
+        auto& slot = table.slots[h.slot];
+        const std::uint32_t hole = slot.index;
+
+        switch (h.kind) {
+        case EntityKind::Point:   swapAndPop(m_points, hole); break;
+        case EntityKind::Line:    swapAndPop(m_lines, hole); break;
+        case EntityKind::Circle:  swapAndPop(m_circles, hole); break;
+        case EntityKind::Arc:     swapAndPop(m_arcs, hole); break;
+        case EntityKind::Ellipse: swapAndPop(m_ellipses, hole); break;
+        case EntityKind::Curve:   swapAndPop(m_curves, hole); break;
+        }
+        swapAndPop(m_headers[static_cast<std::size_t>(h.kind)], hole);
+
+        // The moved row keeps its slot; point that slot at the hole.
+        const auto last = static_cast<std::uint32_t>(table.slotOf.size() - 1);
+        if (hole != last) {
+            table.slotOf[hole] = table.slotOf[last];
+            table.slots[table.slotOf[hole]].index = hole;
+        }
+        table.slotOf.pop_back();
+
+        ++slot.generation;
+        slot.index = table.freeHead;
+        table.freeHead = h.slot;
+        return true;
     }
 
     bool EntityStore::contains(EntityId id) const {
@@ -70,14 +260,275 @@ namespace domain::sketch {
         return it->second;
     }
 
+    bool EntityStore::isValid(EntityHandle h) const {
+        const SlotTable& t = slots(h.kind);
+        return h.slot < t.slots.size() && t.slots[h.slot].generation == h.generation;
+    }
+
+    std::uint32_t EntityStore::checked(EntityHandle h, EntityKind kind) const {
+        if (h.kind != kind || !isValid(h)) {
+            throw std::out_of_range("Stale or mismatched EntityHandle");
+        }
+        return slots(kind).slots[h.slot].index;
+    }
+
+    std::uint32_t EntityStore::indexOf(EntityHandle h) const {
+        return checked(h, h.kind);
+    }
+
+    EntityHandle EntityStore::handleAt(EntityKind kind, std::uint32_t idx) const {
+        const SlotTable& t = slots(kind);
+        const std::uint32_t s = t.slotOf.at(idx);
+        return { kind, s, t.slots[s].generation };
+    }
+
+    // ---- records ----
+
+    EntityHeader EntityStore::header(EntityKind kind, std::uint32_t idx) const {
+        const HeaderColumns& hc = headers(kind);
+        EntityHeader h;
+        h.id = hc.ids.at(idx);
+        h.name = name(h.id);
+        h.construction = hc.construction(idx);
+        h.visible = hc.visible(idx);
+        h.selectable = hc.selectable(idx);
+        return h;
+    }
+
+    const std::string& EntityStore::name(EntityId id) const {
+        static const std::string kUnnamed;
+        auto it = m_names.find(id);
+        return it == m_names.end() ? kUnnamed : it->second;
+    }
+
+    Point2D EntityStore::point(std::uint32_t idx) const {
+        Point2D p;
+        p.h = header(EntityKind::Point, idx);
+        p.p = { m_points.x[idx], m_points.y[idx] };
+        return p;
+    }
+
+    Line2D EntityStore::line(std::uint32_t idx) const {
+        Line2D l;
+        l.h = header(EntityKind::Line, idx);
+        l.a = { m_lines.ax[idx], m_lines.ay[idx] };
+        l.b = { m_lines.bx[idx], m_lines.by[idx] };
+        return l;
+    }
+
+    Circle2D EntityStore::circle(std::uint32_t idx) const {
+        Circle2D c;
+        c.h = header(EntityKind::Circle, idx);
+        c.center = { m_circles.cx[idx], m_circles.cy[idx] };
+        c.radius = m_circles.r[idx];
+        return c;
+    }
+
+    Arc2D EntityStore::arc(std::uint32_t idx) const {
+        Arc2D a;
+        a.h = header(EntityKind::Arc, idx);
+        a.center = { m_arcs.cx[idx], m_arcs.cy[idx] };
+        a.radius = m_arcs.r[idx];
+        a.start = { m_arcs.sx[idx], m_arcs.sy[idx] };
+        a.end = { m_arcs.ex[idx], m_arcs.ey[idx] };
+        a.ccw = m_arcs.ccw[idx] != 0;
+        return a;
+    }
+
+    Ellipse2D EntityStore::ellipse(std::uint32_t idx) const {
+        Ellipse2D e;
+        e.h = header(EntityKind::Ellipse, idx);
+        e.center = { m_ellipses.cx[idx], m_ellipses.cy[idx] };
+        e.rx = m_ellipses.rx[idx];
+        e.ry = m_ellipses.ry[idx];
+        e.rotation = m_ellipses.rotation[idx];
+        return e;
+    }
+
+    Curve2D EntityStore::curve(std::uint32_t idx) const {
+        Curve2D c;
+        c.h = header(EntityKind::Curve, idx);
+        c.controlPoints = m_curves.controlPoints[idx];
+        c.closed = m_curves.closed[idx] != 0;
+        c.degree = m_curves.degree[idx];
+        c.knots = m_curves.knots[idx];
+        c.weights = m_curves.weights[idx];
+        return c;
+    }
+
+    // ---- bulk passes ----
+
+    void EntityStore::transform(const Transform2& t) {
+        using kernels::transformPoints;
+
+        const double s = t.scale();
+        auto scaleColumn = [s](std::vector<double>& v) {
+            for (double& x : v) x *= s;
+        };
+
+        transformPoints(m_points.x.data(), m_points.y.data(), m_points.size(), t);
+
+        transformPoints(m_lines.ax.data(), m_lines.ay.data(), m_lines.size(), t);
+        transformPoints(m_lines.bx.data(), m_lines.by.data(), m_lines.size(), t);
+
+        transformPoints(m_circles.cx.data(), m_circles.cy.data(), m_circles.size(), t);
+        scaleColumn(m_circles.r);
+
+        transformPoints(m_arcs.cx.data(), m_arcs.cy.data(), m_arcs.size(), t);
+        transformPoints(m_arcs.sx.data(), m_arcs.sy.data(), m_arcs.size(), t);
+        transformPoints(m_arcs.ex.data(), m_arcs.ey.data(), m_arcs.size(), t);
+        scaleColumn(m_arcs.r);
+        if (t.flips()) {
+            for (auto& ccw : m_arcs.ccw) ccw ^= 1;
+        }
+
+        transformPoints(m_ellipses.cx.data(), m_ellipses.cy.data(), m_ellipses.size(), t);
+        scaleColumn(m_ellipses.rx);
+        scaleColumn(m_ellipses.ry);
+        for (double& rot : m_ellipses.rotation) {
+            // New direction of the major axis.
+            const double ux = std::cos(rot);
+            const double uy = std::sin(rot);
+            rot = std::atan2(t.c * ux + t.d * uy, t.a * ux + t.b * uy);
+        }
+
+        for (auto& cps : m_curves.controlPoints) {
+            for (auto& cp : cps) cp = t.apply(cp);
+        }
+
+        const std::uint64_t v = nextVersion();
+        for (auto& hc : m_headers) std::fill(hc.versions.begin(), hc.versions.end(), v);
+    }
+
+    Box2 EntityStore::bounds() const {
+        using kernels::expandBounds;
+
+        Box2 box;
+
+        expandBounds(m_points.x.data(), m_points.y.data(), m_points.size(), box);
+
+        expandBounds(m_lines.ax.data(), m_lines.ay.data(), m_lines.size(), box);
+        expandBounds(m_lines.bx.data(), m_lines.by.data(), m_lines.size(), box);
+
+        kernels::expandBoundsCircles(m_circles.cx.data(), m_circles.cy.data(), m_circles.r.data(), m_circles.size(), box);
+
+        for (std::size_t i = 0; i < m_arcs.size(); ++i) box.expand(arcBounds(m_arcs, i));
+        for (std::size_t i = 0; i < m_ellipses.size(); ++i) box.expand(ellipseBounds(m_ellipses, i));
+
+        for (const auto& cps : m_curves.controlPoints) {
+            for (const auto& cp : cps) box.expand(cp);
+        }
+        return box;
+    }
+
+    Box2 EntityStore::bounds(EntityHandle h) const {
+        const std::uint32_t i = indexOf(h);
+        Box2 box;
+        switch (h.kind) {
+        case EntityKind::Point:
+            box.expand(Vec2{ m_points.x[i], m_points.y[i] });
+            break;
+        case EntityKind::Line:
+            box.expand(Vec2{ m_lines.ax[i], m_lines.ay[i] });
+            box.expand(Vec2{ m_lines.bx[i], m_lines.by[i] });
+            break;
+        case EntityKind::Circle: {
+            const double r = std::abs(m_circles.r[i]);
+            box.expand(Vec2{ m_circles.cx[i] - r, m_circles.cy[i] - r });
+            box.expand(Vec2{ m_circles.cx[i] + r, m_circles.cy[i] + r });
+            break;
+        }
+        case EntityKind::Arc:
+            box = arcBounds(m_arcs, i);
+            break;
+        case EntityKind::Ellipse:
+            box = ellipseBounds(m_ellipses, i);
+            break;
+        case EntityKind::Curve:
+            for (const auto& cp : m_curves.controlPoints[i]) box.expand(cp);
+            break;
+        }
+        return box;
+    }
+
+    double EntityStore::distance(EntityHandle h, const Vec2& p) const {
+        const std::uint32_t i = indexOf(h);
+        switch (h.kind) {
+        case EntityKind::Point:
+            return std::hypot(p.x - m_points.x[i], p.y - m_points.y[i]);
+        case EntityKind::Line:
+            return segmentDistance(p, { m_lines.ax[i], m_lines.ay[i] }, { m_lines.bx[i], m_lines.by[i] });
+        case EntityKind::Circle:
+            return std::abs(std::hypot(p.x - m_circles.cx[i], p.y - m_circles.cy[i]) - std::abs(m_circles.r[i]));
+        case EntityKind::Arc: {
+            const Vec2 c{ m_arcs.cx[i], m_arcs.cy[i] };
+            const Vec2 s{ m_arcs.sx[i], m_arcs.sy[i] };
+            const Vec2 e{ m_arcs.ex[i], m_arcs.ey[i] };
+            const double from = std::atan2(s.y - c.y, s.x - c.x);
+            const double to = std::atan2(e.y - c.y, e.x - c.x);
+            if (onSweep(from, to, std::atan2(p.y - c.y, p.x - c.x), m_arcs.ccw[i] != 0)) {
+                return std::abs(std::hypot(p.x - c.x, p.y - c.y) - std::abs(m_arcs.r[i]));
+            }
+            return std::min(std::hypot(p.x - s.x, p.y - s.y), std::hypot(p.x - e.x, p.y - e.y));
+        }
+        case EntityKind::Ellipse: {
+            // Into the ellipse's frame.
+            const double cs = std::cos(m_ellipses.rotation[i]);
+            const double sn = std::sin(m_ellipses.rotation[i]);
+            const double dx = p.x - m_ellipses.cx[i];
+            const double dy = p.y - m_ellipses.cy[i];
+            return ellipseDistance(cs * dx + sn * dy, -sn * dx + cs * dy, m_ellipses.rx[i], m_ellipses.ry[i]);
+        }
+        case EntityKind::Curve: {
+            const auto& cps = m_curves.controlPoints[i];
+            if (cps.empty()) return std::numeric_limits<double>::infinity();
+            double best = std::hypot(p.x - cps[0].x, p.y - cps[0].y);
+            for (std::size_t k = 1; k < cps.size(); ++k) best = std::min(best, segmentDistance(p, cps[k - 1], cps[k]));
+            if (m_curves.closed[i] && cps.size() > 2) best = std::min(best, segmentDistance(p, cps.back(), cps.front()));
+            return best;
+        }
+        }
+        return std::numeric_limits<double>::infinity();
+    }
+
     void EntityStore::clear() {
-        m_points.clear();
-        m_lines.clear();
-        m_circles.clear();
-        m_arcs.clear();
-        m_ellipses.clear();
-        m_curves.clear();
+        clearColumns(m_points);
+        clearColumns(m_lines);
+        clearColumns(m_circles);
+        clearColumns(m_arcs);
+        clearColumns(m_ellipses);
+        clearColumns(m_curves);
+        for (auto& hc : m_headers) clearColumns(hc);
+        m_names.clear();
         m_idToHandle.clear();
+
+        m_removals.clear();
+        m_removalsFrom = nextVersion();
+
+        // Free every slot with a new generation so handles from before the clear stay stale.
+        for (auto& t : m_slots) {
+            t.slotOf.clear();
+            t.freeHead = SlotTable::kNoSlot;
+            for (auto s = static_cast<std::uint32_t>(t.slots.size()); s-- > 0;) {
+                ++t.slots[s].generation;
+                t.slots[s].index = t.freeHead;
+                t.freeHead = s;
+            }
+        }
+    }
+
+    // ---- change tracking ----
+
+    void EntityStore::markChanged(EntityHandle h, std::uint64_t version) {
+        m_headers[static_cast<std::size_t>(h.kind)].versions[indexOf(h)] = version;
+    }
+
+    bool EntityStore::removedSince(std::uint64_t version, std::vector<EntityId>& out) const {
+        if (version < m_removalsFrom) return false;
+        auto it = std::upper_bound(m_removals.begin(), m_removals.end(), version,
+            [](std::uint64_t v, const std::pair<std::uint64_t, EntityId>& r) { return v < r.first; });
+        for (; it != m_removals.end(); ++it) out.push_back(it->second);
+        return true;
     }
 
 } // namespace domain::sketch
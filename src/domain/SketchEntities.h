@@ -1,7 +1,9 @@
 ﻿#pragma once
 
+#include <array>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "SketchIds.h"
@@ -10,9 +12,22 @@
 namespace domain::sketch {
 
     // Runtime-optimized entity storage:
-    //  - Each entity type has its own contiguous vector.
-    //  - EntityId -> (kind,index) map for O(1) access.
+    //  - Each entity type has its own contiguous columns.
+    //  - EntityId -> handle map for O(1) access.
     // This is faster for editing + constraint solving than storing heterogeneous entities in a single variant list.
+    //
+    // The typed columns are a generational slot map: removal swaps the last
+    // entity into the hole and pops, so the columns stay dense, and handles
+    // name a slot rather than a column position. A slot's generation is bumped
+    // when its entity is removed, so a stale handle is detected instead of
+    // silently aliasing whichever entity reuses the slot.
+    //
+    // Geometry is stored structure-of-arrays: one std::vector<double> per
+    // coordinate (x[], y[], r[], ...), so bulk passes (transforms, bounds,
+    // solver gathers, render building) stream only the values they read and
+    // can run SIMD kernels over them. Ids and flags live in a separate header
+    // column; names are cold and kept in a side table keyed by id. The record
+    // structs below are only the insert/read-back format.
 
     struct EntityHeader {
         EntityId id{};
@@ -56,15 +71,97 @@ namespace domain::sketch {
         double rotation{ 0.0 }; // radians
     };
 
+    // B-spline, or NURBS when weights are given (see BSpline in SketchSpline.h).
+    // Empty knots mean a uniform vector: clamped for open curves, periodic
+    // for closed ones.
     struct Curve2D {
         EntityHeader h;
         std::vector<Vec2> controlPoints;
         bool closed{ false };
+        int degree{ 3 };             // lowered to controlPoints.size() - 1 for short curves
+        std::vector<double> knots;   // controlPoints.size() + degree + 1 values, or empty
+        std::vector<double> weights; // one per control point, or empty
     };
 
     struct EntityHandle {
         EntityKind kind{ EntityKind::Point };
-        std::uint32_t index{ 0 };
+        std::uint32_t slot{ 0 };       // stable while the entity exists
+        std::uint32_t generation{ 0 }; // must match the slot's current generation
+    };
+
+    // Bits of HeaderColumns::flags.
+    namespace flags {
+        inline constexpr std::uint8_t Construction = 1u << 0;
+        inline constexpr std::uint8_t Visible = 1u << 1;
+        inline constexpr std::uint8_t Selectable = 1u << 2;
+    }
+
+    // ---- Columns (index i is the i-th entity of the kind) ----
+
+    struct HeaderColumns {
+        std::vector<EntityId> ids;
+        std::vector<std::uint8_t> flags;
+        std::vector<std::uint64_t> versions; // store version of the entity's last change
+
+        std::size_t size() const { return ids.size(); }
+        bool construction(std::size_t i) const { return (flags[i] & flags::Construction) != 0; }
+        bool visible(std::size_t i) const { return (flags[i] & flags::Visible) != 0; }
+        bool selectable(std::size_t i) const { return (flags[i] & flags::Selectable) != 0; }
+
+        template <class F> void forEachColumn(F&& f) { f(ids); f(flags); f(versions); }
+    };
+
+    struct PointColumns {
+        std::vector<double> x, y;
+
+        std::size_t size() const { return x.size(); }
+        template <class F> void forEachColumn(F&& f) { f(x); f(y); }
+    };
+
+    struct LineColumns {
+        std::vector<double> ax, ay; // start
+        std::vector<double> bx, by; // end
+
+        std::size_t size() const { return ax.size(); }
+        template <class F> void forEachColumn(F&& f) { f(ax); f(ay); f(bx); f(by); }
+    };
+
+    struct CircleColumns {
+        std::vector<double> cx, cy, r;
+
+        std::size_t size() const { return cx.size(); }
+        template <class F> void forEachColumn(F&& f) { f(cx); f(cy); f(r); }
+    };
+
+    struct ArcColumns {
+        std::vector<double> cx, cy, r;
+        std::vector<double> sx, sy; // start
+        std::vector<double> ex, ey; // end
+        std::vector<std::uint8_t> ccw;
+
+        std::size_t size() const { return cx.size(); }
+        template <class F> void forEachColumn(F&& f) { f(cx); f(cy); f(r); f(sx); f(sy); f(ex); f(ey); f(ccw); }
+    };
+
+    struct EllipseColumns {
+        std::vector<double> cx, cy, rx, ry;
+        std::vector<double> rotation; // radians
+
+        std::size_t size() const { return cx.size(); }
+        template <class F> void forEachColumn(F&& f) { f(cx); f(cy); f(rx); f(ry); f(rotation); }
+    };
+
+    // Curves have a variable number of control points, so they stay one
+    // vector per entity.
+    struct CurveColumns {
+        std::vector<std::vector<Vec2>> controlPoints;
+        std::vector<std::uint8_t> closed;
+        std::vector<std::uint8_t> degree;
+        std::vector<std::vector<double>> knots;
+        std::vector<std::vector<double>> weights;
+
+        std::size_t size() const { return controlPoints.size(); }
+        template <class F> void forEachColumn(F&& f) { f(controlPoints); f(closed); f(degree); f(knots); f(weights); }
     };
 
     class EntityStore {
@@ -77,47 +174,133 @@ namespace domain::sketch {
         EntityHandle addEllipse(Ellipse2D e);
         EntityHandle addCurve(Curve2D c);
 
+        // Swap-and-pop removal; O(1). Handles of other entities stay valid,
+        // but dense indices do not. Returns false if the id is unknown.
+        bool remove(EntityId id);
+
         bool contains(EntityId id) const;
         EntityHandle getHandle(EntityId id) const; // throws std::out_of_range if missing
 
-        // Typed access
-        Point2D& point(std::uint32_t idx) { return m_points.at(idx); }
-        const Point2D& point(std::uint32_t idx) const { return m_points.at(idx); }
+        bool isValid(EntityHandle h) const;
+        std::uint32_t indexOf(EntityHandle h) const;                   // dense index; throws std::out_of_range if stale
+        EntityHandle handleAt(EntityKind kind, std::uint32_t idx) const; // handle of the idx-th entity of a kind
 
-        Line2D& line(std::uint32_t idx) { return m_lines.at(idx); }
-        const Line2D& line(std::uint32_t idx) const { return m_lines.at(idx); }
+        std::size_t size() const { return m_idToHandle.size(); }
+        std::size_t count(EntityKind kind) const { return headers(kind).size(); }
 
-        Circle2D& circle(std::uint32_t idx) { return m_circles.at(idx); }
-        const Circle2D& circle(std::uint32_t idx) const { return m_circles.at(idx); }
+        // Records by handle (throws std::out_of_range if stale or of another kind)
+        Point2D point(EntityHandle h) const { return point(checked(h, EntityKind::Point)); }
+        Line2D line(EntityHandle h) const { return line(checked(h, EntityKind::Line)); }
+        Circle2D circle(EntityHandle h) const { return circle(checked(h, EntityKind::Circle)); }
+        Arc2D arc(EntityHandle h) const { return arc(checked(h, EntityKind::Arc)); }
+        Ellipse2D ellipse(EntityHandle h) const { return ellipse(checked(h, EntityKind::Ellipse)); }
+        Curve2D curve(EntityHandle h) const { return curve(checked(h, EntityKind::Curve)); }
 
-        Arc2D& arc(std::uint32_t idx) { return m_arcs.at(idx); }
-        const Arc2D& arc(std::uint32_t idx) const { return m_arcs.at(idx); }
+        // Records by dense index
+        Point2D point(std::uint32_t idx) const;
+        Line2D line(std::uint32_t idx) const;
+        Circle2D circle(std::uint32_t idx) const;
+        Arc2D arc(std::uint32_t idx) const;
+        Ellipse2D ellipse(std::uint32_t idx) const;
+        Curve2D curve(std::uint32_t idx) const;
 
-        Ellipse2D& ellipse(std::uint32_t idx) { return m_ellipses.at(idx); }
-        const Ellipse2D& ellipse(std::uint32_t idx) const { return m_ellipses.at(idx); }
+        EntityHeader header(EntityKind kind, std::uint32_t idx) const;
+        const std::string& name(EntityId id) const; // empty if unnamed
 
-        Curve2D& curve(std::uint32_t idx) { return m_curves.at(idx); }
-        const Curve2D& curve(std::uint32_t idx) const { return m_curves.at(idx); }
+        // Bulk column access (rendering, solver gather/scatter). The mutable
+        // overloads are for writing values in place only; never resize a column,
+        // and report what was written with markChanged().
+        const HeaderColumns& headers(EntityKind kind) const { return m_headers[static_cast<std::size_t>(kind)]; }
 
-        // Bulk read access (useful for rendering)
-        const std::vector<Point2D>& points() const { return m_points; }
-        const std::vector<Line2D>& lines() const { return m_lines; }
-        const std::vector<Circle2D>& circles() const { return m_circles; }
-        const std::vector<Arc2D>& arcs() const { return m_arcs; }
-        const std::vector<Ellipse2D>& ellipses() const { return m_ellipses; }
-        const std::vector<Curve2D>& curves() const { return m_curves; }
+        const PointColumns& points() const { return m_points; }
+        const LineColumns& lines() const { return m_lines; }
+        const CircleColumns& circles() const { return m_circles; }
+        const ArcColumns& arcs() const { return m_arcs; }
+        const EllipseColumns& ellipses() const { return m_ellipses; }
+        const CurveColumns& curves() const { return m_curves; }
+
+        PointColumns& points() { return m_points; }
+        LineColumns& lines() { return m_lines; }
+        CircleColumns& circles() { return m_circles; }
+        ArcColumns& arcs() { return m_arcs; }
+        EllipseColumns& ellipses() { return m_ellipses; }
+        CurveColumns& curves() { return m_curves; }
+
+        // Applies a similarity transform (translate/rotate/scale/mirror) to
+        // every entity. Radii scale by t.scale(); mirroring flips arc direction.
+        void transform(const Transform2& t);
+
+        // Tight bounds of all entities; curves are bounded by their control
+        // polygon. Empty if the store is empty.
+        Box2 bounds() const;
+        Box2 bounds(EntityHandle h) const;
+
+        // Distance from `p` to the entity's outline (curves: control polygon).
+        double distance(EntityHandle h, const Vec2& p) const;
 
         void clear();
 
+        // ---- Change tracking ----
+        // Every change gets a new store version: inserts, removals, transform()
+        // and clear() take one themselves, in-place writes through the mutable
+        // columns are reported with markChanged(). headers(kind).versions[i]
+        // is the version of the entity's last change, so a consumer that
+        // remembers version() finds what changed since by comparing against
+        // it, and what went away with removedSince().
+        std::uint64_t version() const { return m_version; }
+
+        // Starts a change and returns its version, for markChanged().
+        std::uint64_t nextVersion() { return ++m_version; }
+        // The version nextVersion() will return next. Writers that may change
+        // nothing mark with it and call nextVersion() only if they did.
+        std::uint64_t pendingVersion() const { return m_version + 1; }
+
+        // Records that the entity's values were written in place. Distinct
+        // entities may be marked concurrently under one nextVersion().
+        void markChanged(EntityHandle h, std::uint64_t version);
+        void markChanged(EntityHandle h) { markChanged(h, nextVersion()); }
+
+        // Appends the ids removed after `version` to `out`, oldest first.
+        // Returns false if the journal no longer reaches back that far (or a
+        // clear() happened since); the caller must then resync from scratch.
+        bool removedSince(std::uint64_t version, std::vector<EntityId>& out) const;
+
     private:
-        std::vector<Point2D> m_points;
-        std::vector<Line2D> m_lines;
-        std::vector<Circle2D> m_circles;
-        std::vector<Arc2D> m_arcs;
-        std::vector<Ellipse2D> m_ellipses;
-        std::vector<Curve2D> m_curves;
+        PointColumns m_points;
+        LineColumns m_lines;
+        CircleColumns m_circles;
+        ArcColumns m_arcs;
+        EllipseColumns m_ellipses;
+        CurveColumns m_curves;
+
+        std::array<HeaderColumns, kEntityKindCount> m_headers;
+        std::unordered_map<EntityId, std::string> m_names; // non-empty names only
 
         std::unordered_map<EntityId, EntityHandle> m_idToHandle;
+
+        std::uint64_t m_version{ 0 };
+        std::vector<std::pair<std::uint64_t, EntityId>> m_removals; // (version, id), oldest first
+        std::uint64_t m_removalsFrom{ 0 }; // removals up to this version were dropped
+
+        // Per-kind slot map over the columns of that kind.
+        struct SlotTable {
+            struct Slot {
+                std::uint32_t index{ 0 };      // dense index while live, next free slot while free
+                std::uint32_t generation{ 0 };
+            };
+            std::vector<Slot> slots;
+            std::vector<std::uint32_t> slotOf; // dense index -> slot
+            std::uint32_t freeHead{ kNoSlot };
+
+            static constexpr std::uint32_t kNoSlot = 0xFFFFFFFFu;
+        };
+        std::array<SlotTable, kEntityKindCount> m_slots;
+
+        SlotTable& slots(EntityKind kind) { return m_slots[static_cast<std::size_t>(kind)]; }
+        const SlotTable& slots(EntityKind kind) const { return m_slots[static_cast<std::size_t>(kind)]; }
+
+        EntityHandle insert(const EntityHeader& h, EntityKind kind);
+        std::uint32_t checked(EntityHandle h, EntityKind kind) const;
     };
 
 } // namespace domain::sketch
@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace domain::sketch {
@@ -18,6 +19,8 @@ namespace domain::sketch {
         Curve
     };
 
+    inline constexpr std::size_t kEntityKindCount = 6;
+
     // Fine-grained location on an entity for constraints/dimensions.
     enum class EntityAnchor : std::uint8_t {
         None = 0,
@@ -0,0 +1,504 @@
+#include "SketchIntersections.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "SketchSpline.h"
+
+namespace domain::sketch {
+
+    namespace {
+
+        using Shape = IntersectionEngine::Shape;
+
+        constexpr double kPi = 3.14159265358979323846;
+        constexpr double kTwoPi = 2.0 * kPi;
+        constexpr int kEllipseSegments = 64;
+        constexpr double kCurveFlattening = 1e-4; // chordal tolerance for curves, relative to their control box
+
+        double dist(const Vec2& a, const Vec2& b) { return std::hypot(a.x - b.x, a.y - b.y); }
+        double cross(double ax, double ay, double bx, double by) { return ax * by - ay * bx; }
+        Vec2 lerp(const Vec2& a, const Vec2& b, double t) { return { a.x + t * (b.x - a.x), a.y + t * (b.y - a.y) }; }
+
+        bool onSweep(double from, double to, double angle, bool ccw) {
+            auto wrap = [](double a) {
+                a = std::fmod(a, kTwoPi);
+                return a < 0.0 ? a + kTwoPi : a;
+            };
+            if (!ccw) std::swap(from, to);
+            return wrap(angle - from) <= wrap(to - from);
+        }
+
+        double roundAngle(const Shape& s, const Vec2& p) {
+            return std::atan2(p.y - s.center.y, p.x - s.center.x);
+        }
+
+        // Whether a point on the circle lies on the arc, allowing `tol` past either end.
+        bool covers(const Shape& s, const Vec2& p, double tol) {
+            if (!s.partial) return true;
+            const double slack = s.r > 0.0 ? tol / s.r : 0.0;
+            return s.ccw
+                ? onSweep(s.from - slack, s.to + slack, roundAngle(s, p), true)
+                : onSweep(s.from + slack, s.to - slack, roundAngle(s, p), false);
+        }
+
+        // Into the ellipse's frame, scaled so the ellipse is the unit circle.
+        Vec2 toUnit(const Shape& e, const Vec2& p) {
+            const double dx = p.x - e.center.x;
+            const double dy = p.y - e.center.y;
+            return { (e.cs * dx + e.sn * dy) / e.rx, (-e.sn * dx + e.cs * dy) / e.ry };
+        }
+
+        double ellipseAngle(const Shape& e, const Vec2& p) {
+            const Vec2 u = toUnit(e, p);
+            return std::atan2(u.y, u.x);
+        }
+
+        Vec2 ellipseAt(const Shape& e, double t) {
+            const double lx = e.rx * std::cos(t);
+            const double ly = e.ry * std::sin(t);
+            return { e.center.x + e.cs * lx - e.sn * ly, e.center.y + e.sn * lx + e.cs * ly };
+        }
+
+        // Parameters along a->b (0..1) where the segment meets circle (c, r),
+        // within `tol`; a near-miss counts as touching at the closest point.
+        int segmentCircle(const Vec2& a, const Vec2& b, const Vec2& c, double r, double tol, double s[2]) {
+            const double dx = b.x - a.x, dy = b.y - a.y;
+            const double len2 = dx * dx + dy * dy;
+            if (len2 <= 0.0) return 0;
+            const double len = std::sqrt(len2);
+            const double foot = ((c.x - a.x) * dx + (c.y - a.y) * dy) / len2;
+            const double d = std::hypot(a.x + foot * dx - c.x, a.y + foot * dy - c.y);
+            if (d > r + tol) return 0;
+
+            const double half = std::sqrt(std::max(0.0, r * r - d * d));
+            const double slack = tol / len;
+            int n = 0;
+            auto keep = [&](double t) {
+                if (t >= -slack && t <= 1.0 + slack) s[n++] = std::clamp(t, 0.0, 1.0);
+            };
+            if (half <= tol) {
+                keep(foot);
+            }
+            else {
+                keep(foot - half / len);
+                keep(foot + half / len);
+            }
+            return n;
+        }
+
+        class PairTester {
+        public:
+            PairTester(std::vector<CurveIntersection>& out, double tol) : m_out(out), m_tol(tol) {}
+
+            void test(const Shape& a, std::uint32_t pa, const Shape& b, std::uint32_t pb) {
+                using T = Shape::Type;
+                if (a.type == T::Polyline && b.type == T::Polyline) segmentSegment(a, pa, b, pb);
+                else if (a.type == T::Polyline && b.type == T::Round) segmentRound(a, pa, b);
+                else if (a.type == T::Round && b.type == T::Polyline) segmentRound(b, pb, a);
+                else if (a.type == T::Polyline && b.type == T::Ellipse) segmentEllipse(a, pa, b);
+                else if (a.type == T::Ellipse && b.type == T::Polyline) segmentEllipse(b, pb, a);
+                else if (a.type == T::Round && b.type == T::Round) roundRound(a, b);
+                else if (b.type == T::Round || (a.type == T::Ellipse && a.id < b.id)) ellipseAgainst(a, b);
+                else ellipseAgainst(b, a);
+            }
+
+        private:
+            std::vector<CurveIntersection>& m_out;
+            double m_tol;
+            Shape m_polygon; // scratch: ellipse flattened for ellipse/round and ellipse/ellipse
+
+            void emit(const Shape& a, const Shape& b, const Vec2& p, double ta, double tb) {
+                m_out.push_back({ a.id, b.id, p, ta, tb });
+            }
+
+            void segmentSegment(const Shape& a, std::uint32_t pa, const Shape& b, std::uint32_t pb) {
+                const Vec2& a0 = a.points[pa];
+                const Vec2& a1 = a.points[pa + 1];
+                const Vec2& b0 = b.points[pb];
+                const Vec2& b1 = b.points[pb + 1];
+                const double rx = a1.x - a0.x, ry = a1.y - a0.y;
+                const double sx = b1.x - b0.x, sy = b1.y - b0.y;
+                const double la = std::hypot(rx, ry), lb = std::hypot(sx, sy);
+                if (la <= 0.0 || lb <= 0.0) return;
+                const double qx = b0.x - a0.x, qy = b0.y - a0.y;
+                const double den = cross(rx, ry, sx, sy);
+                const double slackA = m_tol / la, slackB = m_tol / lb;
+
+                if (std::abs(den) <= 1e-12 * la * lb) {
+                    // Parallel: only collinear overlaps meet, at the ends of the shared stretch.
+                    if (std::abs(cross(qx, qy, rx, ry)) / la > m_tol) return;
+                    auto along = [](const Vec2& o, double dx, double dy, double len2, const Vec2& p) {
+                        return ((p.x - o.x) * dx + (p.y - o.y) * dy) / len2;
+                    };
+                    for (const double ub : { 0.0, 1.0 }) {
+                        const Vec2 p = ub == 0.0 ? b0 : b1;
+                        const double t = along(a0, rx, ry, la * la, p);
+                        if (t >= -slackA && t <= 1.0 + slackA) emit(a, b, p, pa + std::clamp(t, 0.0, 1.0), pb + ub);
+                    }
+                    for (const double ua : { 0.0, 1.0 }) {
+                        const Vec2 p = ua == 0.0 ? a0 : a1;
+                        const double u = along(b0, sx, sy, lb * lb, p);
+                        if (u >= -slackB && u <= 1.0 + slackB) emit(a, b, p, pa + ua, pb + std::clamp(u, 0.0, 1.0));
+                    }
+                    return;
+                }
+
+                double t = cross(qx, qy, sx, sy) / den;
+                double u = cross(qx, qy, rx, ry) / den;
+                if (t < -slackA || t > 1.0 + slackA || u < -slackB || u > 1.0 + slackB) return;
+                t = std::clamp(t, 0.0, 1.0);
+                u = std::clamp(u, 0.0, 1.0);
+                emit(a, b, lerp(a0, a1, t), pa + t, pb + u);
+            }
+
+            void segmentRound(const Shape& a, std::uint32_t pa, const Shape& r) {
+                const Vec2& a0 = a.points[pa];
+                const Vec2& a1 = a.points[pa + 1];
+                double s[2];
+                const int n = segmentCircle(a0, a1, r.center, r.r, m_tol, s);
+                for (int k = 0; k < n; ++k) {
+                    const Vec2 p = lerp(a0, a1, s[k]);
+                    if (covers(r, p, m_tol)) emit(a, r, p, pa + s[k], roundAngle(r, p));
+                }
+            }
+
+            // Exact: an affine map takes the ellipse to the unit circle and
+            // keeps parameters along the segment.
+            void segmentEllipse(const Shape& a, std::uint32_t pa, const Shape& e) {
+                const Vec2& a0 = a.points[pa];
+                const Vec2& a1 = a.points[pa + 1];
+                double s[2];
+                const int n = segmentCircle(toUnit(e, a0), toUnit(e, a1), Vec2{}, 1.0, m_tol / std::min(e.rx, e.ry), s);
+                for (int k = 0; k < n; ++k) {
+                    const Vec2 p = lerp(a0, a1, s[k]);
+                    emit(a, e, p, pa + s[k], ellipseAngle(e, p));
+                }
+            }
+
+            void roundRound(const Shape& a, const Shape& b) {
+                const double d = dist(a.center, b.center);
+                if (d <= 0.0 || d > a.r + b.r + m_tol || d < std::abs(a.r - b.r) - m_tol) return;
+                const double along = (a.r * a.r - b.r * b.r + d * d) / (2.0 * d);
+                const double half = std::sqrt(std::max(0.0, a.r * a.r - along * along));
+                const double ux = (b.center.x - a.center.x) / d, uy = (b.center.y - a.center.y) / d;
+                const Vec2 m{ a.center.x + along * ux, a.center.y + along * uy };
+                const Vec2 ps[2] = { { m.x - half * uy, m.y + half * ux }, { m.x + half * uy, m.y - half * ux } };
+                for (int k = 0; k < (half > m_tol ? 2 : 1); ++k) {
+                    if (covers(a, ps[k], m_tol) && covers(b, ps[k], m_tol)) emit(a, b, ps[k], roundAngle(a, ps[k]), roundAngle(b, ps[k]));
+                }
+            }
+
+            // Ellipse against a circle/arc or another ellipse: flatten `e`,
+            // intersect the polygon with the exact other side, then refine.
+            void ellipseAgainst(const Shape& e, const Shape& other) {
+                m_polygon.type = Shape::Type::Polyline;
+                m_polygon.id = e.id;
+                m_polygon.points.clear();
+                for (int k = 0; k <= kEllipseSegments; ++k) m_polygon.points.push_back(ellipseAt(e, kTwoPi * k / kEllipseSegments));
+
+                const std::size_t first = m_out.size();
+                for (std::uint32_t k = 0; k < kEllipseSegments; ++k) {
+                    if (other.type == Shape::Type::Round) segmentRound(m_polygon, k, other);
+                    else segmentEllipse(m_polygon, k, other);
+                }
+                for (std::size_t i = first; i < m_out.size(); ++i) {
+                    CurveIntersection& hit = m_out[i];
+                    hit.point = refine(e, other, hit.point);
+                    hit.ta = ellipseAngle(e, hit.point);
+                    hit.tb = other.type == Shape::Type::Round ? roundAngle(other, hit.point) : ellipseAngle(other, hit.point);
+                }
+            }
+
+            // Implicit form f(p) = 0 of a round or ellipse, with its gradient.
+            static double implicit(const Shape& s, const Vec2& p, Vec2& grad) {
+                if (s.type == Shape::Type::Round) {
+                    const double dx = p.x - s.center.x, dy = p.y - s.center.y;
+                    grad = { 2.0 * dx, 2.0 * dy };
+                    return dx * dx + dy * dy - s.r * s.r;
+                }
+                const Vec2 u = toUnit(s, p);
+                const double gx = 2.0 * u.x / s.rx, gy = 2.0 * u.y / s.ry;
+                grad = { s.cs * gx - s.sn * gy, s.sn * gx + s.cs * gy };
+                return u.x * u.x + u.y * u.y - 1.0;
+            }
+
+            // Newton on both implicit equations takes a hit on the flattened
+            // ellipse onto the true curves; grazing contacts keep the estimate.
+            static Vec2 refine(const Shape& a, const Shape& b, Vec2 p) {
+                for (int it = 0; it < 4; ++it) {
+                    Vec2 ga, gb;
+                    const double fa = implicit(a, p, ga);
+                    const double fb = implicit(b, p, gb);
+                    const double det = ga.x * gb.y - ga.y * gb.x;
+                    if (std::abs(det) <= 1e-9 * std::hypot(ga.x, ga.y) * std::hypot(gb.x, gb.y)) break;
+                    const Vec2 next{ p.x - (fa * gb.y - fb * ga.y) / det, p.y - (ga.x * fb - gb.x * fa) / det };
+                    if (dist(next, p) > 0.1 * std::min(a.type == Shape::Type::Round ? a.r : std::min(a.rx, a.ry),
+                        b.type == Shape::Type::Round ? b.r : std::min(b.rx, b.ry))) break; // diverging
+                    p = next;
+                }
+                return p;
+            }
+        };
+
+        std::uint32_t pieceCount(const Shape& s) {
+            if (s.type != Shape::Type::Polyline) return 1;
+            return s.points.size() < 2 ? 0 : static_cast<std::uint32_t>(s.points.size() - 1);
+        }
+
+        Box2 segmentBox(const Vec2& a, const Vec2& b, double tol) {
+            Box2 box;
+            box.expand(Vec2{ std::min(a.x, b.x) - tol, std::min(a.y, b.y) - tol });
+            box.expand(Vec2{ std::max(a.x, b.x) + tol, std::max(a.y, b.y) + tol });
+            return box;
+        }
+
+        Box2 grow(Box2 box, double tol) {
+            box.min.x -= tol; box.min.y -= tol;
+            box.max.x += tol; box.max.y += tol;
+            return box;
+        }
+
+        // Box of one piece: a polyline segment, or the whole round or ellipse.
+        Box2 pieceBox(const Shape& s, std::uint32_t piece, double tol) {
+            if (s.type == Shape::Type::Polyline) return segmentBox(s.points[piece], s.points[piece + 1], tol);
+            const double r = s.type == Shape::Type::Round ? std::abs(s.r) : std::max(s.rx, s.ry);
+            return segmentBox({ s.center.x - r, s.center.y - r }, { s.center.x + r, s.center.y + r }, tol);
+        }
+
+        bool passes(std::uint8_t f, const IntersectionOptions& options) {
+            return (f & options.requiredFlags) == options.requiredFlags && (f & options.excludedFlags) == 0;
+        }
+
+        // Orders each hit a < b, then drops repeats of the same pair within
+        // `tol` (a line through a polygon vertex is found on both sides of it).
+        void finish(std::vector<CurveIntersection>& out, std::size_t first, double tol) {
+            for (std::size_t i = first; i < out.size(); ++i) {
+                auto& h = out[i];
+                if (h.b < h.a) {
+                    std::swap(h.a, h.b);
+                    std::swap(h.ta, h.tb);
+                }
+            }
+            std::sort(out.begin() + first, out.end(), [](const CurveIntersection& l, const CurveIntersection& r) {
+                if (l.a != r.a) return l.a < r.a;
+                if (l.b != r.b) return l.b < r.b;
+                if (l.point.x != r.point.x) return l.point.x < r.point.x;
+                return l.point.y < r.point.y;
+            });
+
+            std::size_t kept = first;
+            for (std::size_t i = first; i < out.size(); ++i) {
+                bool repeat = false;
+                for (std::size_t j = kept; j-- > first;) {
+                    const auto& k = out[j];
+                    if (k.a != out[i].a || k.b != out[i].b || out[i].point.x - k.point.x > tol) break;
+                    if (dist(k.point, out[i].point) <= tol) {
+                        repeat = true;
+                        break;
+                    }
+                }
+                if (!repeat) out[kept++] = out[i];
+            }
+            out.resize(kept);
+        }
+
+    } // namespace
+
+    bool IntersectionEngine::shapeOf(const EntityStore& store, EntityId id, Shape& out) {
+        if (!store.contains(id)) return false;
+        const EntityHandle h = store.getHandle(id);
+        const std::uint32_t i = store.indexOf(h);
+        out.id = id;
+        out.points.clear();
+        out.partial = false;
+
+        switch (h.kind) {
+        case EntityKind::Point:
+            return false;
+        case EntityKind::Line: {
+            const auto& lc = store.lines();
+            out.type = Shape::Type::Polyline;
+            out.points.push_back({ lc.ax[i], lc.ay[i] });
+            out.points.push_back({ lc.bx[i], lc.by[i] });
+            return true;
+        }
+        case EntityKind::Circle: {
+            const auto& cc = store.circles();
+            out.type = Shape::Type::Round;
+            out.center = { cc.cx[i], cc.cy[i] };
+            out.r = std::abs(cc.r[i]);
+            return true;
+        }
+        case EntityKind::Arc: {
+            const auto& ac = store.arcs();
+            out.type = Shape::Type::Round;
+            out.center = { ac.cx[i], ac.cy[i] };
+            out.r = std::abs(ac.r[i]);
+            out.partial = true;
+            out.from = std::atan2(ac.sy[i] - ac.cy[i], ac.sx[i] - ac.cx[i]);
+            out.to = std::atan2(ac.ey[i] - ac.cy[i], ac.ex[i] - ac.cx[i]);
+            out.ccw = ac.ccw[i] != 0;
+            return true;
+        }
+        case EntityKind::Ellipse: {
+            const auto& ec = store.ellipses();
+            out.type = Shape::Type::Ellipse;
+            out.center = { ec.cx[i], ec.cy[i] };
+            out.rx = std::abs(ec.rx[i]);
+            out.ry = std::abs(ec.ry[i]);
+            out.cs = std::cos(ec.rotation[i]);
+            out.sn = std::sin(ec.rotation[i]);
+            return out.rx > 0.0 && out.ry > 0.0;
+        }
+        case EntityKind::Curve: {
+            const auto& cps = store.curves().controlPoints[i];
+            if (cps.size() < 2) return false;
+            Box2 box;
+            for (const Vec2& p : cps) box.expand(p);
+            const double size = std::max(box.max.x - box.min.x, box.max.y - box.min.y);
+            out.type = Shape::Type::Polyline;
+            tessellate(BSpline::fromStore(store, i), kCurveFlattening * size, out.points);
+            if (store.curves().closed[i] && out.points.size() > 2 && dist(out.points.front(), out.points.back()) > 0.0) {
+                out.points.push_back(out.points.front());
+            }
+            return out.points.size() >= 2;
+        }
+        }
+        return false;
+    }
+
+    void IntersectionEngine::intersect(const Shape& a, const Shape& b, std::vector<CurveIntersection>& out, double tolerance) {
+        const std::size_t first = out.size();
+        PairTester tester(out, tolerance);
+        const std::uint32_t na = pieceCount(a), nb = pieceCount(b);
+        std::vector<Box2> boxes(nb);
+        for (std::uint32_t pb = 0; pb < nb; ++pb) boxes[pb] = pieceBox(b, pb, tolerance);
+        for (std::uint32_t pa = 0; pa < na; ++pa) {
+            const Box2 box = pieceBox(a, pa, tolerance);
+            for (std::uint32_t pb = 0; pb < nb; ++pb) {
+                if (box.overlaps(boxes[pb])) tester.test(a, pa, b, pb);
+            }
+        }
+        finish(out, first, tolerance);
+    }
+
+    void IntersectionEngine::intersect(const EntityStore& store, EntityId a, EntityId b,
+        std::vector<CurveIntersection>& out, double tolerance) {
+        Shape sa, sb;
+        if (a == b || !shapeOf(store, a, sa) || !shapeOf(store, b, sb)) return;
+        intersect(sa, sb, out, tolerance);
+    }
+
+    void IntersectionEngine::collect(const EntityStore& store, EntityId id, double tolerance) {
+        if (m_shapes.size() == m_shapeCount) m_shapes.emplace_back();
+        Shape& s = m_shapes[m_shapeCount];
+        if (!shapeOf(store, id, s)) return;
+
+        const auto shape = static_cast<std::uint32_t>(m_shapeCount++);
+        if (s.type == Shape::Type::Polyline) {
+            for (std::uint32_t k = 0; k + 1 < s.points.size(); ++k) {
+                m_primitives.push_back({ segmentBox(s.points[k], s.points[k + 1], tolerance), shape, k });
+            }
+        }
+        else {
+            m_primitives.push_back({ grow(store.bounds(store.getHandle(id)), tolerance), shape, 0 });
+        }
+    }
+
+    void IntersectionEngine::findAll(const EntityStore& store, std::vector<CurveIntersection>& out, const IntersectionOptions& options) {
+        out.clear();
+        m_shapeCount = 0;
+        m_primitives.clear();
+        m_pairTests = 0;
+
+        for (std::size_t k = 0; k < kEntityKindCount; ++k) {
+            const auto& headers = store.headers(static_cast<EntityKind>(k));
+            for (std::size_t i = 0; i < headers.size(); ++i) {
+                if (passes(headers.flags[i], options)) collect(store, headers.ids[i], options.tolerance);
+            }
+        }
+
+        // Sweep along x: a primitive stays active until the sweep passes its
+        // right edge, and each new one is tested against the active ones it
+        // overlaps in y.
+        m_order.resize(m_primitives.size());
+        for (std::uint32_t i = 0; i < m_order.size(); ++i) m_order[i] = i;
+        std::sort(m_order.begin(), m_order.end(), [&](std::uint32_t l, std::uint32_t r) {
+            return m_primitives[l].box.min.x < m_primitives[r].box.min.x;
+        });
+
+        PairTester tester(out, options.tolerance);
+        m_active.clear();
+        for (std::uint32_t p : m_order) {
+            const Primitive& P = m_primitives[p];
+            std::size_t live = 0;
+            for (std::uint32_t q : m_active) {
+                const Primitive& Q = m_primitives[q];
+                if (Q.box.max.x < P.box.min.x) continue;
+                m_active[live++] = q;
+                if (Q.shape == P.shape || Q.box.max.y < P.box.min.y || P.box.max.y < Q.box.min.y) continue;
+                ++m_pairTests;
+                tester.test(m_shapes[Q.shape], Q.piece, m_shapes[P.shape], P.piece);
+            }
+            m_active.resize(live);
+            m_active.push_back(p);
+        }
+
+        finish(out, 0, options.tolerance);
+    }
+
+    void IntersectionEngine::findAmong(const EntityStore& store, const std::vector<EntityId>& ids,
+        std::vector<CurveIntersection>& out, const IntersectionOptions& options) {
+        out.clear();
+        m_shapeCount = 0;
+        m_primitives.clear();
+        m_pairTests = 0;
+
+        // The changed entities' primitives first, then only the entities
+        // whose bounds reach them.
+        Box2 reach;
+        std::vector<EntityId> probes;
+        for (EntityId id : ids) {
+            if (!store.contains(id)) continue;
+            const EntityHandle h = store.getHandle(id);
+            if (!passes(store.headers(h.kind).flags[store.indexOf(h)], options)) continue;
+            probes.push_back(id);
+        }
+        std::sort(probes.begin(), probes.end());
+        probes.erase(std::unique(probes.begin(), probes.end()), probes.end());
+        for (EntityId id : probes) {
+            collect(store, id, options.tolerance);
+            reach.expand(grow(store.bounds(store.getHandle(id)), options.tolerance));
+        }
+        const std::size_t probePrimitives = m_primitives.size();
+        if (probePrimitives == 0) return;
+
+        for (std::size_t k = 0; k < kEntityKindCount; ++k) {
+            const auto kind = static_cast<EntityKind>(k);
+            const auto& headers = store.headers(kind);
+            for (std::uint32_t i = 0; i < headers.size(); ++i) {
+                if (!passes(headers.flags[i], options) || std::binary_search(probes.begin(), probes.end(), headers.ids[i])) continue;
+                if (!reach.overlaps(store.bounds(store.handleAt(kind, i)))) continue;
+                collect(store, headers.ids[i], options.tolerance);
+            }
+        }
+
+        PairTester tester(out, options.tolerance);
+        for (std::size_t p = 0; p < probePrimitives; ++p) {
+            const Primitive& P = m_primitives[p];
+            // Probe/probe pairs once (q < p), probe/other pairs all.
+            for (std::size_t q = 0; q < m_primitives.size(); ++q) {
+                if (q >= p && q < probePrimitives) continue;
+                const Primitive& Q = m_primitives[q];
+                if (Q.shape == P.shape || !P.box.overlaps(Q.box)) continue;
+                ++m_pairTests;
+                tester.test(m_shapes[P.shape], P.piece, m_shapes[Q.shape], Q.piece);
+            }
+        }
+
+        finish(out, 0, options.tolerance);
+    }
+
+} // namespace domain::sketch
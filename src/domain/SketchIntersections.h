@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "SketchEntities.h"
+#include "SketchIds.h"
+#include "SketchMath.h"
+
+namespace domain::sketch {
+
+    // One crossing or touching point of two entities, a < b. The parameters
+    // locate the point on each entity, for trimming: lines 0..1 from start to
+    // end, circles and arcs the polar angle about the center, ellipses the
+    // eccentric angle in their own frame, curves the position along their
+    // flattened polyline (segment index + fraction).
+    struct CurveIntersection {
+        EntityId a{};
+        EntityId b{};
+        Vec2 point;
+        double ta{ 0.0 };
+        double tb{ 0.0 };
+    };
+
+    struct IntersectionOptions {
+        std::uint8_t requiredFlags{ flags::Visible }; // entities missing any of these are skipped
+        std::uint8_t excludedFlags{ 0 };              // entities with any of these are skipped
+        double tolerance{ 1e-7 };                     // touching distance; closer hits of one pair merge
+    };
+
+    // Finds all intersections among the entities of a sketch.
+    //
+    // Every entity is split into primitives (segments, circles/arcs, whole
+    // ellipses; curves flattened to a polyline) whose boxes are swept along
+    // x: a primitive is only tested against the active ones whose x-range it
+    // reaches and whose y-range overlaps, so the cost follows the number of
+    // overlapping boxes rather than n^2. Narrow-phase tests are exact except
+    // ellipse against circle/arc/ellipse, which intersects a 64-gon of one
+    // side with the exact other.
+    //
+    // Collinear overlaps report the ends of the shared stretch. The engine
+    // keeps its scratch buffers between runs.
+    class IntersectionEngine {
+    public:
+        void findAll(const EntityStore& store, std::vector<CurveIntersection>& out, const IntersectionOptions& options = {});
+
+        // Only the pairs involving `ids` (each pair once), for updates after a
+        // few entities changed.
+        void findAmong(const EntityStore& store, const std::vector<EntityId>& ids,
+            std::vector<CurveIntersection>& out, const IntersectionOptions& options = {});
+
+        // Intersections of a single pair, appended to `out`.
+        static void intersect(const EntityStore& store, EntityId a, EntityId b,
+            std::vector<CurveIntersection>& out, double tolerance = 1e-7);
+
+        std::size_t lastPairTests() const { return m_pairTests; }
+
+        // An entity as the narrow phase sees it; points have none.
+        struct Shape {
+            enum class Type : std::uint8_t { Polyline, Round, Ellipse };
+
+            Type type{ Type::Polyline };
+            EntityId id{};
+            std::vector<Vec2> points;            // polyline vertices; closed curves repeat the first
+            Vec2 center;
+            double r{ 0.0 };                     // round
+            double from{ 0.0 }, to{ 0.0 };       // arc sweep, when partial
+            bool partial{ false };
+            bool ccw{ true };
+            double rx{ 0.0 }, ry{ 0.0 };         // ellipse semi-axes
+            double cs{ 1.0 }, sn{ 0.0 };         // ellipse rotation
+        };
+
+        static bool shapeOf(const EntityStore& store, EntityId id, Shape& out);
+        static void intersect(const Shape& a, const Shape& b, std::vector<CurveIntersection>& out, double tolerance = 1e-7);
+
+    private:
+        struct Primitive {
+            Box2 box;
+            std::uint32_t shape{ 0 };
+            std::uint32_t piece{ 0 }; // polyline segment index; 0 otherwise
+        };
+
+        std::vector<Shape> m_shapes;  // the first m_shapeCount are in use; the rest keep their buffers
+        std::size_t m_shapeCount{ 0 };
+        std::vector<Primitive> m_primitives;
+        std::vector<std::uint32_t> m_order;
+        std::vector<std::uint32_t> m_active;
+        std::size_t m_pairTests{ 0 };
+
+        void collect(const EntityStore& store, EntityId id, double tolerance);
+    };
+
+} // namespace domain::sketch
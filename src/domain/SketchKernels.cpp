@@ -0,0 +1,243 @@
+#include "SketchKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SKETCH_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX instructions inside functions marked for it;
+// MSVC accepts the intrinsics anywhere.
+#if defined(SKETCH_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SKETCH_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SKETCH_TARGET_AVX2
+#endif
+
+namespace domain::sketch::kernels {
+
+    namespace {
+
+        enum class Isa { Scalar, Sse2, Avx2 };
+
+        Isa detect() {
+#if defined(SKETCH_KERNELS_X86)
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            const int maxLeaf = info[0];
+            __cpuid(info, 1);
+            const bool sse2 = (info[3] & (1 << 26)) != 0;
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            bool avx2 = false;
+            if (maxLeaf >= 7 && osxsave && (_xgetbv(0) & 0x6) == 0x6) {
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] & (1 << 5)) != 0;
+            }
+#else
+            __builtin_cpu_init();
+            const bool sse2 = __builtin_cpu_supports("sse2");
+            const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+            if (avx2) return Isa::Avx2;
+            if (sse2) return Isa::Sse2;
+#endif
+            return Isa::Scalar;
+        }
+
+        Isa isa() {
+            static const Isa selected = detect();
+            return selected;
+        }
+
+        // ---- scalar (also the tail of every vector loop) ----
+
+        void transformScalar(double* x, double* y, std::size_t begin, std::size_t n, const Transform2& t) {
+            for (std::size_t i = begin; i < n; ++i) {
+                const double px = x[i];
+                const double py = y[i];
+                x[i] = t.a * px + t.b * py + t.t.x;
+                y[i] = t.c * px + t.d * py + t.t.y;
+            }
+        }
+
+        void boundsScalar(const double* x, const double* y, std::size_t begin, std::size_t n, Box2& box) {
+            for (std::size_t i = begin; i < n; ++i) {
+                box.min.x = std::min(box.min.x, x[i]);
+                box.max.x = std::max(box.max.x, x[i]);
+                box.min.y = std::min(box.min.y, y[i]);
+                box.max.y = std::max(box.max.y, y[i]);
+            }
+        }
+
+        void circlesScalar(const double* cx, const double* cy, const double* r, std::size_t begin, std::size_t n, Box2& box) {
+            for (std::size_t i = begin; i < n; ++i) {
+                const double rr = std::abs(r[i]);
+                box.min.x = std::min(box.min.x, cx[i] - rr);
+                box.max.x = std::max(box.max.x, cx[i] + rr);
+                box.min.y = std::min(box.min.y, cy[i] - rr);
+                box.max.y = std::max(box.max.y, cy[i] + rr);
+            }
+        }
+
+#if defined(SKETCH_KERNELS_X86)
+
+        // ---- SSE2: two doubles per register ----
+
+        void transformSse2(double* x, double* y, std::size_t n, const Transform2& t) {
+            const __m128d a = _mm_set1_pd(t.a), b = _mm_set1_pd(t.b), tx = _mm_set1_pd(t.t.x);
+            const __m128d c = _mm_set1_pd(t.c), d = _mm_set1_pd(t.d), ty = _mm_set1_pd(t.t.y);
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                const __m128d px = _mm_loadu_pd(x + i);
+                const __m128d py = _mm_loadu_pd(y + i);
+                _mm_storeu_pd(x + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(a, px), _mm_mul_pd(b, py)), tx));
+                _mm_storeu_pd(y + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(c, px), _mm_mul_pd(d, py)), ty));
+            }
+            transformScalar(x, y, i, n, t);
+        }
+
+        inline double lowest(__m128d v) { return std::min(_mm_cvtsd_f64(v), _mm_cvtsd_f64(_mm_unpackhi_pd(v, v))); }
+        inline double highest(__m128d v) { return std::max(_mm_cvtsd_f64(v), _mm_cvtsd_f64(_mm_unpackhi_pd(v, v))); }
+
+        void boundsSse2(const double* x, const double* y, std::size_t n, Box2& box) {
+            if (n < 2) {
+                boundsScalar(x, y, 0, n, box);
+                return;
+            }
+            __m128d minX = _mm_set1_pd(box.min.x), maxX = _mm_set1_pd(box.max.x);
+            __m128d minY = _mm_set1_pd(box.min.y), maxY = _mm_set1_pd(box.max.y);
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                const __m128d px = _mm_loadu_pd(x + i);
+                const __m128d py = _mm_loadu_pd(y + i);
+                minX = _mm_min_pd(minX, px); maxX = _mm_max_pd(maxX, px);
+                minY = _mm_min_pd(minY, py); maxY = _mm_max_pd(maxY, py);
+            }
+            box.min.x = lowest(minX); box.max.x = highest(maxX);
+            box.min.y = lowest(minY); box.max.y = highest(maxY);
+            boundsScalar(x, y, i, n, box);
+        }
+
+        void circlesSse2(const double* cx, const double* cy, const double* r, std::size_t n, Box2& box) {
+            const __m128d signMask = _mm_set1_pd(-0.0);
+            __m128d minX = _mm_set1_pd(box.min.x), maxX = _mm_set1_pd(box.max.x);
+            __m128d minY = _mm_set1_pd(box.min.y), maxY = _mm_set1_pd(box.max.y);
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                const __m128d rr = _mm_andnot_pd(signMask, _mm_loadu_pd(r + i));
+                const __m128d px = _mm_loadu_pd(cx + i);
+                const __m128d py = _mm_loadu_pd(cy + i);
+                minX = _mm_min_pd(minX, _mm_sub_pd(px, rr)); maxX = _mm_max_pd(maxX, _mm_add_pd(px, rr));
+                minY = _mm_min_pd(minY, _mm_sub_pd(py, rr)); maxY = _mm_max_pd(maxY, _mm_add_pd(py, rr));
+            }
+            box.min.x = lowest(minX); box.max.x = highest(maxX);
+            box.min.y = lowest(minY); box.max.y = highest(maxY);
+            circlesScalar(cx, cy, r, i, n, box);
+        }
+
+        // ---- AVX2: four doubles per register ----
+
+        SKETCH_TARGET_AVX2 void transformAvx2(double* x, double* y, std::size_t n, const Transform2& t) {
+            const __m256d a = _mm256_set1_pd(t.a), b = _mm256_set1_pd(t.b), tx = _mm256_set1_pd(t.t.x);
+            const __m256d c = _mm256_set1_pd(t.c), d = _mm256_set1_pd(t.d), ty = _mm256_set1_pd(t.t.y);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                const __m256d px = _mm256_loadu_pd(x + i);
+                const __m256d py = _mm256_loadu_pd(y + i);
+                _mm256_storeu_pd(x + i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(a, px), _mm256_mul_pd(b, py)), tx));
+                _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(c, px), _mm256_mul_pd(d, py)), ty));
+            }
+            transformScalar(x, y, i, n, t);
+        }
+
+        SKETCH_TARGET_AVX2 inline __m128d fold(__m256d v, bool wantMin) {
+            const __m128d lo = _mm256_castpd256_pd128(v);
+            const __m128d hi = _mm256_extractf128_pd(v, 1);
+            return wantMin ? _mm_min_pd(lo, hi) : _mm_max_pd(lo, hi);
+        }
+
+        SKETCH_TARGET_AVX2 void boundsAvx2(const double* x, const double* y, std::size_t n, Box2& box) {
+            __m256d minX = _mm256_set1_pd(box.min.x), maxX = _mm256_set1_pd(box.max.x);
+            __m256d minY = _mm256_set1_pd(box.min.y), maxY = _mm256_set1_pd(box.max.y);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                const __m256d px = _mm256_loadu_pd(x + i);
+                const __m256d py = _mm256_loadu_pd(y + i);
+                minX = _mm256_min_pd(minX, px); maxX = _mm256_max_pd(maxX, px);
+                minY = _mm256_min_pd(minY, py); maxY = _mm256_max_pd(maxY, py);
+            }
+            box.min.x = lowest(fold(minX, true)); box.max.x = highest(fold(maxX, false));
+            box.min.y = lowest(fold(minY, true)); box.max.y = highest(fold(maxY, false));
+            boundsScalar(x, y, i, n, box);
+        }
+
+        SKETCH_TARGET_AVX2 void circlesAvx2(const double* cx, const double* cy, const double* r, std::size_t n, Box2& box) {
+            const __m256d signMask = _mm256_set1_pd(-0.0);
+            __m256d minX = _mm256_set1_pd(box.min.x), maxX = _mm256_set1_pd(box.max.x);
+            __m256d minY = _mm256_set1_pd(box.min.y), maxY = _mm256_set1_pd(box.max.y);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                const __m256d rr = _mm256_andnot_pd(signMask, _mm256_loadu_pd(r + i));
+                const __m256d px = _mm256_loadu_pd(cx + i);
+                const __m256d py = _mm256_loadu_pd(cy + i);
+                minX = _mm256_min_pd(minX, _mm256_sub_pd(px, rr)); maxX = _mm256_max_pd(maxX, _mm256_add_pd(px, rr));
+                minY = _mm256_min_pd(minY, _mm256_sub_pd(py, rr)); maxY = _mm256_max_pd(maxY, _mm256_add_pd(py, rr));
+            }
+            box.min.x = lowest(fold(minX, true)); box.max.x = highest(fold(maxX, false));
+            box.min.y = lowest(fold(minY, true)); box.max.y = highest(fold(maxY, false));
+            circlesScalar(cx, cy, r, i, n, box);
+        }
+
+#endif // SKETCH_KERNELS_X86
+
+    } // namespace
+
+    void transformPoints(double* x, double* y, std::size_t n, const Transform2& t) {
+#if defined(SKETCH_KERNELS_X86)
+        switch (isa()) {
+        case Isa::Avx2: transformAvx2(x, y, n, t); return;
+        case Isa::Sse2: transformSse2(x, y, n, t); return;
+        case Isa::Scalar: break;
+        }
+#endif
+        transformScalar(x, y, 0, n, t);
+    }
+
+    void expandBounds(const double* x, const double* y, std::size_t n, Box2& box) {
+#if defined(SKETCH_KERNELS_X86)
+        switch (isa()) {
+        case Isa::Avx2: boundsAvx2(x, y, n, box); return;
+        case Isa::Sse2: boundsSse2(x, y, n, box); return;
+        case Isa::Scalar: break;
+        }
+#endif
+        boundsScalar(x, y, 0, n, box);
+    }
+
+    void expandBoundsCircles(const double* cx, const double* cy, const double* r, std::size_t n, Box2& box) {
+#if defined(SKETCH_KERNELS_X86)
+        switch (isa()) {
+        case Isa::Avx2: circlesAvx2(cx, cy, r, n, box); return;
+        case Isa::Sse2: circlesSse2(cx, cy, r, n, box); return;
+        case Isa::Scalar: break;
+        }
+#endif
+        circlesScalar(cx, cy, r, 0, n, box);
+    }
+
+    const char* instructionSet() {
+        switch (isa()) {
+        case Isa::Avx2: return "avx2";
+        case Isa::Sse2: return "sse2";
+        case Isa::Scalar: break;
+        }
+        return "scalar";
+    }
+
+} // namespace domain::sketch::kernels
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+#include "SketchMath.h"
+
+namespace domain::sketch::kernels {
+
+    // Bulk geometry kernels over structure-of-arrays coordinate columns.
+    // The widest instruction set the CPU supports (AVX2, else SSE2, else
+    // scalar) is picked once at first use, so the default build does not need
+    // /arch or -m flags to get the vector paths.
+
+    // (x[i], y[i]) = t(x[i], y[i]) for i < n, in place.
+    void transformPoints(double* x, double* y, std::size_t n, const Transform2& t);
+
+    // Grows `box` to contain the n points.
+    void expandBounds(const double* x, const double* y, std::size_t n, Box2& box);
+
+    // Grows `box` to contain n circles given as center and radius columns.
+    void expandBoundsCircles(const double* cx, const double* cy, const double* r, std::size_t n, Box2& box);
+
+    // "avx2", "sse2" or "scalar".
+    const char* instructionSet();
+
+} // namespace domain::sketch::kernels
@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+#include <cmath>
+#include <limits>
+
 namespace domain::sketch {
 
     struct Vec2 {
@@ -7,4 +10,81 @@ namespace domain::sketch {
         double y{ 0.0 };
     };
 
+    // Axis-aligned bounding box; default-constructed boxes are empty.
+    struct Box2 {
+        Vec2 min{ std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() };
+        Vec2 max{ -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+
+        bool empty() const { return min.x > max.x || min.y > max.y; }
+
+        void expand(const Vec2& p) {
+            min.x = std::fmin(min.x, p.x); min.y = std::fmin(min.y, p.y);
+            max.x = std::fmax(max.x, p.x); max.y = std::fmax(max.y, p.y);
+        }
+
+        void expand(const Box2& b) {
+            min.x = std::fmin(min.x, b.min.x); min.y = std::fmin(min.y, b.min.y);
+            max.x = std::fmax(max.x, b.max.x); max.y = std::fmax(max.y, b.max.y);
+        }
+
+        bool overlaps(const Box2& b) const {
+            return min.x <= b.max.x && b.min.x <= max.x && min.y <= b.max.y && b.min.y <= max.y;
+        }
+
+        bool contains(const Box2& b) const {
+            return min.x <= b.min.x && b.max.x <= max.x && min.y <= b.min.y && b.max.y <= max.y;
+        }
+    };
+
+    // Similarity transform p' = [a b; c d] p + t: any composition of
+    // translation, rotation, uniform scale and mirror. Circles stay circles,
+    // so radii simply scale by scale().
+    struct Transform2 {
+        double a{ 1.0 }, b{ 0.0 };
+        double c{ 0.0 }, d{ 1.0 };
+        Vec2 t;
+
+        static Transform2 translation(const Vec2& delta) {
+            Transform2 m;
+            m.t = delta;
+            return m;
+        }
+
+        static Transform2 rotation(const Vec2& center, double radians) {
+            const double cs = std::cos(radians);
+            const double sn = std::sin(radians);
+            return about(center, cs, -sn, sn, cs);
+        }
+
+        static Transform2 scaling(const Vec2& center, double factor) {
+            return about(center, factor, 0.0, 0.0, factor);
+        }
+
+        // Reflection across the line through p0 and p1.
+        static Transform2 mirror(const Vec2& p0, const Vec2& p1) {
+            double ux = p1.x - p0.x;
+            double uy = p1.y - p0.y;
+            const double len = std::hypot(ux, uy);
+            if (len > 0.0) { ux /= len; uy /= len; }
+            else { ux = 1.0; uy = 0.0; }
+            return about(p0, 2.0 * ux * ux - 1.0, 2.0 * ux * uy, 2.0 * ux * uy, 2.0 * uy * uy - 1.0);
+        }
+
+        Vec2 apply(const Vec2& p) const { return { a * p.x + b * p.y + t.x, c * p.x + d * p.y + t.y }; }
+
+        double determinant() const { return a * d - b * c; }
+        double scale() const { return std::sqrt(std::abs(determinant())); }
+        bool flips() const { return determinant() < 0.0; }
+
+    private:
+        // Linear part [a b; c d] applied about a fixed point.
+        static Transform2 about(const Vec2& o, double m00, double m01, double m10, double m11) {
+            Transform2 m;
+            m.a = m00; m.b = m01;
+            m.c = m10; m.d = m11;
+            m.t = { o.x - (m00 * o.x + m01 * o.y), o.y - (m10 * o.x + m11 * o.y) };
+            return m;
+        }
+    };
+
 } // namespace domain::sketch
@@ -0,0 +1,633 @@
+#include "SketchRegions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <utility>
+
+namespace domain::sketch {
+
+    namespace {
+
+        using Shape = IntersectionEngine::Shape;
+
+        constexpr double kPi = 3.14159265358979323846;
+        constexpr double kTwoPi = 2.0 * kPi;
+        constexpr double kMaxStep = kTwoPi / 96.0; // flattening step for circles, arcs and ellipses
+
+        double wrapAngle(double a) {
+            a = std::fmod(a, kTwoPi);
+            return a < 0.0 ? a + kTwoPi : a;
+        }
+
+        std::uint64_t mix(std::uint64_t h, std::uint64_t v) {
+            return h ^ (v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2));
+        }
+
+        std::uint64_t bitsOf(double d) {
+            std::uint64_t u;
+            std::memcpy(&u, &d, sizeof u);
+            return u;
+        }
+
+        // Changes whenever the entity's geometry or flags do.
+        std::uint64_t fingerprint(const EntityStore& store, EntityKind kind, std::uint32_t i) {
+            std::uint64_t h = mix(static_cast<std::uint64_t>(kind), store.headers(kind).flags[i]);
+            auto add = [&h](double v) { h = mix(h, bitsOf(v)); };
+            switch (kind) {
+            case EntityKind::Point:
+                break;
+            case EntityKind::Line: {
+                const auto& c = store.lines();
+                add(c.ax[i]); add(c.ay[i]); add(c.bx[i]); add(c.by[i]);
+                break;
+            }
+            case EntityKind::Circle: {
+                const auto& c = store.circles();
+                add(c.cx[i]); add(c.cy[i]); add(c.r[i]);
+                break;
+            }
+            case EntityKind::Arc: {
+                const auto& c = store.arcs();
+                add(c.cx[i]); add(c.cy[i]); add(c.r[i]);
+                add(c.sx[i]); add(c.sy[i]); add(c.ex[i]); add(c.ey[i]);
+                h = mix(h, c.ccw[i]);
+                break;
+            }
+            case EntityKind::Ellipse: {
+                const auto& c = store.ellipses();
+                add(c.cx[i]); add(c.cy[i]); add(c.rx[i]); add(c.ry[i]); add(c.rotation[i]);
+                break;
+            }
+            case EntityKind::Curve: {
+                const auto& c = store.curves();
+                for (const Vec2& p : c.controlPoints[i]) { add(p.x); add(p.y); }
+                for (double k : c.knots[i]) add(k);
+                for (double w : c.weights[i]) add(w);
+                h = mix(mix(h, c.closed[i]), c.degree[i]);
+                break;
+            }
+            }
+            return h;
+        }
+
+        // An entity's shape with a monotone parameter u along it: polyline
+        // position, angle for closed rounds and ellipses, swept angle for arcs.
+        struct Curve {
+            Shape shape;
+            bool closed{ false };
+            double end{ 0.0 };  // open: u runs over [0, end]; closed: the period
+            double sign{ 1.0 }; // arcs: angle = shape.from + sign * u
+
+            bool init() {
+                closed = false;
+                sign = 1.0;
+                switch (shape.type) {
+                case Shape::Type::Polyline:
+                    end = static_cast<double>(shape.points.size() - 1);
+                    closed = shape.points.size() > 2
+                        && shape.points.front().x == shape.points.back().x && shape.points.front().y == shape.points.back().y;
+                    return end > 0.0;
+                case Shape::Type::Round:
+                    if (!shape.partial) {
+                        closed = true;
+                        end = kTwoPi;
+                        return shape.r > 0.0;
+                    }
+                    sign = shape.ccw ? 1.0 : -1.0;
+                    end = wrapAngle(sign * (shape.to - shape.from));
+                    return shape.r > 0.0 && end > 0.0;
+                case Shape::Type::Ellipse:
+                    closed = true;
+                    end = kTwoPi;
+                    return true;
+                }
+                return false;
+            }
+
+            Vec2 at(double u) const {
+                switch (shape.type) {
+                case Shape::Type::Polyline: {
+                    const std::size_t n = shape.points.size() - 1;
+                    if (closed) u = std::fmod(u, end);
+                    const std::size_t k = std::min(static_cast<std::size_t>(std::max(u, 0.0)), n - 1);
+                    const double f = u - static_cast<double>(k);
+                    const Vec2& a = shape.points[k];
+                    const Vec2& b = shape.points[k + 1];
+                    return { a.x + f * (b.x - a.x), a.y + f * (b.y - a.y) };
+                }
+                case Shape::Type::Round: {
+                    const double a = param(u);
+                    return { shape.center.x + shape.r * std::cos(a), shape.center.y + shape.r * std::sin(a) };
+                }
+                case Shape::Type::Ellipse: {
+                    const double lx = shape.rx * std::cos(u);
+                    const double ly = shape.ry * std::sin(u);
+                    return { shape.center.x + shape.cs * lx - shape.sn * ly, shape.center.y + shape.sn * lx + shape.cs * ly };
+                }
+                }
+                return {};
+            }
+
+            // From the intersection parameter.
+            double fromParam(double t) const {
+                if (shape.type == Shape::Type::Polyline) return closed && t >= end ? t - end : t;
+                if (closed) return wrapAngle(t);
+                const double s = wrapAngle(sign * (t - shape.from));
+                if (s <= end) return s;
+                return s - end < kTwoPi - s ? end : 0.0; // just past an end, within tolerance
+            }
+
+            // Back to the intersection parameter, unwrapped.
+            double param(double u) const {
+                return shape.type == Shape::Type::Round && shape.partial ? shape.from + sign * u : u;
+            }
+
+            void sample(double u0, double u1, std::vector<Vec2>& out) const {
+                out.push_back(at(u0));
+                if (shape.type == Shape::Type::Polyline) {
+                    for (double k = std::floor(u0) + 1.0; k < u1; k += 1.0) out.push_back(at(k));
+                }
+                else {
+                    const int n = std::max(2, static_cast<int>(std::ceil((u1 - u0) / kMaxStep)));
+                    for (int j = 1; j < n; ++j) out.push_back(at(u0 + (u1 - u0) * j / n));
+                }
+                out.push_back(at(u1));
+            }
+        };
+
+        struct Edge {
+            std::uint32_t v0{ 0 }, v1{ 0 };
+            std::vector<Vec2> points;
+            RegionEdge ref;
+            bool alive{ true };
+        };
+
+        double polylineLength(const std::vector<Vec2>& pts) {
+            double len = 0.0;
+            for (std::size_t k = 1; k < pts.size(); ++k) len += std::hypot(pts[k].x - pts[k - 1].x, pts[k].y - pts[k - 1].y);
+            return len;
+        }
+
+        // Point a fraction t of the way along a polyline, by length.
+        Vec2 pointAlong(const std::vector<Vec2>& pts, double t) {
+            double left = t * polylineLength(pts);
+            for (std::size_t k = 1; k < pts.size(); ++k) {
+                const Vec2& a = pts[k - 1];
+                const Vec2& b = pts[k];
+                const double len = std::hypot(b.x - a.x, b.y - a.y);
+                if (len > 0.0 && left <= len) {
+                    const double f = left / len;
+                    return { a.x + (b.x - a.x) * f, a.y + (b.y - a.y) * f };
+                }
+                left -= len;
+            }
+            return pts.back();
+        }
+
+        // Whether two edges between the same vertices run along the same path.
+        // Flattened curves are compared at a few points, allowing for the
+        // sampling of each.
+        bool coincident(const Edge& a, const Edge& b, double merge) {
+            const bool flipped = a.v0 != b.v0;
+            const double tol = std::max(4.0 * merge, 1e-3 * polylineLength(a.points));
+            for (double t : { 0.25, 0.5, 0.75 }) {
+                const Vec2 p = pointAlong(a.points, t);
+                const Vec2 q = pointAlong(b.points, flipped ? 1.0 - t : t);
+                if (std::hypot(p.x - q.x, p.y - q.y) > tol) return false;
+            }
+            return true;
+        }
+
+        // Direction leaving the start of a half-edge's polyline.
+        double leavingAngle(const std::vector<Vec2>& pts, bool reversed) {
+            const std::size_t n = pts.size();
+            const Vec2& o = reversed ? pts[n - 1] : pts[0];
+            for (std::size_t k = 1; k < n; ++k) {
+                const Vec2& p = reversed ? pts[n - 1 - k] : pts[k];
+                if (p.x != o.x || p.y != o.y) return std::atan2(p.y - o.y, p.x - o.x);
+            }
+            return 0.0;
+        }
+
+        bool insidePolygon(const std::vector<Vec2>& poly, const Vec2& p) {
+            bool inside = false;
+            for (std::size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
+                const Vec2& a = poly[i];
+                const Vec2& b = poly[j];
+                if ((a.y > p.y) != (b.y > p.y) && p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x) inside = !inside;
+            }
+            return inside;
+        }
+
+    } // namespace
+
+    RegionDetector::RegionDetector(const RegionOptions& options) : m_options(options) {}
+
+    void RegionDetector::invalidate() {
+        m_valid = false;
+    }
+
+    // Whether `hole` (a component's outer boundary) lies inside `face` of another component.
+    bool RegionDetector::encloses(std::uint64_t face, std::uint64_t hole) const {
+        const LoopRef& f = m_loops.at(face);
+        const LoopRef& h = m_loops.at(hole);
+        if (f.component == h.component || f.loop->area <= -h.loop->area) return false;
+        // Components do not touch, so any boundary point is strictly inside or outside.
+        const Vec2& p = h.loop->polygon.front();
+        const Box2& box = f.loop->box;
+        if (p.x < box.min.x || p.x > box.max.x || p.y < box.min.y || p.y > box.max.y) return false;
+        return insidePolygon(f.loop->polygon, p);
+    }
+
+    const std::vector<Region>& RegionDetector::update(const EntityStore& store) {
+        if (m_valid && &store == m_store && store.version() == m_storeVersion) {
+            m_lastRetraced = 0;
+            return m_regions;
+        }
+        m_store = &store;
+        m_storeVersion = store.version();
+
+        IntersectionOptions filter;
+        filter.requiredFlags = flags::Visible;
+        filter.excludedFlags = flags::Construction;
+        filter.tolerance = m_options.tolerance;
+
+        std::unordered_map<EntityId, std::uint64_t> prints;
+        prints.reserve(m_fingerprints.size());
+        for (std::size_t k = 0; k < kEntityKindCount; ++k) {
+            const auto kind = static_cast<EntityKind>(k);
+            if (kind == EntityKind::Point) continue;
+            const auto& headers = store.headers(kind);
+            for (std::uint32_t i = 0; i < headers.size(); ++i) {
+                const std::uint8_t f = headers.flags[i];
+                if ((f & filter.requiredFlags) != filter.requiredFlags || (f & filter.excludedFlags) != 0) continue;
+                prints.emplace(headers.ids[i], fingerprint(store, kind, i));
+            }
+        }
+
+        // What changed since the last update: added, moved or removed.
+        std::vector<EntityId> changed;
+        if (m_valid) {
+            for (const auto& [id, print] : prints) {
+                auto it = m_fingerprints.find(id);
+                if (it == m_fingerprints.end() || it->second != print) changed.push_back(id);
+            }
+            for (const auto& [id, print] : m_fingerprints) {
+                if (prints.find(id) == prints.end()) changed.push_back(id);
+            }
+            if (changed.empty()) {
+                m_lastRetraced = 0;
+                return m_regions;
+            }
+            std::sort(changed.begin(), changed.end());
+
+            auto involves = [&](const CurveIntersection& h) {
+                return std::binary_search(changed.begin(), changed.end(), h.a) || std::binary_search(changed.begin(), changed.end(), h.b);
+            };
+            m_hits.erase(std::remove_if(m_hits.begin(), m_hits.end(), involves), m_hits.end());
+            std::vector<CurveIntersection> fresh;
+            m_engine.findAmong(store, changed, fresh, filter);
+            m_hits.insert(m_hits.end(), fresh.begin(), fresh.end());
+        }
+        else {
+            m_engine.findAll(store, m_hits, filter);
+            m_components.clear();
+            m_loops.clear();
+            m_holeIn.clear();
+            m_faceIndex.clear();
+        }
+        m_fingerprints = std::move(prints);
+
+        // Connected components over the intersections.
+        std::vector<EntityId> ids;
+        ids.reserve(m_fingerprints.size());
+        for (const auto& [id, print] : m_fingerprints) ids.push_back(id);
+        std::sort(ids.begin(), ids.end());
+        std::unordered_map<EntityId, std::uint32_t> slot;
+        slot.reserve(ids.size());
+        for (std::uint32_t i = 0; i < ids.size(); ++i) slot.emplace(ids[i], i);
+
+        std::vector<std::uint32_t> parent(ids.size());
+        std::iota(parent.begin(), parent.end(), 0u);
+        auto root = [&parent](std::uint32_t i) {
+            while (parent[i] != i) i = parent[i] = parent[parent[i]];
+            return i;
+        };
+        std::unordered_map<EntityId, std::vector<std::size_t>> hitsOf;
+        for (std::size_t h = 0; h < m_hits.size(); ++h) {
+            const auto& hit = m_hits[h];
+            const std::uint32_t a = root(slot.at(hit.a)), b = root(slot.at(hit.b));
+            parent[std::max(a, b)] = std::min(a, b);
+            hitsOf[hit.a].push_back(h);
+            hitsOf[hit.b].push_back(h);
+        }
+
+        std::vector<Component> components;
+        std::vector<std::uint32_t> componentOf(ids.size(), 0);
+        for (std::uint32_t i = 0; i < ids.size(); ++i) {
+            const std::uint32_t r = root(i);
+            if (r == i) {
+                componentOf[i] = static_cast<std::uint32_t>(components.size());
+                components.emplace_back();
+            }
+            else {
+                componentOf[i] = componentOf[r]; // roots are the smallest index, so seen first
+            }
+            components[componentOf[i]].ids.push_back(ids[i]);
+        }
+
+        // Unchanged components keep their loops.
+        std::unordered_map<EntityId, std::size_t> previous;
+        for (std::size_t c = 0; c < m_components.size(); ++c) previous.emplace(m_components[c].ids.front(), c);
+
+        std::vector<char> reused(m_components.size(), 0);
+        std::vector<std::uint64_t> added;
+        m_lastRetraced = 0;
+        for (Component& comp : components) {
+            const bool touched = !m_valid || std::any_of(comp.ids.begin(), comp.ids.end(),
+                [&](EntityId id) { return std::binary_search(changed.begin(), changed.end(), id); });
+            if (!touched) {
+                auto it = previous.find(comp.ids.front());
+                if (it != previous.end() && m_components[it->second].ids == comp.ids) {
+                    // Moving the vectors keeps the loops where m_loops points.
+                    comp.loops = std::move(m_components[it->second].loops);
+                    comp.keys = std::move(m_components[it->second].keys);
+                    reused[it->second] = 1;
+                    continue;
+                }
+            }
+            comp.loops = trace(store, comp.ids, hitsOf);
+            for (std::size_t l = 0; l < comp.loops.size(); ++l) {
+                comp.keys.push_back(m_nextKey);
+                added.push_back(m_nextKey++);
+            }
+            ++m_lastRetraced;
+        }
+
+        std::vector<std::uint64_t> removed;
+        for (std::size_t c = 0; c < m_components.size(); ++c) {
+            if (!reused[c]) removed.insert(removed.end(), m_components[c].keys.begin(), m_components[c].keys.end());
+        }
+        for (std::uint64_t key : removed) {
+            auto it = m_loops.find(key);
+            if (it->second.loop->area > 0.0) m_faceIndex.remove(key);
+            m_loops.erase(it);
+        }
+        m_components = std::move(components);
+        for (const Component& comp : m_components) {
+            for (std::size_t l = 0; l < comp.loops.size(); ++l) m_loops[comp.keys[l]] = { &comp.loops[l], comp.ids.front() };
+        }
+
+        nest(removed, added, !m_valid);
+        m_valid = true;
+        ++m_version;
+        return m_regions;
+    }
+
+    std::vector<RegionLoop> RegionDetector::trace(const EntityStore& store, const std::vector<EntityId>& ids,
+        const std::unordered_map<EntityId, std::vector<std::size_t>>& hitsOf) const {
+        const double merge = m_options.mergeDistance;
+
+        // Vertices: split points merged within `merge`, through a hash grid.
+        std::vector<Vec2> vertices;
+        std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> grid;
+        auto cellOf = [merge](double v) { return static_cast<std::int64_t>(std::floor(v / merge)); };
+        auto key = [](std::int64_t x, std::int64_t y) {
+            return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+        };
+        auto vertexAt = [&](const Vec2& p) {
+            const std::int64_t cx = cellOf(p.x), cy = cellOf(p.y);
+            for (std::int64_t x = cx - 1; x <= cx + 1; ++x) {
+                for (std::int64_t y = cy - 1; y <= cy + 1; ++y) {
+                    auto it = grid.find(key(x, y));
+                    if (it == grid.end()) continue;
+                    for (std::uint32_t v : it->second) {
+                        if (std::hypot(vertices[v].x - p.x, vertices[v].y - p.y) <= merge) return v;
+                    }
+                }
+            }
+            const auto v = static_cast<std::uint32_t>(vertices.size());
+            vertices.push_back(p);
+            grid[key(cx, cy)].push_back(v);
+            return v;
+        };
+
+        // Edges: each entity cut at its splits (plus its ends, if open).
+        struct Split {
+            double u;
+            Vec2 p;
+        };
+        std::vector<Edge> edges;
+        std::vector<Split> splits;
+        Curve curve;
+        for (EntityId id : ids) {
+            if (!IntersectionEngine::shapeOf(store, id, curve.shape) || !curve.init()) continue;
+
+            splits.clear();
+            auto it = hitsOf.find(id);
+            if (it != hitsOf.end()) {
+                for (std::size_t h : it->second) {
+                    const CurveIntersection& hit = m_hits[h];
+                    splits.push_back({ curve.fromParam(hit.a == id ? hit.ta : hit.tb), hit.point });
+                }
+            }
+            if (!curve.closed) {
+                splits.push_back({ 0.0, curve.at(0.0) });
+                splits.push_back({ curve.end, curve.at(curve.end) });
+            }
+            else if (splits.empty()) {
+                splits.push_back({ 0.0, curve.at(0.0) });
+            }
+            std::sort(splits.begin(), splits.end(), [](const Split& a, const Split& b) { return a.u < b.u; });
+
+            std::vector<std::uint32_t> verts(splits.size());
+            for (std::size_t k = 0; k < splits.size(); ++k) verts[k] = vertexAt(splits[k].p);
+
+            const std::size_t count = curve.closed ? splits.size() : splits.size() - 1;
+            for (std::size_t k = 0; k < count; ++k) {
+                const std::size_t n = (k + 1) % splits.size();
+                const double u0 = splits[k].u;
+                const double u1 = n > k ? splits[n].u : splits[n].u + curve.end;
+
+                Edge e;
+                e.v0 = verts[k];
+                e.v1 = verts[n];
+                curve.sample(u0, u1, e.points);
+                e.points.front() = vertices[e.v0];
+                e.points.back() = vertices[e.v1];
+                if (e.v0 == e.v1 && polylineLength(e.points) <= 4.0 * merge) continue; // repeated split
+                e.ref = { id, curve.param(u0), curve.param(u1) };
+                edges.push_back(std::move(e));
+            }
+        }
+
+        // Coincident edges (a line drawn twice, or a shorter one lying along
+        // another) leave each end at the same angle, and the sort below would
+        // order the tie differently at the two ends, joining faces that are
+        // not adjacent. Keep one edge of each such group.
+        std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> between;
+        for (std::uint32_t e = 0; e < edges.size(); ++e) {
+            const std::uint32_t lo = std::min(edges[e].v0, edges[e].v1);
+            const std::uint32_t hi = std::max(edges[e].v0, edges[e].v1);
+            auto& same = between[(static_cast<std::uint64_t>(lo) << 32) | hi];
+            for (std::uint32_t kept : same) {
+                if (coincident(edges[kept], edges[e], merge)) {
+                    edges[e].alive = false;
+                    break;
+                }
+            }
+            if (edges[e].alive) same.push_back(e);
+        }
+
+        // Prune dangling chains: they bound no face.
+        std::vector<std::vector<std::uint32_t>> incident(vertices.size());
+        std::vector<std::uint32_t> degree(vertices.size(), 0);
+        for (std::uint32_t e = 0; e < edges.size(); ++e) {
+            if (!edges[e].alive) continue;
+            incident[edges[e].v0].push_back(e);
+            incident[edges[e].v1].push_back(e);
+            ++degree[edges[e].v0];
+            ++degree[edges[e].v1];
+        }
+        std::vector<std::uint32_t> leaves;
+        for (std::uint32_t v = 0; v < vertices.size(); ++v) {
+            if (degree[v] == 1) leaves.push_back(v);
+        }
+        while (!leaves.empty()) {
+            const std::uint32_t v = leaves.back();
+            leaves.pop_back();
+            for (std::uint32_t e : incident[v]) {
+                if (!edges[e].alive) continue;
+                edges[e].alive = false;
+                const std::uint32_t other = edges[e].v0 == v ? edges[e].v1 : edges[e].v0;
+                --degree[v];
+                if (--degree[other] == 1) leaves.push_back(other);
+                break;
+            }
+        }
+
+        // Half-edge h = 2e runs v0 -> v1, h ^ 1 back. Outgoing half-edges of
+        // each vertex sorted counter-clockwise by leaving direction.
+        const std::size_t halfCount = 2 * edges.size();
+        std::vector<std::vector<std::uint32_t>> outgoing(vertices.size());
+        std::vector<double> angle(halfCount, 0.0);
+        std::vector<std::uint32_t> position(halfCount, 0);
+        auto origin = [&](std::uint32_t h) { return (h & 1u) ? edges[h >> 1].v1 : edges[h >> 1].v0; };
+        for (std::uint32_t e = 0; e < edges.size(); ++e) {
+            if (!edges[e].alive) continue;
+            for (std::uint32_t h : { 2 * e, 2 * e + 1 }) {
+                angle[h] = leavingAngle(edges[e].points, (h & 1u) != 0);
+                outgoing[origin(h)].push_back(h);
+            }
+        }
+        for (auto& out : outgoing) {
+            std::sort(out.begin(), out.end(), [&](std::uint32_t a, std::uint32_t b) { return angle[a] < angle[b]; });
+            for (std::uint32_t k = 0; k < out.size(); ++k) position[out[k]] = k;
+        }
+
+        // Walk each face keeping it on the left: from the twin of the arriving
+        // half-edge, turn to the next outgoing one clockwise.
+        std::vector<RegionLoop> loops;
+        std::vector<char> visited(halfCount, 0);
+        for (std::uint32_t start = 0; start < halfCount; ++start) {
+            if (visited[start] || !edges[start >> 1].alive) continue;
+
+            RegionLoop loop;
+            std::uint32_t h = start;
+            do {
+                visited[h] = 1;
+                const Edge& e = edges[h >> 1];
+                const bool reversed = (h & 1u) != 0;
+                loop.edges.push_back(reversed ? RegionEdge{ e.ref.entity, e.ref.to, e.ref.from } : e.ref);
+                const std::size_t n = e.points.size();
+                for (std::size_t k = 0; k + 1 < n; ++k) loop.polygon.push_back(reversed ? e.points[n - 1 - k] : e.points[k]);
+
+                const std::uint32_t twin = h ^ 1u;
+                const auto& out = outgoing[origin(twin)];
+                h = out[(position[twin] + out.size() - 1) % out.size()];
+            } while (h != start);
+
+            for (std::size_t i = 0, j = loop.polygon.size() - 1; i < loop.polygon.size(); j = i++) {
+                loop.area += (loop.polygon[j].x * loop.polygon[i].y - loop.polygon[i].x * loop.polygon[j].y);
+                loop.box.expand(loop.polygon[i]);
+            }
+            loop.area *= 0.5;
+            if (std::abs(loop.area) > merge * merge) loops.push_back(std::move(loop));
+        }
+        return loops;
+    }
+
+    void RegionDetector::nest(const std::vector<std::uint64_t>& removed, const std::vector<std::uint64_t>& added, bool full) {
+        // Holes to place: new ones, and those whose face went away.
+        std::vector<std::uint64_t> pending;
+        for (std::uint64_t key : removed) m_holeIn.erase(key);
+        if (!removed.empty()) {
+            for (auto& [hole, face] : m_holeIn) {
+                if (face != 0 && m_loops.find(face) == m_loops.end()) {
+                    face = 0;
+                    pending.push_back(hole);
+                }
+            }
+        }
+
+        std::vector<std::uint64_t> newFaces;
+        for (std::uint64_t key : added) {
+            const RegionLoop& loop = *m_loops.at(key).loop;
+            if (loop.area > 0.0) {
+                m_faceIndex.insert(key, loop.box);
+                newFaces.push_back(key);
+            }
+            else {
+                m_holeIn[key] = 0;
+                pending.push_back(key);
+            }
+        }
+
+        // A new face may be a tighter fit for a hole that is already placed.
+        // With many new faces, placing every hole again is cheaper.
+        constexpr std::size_t kRecheckLimit = 16;
+        if (full || newFaces.size() > kRecheckLimit) {
+            pending.clear();
+            for (auto& [hole, face] : m_holeIn) pending.push_back(hole);
+        }
+        else if (!newFaces.empty()) {
+            for (auto& [hole, face] : m_holeIn) {
+                for (std::uint64_t f : newFaces) {
+                    if ((face == 0 || m_loops.at(f).loop->area < m_loops.at(face).loop->area) && encloses(f, hole)) face = f;
+                }
+            }
+        }
+
+        for (std::uint64_t hole : pending) {
+            const Vec2& p = m_loops.at(hole).loop->polygon.front();
+            Box2 at;
+            at.expand(p);
+            std::uint64_t best = 0;
+            m_faceIndex.query(at, [&](EntityId face, const Box2&) {
+                if (best != 0 && m_loops.at(face).loop->area >= m_loops.at(best).loop->area) return;
+                if (encloses(face, hole)) best = face;
+            });
+            m_holeIn[hole] = best;
+        }
+
+        m_regions.clear();
+        std::unordered_map<std::uint64_t, std::size_t> regionOf;
+        for (const Component& comp : m_components) {
+            for (std::size_t l = 0; l < comp.loops.size(); ++l) {
+                if (comp.loops[l].area <= 0.0) continue;
+                regionOf.emplace(comp.keys[l], m_regions.size());
+                m_regions.push_back({ &comp.loops[l], {} });
+            }
+        }
+        for (const Component& comp : m_components) {
+            for (std::size_t l = 0; l < comp.loops.size(); ++l) {
+                if (comp.loops[l].area > 0.0) continue;
+                const std::uint64_t face = m_holeIn.at(comp.keys[l]);
+                if (face != 0) m_regions[regionOf.at(face)].holes.push_back(&comp.loops[l]);
+            }
+        }
+    }
+
+} // namespace domain::sketch
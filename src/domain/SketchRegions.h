@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "SketchEntities.h"
+#include "SketchIds.h"
+#include "SketchIntersections.h"
+#include "SketchMath.h"
+#include "SketchSpatialIndex.h"
+
+namespace domain::sketch {
+
+    // A piece of an entity on a region boundary, traversed from `from` to
+    // `to` in the entity's intersection parameter (see CurveIntersection).
+    // Angles are unwrapped, so to - from gives both direction and extent.
+    struct RegionEdge {
+        EntityId entity{};
+        double from{ 0.0 };
+        double to{ 0.0 };
+    };
+
+    struct RegionLoop {
+        std::vector<RegionEdge> edges;
+        std::vector<Vec2> polygon; // flattened boundary, not repeating the first point
+        double area{ 0.0 };        // signed: outer loops counter-clockwise, holes clockwise
+        Box2 box;
+    };
+
+    // A bounded face of the sketch's planar arrangement. The loops belong to
+    // the RegionDetector and stay valid until its next update().
+    struct Region {
+        const RegionLoop* outer{ nullptr };
+        std::vector<const RegionLoop*> holes;
+    };
+
+    struct RegionOptions {
+        double tolerance{ 1e-7 };     // intersection touching distance
+        double mergeDistance{ 1e-6 }; // curve ends and crossings closer than this share a vertex
+    };
+
+    // Closed profiles formed by the visible, non-construction entities.
+    //
+    // Entities are split at their intersections into the edges of a
+    // half-edge graph; dangling chains are pruned, and walking each face
+    // with its interior on the left gives counter-clockwise loops for the
+    // bounded faces and one clockwise loop around each connected component.
+    // A component's clockwise loop is a hole of the smallest face of another
+    // component that contains it.
+    //
+    // update() fingerprints the entities and redoes only what changed: the
+    // intersections of changed entities are found against the rest (the
+    // others stay cached), only components whose entities changed are
+    // re-traced, and only holes that are new, lost their face or may have a
+    // new, tighter one are placed again. An unchanged store version returns
+    // the cached regions straight away.
+    class RegionDetector {
+    public:
+        explicit RegionDetector(const RegionOptions& options = {});
+
+        const std::vector<Region>& update(const EntityStore& store);
+        void invalidate();
+
+        const std::vector<Region>& regions() const { return m_regions; }
+        // Bumped whenever update() produced new regions.
+        std::uint64_t version() const { return m_version; }
+        // Components re-traced by the last update().
+        std::size_t lastRetraced() const { return m_lastRetraced; }
+
+    private:
+        struct Component {
+            std::vector<EntityId> ids; // sorted
+            std::vector<RegionLoop> loops;
+            std::vector<std::uint64_t> keys; // per loop, stable while the component is reused
+        };
+
+        struct LoopRef {
+            const RegionLoop* loop{ nullptr };
+            EntityId component{}; // the component's first entity
+        };
+
+        RegionOptions m_options;
+        IntersectionEngine m_engine;
+
+        std::unordered_map<EntityId, std::uint64_t> m_fingerprints; // entities taking part
+        std::vector<CurveIntersection> m_hits;
+        std::vector<Component> m_components;
+        std::vector<Region> m_regions;
+
+        std::unordered_map<std::uint64_t, LoopRef> m_loops;        // by key
+        std::unordered_map<std::uint64_t, std::uint64_t> m_holeIn; // hole key -> face key, 0 if none
+        SpatialIndex m_faceIndex{ 0.0 };                           // faces by key
+        std::uint64_t m_nextKey{ 1 };
+        std::uint64_t m_version{ 0 };
+        const EntityStore* m_store{ nullptr };
+        std::uint64_t m_storeVersion{ 0 };
+        std::size_t m_lastRetraced{ 0 };
+        bool m_valid{ false };
+
+        std::vector<RegionLoop> trace(const EntityStore& store, const std::vector<EntityId>& ids,
+            const std::unordered_map<EntityId, std::vector<std::size_t>>& hitsOf) const;
+        bool encloses(std::uint64_t face, std::uint64_t hole) const;
+        void nest(const std::vector<std::uint64_t>& removed, const std::vector<std::uint64_t>& added, bool full);
+    };
+
+} // namespace domain::sketch
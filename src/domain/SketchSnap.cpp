@@ -0,0 +1,532 @@
+#include "SketchSnap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "SketchSpline.h"
+
+namespace domain::sketch {
+
+    namespace {
+
+        constexpr double kPi = 3.14159265358979323846;
+        constexpr double kTwoPi = 2.0 * kPi;
+        constexpr double kEps = 1e-12;
+
+        constexpr std::size_t kMaxEntityCells = 256; // beyond this an entity goes on the oversized list
+        constexpr std::size_t kAlignScan = 64;       // sorted neighbours examined per alignment axis
+
+        double dist(const Vec2& a, const Vec2& b) { return std::hypot(a.x - b.x, a.y - b.y); }
+        bool samePoint(const Vec2& a, const Vec2& b) { return dist(a, b) <= 1e-9 * (1.0 + std::abs(b.x) + std::abs(b.y)); }
+
+        bool onSweep(double from, double to, double angle, bool ccw) {
+            auto wrap = [](double a) {
+                a = std::fmod(a, kTwoPi);
+                return a < 0.0 ? a + kTwoPi : a;
+            };
+            if (!ccw) std::swap(from, to);
+            return wrap(angle - from) <= wrap(to - from);
+        }
+
+        // A circle, or an arc of one.
+        struct Round {
+            Vec2 c;
+            double r{ 0.0 };
+            bool partial{ false }; // arc: only [from, to] in direction ccw
+            double from{ 0.0 }, to{ 0.0 };
+            bool ccw{ true };
+
+            bool covers(const Vec2& p) const {
+                return !partial || onSweep(from, to, std::atan2(p.y - c.y, p.x - c.x), ccw);
+            }
+        };
+
+        Round roundOf(const EntityStore& store, EntityHandle h) {
+            Round s;
+            const std::uint32_t i = store.indexOf(h);
+            if (h.kind == EntityKind::Circle) {
+                const auto& cc = store.circles();
+                s.c = { cc.cx[i], cc.cy[i] };
+                s.r = std::abs(cc.r[i]);
+            }
+            else {
+                const auto& ac = store.arcs();
+                s.partial = true;
+                s.c = { ac.cx[i], ac.cy[i] };
+                s.r = std::abs(ac.r[i]);
+                s.from = std::atan2(ac.sy[i] - ac.cy[i], ac.sx[i] - ac.cx[i]);
+                s.to = std::atan2(ac.ey[i] - ac.cy[i], ac.ex[i] - ac.cx[i]);
+                s.ccw = ac.ccw[i] != 0;
+            }
+            return s;
+        }
+
+        // Candidates are ranked by distance, with a kind's priority worth a
+        // tenth of the capture radius per step.
+        double score(const SnapCandidate& c, double radius) {
+            return c.distance + static_cast<double>(c.kind) * 0.1 * radius;
+        }
+
+        bool isPointAnchor(EntityAnchor a) {
+            return a != EntityAnchor::None && a != EntityAnchor::LineMid;
+        }
+
+    } // namespace
+
+    // ---- grid ----
+
+    std::int64_t SnapEngine::cellCoord(double v) const {
+        return static_cast<std::int64_t>(std::floor(v / m_cell));
+    }
+
+    std::uint64_t SnapEngine::cellKey(std::int64_t cx, std::int64_t cy) const {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) | static_cast<std::uint32_t>(cy);
+    }
+
+    void SnapEngine::clear() {
+        m_grid.clear();
+        m_entities.clear();
+        m_oversized.clear();
+        m_points.clear();
+        m_freePoints.clear();
+        m_intersectionCount = 0;
+        m_byX.clear();
+        m_byY.clear();
+        m_axesDirty = true;
+    }
+
+    void SnapEngine::build(const EntityStore& store, double cellSize) {
+        clear();
+
+        if (cellSize <= 0.0) {
+            // About two entities per cell if they were spread evenly.
+            const Box2 all = store.bounds();
+            const double w = all.empty() ? 0.0 : all.max.x - all.min.x;
+            const double h = all.empty() ? 0.0 : all.max.y - all.min.y;
+            const double area = std::max(w * h, std::max(w, h) * std::max(w, h) * 1e-3);
+            cellSize = store.size() > 0 ? std::sqrt(2.0 * area / static_cast<double>(store.size())) : 1.0;
+            if (!(cellSize > 0.0) || !std::isfinite(cellSize)) cellSize = 1.0;
+        }
+        m_cell = cellSize;
+
+        m_entities.reserve(store.size());
+        for (std::size_t k = 0; k < kEntityKindCount; ++k) {
+            for (EntityId id : store.headers(static_cast<EntityKind>(k)).ids) addEntity(store, id);
+        }
+
+        IntersectionEngine engine;
+        std::vector<CurveIntersection> hits;
+        engine.findAll(store, hits);
+        for (const CurveIntersection& hit : hits) addIntersection(hit);
+    }
+
+    void SnapEngine::refresh(const EntityStore& store, EntityId id) {
+        removeEntity(id);
+        if (!store.contains(id)) return;
+        addEntity(store, id);
+        if (m_entities.count(id)) intersectWithNeighbours(store, id);
+    }
+
+    std::uint32_t SnapEngine::addPoint(const SnapPoint& sp) {
+        std::uint32_t i;
+        if (!m_freePoints.empty()) {
+            i = m_freePoints.back();
+            m_freePoints.pop_back();
+            m_points[i] = sp;
+        }
+        else {
+            i = static_cast<std::uint32_t>(m_points.size());
+            m_points.push_back(sp);
+        }
+        m_grid[cellKey(cellCoord(sp.p.x), cellCoord(sp.p.y))].points.push_back(i);
+        m_axesDirty = true;
+        return i;
+    }
+
+    void SnapEngine::removePoint(std::uint32_t i) {
+        SnapPoint& sp = m_points[i];
+        auto it = m_grid.find(cellKey(cellCoord(sp.p.x), cellCoord(sp.p.y)));
+        if (it != m_grid.end()) {
+            auto& pts = it->second.points;
+            auto at = std::find(pts.begin(), pts.end(), i);
+            if (at != pts.end()) {
+                *at = pts.back();
+                pts.pop_back();
+            }
+            if (pts.empty() && it->second.entities.empty()) m_grid.erase(it);
+        }
+        if (sp.kind == SnapKind::Intersection) --m_intersectionCount;
+        sp.live = false;
+        m_freePoints.push_back(i);
+        m_axesDirty = true;
+    }
+
+    void SnapEngine::addEntity(const EntityStore& store, EntityId id) {
+        const EntityHandle h = store.getHandle(id);
+        const std::uint32_t i = store.indexOf(h);
+        if (!store.headers(h.kind).visible(i)) return;
+
+        EntityEntry& entry = m_entities[id];
+        entry.box = store.bounds(h);
+
+        auto add = [&](const Vec2& p, SnapKind kind, EntityAnchor anchor) {
+            entry.points.push_back(addPoint({ p, kind, { id, anchor }, {}, true }));
+        };
+        auto quadrants = [&](const Vec2& c, double r, const Round* sweep) {
+            const Vec2 qs[4] = { { c.x + r, c.y }, { c.x, c.y + r }, { c.x - r, c.y }, { c.x, c.y - r } };
+            for (const Vec2& q : qs) {
+                if (!sweep || sweep->covers(q)) add(q, SnapKind::Quadrant, EntityAnchor::None);
+            }
+        };
+
+        switch (h.kind) {
+        case EntityKind::Point:
+            add({ store.points().x[i], store.points().y[i] }, SnapKind::Endpoint, EntityAnchor::Point);
+            break;
+        case EntityKind::Line: {
+            const auto& lc = store.lines();
+            const Vec2 a{ lc.ax[i], lc.ay[i] };
+            const Vec2 b{ lc.bx[i], lc.by[i] };
+            add(a, SnapKind::Endpoint, EntityAnchor::LineStart);
+            add(b, SnapKind::Endpoint, EntityAnchor::LineEnd);
+            add({ 0.5 * (a.x + b.x), 0.5 * (a.y + b.y) }, SnapKind::Midpoint, EntityAnchor::LineMid);
+            break;
+        }
+        case EntityKind::Circle: {
+            const auto& cc = store.circles();
+            const Vec2 c{ cc.cx[i], cc.cy[i] };
+            add(c, SnapKind::Center, EntityAnchor::Center);
+            quadrants(c, std::abs(cc.r[i]), nullptr);
+            break;
+        }
+        case EntityKind::Arc: {
+            const auto& ac = store.arcs();
+            const Round s = roundOf(store, h);
+            add(s.c, SnapKind::Center, EntityAnchor::Center);
+            add({ ac.sx[i], ac.sy[i] }, SnapKind::Endpoint, EntityAnchor::Start);
+            add({ ac.ex[i], ac.ey[i] }, SnapKind::Endpoint, EntityAnchor::End);
+            quadrants(s.c, s.r, &s);
+            break;
+        }
+        case EntityKind::Ellipse: {
+            const auto& ec = store.ellipses();
+            const Vec2 c{ ec.cx[i], ec.cy[i] };
+            const double cs = std::cos(ec.rotation[i]);
+            const double sn = std::sin(ec.rotation[i]);
+            add(c, SnapKind::Center, EntityAnchor::Center);
+            for (const auto& [lx, ly] : { std::pair{ ec.rx[i], 0.0 }, std::pair{ 0.0, ec.ry[i] },
+                                          std::pair{ -ec.rx[i], 0.0 }, std::pair{ 0.0, -ec.ry[i] } }) {
+                add({ c.x + cs * lx - sn * ly, c.y + sn * lx + cs * ly }, SnapKind::Quadrant, EntityAnchor::None);
+            }
+            break;
+        }
+        case EntityKind::Curve: {
+            const auto& cps = store.curves().controlPoints[i];
+            if (cps.size() >= 2 && !store.curves().closed[i]) {
+                // Clamped curves end on their end control points, which constraints can anchor to.
+                const BSpline spline = BSpline::fromStore(store, i);
+                const Vec2 a = spline.evaluate(spline.first());
+                const Vec2 b = spline.evaluate(spline.last());
+                add(a, SnapKind::Endpoint, samePoint(a, cps.front()) ? EntityAnchor::CurvePoint0 : EntityAnchor::None);
+                add(b, SnapKind::Endpoint, samePoint(b, cps.back()) ? EntityAnchor::CurvePoint1 : EntityAnchor::None);
+            }
+            break;
+        }
+        }
+
+        const std::int64_t x0 = cellCoord(entry.box.min.x), x1 = cellCoord(entry.box.max.x);
+        const std::int64_t y0 = cellCoord(entry.box.min.y), y1 = cellCoord(entry.box.max.y);
+        const double cells = static_cast<double>(x1 - x0 + 1) * static_cast<double>(y1 - y0 + 1);
+        if (cells > static_cast<double>(kMaxEntityCells)) {
+            m_oversized.push_back(id);
+            return;
+        }
+        for (std::int64_t cx = x0; cx <= x1; ++cx) {
+            for (std::int64_t cy = y0; cy <= y1; ++cy) {
+                const std::uint64_t key = cellKey(cx, cy);
+                m_grid[key].entities.push_back(id);
+                entry.cells.push_back(key);
+            }
+        }
+    }
+
+    void SnapEngine::removeEntity(EntityId id) {
+        auto it = m_entities.find(id);
+        if (it == m_entities.end()) return;
+        EntityEntry& entry = it->second;
+
+        for (std::uint32_t pi : entry.points) {
+            const SnapPoint& sp = m_points[pi];
+            if (sp.kind == SnapKind::Intersection) {
+                // Shared with the other entity; drop its reference too.
+                const EntityId other = sp.target.id == id ? sp.other.id : sp.target.id;
+                auto& pts = m_entities.at(other).points;
+                pts.erase(std::find(pts.begin(), pts.end(), pi));
+            }
+            removePoint(pi);
+        }
+
+        for (std::uint64_t key : entry.cells) {
+            auto cell = m_grid.find(key);
+            if (cell == m_grid.end()) continue;
+            auto& ids = cell->second.entities;
+            ids.erase(std::find(ids.begin(), ids.end(), id));
+            if (ids.empty() && cell->second.points.empty()) m_grid.erase(cell);
+        }
+        if (entry.cells.empty()) {
+            auto at = std::find(m_oversized.begin(), m_oversized.end(), id);
+            if (at != m_oversized.end()) m_oversized.erase(at);
+        }
+        m_entities.erase(it);
+    }
+
+    void SnapEngine::intersectWithNeighbours(const EntityStore& store, EntityId id) {
+        const EntityEntry& entry = m_entities.at(id);
+        std::vector<EntityId> others;
+        if (entry.cells.empty()) {
+            for (const auto& [other, e] : m_entities) {
+                if (other != id && entry.box.overlaps(e.box)) others.push_back(other);
+            }
+        }
+        else {
+            for (std::uint64_t key : entry.cells) {
+                const auto& ids = m_grid.at(key).entities;
+                others.insert(others.end(), ids.begin(), ids.end());
+            }
+            others.insert(others.end(), m_oversized.begin(), m_oversized.end());
+            std::sort(others.begin(), others.end());
+            others.erase(std::unique(others.begin(), others.end()), others.end());
+        }
+        for (EntityId other : others) {
+            if (other != id && entry.box.overlaps(m_entities.at(other).box)) addIntersections(store, id, other);
+        }
+    }
+
+    void SnapEngine::addIntersections(const EntityStore& store, EntityId a, EntityId b) {
+        std::vector<CurveIntersection> hits;
+        IntersectionEngine::intersect(store, a, b, hits);
+        for (const CurveIntersection& hit : hits) addIntersection(hit);
+    }
+
+    void SnapEngine::addIntersection(const CurveIntersection& hit) {
+        const std::uint32_t pi = addPoint({ hit.point, SnapKind::Intersection, { hit.a, EntityAnchor::None }, { hit.b, EntityAnchor::None }, true });
+        m_entities[hit.a].points.push_back(pi);
+        m_entities[hit.b].points.push_back(pi);
+        ++m_intersectionCount;
+    }
+
+    void SnapEngine::sortAxes() const {
+        m_byX.clear();
+        for (std::uint32_t i = 0; i < m_points.size(); ++i) {
+            const SnapPoint& sp = m_points[i];
+            if (sp.live && isPointAnchor(sp.target.anchor)) m_byX.push_back(i);
+        }
+        m_byY = m_byX;
+        std::sort(m_byX.begin(), m_byX.end(), [&](std::uint32_t a, std::uint32_t b) { return m_points[a].p.x < m_points[b].p.x; });
+        std::sort(m_byY.begin(), m_byY.end(), [&](std::uint32_t a, std::uint32_t b) { return m_points[a].p.y < m_points[b].p.y; });
+        m_axesDirty = false;
+    }
+
+    // ---- queries ----
+
+    void SnapEngine::query(const EntityStore& store, const SnapQuery& q, std::vector<SnapCandidate>& out) const {
+        out.clear();
+        const double r = q.radius;
+        const Vec2 at = q.cursor;
+        auto wants = [&](SnapKind k) { return (q.kinds & snapBit(k)) != 0; };
+        auto ignored = [&](EntityId id) { return q.ignore && *q.ignore == id; };
+
+        const std::int64_t x0 = cellCoord(at.x - r), x1 = cellCoord(at.x + r);
+        const std::int64_t y0 = cellCoord(at.y - r), y1 = cellCoord(at.y + r);
+
+        // Fixed snap points, intersections included.
+        std::vector<EntityId> nearby;
+        for (std::int64_t cx = x0; cx <= x1; ++cx) {
+            for (std::int64_t cy = y0; cy <= y1; ++cy) {
+                auto it = m_grid.find(cellKey(cx, cy));
+                if (it == m_grid.end()) continue;
+                for (std::uint32_t pi : it->second.points) {
+                    const SnapPoint& sp = m_points[pi];
+                    if (!wants(sp.kind) || ignored(sp.target.id) || (sp.kind == SnapKind::Intersection && ignored(sp.other.id))) continue;
+                    const double d = dist(sp.p, at);
+                    if (d <= r) out.push_back({ sp.kind, sp.p, sp.target, sp.other, d });
+                }
+                nearby.insert(nearby.end(), it->second.entities.begin(), it->second.entities.end());
+            }
+        }
+
+        // Tangent and perpendicular points, seen from where the user is drawing.
+        if (q.from && (wants(SnapKind::Tangent) || wants(SnapKind::Perpendicular))) {
+            const Vec2 from = *q.from;
+            nearby.insert(nearby.end(), m_oversized.begin(), m_oversized.end());
+            std::sort(nearby.begin(), nearby.end());
+            nearby.erase(std::unique(nearby.begin(), nearby.end()), nearby.end());
+
+            Box2 reach;
+            reach.expand(Vec2{ at.x - r, at.y - r });
+            reach.expand(Vec2{ at.x + r, at.y + r });
+            auto consider = [&](SnapKind kind, const Vec2& p, EntityId id) {
+                const double d = dist(p, at);
+                if (d <= r) out.push_back({ kind, p, { id, EntityAnchor::None }, {}, d });
+            };
+
+            for (EntityId id : nearby) {
+                if (ignored(id) || !m_entities.at(id).box.overlaps(reach)) continue;
+                const EntityHandle h = store.getHandle(id);
+                if (h.kind == EntityKind::Line && wants(SnapKind::Perpendicular)) {
+                    const std::uint32_t i = store.indexOf(h);
+                    const auto& lc = store.lines();
+                    const double dx = lc.bx[i] - lc.ax[i], dy = lc.by[i] - lc.ay[i];
+                    const double len2 = dx * dx + dy * dy;
+                    if (len2 < kEps) continue;
+                    const double t = ((from.x - lc.ax[i]) * dx + (from.y - lc.ay[i]) * dy) / len2;
+                    if (t >= 0.0 && t <= 1.0) consider(SnapKind::Perpendicular, { lc.ax[i] + t * dx, lc.ay[i] + t * dy }, id);
+                    continue;
+                }
+                if (h.kind != EntityKind::Circle && h.kind != EntityKind::Arc) continue;
+
+                const Round s = roundOf(store, h);
+                const double d = dist(from, s.c);
+                if (d < kEps) continue;
+                const double ux = (from.x - s.c.x) / d, uy = (from.y - s.c.y) / d;
+                if (wants(SnapKind::Perpendicular)) {
+                    for (const double sign : { 1.0, -1.0 }) {
+                        const Vec2 p{ s.c.x + sign * s.r * ux, s.c.y + sign * s.r * uy };
+                        if (s.covers(p)) consider(SnapKind::Perpendicular, p, id);
+                    }
+                }
+                if (wants(SnapKind::Tangent) && d > s.r) {
+                    // Tangent points sit at acos(r/d) either side of the direction to `from`.
+                    const double alpha = std::acos(s.r / d);
+                    const double base = std::atan2(uy, ux);
+                    for (const double sign : { 1.0, -1.0 }) {
+                        const double ang = base + sign * alpha;
+                        const Vec2 p{ s.c.x + s.r * std::cos(ang), s.c.y + s.r * std::sin(ang) };
+                        if (s.covers(p)) consider(SnapKind::Tangent, p, id);
+                    }
+                }
+            }
+        }
+
+        // Alignment with existing points: the nearest one per axis.
+        if (wants(SnapKind::Horizontal) || wants(SnapKind::Vertical)) {
+            if (m_axesDirty) sortAxes();
+            auto align = [&](const std::vector<std::uint32_t>& sorted, bool byX) {
+                const double key = byX ? at.x : at.y;
+                auto coord = [&](std::uint32_t pi) { return byX ? m_points[pi].p.x : m_points[pi].p.y; };
+                const auto mid = std::lower_bound(sorted.begin(), sorted.end(), key,
+                    [&](std::uint32_t pi, double v) { return coord(pi) < v; });
+
+                // Walk outwards from the cursor; among equally close lines
+                // prefer the point nearest the cursor.
+                auto lo = mid, hi = mid;
+                const SnapPoint* best = nullptr;
+                double bestOff = r, bestAlong = 0.0;
+                for (std::size_t n = 0; n < kAlignScan; ++n) {
+                    const bool takeLo = lo != sorted.begin() &&
+                        (hi == sorted.end() || key - coord(*(lo - 1)) <= coord(*hi) - key);
+                    if (!takeLo && hi == sorted.end()) break;
+                    const std::uint32_t pi = takeLo ? *--lo : *hi++;
+                    if (ignored(m_points[pi].target.id)) continue;
+                    const double off = std::abs(coord(pi) - key);
+                    if (off > bestOff + kEps && best) break;
+                    if (off > r) break;
+                    const double along = byX ? std::abs(m_points[pi].p.y - at.y) : std::abs(m_points[pi].p.x - at.x);
+                    if (along <= r) continue; // already a point snap
+                    if (!best || off < bestOff - kEps || along < bestAlong) {
+                        best = &m_points[pi];
+                        bestOff = off;
+                        bestAlong = along;
+                    }
+                }
+                if (!best) return;
+                const Vec2 p = byX ? Vec2{ best->p.x, at.y } : Vec2{ at.x, best->p.y };
+                out.push_back({ byX ? SnapKind::Vertical : SnapKind::Horizontal, p, best->target, {}, bestOff });
+            };
+            if (wants(SnapKind::Vertical)) align(m_byX, true);
+            if (wants(SnapKind::Horizontal)) align(m_byY, false);
+        }
+
+        std::sort(out.begin(), out.end(), [&](const SnapCandidate& a, const SnapCandidate& b) {
+            return score(a, r) < score(b, r);
+        });
+        if (out.size() > q.maxCandidates) out.resize(q.maxCandidates);
+    }
+
+    // ---- inference ----
+
+    std::vector<GeometricConstraint> SnapEngine::constraintsFor(const EntityStore& store,
+        const SnapCandidate& snap, const EntityRef& subject) {
+        std::vector<GeometricConstraint> out;
+        auto emit = [&](GeometricConstraintType type, EntityRef a, EntityRef b) {
+            GeometricConstraint c;
+            c.type = type;
+            c.refs = { a, b };
+            out.push_back(std::move(c));
+        };
+        auto kindOf = [&](EntityId id) { return store.getHandle(id).kind; };
+        auto isRound = [&](EntityId id) {
+            const EntityKind k = kindOf(id);
+            return k == EntityKind::Circle || k == EntityKind::Arc;
+        };
+        // Point-on-entity is expressible for lines, circles and arcs.
+        auto onEntity = [&](EntityId id) {
+            if (kindOf(id) == EntityKind::Line || isRound(id)) {
+                emit(GeometricConstraintType::Coincident, subject, { id, EntityAnchor::None });
+            }
+        };
+        const EntityRef whole{ snap.target.id, EntityAnchor::None };
+
+        switch (snap.kind) {
+        case SnapKind::Endpoint:
+        case SnapKind::Center:
+            emit(GeometricConstraintType::Coincident, subject, snap.target);
+            break;
+        case SnapKind::Midpoint:
+            emit(GeometricConstraintType::Midpoint, subject, whole);
+            break;
+        case SnapKind::Quadrant: {
+            if (!isRound(snap.target.id)) break;
+            onEntity(snap.target.id);
+            // Level with the center for the left/right quadrants, plumb for top/bottom.
+            const std::uint32_t i = store.indexOf(store.getHandle(snap.target.id));
+            const Vec2 c = kindOf(snap.target.id) == EntityKind::Circle
+                ? Vec2{ store.circles().cx[i], store.circles().cy[i] }
+                : Vec2{ store.arcs().cx[i], store.arcs().cy[i] };
+            const bool level = std::abs(snap.point.y - c.y) < std::abs(snap.point.x - c.x);
+            emit(level ? GeometricConstraintType::Horizontal : GeometricConstraintType::Vertical,
+                subject, { snap.target.id, EntityAnchor::Center });
+            break;
+        }
+        case SnapKind::Intersection:
+            onEntity(snap.target.id);
+            onEntity(snap.other.id);
+            break;
+        case SnapKind::Tangent:
+            if (kindOf(subject.id) != EntityKind::Line) break;
+            emit(GeometricConstraintType::Tangent, { subject.id, EntityAnchor::None }, whole);
+            onEntity(snap.target.id);
+            break;
+        case SnapKind::Perpendicular:
+            if (kindOf(subject.id) != EntityKind::Line) break;
+            if (kindOf(snap.target.id) == EntityKind::Line) {
+                emit(GeometricConstraintType::Perpendicular, { subject.id, EntityAnchor::None }, whole);
+            }
+            else {
+                // Normal to a circle: the line runs through its center.
+                emit(GeometricConstraintType::Coincident, { snap.target.id, EntityAnchor::Center }, { subject.id, EntityAnchor::None });
+            }
+            onEntity(snap.target.id);
+            break;
+        case SnapKind::Horizontal:
+            emit(GeometricConstraintType::Horizontal, subject, snap.target);
+            break;
+        case SnapKind::Vertical:
+            emit(GeometricConstraintType::Vertical, subject, snap.target);
+            break;
+        }
+        return out;
+    }
+
+} // namespace domain::sketch
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "SketchConstraints.h"
+#include "SketchEntities.h"
+#include "SketchIds.h"
+#include "SketchIntersections.h"
+#include "SketchMath.h"
+
+namespace domain::sketch {
+
+    enum class SnapKind : std::uint8_t {
+        Endpoint,
+        Intersection,
+        Midpoint,
+        Center,
+        Quadrant,
+        Tangent,       // tangent point on a circle/arc, seen from SnapQuery::from
+        Perpendicular, // foot of the perpendicular from SnapQuery::from
+        Horizontal,    // cursor level with a snap point
+        Vertical       // cursor plumb with a snap point
+    };
+
+    // Bit per SnapKind, for SnapQuery::kinds.
+    inline constexpr std::uint16_t snapBit(SnapKind k) { return static_cast<std::uint16_t>(1u << static_cast<unsigned>(k)); }
+    inline constexpr std::uint16_t kAllSnaps = 0x1FF;
+
+    struct SnapQuery {
+        Vec2 cursor;
+        double radius{ 1.0 };             // capture radius, sketch units
+        std::optional<Vec2> from;         // start of the segment being drawn (tangent/perpendicular)
+        std::uint16_t kinds{ kAllSnaps };
+        std::optional<EntityId> ignore;   // the entity being drawn, so it does not snap to itself
+        std::size_t maxCandidates{ 8 };
+    };
+
+    struct SnapCandidate {
+        SnapKind kind{ SnapKind::Endpoint };
+        Vec2 point;         // where the cursor snaps to
+        EntityRef target;   // anchor or entity snapped to
+        EntityRef other;    // second entity of an intersection
+        double distance{ 0.0 };
+    };
+
+    // Snap/inference engine for sketch editing.
+    //
+    // Every snap point (endpoints, midpoints, centers, quadrants and the
+    // intersections between entities) is precomputed into a uniform hash grid,
+    // together with the entities' bounding boxes, so a query only touches the
+    // few cells under the cursor. Intersections are the expensive part: they
+    // are found once by the IntersectionEngine and cached, and refresh()
+    // recomputes only those of an entity that changed, against the entities
+    // sharing its cells.
+    //
+    // Tangent and perpendicular snaps depend on the point the user is drawing
+    // from, so they are solved per query against the entities near the cursor.
+    // H/V alignment uses per-axis sorted views of the snap points.
+    class SnapEngine {
+    public:
+        // cellSize <= 0 picks one from the sketch's extent and entity count.
+        void build(const EntityStore& store, double cellSize = 0.0);
+        // Re-derives the snap points of an added, moved or removed entity.
+        void refresh(const EntityStore& store, EntityId id);
+        void clear();
+
+        // Candidates within query.radius, best first. Closer wins, with
+        // endpoints and intersections favoured over weaker inferences.
+        void query(const EntityStore& store, const SnapQuery& query, std::vector<SnapCandidate>& out) const;
+
+        std::size_t pointCount() const { return m_points.size() - m_freePoints.size(); }
+        std::size_t intersectionCount() const { return m_intersectionCount; }
+
+        // Constraints that make `subject` (the anchor being placed; for
+        // tangent/perpendicular snaps, an end of the line being drawn) keep
+        // the snapped relation. Only relations the solver can express are
+        // emitted; meta.id is left for the caller to assign.
+        static std::vector<GeometricConstraint> constraintsFor(const EntityStore& store,
+            const SnapCandidate& snap, const EntityRef& subject);
+
+    private:
+        struct SnapPoint {
+            Vec2 p;
+            SnapKind kind{ SnapKind::Endpoint };
+            EntityRef target;
+            EntityRef other;
+            bool live{ false };
+        };
+
+        struct Cell {
+            std::vector<std::uint32_t> points;
+            std::vector<EntityId> entities;
+        };
+
+        struct EntityEntry {
+            Box2 box;
+            std::vector<std::uint32_t> points;         // snap points owned (intersections: by both)
+            std::vector<std::uint64_t> cells;          // cells listing the entity; empty if oversized
+        };
+
+        double m_cell{ 1.0 };
+        std::unordered_map<std::uint64_t, Cell> m_grid;
+        std::unordered_map<EntityId, EntityEntry> m_entities;
+        std::vector<EntityId> m_oversized; // entities spanning too many cells to list in each
+
+        std::vector<SnapPoint> m_points;
+        std::vector<std::uint32_t> m_freePoints;
+        std::size_t m_intersectionCount{ 0 };
+
+        // H/V alignment: live point indices sorted by x and by y, rebuilt lazily.
+        mutable std::vector<std::uint32_t> m_byX;
+        mutable std::vector<std::uint32_t> m_byY;
+        mutable bool m_axesDirty{ true };
+
+        std::uint64_t cellKey(std::int64_t cx, std::int64_t cy) const;
+        std::int64_t cellCoord(double v) const;
+
+        std::uint32_t addPoint(const SnapPoint& sp);
+        void removePoint(std::uint32_t i);
+        void addEntity(const EntityStore& store, EntityId id);
+        void removeEntity(EntityId id);
+        void intersectWithNeighbours(const EntityStore& store, EntityId id);
+        void addIntersections(const EntityStore& store, EntityId a, EntityId b);
+        void addIntersection(const CurveIntersection& hit);
+        void sortAxes() const;
+    };
+
+} // namespace domain::sketch
@@ -0,0 +1,352 @@
+#include "SketchSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace domain::sketch {
+
+    namespace {
+
+        Box2 unite(const Box2& a, const Box2& b) {
+            Box2 r = a;
+            r.expand(b);
+            return r;
+        }
+
+        double perimeter(const Box2& b) {
+            return 2.0 * ((b.max.x - b.min.x) + (b.max.y - b.min.y));
+        }
+
+        // Distance from `p` to the nearest point of `b` (0 inside).
+        double boxDistance(const Box2& b, const Vec2& p) {
+            const double dx = std::max({ b.min.x - p.x, 0.0, p.x - b.max.x });
+            const double dy = std::max({ b.min.y - p.y, 0.0, p.y - b.max.y });
+            return std::hypot(dx, dy);
+        }
+
+        // Tight box plus the drag/snap handles that lie off the outline.
+        Box2 reachOf(const EntityStore& store, EntityHandle h, const Box2& tight) {
+            Box2 reach = tight;
+            if (h.kind == EntityKind::Arc) {
+                const std::uint32_t i = store.indexOf(h);
+                reach.expand(Vec2{ store.arcs().cx[i], store.arcs().cy[i] });
+            }
+            return reach;
+        }
+
+        bool hasFlags(const EntityStore& store, EntityId id, std::uint8_t required) {
+            if (required == 0) return true;
+            const EntityHandle h = store.getHandle(id);
+            return (store.headers(h.kind).flags[store.indexOf(h)] & required) == required;
+        }
+
+    } // namespace
+
+    SpatialIndex::SpatialIndex(double margin) : m_margin(margin) {}
+
+    void SpatialIndex::build(const EntityStore& store) {
+        clear();
+        m_nodes.reserve(2 * store.size());
+        m_leaves.reserve(store.size());
+        for (std::size_t k = 0; k < kEntityKindCount; ++k) {
+            const auto kind = static_cast<EntityKind>(k);
+            const auto& ids = store.headers(kind).ids;
+            for (std::uint32_t i = 0; i < ids.size(); ++i) {
+                const EntityHandle h = store.handleAt(kind, i);
+                const Box2 tight = store.bounds(h);
+                place(ids[i], tight, reachOf(store, h, tight));
+            }
+        }
+    }
+
+    void SpatialIndex::clear() {
+        m_nodes.clear();
+        m_leaves.clear();
+        m_root = kNull;
+        m_free = kNull;
+    }
+
+    Box2 SpatialIndex::fatten(const Box2& box) const {
+        Box2 fat = box;
+        fat.min.x -= m_margin; fat.min.y -= m_margin;
+        fat.max.x += m_margin; fat.max.y += m_margin;
+        return fat;
+    }
+
+    std::int32_t SpatialIndex::allocate() {
+        if (m_free != kNull) {
+            const std::int32_t n = m_free;
+            m_free = m_nodes[n].parent;
+            m_nodes[n] = Node{};
+            return n;
+        }
+        m_nodes.emplace_back();
+        return static_cast<std::int32_t>(m_nodes.size() - 1);
+    }
+
+    void SpatialIndex::release(std::int32_t n) {
+        m_nodes[n].height = -1;
+        m_nodes[n].parent = m_free;
+        m_free = n;
+    }
+
+    void SpatialIndex::insert(EntityId id, const Box2& box) {
+        place(id, box, box);
+    }
+
+    bool SpatialIndex::remove(EntityId id) {
+        auto it = m_leaves.find(id);
+        if (it == m_leaves.end()) return false;
+        removeLeaf(it->second);
+        release(it->second);
+        m_leaves.erase(it);
+        return true;
+    }
+
+    bool SpatialIndex::update(EntityId id, const Box2& box) {
+        return place(id, box, box);
+    }
+
+    void SpatialIndex::refresh(const EntityStore& store, EntityId id) {
+        if (!store.contains(id)) {
+            remove(id);
+            return;
+        }
+        const EntityHandle h = store.getHandle(id);
+        const Box2 tight = store.bounds(h);
+        place(id, tight, reachOf(store, h, tight));
+    }
+
+    // Inserts or updates a leaf; returns true if it was (re)inserted into the tree.
+    bool SpatialIndex::place(EntityId id, const Box2& tight, const Box2& reach) {
+        auto it = m_leaves.find(id);
+        if (it == m_leaves.end()) {
+            const std::int32_t leaf = allocate();
+            Node& n = m_nodes[leaf];
+            n.tight = tight;
+            n.fat = fatten(reach);
+            n.id = id;
+            m_leaves.emplace(id, leaf);
+            insertLeaf(leaf);
+            return true;
+        }
+
+        const std::int32_t leaf = it->second;
+        m_nodes[leaf].tight = tight;
+        if (m_nodes[leaf].fat.contains(reach)) {
+            return false;
+        }
+        removeLeaf(leaf);
+        m_nodes[leaf].fat = fatten(reach);
+        insertLeaf(leaf);
+        return true;
+    }
+
+    // ---- tree maintenance ----
+
+    void SpatialIndex::insertLeaf(std::int32_t leaf) {
+        if (m_root == kNull) {
+            m_root = leaf;
+            m_nodes[leaf].parent = kNull;
+            return;
+        }
+
+        // Descend towards the sibling that minimises the total perimeter added.
+        const Box2 leafBox = m_nodes[leaf].fat;
+        std::int32_t index = m_root;
+        while (!m_nodes[index].leaf()) {
+            const Node& node = m_nodes[index];
+            const double combined = perimeter(unite(node.fat, leafBox));
+            const double here = 2.0 * combined;                             // new parent above this node
+            const double inherited = 2.0 * (combined - perimeter(node.fat)); // growth of this node if we descend
+
+            auto descendCost = [&](std::int32_t c) {
+                const Node& child = m_nodes[c];
+                const double grown = perimeter(unite(child.fat, leafBox));
+                return (child.leaf() ? grown : grown - perimeter(child.fat)) + inherited;
+            };
+            const double cost1 = descendCost(node.child1);
+            const double cost2 = descendCost(node.child2);
+
+            if (here < cost1 && here < cost2) break;
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        const std::int32_t sibling = index;
+        const std::int32_t oldParent = m_nodes[sibling].parent;
+        const std::int32_t newParent = allocate(); // may reallocate m_nodes
+
+        Node& p = m_nodes[newParent];
+        p.parent = oldParent;
+        p.fat = unite(leafBox, m_nodes[sibling].fat);
+        p.height = m_nodes[sibling].height + 1;
+        p.child1 = sibling;
+        p.child2 = leaf;
+        m_nodes[sibling].parent = newParent;
+        m_nodes[leaf].parent = newParent;
+
+        if (oldParent == kNull) {
+            m_root = newParent;
+        }
+        else if (m_nodes[oldParent].child1 == sibling) {
+            m_nodes[oldParent].child1 = newParent;
+        }
+        else {
+            m_nodes[oldParent].child2 = newParent;
+        }
+
+        refit(m_nodes[leaf].parent);
+    }
+
+    void SpatialIndex::removeLeaf(std::int32_t leaf) {
+        if (leaf == m_root) {
+            m_root = kNull;
+            return;
+        }
+
+        const std::int32_t parent = m_nodes[leaf].parent;
+        const std::int32_t grandParent = m_nodes[parent].parent;
+        const std::int32_t sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+        if (grandParent == kNull) {
+            m_root = sibling;
+            m_nodes[sibling].parent = kNull;
+            release(parent);
+            return;
+        }
+
+        if (m_nodes[grandParent].child1 == parent) m_nodes[grandParent].child1 = sibling;
+        else m_nodes[grandParent].child2 = sibling;
+        m_nodes[sibling].parent = grandParent;
+        release(parent);
+
+        refit(grandParent);
+    }
+
+    // Rebalances and recomputes bounds and heights from `n` up to the root.
+    void SpatialIndex::refit(std::int32_t n) {
+        while (n != kNull) {
+            n = balance(n);
+            Node& node = m_nodes[n];
+            const Node& c1 = m_nodes[node.child1];
+            const Node& c2 = m_nodes[node.child2];
+            node.height = 1 + std::max(c1.height, c2.height);
+            node.fat = unite(c1.fat, c2.fat);
+            n = node.parent;
+        }
+    }
+
+    // AVL rotation: if one child of `a` is more than one level taller than the
+    // other, lifts that child into a's place. Returns the subtree's new root.
+    std::int32_t SpatialIndex::balance(std::int32_t ia) {
+        Node& a = m_nodes[ia];
+        if (a.leaf() || a.height < 2) return ia;
+
+        const std::int32_t ib = a.child1;
+        const std::int32_t ic = a.child2;
+        Node& b = m_nodes[ib];
+        Node& c = m_nodes[ic];
+        const int skew = c.height - b.height;
+
+        // Lift `up` (a child of a, with children f and g); a keeps `stay` and
+        // the shorter of f/g, while up keeps the taller.
+        auto rotate = [&](std::int32_t iup, Node& up, Node& stay, bool upWasChild2) {
+            const std::int32_t iff = up.child1;
+            const std::int32_t ig = up.child2;
+            Node& f = m_nodes[iff];
+            Node& g = m_nodes[ig];
+
+            up.child1 = ia;
+            up.parent = a.parent;
+            a.parent = iup;
+
+            if (up.parent == kNull) m_root = iup;
+            else if (m_nodes[up.parent].child1 == ia) m_nodes[up.parent].child1 = iup;
+            else m_nodes[up.parent].child2 = iup;
+
+            const bool keepF = f.height > g.height;
+            const std::int32_t italler = keepF ? iff : ig;
+            const std::int32_t ishorter = keepF ? ig : iff;
+            Node& taller = keepF ? f : g;
+            Node& shorter = keepF ? g : f;
+
+            up.child2 = italler;
+            if (upWasChild2) a.child2 = ishorter;
+            else a.child1 = ishorter;
+            shorter.parent = ia;
+
+            a.fat = unite(stay.fat, shorter.fat);
+            a.height = 1 + std::max(stay.height, shorter.height);
+            up.fat = unite(a.fat, taller.fat);
+            up.height = 1 + std::max(a.height, taller.height);
+            return iup;
+        };
+
+        if (skew > 1) return rotate(ic, c, b, true);
+        if (skew < -1) return rotate(ib, b, c, false);
+        return ia;
+    }
+
+    // ---- queries ----
+
+    void SpatialIndex::select(const Box2& box, SelectMode mode, std::vector<EntityId>& out) const {
+        out.clear();
+        query(box, [&](EntityId id, const Box2& tight) {
+            if (mode == SelectMode::Contained ? box.contains(tight) : box.overlaps(tight)) out.push_back(id);
+        });
+    }
+
+    void SpatialIndex::queryRadius(const EntityStore& store, const Vec2& center, double radius,
+        std::vector<EntityId>& out, std::uint8_t requiredFlags) const {
+        out.clear();
+        Box2 box;
+        box.expand(Vec2{ center.x - radius, center.y - radius });
+        box.expand(Vec2{ center.x + radius, center.y + radius });
+        query(box, [&](EntityId id, const Box2& tight) {
+            if (boxDistance(tight, center) > radius) return;
+            if (!hasFlags(store, id, requiredFlags)) return;
+            if (store.distance(store.getHandle(id), center) <= radius) out.push_back(id);
+        });
+    }
+
+    bool SpatialIndex::nearest(const EntityStore& store, const Vec2& at, double maxDistance,
+        Hit& out, std::uint8_t requiredFlags) const {
+        if (m_root == kNull) return false;
+
+        // Best-first: nodes come off the queue in order of box distance, so
+        // the search stops once the nearest box is farther than the best hit.
+        using Entry = std::pair<double, std::int32_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        open.emplace(boxDistance(m_nodes[m_root].fat, at), m_root);
+
+        double best = maxDistance;
+        bool found = false;
+        while (!open.empty()) {
+            const auto [d, n] = open.top();
+            open.pop();
+            if (d > best) break;
+
+            const Node& node = m_nodes[n];
+            if (node.leaf()) {
+                if (boxDistance(node.tight, at) > best) continue;
+                if (!hasFlags(store, node.id, requiredFlags)) continue;
+                const double exact = store.distance(store.getHandle(node.id), at);
+                if (exact <= best) {
+                    best = exact;
+                    out = { node.id, exact };
+                    found = true;
+                }
+                continue;
+            }
+            for (std::int32_t c : { node.child1, node.child2 }) {
+                const double dc = boxDistance(m_nodes[c].fat, at);
+                if (dc <= best) open.emplace(dc, c);
+            }
+        }
+        return found;
+    }
+
+} // namespace domain::sketch
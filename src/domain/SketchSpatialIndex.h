@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "SketchEntities.h"
+#include "SketchMath.h"
+
+namespace domain::sketch {
+
+    // Dynamic AABB tree over the bounding boxes of sketch entities, for
+    // picking, box selection and snapping.
+    //
+    // Leaves store the entity's tight box plus a "fat" box grown by a margin;
+    // the tree is built over the fat boxes, so an entity that moves by less
+    // than the margin only updates its tight box. The fat box also covers
+    // handles off the outline (an arc's center), so picking and snapping find
+    // them. Larger moves remove and
+    // reinsert the leaf (O(log n)); internal nodes are kept AVL-balanced by
+    // rotations, and new leaves are placed with the surface-area heuristic.
+    //
+    // The index does not observe the store: callers refresh() the entities
+    // they change (the drag solver's cluster after every frame, say).
+    class SpatialIndex {
+    public:
+        enum class SelectMode : std::uint8_t {
+            Intersecting, // bounding box touches the query box
+            Contained     // bounding box lies entirely inside the query box
+        };
+
+        struct Hit {
+            EntityId id{};
+            double distance{ 0.0 };
+        };
+
+        explicit SpatialIndex(double margin = 0.5);
+
+        void build(const EntityStore& store);
+        void clear();
+
+        void insert(EntityId id, const Box2& box);
+        bool remove(EntityId id);
+        // Returns true if the leaf had to be moved in the tree.
+        bool update(EntityId id, const Box2& box);
+        // Inserts, updates or removes `id` to match the store.
+        void refresh(const EntityStore& store, EntityId id);
+
+        bool contains(EntityId id) const { return m_leaves.find(id) != m_leaves.end(); }
+        std::size_t size() const { return m_leaves.size(); }
+        int height() const { return m_root == kNull ? 0 : m_nodes[m_root].height; }
+
+        // Calls visit(id, tight) for every entity whose fat box overlaps
+        // `box`; candidates may lie up to the margin outside it.
+        template <class F>
+        void query(const Box2& box, F&& visit) const;
+
+        void select(const Box2& box, SelectMode mode, std::vector<EntityId>& out) const;
+
+        // Entities within `radius` of `center`, by exact distance to the
+        // outline. Entities missing any of `requiredFlags` are skipped.
+        void queryRadius(const EntityStore& store, const Vec2& center, double radius,
+            std::vector<EntityId>& out, std::uint8_t requiredFlags = 0) const;
+
+        // Closest entity within `maxDistance`, by best-first descent.
+        bool nearest(const EntityStore& store, const Vec2& at, double maxDistance,
+            Hit& out, std::uint8_t requiredFlags = 0) const;
+
+    private:
+        static constexpr std::int32_t kNull = -1;
+
+        struct Node {
+            Box2 fat;                     // tree bound (leaves: tight grown by the margin)
+            Box2 tight;                   // leaves only
+            std::int32_t parent{ kNull }; // next free node while on the free list
+            std::int32_t child1{ kNull };
+            std::int32_t child2{ kNull };
+            std::int32_t height{ 0 };     // 0 for leaves, -1 while free
+            EntityId id{};
+
+            bool leaf() const { return child1 == kNull; }
+        };
+
+        std::vector<Node> m_nodes;
+        std::int32_t m_root{ kNull };
+        std::int32_t m_free{ kNull };
+        std::unordered_map<EntityId, std::int32_t> m_leaves;
+        double m_margin;
+
+        std::int32_t allocate();
+        void release(std::int32_t n);
+        void insertLeaf(std::int32_t leaf);
+        void removeLeaf(std::int32_t leaf);
+        void refit(std::int32_t n);
+        std::int32_t balance(std::int32_t a);
+        bool place(EntityId id, const Box2& tight, const Box2& reach);
+        Box2 fatten(const Box2& box) const;
+    };
+
+    template <class F>
+    void SpatialIndex::query(const Box2& box, F&& visit) const {
+        if (m_root == kNull) return;
+
+        std::vector<std::int32_t> stack;
+        stack.reserve(64);
+        stack.push_back(m_root);
+        while (!stack.empty()) {
+            const Node& node = m_nodes[stack.back()];
+            stack.pop_back();
+            if (!node.fat.overlaps(box)) continue;
+            if (node.leaf()) {
+                visit(node.id, node.tight);
+                continue;
+            }
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+
+} // namespace domain::sketch
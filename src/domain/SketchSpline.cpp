@@ -0,0 +1,333 @@
+#include "SketchSpline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace domain::sketch {
+
+    namespace {
+
+        constexpr std::size_t kLanes = 8;            // parameters evaluated side by side
+        constexpr int kMaxDepth = 20;                // refinement rounds
+        constexpr std::size_t kMaxSegments = 1 << 16;
+
+        std::uint64_t mix(std::uint64_t h, std::uint64_t v) {
+            return h ^ (v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2));
+        }
+
+        std::uint64_t bitsOf(double d) {
+            std::uint64_t u;
+            std::memcpy(&u, &d, sizeof u);
+            return u;
+        }
+
+        double chordDistance(const Vec2& p, const Vec2& a, const Vec2& b) {
+            const double dx = b.x - a.x, dy = b.y - a.y;
+            const double len2 = dx * dx + dy * dy;
+            double u = len2 > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2 : 0.0;
+            u = std::clamp(u, 0.0, 1.0);
+            return std::hypot(p.x - (a.x + u * dx), p.y - (a.y + u * dy));
+        }
+
+        bool validKnots(const std::vector<double>& knots, std::size_t count, int p) {
+            if (knots.size() != count + static_cast<std::size_t>(p) + 1) return false;
+            for (std::size_t i = 1; i < knots.size(); ++i) {
+                if (!(knots[i] >= knots[i - 1])) return false; // also rejects NaN
+            }
+            return knots[p] < knots[count];
+        }
+
+    } // namespace
+
+    BSpline::BSpline(const std::vector<Vec2>& controlPoints, int degree, const std::vector<double>& knots,
+        const std::vector<double>& weights, bool closed) {
+        const std::size_t n = controlPoints.size();
+        if (n < 2) return;
+
+        m_degree = std::clamp(degree, 1, std::min(static_cast<int>(n) - 1, kMaxDegree));
+        const std::size_t p = static_cast<std::size_t>(m_degree);
+
+        m_rational = weights.size() == n &&
+            std::all_of(weights.begin(), weights.end(), [](double w) { return w > 0.0 && std::isfinite(w); });
+
+        // Periodic curves wrap the first p control points around.
+        const bool given = validKnots(knots, n, m_degree);
+        const bool periodic = closed && !given;
+        const std::size_t count = periodic ? n + p : n;
+
+        m_x.resize(count);
+        m_y.resize(count);
+        m_w.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::size_t j = i % n;
+            const double w = m_rational ? weights[j] : 1.0;
+            m_x[i] = w * controlPoints[j].x;
+            m_y[i] = w * controlPoints[j].y;
+            m_w[i] = w;
+        }
+
+        if (given) {
+            m_knots = knots;
+        }
+        else if (periodic) {
+            m_knots.resize(count + p + 1);
+            for (std::size_t i = 0; i < m_knots.size(); ++i) m_knots[i] = static_cast<double>(i);
+        }
+        else {
+            // Clamped uniform: p + 1 equal knots at each end.
+            m_knots.resize(count + p + 1);
+            const double spans = static_cast<double>(count - p);
+            for (std::size_t i = 0; i < m_knots.size(); ++i) {
+                const double k = static_cast<double>(i) - static_cast<double>(p);
+                m_knots[i] = std::clamp(k, 0.0, spans);
+            }
+        }
+    }
+
+    BSpline BSpline::fromStore(const EntityStore& store, std::uint32_t idx) {
+        const auto& c = store.curves();
+        return BSpline(c.controlPoints[idx], c.degree[idx], c.knots[idx], c.weights[idx], c.closed[idx] != 0);
+    }
+
+    SplineEnd BSpline::end(bool atLast) const {
+        SplineEnd out;
+        const std::size_t n = m_x.size();
+        if (!valid() || n < 2) return out;
+
+        // Knots and weights counted from the end asked for; mirroring the knots
+        // keeps their differences.
+        const std::size_t p = static_cast<std::size_t>(m_degree);
+        const std::size_t m = m_knots.size() - 1;
+        auto k = [&](std::size_t i) { return atLast ? -m_knots[m - i] : m_knots[i]; };
+        auto w = [&](std::size_t i) { return atLast ? m_w[n - 1 - i] : m_w[i]; };
+        if (k(p) != k(0)) return out;
+
+        // C' = c1 (w1 / w0) u. C'' has a part along u and one along the next
+        // leg, e * d1 * (w2 / w0) w, which alone turns the curve.
+        const double c1 = k(p + 1) - k(1);
+        if (!(c1 > 0.0)) return out;
+        out.clamped = true;
+        if (p < 2 || n < 3) return out;
+
+        const double d1 = k(p + 2) - k(2);
+        const double e = k(p + 1) - k(2);
+        if (!(d1 > 0.0) || !(e > 0.0)) {
+            out.clamped = false;
+            return out;
+        }
+        const double pd = static_cast<double>(p);
+        const double speed = pd / c1 * w(1) / w(0);
+        out.curvature = (pd - 1.0) / e * pd / d1 * w(2) / w(0) / (speed * speed);
+        return out;
+    }
+
+    std::size_t BSpline::span(double t) const {
+        const std::size_t p = static_cast<std::size_t>(m_degree);
+        const std::size_t n = m_x.size();
+        // Last k in [p, n - 1] with knots[k] <= t, skipping empty spans at the end.
+        auto it = std::upper_bound(m_knots.begin() + p, m_knots.begin() + n, t);
+        std::size_t k = static_cast<std::size_t>(it - m_knots.begin());
+        k = k > p ? k - 1 : p;
+        while (k > p && m_knots[k] == m_knots[k + 1]) --k;
+        return k;
+    }
+
+    Vec2 BSpline::evaluate(double t) const {
+        Vec2 out;
+        evaluate(&t, 1, &out);
+        return out;
+    }
+
+    void BSpline::evaluate(const double* t, std::size_t n, Vec2* out) const {
+        if (!valid()) {
+            std::fill(out, out + n, Vec2{});
+            return;
+        }
+
+        const std::size_t p = static_cast<std::size_t>(m_degree);
+        const double lo = first(), hi = last();
+
+        // Per block, lane l holds one parameter; rows are the de Boor points
+        // and the 2p + 1 knots around its span, so every inner loop runs over
+        // contiguous lanes.
+        double dx[kMaxDegree + 1][kLanes], dy[kMaxDegree + 1][kLanes], dw[kMaxDegree + 1][kLanes];
+        double kn[2 * kMaxDegree + 1][kLanes];
+        double tt[kLanes];
+
+        for (std::size_t base = 0; base < n; base += kLanes) {
+            const std::size_t lanes = std::min(kLanes, n - base);
+            for (std::size_t l = 0; l < kLanes; ++l) {
+                const double u = std::clamp(t[base + std::min(l, lanes - 1)], lo, hi);
+                const std::size_t k = span(u);
+                tt[l] = u;
+                for (std::size_t j = 0; j <= p; ++j) {
+                    dx[j][l] = m_x[k - p + j];
+                    dy[j][l] = m_y[k - p + j];
+                    dw[j][l] = m_w[k - p + j];
+                }
+                for (std::size_t q = 0; q <= 2 * p; ++q) kn[q][l] = m_knots[k - p + q];
+            }
+
+            for (std::size_t r = 1; r <= p; ++r) {
+                for (std::size_t j = p; j >= r; --j) {
+                    const double* k0 = kn[j];
+                    const double* k1 = kn[j + p - r + 1];
+                    for (std::size_t l = 0; l < kLanes; ++l) {
+                        const double den = k1[l] - k0[l];
+                        const double a = den > 0.0 ? (tt[l] - k0[l]) / den : 0.0;
+                        dx[j][l] = dx[j - 1][l] + a * (dx[j][l] - dx[j - 1][l]);
+                        dy[j][l] = dy[j - 1][l] + a * (dy[j][l] - dy[j - 1][l]);
+                        dw[j][l] = dw[j - 1][l] + a * (dw[j][l] - dw[j - 1][l]);
+                    }
+                }
+            }
+
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const double w = m_rational ? dw[p][l] : 1.0;
+                out[base + l] = { dx[p][l] / w, dy[p][l] / w };
+            }
+        }
+    }
+
+    void tessellate(const BSpline& spline, double chordTolerance, std::vector<Vec2>& points, std::vector<double>* params) {
+        points.clear();
+        if (params) params->clear();
+        if (!spline.valid()) return;
+
+        const double tol = std::max(chordTolerance, 1e-12);
+        const auto& knots = spline.knots();
+        const std::size_t p = static_cast<std::size_t>(spline.degree());
+
+        // One chord per non-empty knot span to start with.
+        std::vector<double> breaks;
+        for (std::size_t k = p; knots[k] < spline.last(); ++k) {
+            if (knots[k] < knots[k + 1]) breaks.push_back(knots[k]);
+        }
+        breaks.push_back(spline.last());
+
+        struct Piece {
+            double t0, t1;
+            Vec2 a, b; // at t0 and t1
+            bool done;
+        };
+
+        std::vector<double> ts(breaks);
+        std::vector<Vec2> at(ts.size());
+        spline.evaluate(ts.data(), ts.size(), at.data());
+
+        std::vector<Piece> pieces;
+        for (std::size_t i = 0; i + 1 < breaks.size(); ++i) pieces.push_back({ breaks[i], breaks[i + 1], at[i], at[i + 1], false });
+
+        std::vector<Piece> next;
+        for (int depth = 0; depth < kMaxDepth; ++depth) {
+            // The quarter points of every open piece, in one batch.
+            ts.clear();
+            for (const Piece& piece : pieces) {
+                if (piece.done) continue;
+                for (double f : { 0.25, 0.5, 0.75 }) ts.push_back(piece.t0 + f * (piece.t1 - piece.t0));
+            }
+            if (ts.empty()) break;
+            at.resize(ts.size());
+            spline.evaluate(ts.data(), ts.size(), at.data());
+
+            // Deviation falls roughly with the square of the piece count, so a
+            // piece straying d is cut into a little over sqrt(d / tol) equal
+            // parts (the quarter points underestimate d); their inner ends form
+            // a second batch.
+            next.clear();
+            std::vector<double> cuts;
+            std::size_t q = 0;
+            for (const Piece& piece : pieces) {
+                if (piece.done) {
+                    next.push_back(piece);
+                    continue;
+                }
+                double d = 0.0;
+                for (int k = 0; k < 3; ++k) d = std::max(d, chordDistance(at[q++], piece.a, piece.b));
+                if (d <= tol || next.size() >= kMaxSegments) {
+                    next.push_back({ piece.t0, piece.t1, piece.a, piece.b, true });
+                    continue;
+                }
+                const int parts = static_cast<int>(std::clamp(std::ceil(1.2 * std::sqrt(d / tol)), 2.0, 64.0));
+                const double dt = (piece.t1 - piece.t0) / parts;
+                for (int k = 0; k < parts; ++k) {
+                    const double t0 = piece.t0 + k * dt;
+                    const double t1 = k + 1 == parts ? piece.t1 : t0 + dt;
+                    next.push_back({ t0, t1, piece.a, piece.b, false });
+                    if (k > 0) cuts.push_back(t0);
+                }
+            }
+            at.resize(cuts.size());
+            spline.evaluate(cuts.data(), cuts.size(), at.data());
+            std::size_t c = 0;
+            for (std::size_t i = 1; i < next.size(); ++i) {
+                // Cuts were queued in order, at the t0 of each new piece but the first.
+                Piece& piece = next[i];
+                Piece& prev = next[i - 1];
+                if (!piece.done && !prev.done && c < cuts.size() && piece.t0 == cuts[c]) {
+                    prev.b = at[c];
+                    piece.a = at[c];
+                    ++c;
+                }
+            }
+            pieces.swap(next);
+        }
+
+        points.reserve(pieces.size() + 1);
+        points.push_back(pieces.front().a);
+        for (const Piece& piece : pieces) points.push_back(piece.b);
+        if (params) {
+            params->reserve(pieces.size() + 1);
+            params->push_back(pieces.front().t0);
+            for (const Piece& piece : pieces) params->push_back(piece.t1);
+        }
+    }
+
+    CurveTessellationCache::CurveTessellationCache(double chordTolerance)
+        : m_tolerance(chordTolerance) {}
+
+    void CurveTessellationCache::setTolerance(double chordTolerance) {
+        if (chordTolerance == m_tolerance) return;
+        m_tolerance = chordTolerance;
+        m_entries.clear();
+    }
+
+    const std::vector<Vec2>& CurveTessellationCache::get(const EntityStore& store, std::uint32_t idx) {
+        const auto& c = store.curves();
+        const auto& cps = c.controlPoints[idx];
+        const auto& headers = store.headers(EntityKind::Curve);
+
+        Entry& entry = m_entries[headers.ids[idx]];
+        if (entry.version == headers.versions[idx]) return entry.points;
+        entry.version = headers.versions[idx];
+
+        std::uint64_t h = mix(c.closed[idx], c.degree[idx]);
+        for (const Vec2& v : cps) h = mix(mix(h, bitsOf(v.x)), bitsOf(v.y));
+        h = mix(h, c.knots[idx].size());
+        for (double k : c.knots[idx]) h = mix(h, bitsOf(k));
+        h = mix(h, c.weights[idx].size());
+        for (double w : c.weights[idx]) h = mix(h, bitsOf(w));
+
+        if (entry.fingerprint == h && (!entry.points.empty() || cps.size() < 2)) return entry.points;
+
+        entry.fingerprint = h;
+        tessellate(BSpline::fromStore(store, idx), m_tolerance, entry.points);
+        if (c.closed[idx] && entry.points.size() > 2) {
+            const Vec2& a = entry.points.front();
+            const Vec2& b = entry.points.back();
+            if (std::hypot(a.x - b.x, a.y - b.y) <= m_tolerance) entry.points.back() = a;
+            else entry.points.push_back(a);
+        }
+        ++m_tessellations;
+        return entry.points;
+    }
+
+    void CurveTessellationCache::prune(const EntityStore& store) {
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (store.contains(it->first)) ++it;
+            else it = m_entries.erase(it);
+        }
+    }
+
+} // namespace domain::sketch
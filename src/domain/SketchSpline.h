@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "SketchEntities.h"
+#include "SketchIds.h"
+#include "SketchMath.h"
+
+namespace domain::sketch {
+
+    // The shape of a curve at one of its ends, for constraints there. Only a
+    // clamped end (p + 1 equal knots) starts at its end control point E; its
+    // tangent then runs along the leg u = N - E to the next control point,
+    // and its curvature is curvature * |u x w| / |u|^3, w being the leg after
+    // u. The factor comes from the knots, degree and weights: 2/3 for a cubic
+    // Bezier, 1/2 for a quadratic one, 0 for degree 1.
+    struct SplineEnd {
+        bool clamped{ false };
+        double curvature{ 0.0 };
+    };
+
+    // A curve entity in evaluation form: degree p, knot vector and control
+    // points in homogeneous coordinates (w*x, w*y, w), stored as columns.
+    //
+    // Missing or malformed knots fall back to a uniform vector (clamped for
+    // open curves, so they pass through their end points; periodic for closed
+    // ones, with the first p control points wrapped around). Weights are
+    // ignored unless there is one positive weight per control point.
+    class BSpline {
+    public:
+        static constexpr int kMaxDegree = 15;
+
+        BSpline() = default;
+        BSpline(const std::vector<Vec2>& controlPoints, int degree, const std::vector<double>& knots,
+            const std::vector<double>& weights, bool closed);
+
+        // The idx-th curve of a store.
+        static BSpline fromStore(const EntityStore& store, std::uint32_t idx);
+
+        bool valid() const { return !m_x.empty(); }
+        int degree() const { return m_degree; }
+        bool rational() const { return m_rational; }
+        const std::vector<double>& knots() const { return m_knots; }
+
+        // Parameter domain.
+        double first() const { return m_knots[m_degree]; }
+        double last() const { return m_knots[m_x.size()]; }
+
+        Vec2 evaluate(double t) const;
+
+        // The start (atLast false) or end of the curve. Periodic curves have
+        // no clamped ends.
+        SplineEnd end(bool atLast) const;
+
+        // out[i] = evaluate(t[i]) for i < n. De Boor runs on blocks of
+        // parameters side by side, so its recurrences compile to vector code.
+        void evaluate(const double* t, std::size_t n, Vec2* out) const;
+
+    private:
+        int m_degree{ 0 };
+        bool m_rational{ false };
+        std::vector<double> m_knots;
+        std::vector<double> m_x, m_y, m_w; // homogeneous control points
+
+        std::size_t span(double t) const;
+    };
+
+    // Flattens a spline into a polyline that stays within `chordTolerance`
+    // of the curve. Each knot span starts as one chord, which is split at its
+    // midpoint while the curve at 1/4, 1/2 or 3/4 of it strays further than
+    // the tolerance, so flat stretches get few segments and tight bends many.
+    // `params`, when given, receives the parameter of each point.
+    void tessellate(const BSpline& spline, double chordTolerance, std::vector<Vec2>& points,
+        std::vector<double>* params = nullptr);
+
+    // Tessellations of a store's curves, kept per entity and redone only when
+    // the curve's control points, knots, weights, degree or closure change.
+    // An entity whose store version is unchanged is not even hashed again.
+    class CurveTessellationCache {
+    public:
+        explicit CurveTessellationCache(double chordTolerance = 1e-3);
+
+        // Clears the cache if the tolerance changes.
+        void setTolerance(double chordTolerance);
+        double tolerance() const { return m_tolerance; }
+
+        // Polyline of the idx-th curve of `store`; closed curves repeat the
+        // first point. Valid until the next call that re-tessellates it.
+        const std::vector<Vec2>& get(const EntityStore& store, std::uint32_t idx);
+
+        // Drops the entries of curves no longer in `store`.
+        void prune(const EntityStore& store);
+        void erase(EntityId id) { m_entries.erase(id); }
+        void clear() { m_entries.clear(); }
+
+        std::size_t size() const { return m_entries.size(); }
+        // Curves tessellated since construction, for profiling.
+        std::size_t tessellations() const { return m_tessellations; }
+
+    private:
+        struct Entry {
+            std::uint64_t version{ 0 }; // entity version the entry was checked at
+            std::uint64_t fingerprint{ 0 };
+            std::vector<Vec2> points;
+        };
+
+        double m_tolerance;
+        std::unordered_map<EntityId, Entry> m_entries;
+        std::size_t m_tessellations{ 0 };
+    };
+
+} // namespace domain::sketch
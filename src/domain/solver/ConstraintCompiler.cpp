@@ -0,0 +1,587 @@
+#include "domain/solver/ConstraintCompiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace domain::solver {
+
+    using namespace domain::sketch;
+
+    namespace {
+
+        constexpr double kDegToRad = 3.14159265358979323846 / 180.0;
+
+        // Two parameter indices describing a directed segment A -> B (x,y pairs).
+        struct Segment {
+            ParamIndex a{ kInvalidParam };
+            ParamIndex b{ kInvalidParam };
+            bool valid() const { return a != kInvalidParam; }
+        };
+
+        // Center (x,y pair) and radius parameter of a circle-like entity.
+        struct Round {
+            ParamIndex center{ kInvalidParam };
+            ParamIndex radius{ kInvalidParam };
+            bool valid() const { return center != kInvalidParam; }
+        };
+
+        // Equation argument: a single parameter or an (x,y) pair starting at p.
+        struct Arg {
+            ParamIndex p;
+            bool pair;
+        };
+
+        inline Arg pt(ParamIndex p) { return { p, true }; }
+        inline Arg sc(ParamIndex p) { return { p, false }; }
+
+        struct Ref {
+            const EntityParams* ep{ nullptr };
+            EntityAnchor anchor{ EntityAnchor::None };
+
+            bool is(EntityKind k) const { return ep && ep->kind == k; }
+        };
+
+        // Constraints reference only a handful of entities; resolve them on the stack.
+        struct RefList {
+            std::array<Ref, 8> items{};
+            std::size_t count{ 0 };
+
+            std::size_t size() const { return count; }
+            const Ref& operator[](std::size_t i) const { return items[i]; }
+            const Ref* begin() const { return items.data(); }
+            const Ref* end() const { return items.data() + count; }
+        };
+
+        bool isCurveEnd(EntityAnchor a) {
+            return a == EntityAnchor::End || a == EntityAnchor::CurvePoint1 || a == EntityAnchor::CurveTangent1;
+        }
+
+        // The curve end a reference names. Only a clamped end lies on its end
+        // control point with its tangent along the first leg.
+        const SplineEnd& curveEnd(const Ref& r) {
+            return r.ep->ends[isCurveEnd(r.anchor) ? 1 : 0];
+        }
+
+        // Resolves a reference to a concrete (x,y) parameter pair, if the anchor names one.
+        ParamIndex pointOf(const Ref& r) {
+            if (!r.ep) return kInvalidParam;
+            const auto off = r.ep->offset;
+            switch (r.ep->kind) {
+            case EntityKind::Point:
+                return off + layout::PointP;
+            case EntityKind::Line:
+                if (r.anchor == EntityAnchor::LineStart) return off + layout::LineA;
+                if (r.anchor == EntityAnchor::LineEnd) return off + layout::LineB;
+                return kInvalidParam;
+            case EntityKind::Circle:
+                return r.anchor == EntityAnchor::Center ? off + layout::CircleCenter : kInvalidParam;
+            case EntityKind::Arc:
+                if (r.anchor == EntityAnchor::Center) return off + layout::ArcCenter;
+                if (r.anchor == EntityAnchor::Start) return off + layout::ArcStart;
+                if (r.anchor == EntityAnchor::End) return off + layout::ArcEnd;
+                return kInvalidParam;
+            case EntityKind::Ellipse:
+                return r.anchor == EntityAnchor::Center ? off + layout::EllipseCenter : kInvalidParam;
+            case EntityKind::Curve:
+                if (r.ep->count < 2 || !curveEnd(r).clamped) return kInvalidParam;
+                if (r.anchor == EntityAnchor::CurvePoint0 || r.anchor == EntityAnchor::Start) return off;
+                if (r.anchor == EntityAnchor::CurvePoint1 || r.anchor == EntityAnchor::End) return off + r.ep->count - 2;
+                return kInvalidParam;
+            }
+            return kInvalidParam;
+        }
+
+        // Line-like direction: a line, or the end tangent of a curve (pointing out of the curve end).
+        Segment segmentOf(const Ref& r) {
+            if (r.is(EntityKind::Line)) {
+                return { r.ep->offset + layout::LineA, r.ep->offset + layout::LineB };
+            }
+            if (r.is(EntityKind::Curve) && r.ep->count >= 4 && curveEnd(r).clamped) {
+                const auto off = r.ep->offset;
+                const auto last = off + r.ep->count - 2;
+                if (isCurveEnd(r.anchor)) return { last - 2, last };
+                return { off + 2, off };
+            }
+            return {};
+        }
+
+        Round roundOf(const Ref& r) {
+            if (r.is(EntityKind::Circle)) {
+                return { r.ep->offset + layout::CircleCenter, r.ep->offset + layout::CircleRadius };
+            }
+            if (r.is(EntityKind::Arc)) {
+                return { r.ep->offset + layout::ArcCenter, r.ep->offset + layout::ArcRadius };
+            }
+            return {};
+        }
+
+        ParamIndex centerOf(const Ref& r) {
+            if (r.is(EntityKind::Circle) || r.is(EntityKind::Arc) || r.is(EntityKind::Ellipse)) {
+                return r.ep->offset; // center is first in every round layout
+            }
+            return kInvalidParam;
+        }
+
+        // Appends equations for one constraint. All helpers write into the caller's
+        // vector; nothing here allocates per equation beyond vector growth.
+        class Emitter {
+        public:
+            Emitter(std::vector<Equation>& out, const double* x, ConstraintId source)
+                : m_out(out), m_x(x), m_source(source) {
+            }
+
+            const double* x() const { return m_x; }
+
+            void linear(std::initializer_list<std::pair<ParamIndex, double>> terms, double value) {
+                Equation eq;
+                eq.kind = EquationKind::Linear;
+                eq.value = value;
+                eq.source = m_source;
+                for (const auto& [p, k] : terms) {
+                    eq.p[eq.paramCount] = p;
+                    eq.k[eq.paramCount] = k;
+                    ++eq.paramCount;
+                }
+                m_out.push_back(eq);
+            }
+
+            Equation& emit(EquationKind kind, std::initializer_list<Arg> args, double value = 0.0) {
+                Equation eq;
+                eq.kind = kind;
+                eq.value = value;
+                eq.source = m_source;
+                for (const Arg& a : args) {
+                    eq.p[eq.paramCount++] = a.p;
+                    if (a.pair) eq.p[eq.paramCount++] = a.p + 1;
+                }
+                m_out.push_back(eq);
+                return m_out.back();
+            }
+
+            void coincident(ParamIndex a, ParamIndex b) {
+                if (a == b) return;
+                linear({ { a, 1.0 }, { b, -1.0 } }, 0.0);
+                linear({ { a + 1, 1.0 }, { b + 1, -1.0 } }, 0.0);
+            }
+
+            void midpoint(ParamIndex m, ParamIndex a, ParamIndex b) {
+                linear({ { m, 1.0 }, { a, -0.5 }, { b, -0.5 } }, 0.0);
+                linear({ { m + 1, 1.0 }, { a + 1, -0.5 }, { b + 1, -0.5 } }, 0.0);
+            }
+
+            void pointDistance(ParamIndex a, ParamIndex b, double value) {
+                emit(EquationKind::PointDistance, { pt(a), pt(b) }, value);
+            }
+
+            void pointOnCircle(ParamIndex p, Round c) {
+                emit(EquationKind::PointOnCircle, { pt(p), pt(c.center), sc(c.radius) });
+            }
+
+            // Signed distance of p from segment s; `value` is matched with the side p currently lies on.
+            void pointLineDistance(ParamIndex p, Segment s, double value) {
+                emit(EquationKind::PointLineDistance, { pt(p), pt(s.a), pt(s.b) }, signedSide(p, s) * value);
+            }
+
+            void midpointOnLine(ParamIndex p0, ParamIndex p1, Segment s) {
+                emit(EquationKind::MidpointLineDistance, { pt(p0), pt(p1), pt(s.a), pt(s.b) });
+            }
+
+            void lineCircleTangent(Segment s, Round c) {
+                Equation& eq = emit(EquationKind::LineCircleTangent, { pt(c.center), sc(c.radius), pt(s.a), pt(s.b) });
+                eq.k[0] = signedSide(c.center, s);
+            }
+
+            void circleCircleTangent(Round c0, Round c1) {
+                const double dx = m_x[c0.center] - m_x[c1.center];
+                const double dy = m_x[c0.center + 1] - m_x[c1.center + 1];
+                const double d = std::sqrt(dx * dx + dy * dy);
+                const double r0 = m_x[c0.radius];
+                const double r1 = m_x[c1.radius];
+
+                // Internal tangency if one circle currently sits inside the other.
+                const bool internal = d < std::max(r0, r1);
+                if (internal && r1 > r0) std::swap(c0, c1);
+
+                Equation& eq = emit(EquationKind::CircleCircleTangent, { pt(c0.center), sc(c0.radius), pt(c1.center), sc(c1.radius) });
+                eq.k[0] = internal ? -1.0 : 1.0;
+            }
+
+            void directional(EquationKind kind, Segment s0, Segment s1, double value = 0.0) {
+                emit(kind, { pt(s0.a), pt(s0.b), pt(s1.a), pt(s1.b) }, value);
+            }
+
+            // Signed angle from s0 to s1; the target takes the rotation sense the geometry currently has.
+            void angle(Segment s0, Segment s1, double radians) {
+                const double ux = m_x[s0.b] - m_x[s0.a], uy = m_x[s0.b + 1] - m_x[s0.a + 1];
+                const double vx = m_x[s1.b] - m_x[s1.a], vy = m_x[s1.b + 1] - m_x[s1.a + 1];
+                const double sense = (ux * vy - uy * vx) < 0.0 ? -1.0 : 1.0;
+                directional(EquationKind::Angle, s0, s1, sense * radians);
+            }
+
+            // `factor` is SplineEnd::curvature of the curve end at p0.
+            void endCurvature(ParamIndex p0, ParamIndex p1, ParamIndex p2, ParamIndex radius, double factor) {
+                Equation& eq = emit(EquationKind::EndCurvature, { pt(p0), pt(p1), pt(p2), sc(radius) });
+                eq.k[0] = factor;
+            }
+
+        private:
+            std::vector<Equation>& m_out;
+            const double* m_x;
+            ConstraintId m_source;
+
+            double signedSide(ParamIndex p, Segment s) const {
+                const double dx = m_x[s.b] - m_x[s.a];
+                const double dy = m_x[s.b + 1] - m_x[s.a + 1];
+                const double mx = m_x[p] - m_x[s.a];
+                const double my = m_x[p + 1] - m_x[s.a + 1];
+                return (dx * my - dy * mx) < 0.0 ? -1.0 : 1.0;
+            }
+        };
+
+        // Tries (a,b) and then (b,a) so callers only write one argument order.
+        template <typename F>
+        bool eitherOrder(const Ref& a, const Ref& b, F&& f) {
+            return f(a, b) || f(b, a);
+        }
+
+        bool compileGeometric(const GeometricConstraint& c, const RefList& refs, Emitter& em) {
+            const auto n = refs.size();
+
+            switch (c.type) {
+            case GeometricConstraintType::Horizontal:
+            case GeometricConstraintType::Vertical: {
+                const ParamIndex axis = (c.type == GeometricConstraintType::Horizontal) ? 1 : 0;
+                if (n == 1) {
+                    const Segment s = segmentOf(refs[0]);
+                    if (!s.valid()) return false;
+                    em.linear({ { s.a + axis, 1.0 }, { s.b + axis, -1.0 } }, 0.0);
+                    return true;
+                }
+                if (n == 2) {
+                    const ParamIndex a = pointOf(refs[0]);
+                    const ParamIndex b = pointOf(refs[1]);
+                    if (a == kInvalidParam || b == kInvalidParam) return false;
+                    em.linear({ { a + axis, 1.0 }, { b + axis, -1.0 } }, 0.0);
+                    return true;
+                }
+                return false;
+            }
+
+            case GeometricConstraintType::Coincident: {
+                if (n != 2) return false;
+                const ParamIndex a = pointOf(refs[0]);
+                const ParamIndex b = pointOf(refs[1]);
+                if (a != kInvalidParam && b != kInvalidParam) {
+                    em.coincident(a, b);
+                    return true;
+                }
+                return eitherOrder(refs[0], refs[1], [&](const Ref& pr, const Ref& other) {
+                    const ParamIndex p = pointOf(pr);
+                    if (p == kInvalidParam) return false;
+                    if (other.is(EntityKind::Line)) {
+                        const Segment s = segmentOf(other);
+                        if (other.anchor == EntityAnchor::LineMid) em.midpoint(p, s.a, s.b);
+                        else em.pointLineDistance(p, s, 0.0);
+                        return true;
+                    }
+                    const Round r = roundOf(other);
+                    if (r.valid()) {
+                        em.pointOnCircle(p, r);
+                        return true;
+                    }
+                    return false;
+                });
+            }
+
+            case GeometricConstraintType::Tangent: {
+                if (n != 2) return false;
+                const Round r0 = roundOf(refs[0]);
+                const Round r1 = roundOf(refs[1]);
+                if (r0.valid() && r1.valid()) {
+                    em.circleCircleTangent(r0, r1);
+                    return true;
+                }
+                return eitherOrder(refs[0], refs[1], [&](const Ref& lr, const Ref& other) {
+                    const Segment s = segmentOf(lr);
+                    if (!s.valid()) return false;
+                    const Round r = roundOf(other);
+                    if (lr.is(EntityKind::Curve)) {
+                        // G1 at the curve end: tangent parallel to a line, or normal to a radius.
+                        if (other.is(EntityKind::Line)) {
+                            em.directional(EquationKind::Cross, s, segmentOf(other));
+                            return true;
+                        }
+                        if (r.valid()) {
+                            em.directional(EquationKind::Dot, s, Segment{ r.center, s.b });
+                            return true;
+                        }
+                        return false;
+                    }
+                    if (!r.valid()) return false;
+                    em.lineCircleTangent(s, r);
+                    return true;
+                });
+            }
+
+            case GeometricConstraintType::Perpendicular:
+            case GeometricConstraintType::Parallel: {
+                if (n != 2) return false;
+                const Segment s0 = segmentOf(refs[0]);
+                const Segment s1 = segmentOf(refs[1]);
+                if (!s0.valid() || !s1.valid()) return false;
+                em.directional(c.type == GeometricConstraintType::Parallel ? EquationKind::Cross : EquationKind::Dot, s0, s1);
+                return true;
+            }
+
+            case GeometricConstraintType::Collinear: {
+                if (n != 2) return false;
+                const Segment s0 = segmentOf(refs[0]);
+                const Segment s1 = segmentOf(refs[1]);
+                if (!refs[0].is(EntityKind::Line) || !refs[1].is(EntityKind::Line)) return false;
+                em.pointLineDistance(s1.a, s0, 0.0);
+                em.pointLineDistance(s1.b, s0, 0.0);
+                return true;
+            }
+
+            case GeometricConstraintType::Midpoint: {
+                if (n != 2) return false;
+                return eitherOrder(refs[0], refs[1], [&](const Ref& pr, const Ref& lr) {
+                    const ParamIndex p = pointOf(pr);
+                    if (p == kInvalidParam || !lr.is(EntityKind::Line)) return false;
+                    const Segment s = segmentOf(lr);
+                    em.midpoint(p, s.a, s.b);
+                    return true;
+                });
+            }
+
+            case GeometricConstraintType::Concentric: {
+                if (n != 2) return false;
+                const ParamIndex a = centerOf(refs[0]);
+                const ParamIndex b = centerOf(refs[1]);
+                if (a == kInvalidParam || b == kInvalidParam) return false;
+                em.coincident(a, b);
+                return true;
+            }
+
+            case GeometricConstraintType::Symmetry: {
+                if (n != 3) return false;
+                const ParamIndex p0 = pointOf(refs[0]);
+                const ParamIndex p1 = pointOf(refs[1]);
+                if (p0 == kInvalidParam || p1 == kInvalidParam) return false;
+                if (refs[2].is(EntityKind::Line) && refs[2].anchor != EntityAnchor::LineStart && refs[2].anchor != EntityAnchor::LineEnd) {
+                    const Segment axis = segmentOf(refs[2]);
+                    em.midpointOnLine(p0, p1, axis);
+                    em.directional(EquationKind::Dot, Segment{ p0, p1 }, axis);
+                    return true;
+                }
+                const ParamIndex m = pointOf(refs[2]);
+                if (m == kInvalidParam) return false;
+                em.midpoint(m, p0, p1);
+                return true;
+            }
+
+            case GeometricConstraintType::Fix: {
+                if (n == 0) return false;
+                for (const Ref& r : refs) {
+                    if (!r.ep) return false;
+                    const ParamIndex p = (r.anchor != EntityAnchor::None) ? pointOf(r) : kInvalidParam;
+                    if (p != kInvalidParam) {
+                        em.linear({ { p, 1.0 } }, em.x()[p]);
+                        em.linear({ { p + 1, 1.0 } }, em.x()[p + 1]);
+                        continue;
+                    }
+                    for (std::uint32_t i = 0; i < r.ep->count; ++i) {
+                        const ParamIndex q = r.ep->offset + i;
+                        em.linear({ { q, 1.0 } }, em.x()[q]);
+                    }
+                }
+                return true;
+            }
+
+            case GeometricConstraintType::Curvature: {
+                if (n != 2) return false;
+                return eitherOrder(refs[0], refs[1], [&](const Ref& cr, const Ref& other) {
+                    if (!cr.is(EntityKind::Curve) || cr.ep->count < 6) return false;
+                    const Segment t = segmentOf(cr);   // (P1 -> P0) at the joined end
+                    if (!t.valid()) return false;
+                    const double factor = curveEnd(cr).curvature;
+                    const ParamIndex p0 = t.b;
+                    const ParamIndex p1 = t.a;
+                    const ParamIndex p2 = isCurveEnd(cr.anchor) ? p1 - 2 : p1 + 2;
+                    if (other.is(EntityKind::Line)) {
+                        // Matching a line: tangent along the line and zero end curvature
+                        // (which a degree 1 curve has anyway).
+                        em.directional(EquationKind::Cross, t, segmentOf(other));
+                        if (factor != 0.0) em.directional(EquationKind::Cross, Segment{ p0, p1 }, Segment{ p1, p2 });
+                        return true;
+                    }
+                    const Round r = roundOf(other);
+                    if (!r.valid() || factor == 0.0) return false;
+                    em.directional(EquationKind::Dot, t, Segment{ r.center, p0 });
+                    em.endCurvature(p0, p1, p2, r.radius, factor);
+                    return true;
+                });
+            }
+            }
+            return false;
+        }
+
+        bool compileDimensional(const DimensionalConstraint& c, const RefList& refs, Emitter& em) {
+            const auto n = refs.size();
+
+            switch (c.type) {
+            case DimensionalConstraintType::Distance: {
+                if (n != 2) return false;
+                const ParamIndex a = pointOf(refs[0]);
+                const ParamIndex b = pointOf(refs[1]);
+                if (a != kInvalidParam && b != kInvalidParam) {
+                    em.pointDistance(a, b, c.value);
+                    return true;
+                }
+                if (refs[0].is(EntityKind::Line) && refs[1].is(EntityKind::Line)) {
+                    // Offset between lines: both ends of the second line keep the distance.
+                    const Segment s0 = segmentOf(refs[0]);
+                    const Segment s1 = segmentOf(refs[1]);
+                    em.pointLineDistance(s1.a, s0, c.value);
+                    em.pointLineDistance(s1.b, s0, c.value);
+                    return true;
+                }
+                return eitherOrder(refs[0], refs[1], [&](const Ref& pr, const Ref& lr) {
+                    const ParamIndex p = pointOf(pr);
+                    if (p == kInvalidParam || !lr.is(EntityKind::Line)) return false;
+                    em.pointLineDistance(p, segmentOf(lr), c.value);
+                    return true;
+                });
+            }
+
+            case DimensionalConstraintType::Length: {
+                if (n == 1 && refs[0].is(EntityKind::Line)) {
+                    const Segment s = segmentOf(refs[0]);
+                    em.pointDistance(s.a, s.b, c.value);
+                    return true;
+                }
+                if (n == 2) {
+                    const ParamIndex a = pointOf(refs[0]);
+                    const ParamIndex b = pointOf(refs[1]);
+                    if (a == kInvalidParam || b == kInvalidParam) return false;
+                    em.pointDistance(a, b, c.value);
+                    return true;
+                }
+                return false;
+            }
+
+            case DimensionalConstraintType::Angle: {
+                if (n != 2) return false;
+                const Segment s0 = segmentOf(refs[0]);
+                const Segment s1 = segmentOf(refs[1]);
+                if (!s0.valid() || !s1.valid()) return false;
+                const double radians = (c.units == "deg") ? c.value * kDegToRad : c.value;
+                em.angle(s0, s1, radians);
+                return true;
+            }
+
+            case DimensionalConstraintType::Radius:
+            case DimensionalConstraintType::Diameter: {
+                // Any reference onto the round entity names it (Center, RadiusPoint, ...).
+                for (const Ref& r : refs) {
+                    const Round round = roundOf(r);
+                    if (!round.valid()) continue;
+                    const double k = (c.type == DimensionalConstraintType::Diameter) ? 2.0 : 1.0;
+                    em.linear({ { round.radius, k } }, c.value);
+                    return true;
+                }
+                return false;
+            }
+            }
+            return false;
+        }
+
+    } // namespace
+
+    bool isActiveConstraint(const Constraint& constraint) {
+        return std::visit([](auto&& c) {
+            using T = std::decay_t<decltype(c)>;
+            if (!c.meta.enabled || c.meta.suppressed) return false;
+            if constexpr (std::is_same_v<T, DimensionalConstraint>) return c.driving;
+            return true;
+        }, constraint);
+    }
+
+    bool compileConstraint(const Constraint& constraint, const ParameterTable& params, std::vector<Equation>& out) {
+        return std::visit([&](auto&& c) {
+            using T = std::decay_t<decltype(c)>;
+
+            RefList refs;
+            if (c.refs.size() > refs.items.size()) return false;
+            for (const auto& r : c.refs) {
+                const EntityParams* ep = params.find(r.id);
+                if (!ep) return false;
+                refs.items[refs.count++] = Ref{ ep, r.anchor };
+            }
+
+            const std::size_t before = out.size();
+            Emitter em(out, params.values().data(), c.meta.id);
+
+            bool ok = false;
+            if constexpr (std::is_same_v<T, GeometricConstraint>) {
+                ok = compileGeometric(c, refs, em);
+            } else {
+                ok = compileDimensional(c, refs, em);
+            }
+
+            if (!ok) out.resize(before);
+            return ok;
+        }, constraint);
+    }
+
+    void compileIntrinsic(const ParameterTable& params, const EntityParams& entity, std::vector<Equation>& out) {
+        if (entity.kind != EntityKind::Arc) return;
+
+        Emitter em(out, params.values().data(), ConstraintId{});
+        const Round r{ entity.offset + layout::ArcCenter, entity.offset + layout::ArcRadius };
+        em.pointOnCircle(entity.offset + layout::ArcStart, r);
+        em.pointOnCircle(entity.offset + layout::ArcEnd, r);
+    }
+
+    void compileSketch(const Sketch& sketch, const ParameterTable& params, EquationSystem& out) {
+        out.clear();
+        out.equations.reserve(2 * sketch.constraints.size() + 2 * sketch.entities.arcs().size());
+
+        for (EntityId id : sketch.entities.headers(EntityKind::Arc).ids) {
+            if (const EntityParams* ep = params.find(id)) {
+                compileIntrinsic(params, *ep, out.equations);
+            }
+        }
+
+        for (const auto& constraint : sketch.constraints) {
+            if (!isActiveConstraint(constraint)) continue;
+
+            if (!compileConstraint(constraint, params, out.equations)) {
+                std::visit([&](auto&& c) { out.unsupported.push_back(c.meta.id); }, constraint);
+            }
+        }
+    }
+
+    void compileCluster(const Sketch& sketch, const std::vector<EntityId>& entities,
+        const std::vector<std::uint32_t>& constraints, const ParameterTable& params, EquationSystem& out) {
+        out.clear();
+        out.equations.reserve(2 * constraints.size() + entities.size());
+
+        for (EntityId id : entities) {
+            const EntityParams* ep = params.find(id);
+            if (ep && ep->kind == EntityKind::Arc) compileIntrinsic(params, *ep, out.equations);
+        }
+
+        for (std::uint32_t ci : constraints) {
+            const auto& constraint = sketch.constraints[ci];
+            if (!compileConstraint(constraint, params, out.equations)) {
+                std::visit([&](auto&& c) { out.unsupported.push_back(c.meta.id); }, constraint);
+            }
+        }
+    }
+
+} // namespace domain::solver
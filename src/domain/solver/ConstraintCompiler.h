@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "domain/SketchModel.h"
+#include "Equations.h"
+#include "ParameterTable.h"
+
+namespace domain::solver {
+
+    struct EquationSystem {
+        std::vector<Equation> equations;
+        std::vector<sketch::ConstraintId> unsupported;
+
+        void clear() {
+            equations.clear();
+            unsupported.clear();
+        }
+    };
+
+    // Enabled, not suppressed and (for dimensions) driving.
+    bool isActiveConstraint(const sketch::Constraint& constraint);
+
+    // Translates Sketch::constraints into primitive equations over the packed
+    // parameter vector. Disabled, suppressed and driven (non-driving) constraints
+    // are skipped. Sign-ambiguous constraints (tangency side, signed distances)
+    // take their branch from the current geometry in `params`.
+    //
+    // Angles are in radians unless the dimension's units are "deg".
+    void compileSketch(const sketch::Sketch& sketch, const ParameterTable& params, EquationSystem& out);
+
+    // Like compileSketch, restricted to one cluster: arc intrinsics for the listed
+    // entities plus the listed constraints (indices into Sketch::constraints,
+    // assumed active). `params` must hold every entity they reference.
+    void compileCluster(const sketch::Sketch& sketch, const std::vector<sketch::EntityId>& entities,
+        const std::vector<std::uint32_t>& constraints, const ParameterTable& params, EquationSystem& out);
+
+    // Compiles a single constraint (appends to `out`). Returns false if the
+    // constraint's reference pattern is not supported.
+    bool compileConstraint(const sketch::Constraint& constraint, const ParameterTable& params, std::vector<Equation>& out);
+
+    // Equations every arc carries implicitly: start and end lie on the arc's circle.
+    void compileIntrinsic(const ParameterTable& params, const EntityParams& entity, std::vector<Equation>& out);
+
+} // namespace domain::solver
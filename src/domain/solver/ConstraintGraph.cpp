@@ -0,0 +1,122 @@
+#include "domain/solver/ConstraintGraph.h"
+
+#include <algorithm>
+#include <array>
+
+#include "domain/solver/ConstraintCompiler.h"
+
+namespace domain::solver {
+
+    using namespace domain::sketch;
+
+    namespace {
+
+        constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+
+        std::uint32_t findRoot(std::vector<std::uint32_t>& parent, std::uint32_t i) {
+            while (parent[i] != i) {
+                parent[i] = parent[parent[i]]; // path halving
+                i = parent[i];
+            }
+            return i;
+        }
+
+        void unite(std::vector<std::uint32_t>& parent, std::uint32_t a, std::uint32_t b) {
+            a = findRoot(parent, a);
+            b = findRoot(parent, b);
+            if (a == b) return;
+            // Attach the higher index below the lower so roots are stable across builds.
+            if (a < b) parent[b] = a;
+            else parent[a] = b;
+        }
+
+    } // namespace
+
+    void ConstraintGraph::build(const Sketch& sketch) {
+        const auto& store = sketch.entities;
+
+        m_clusters.clear();
+        m_orphans.clear();
+        m_clusterOfEntity.clear();
+
+        // Dense entity numbering: typed vectors laid end to end.
+        std::array<std::uint32_t, kEntityKindCount> base{};
+        std::uint32_t total = 0;
+        for (std::size_t k = 0; k < kEntityKindCount; ++k) {
+            base[k] = total;
+            total += static_cast<std::uint32_t>(store.count(static_cast<EntityKind>(k)));
+        }
+
+        m_denseIds.resize(total);
+        for (std::size_t k = 0; k < kEntityKindCount; ++k) {
+            const auto& ids = store.headers(static_cast<EntityKind>(k)).ids;
+            std::copy(ids.begin(), ids.end(), m_denseIds.begin() + base[k]);
+        }
+
+        auto denseOf = [&](EntityId id) -> std::uint32_t {
+            if (!store.contains(id)) return kNone;
+            const EntityHandle h = store.getHandle(id);
+            return base[static_cast<std::size_t>(h.kind)] + store.indexOf(h);
+        };
+
+        m_parent.resize(total);
+        for (std::uint32_t i = 0; i < total; ++i) m_parent[i] = i;
+
+        // Pass 1: union the entities of every active constraint; remember an anchor entity per constraint.
+        std::vector<std::uint32_t> anchorOf(sketch.constraints.size(), kNone);
+        std::vector<char> touched(total, 0);
+        for (std::uint32_t ci = 0; ci < sketch.constraints.size(); ++ci) {
+            const auto& constraint = sketch.constraints[ci];
+            if (!isActiveConstraint(constraint)) continue;
+
+            std::visit([&](auto&& c) {
+                std::uint32_t first = kNone;
+                for (const auto& r : c.refs) {
+                    const std::uint32_t d = denseOf(r.id);
+                    if (d == kNone) continue;
+                    touched[d] = 1;
+                    if (first == kNone) first = d;
+                    else unite(m_parent, first, d);
+                }
+                anchorOf[ci] = first;
+            }, constraint);
+
+            if (anchorOf[ci] == kNone) m_orphans.push_back(ci);
+        }
+
+        // Arcs always carry intrinsic equations.
+        for (std::uint32_t i = 0; i < store.count(EntityKind::Arc); ++i) {
+            touched[base[static_cast<std::size_t>(EntityKind::Arc)] + i] = 1;
+        }
+
+        // Pass 2: number the roots and fill clusters.
+        std::vector<std::uint32_t> clusterOfRoot(total, kNone);
+        for (std::uint32_t d = 0; d < total; ++d) {
+            if (!touched[d]) continue;
+            const std::uint32_t root = findRoot(m_parent, d);
+            if (clusterOfRoot[root] == kNone) {
+                clusterOfRoot[root] = static_cast<std::uint32_t>(m_clusters.size());
+                m_clusters.emplace_back();
+            }
+            const std::uint32_t cl = clusterOfRoot[root];
+            m_clusters[cl].entities.push_back(m_denseIds[d]);
+            m_clusterOfEntity.emplace(m_denseIds[d], cl);
+        }
+
+        for (std::uint32_t ci = 0; ci < sketch.constraints.size(); ++ci) {
+            if (anchorOf[ci] == kNone) continue;
+            auto& cluster = m_clusters[clusterOfRoot[findRoot(m_parent, anchorOf[ci])]];
+            cluster.constraints.push_back(ci);
+        }
+
+        for (auto& cluster : m_clusters) {
+            cluster.equationEstimate = 2 * cluster.constraints.size() + cluster.entities.size();
+        }
+    }
+
+    std::size_t ConstraintGraph::clusterOf(EntityId id) const {
+        auto it = m_clusterOfEntity.find(id);
+        return it == m_clusterOfEntity.end() ? npos : it->second;
+    }
+
+} // namespace domain::solver
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "domain/SketchModel.h"
+
+namespace domain::solver {
+
+    // A connected component of the entity/constraint bipartite graph. Clusters
+    // share no parameters, so each one can be solved independently.
+    struct Cluster {
+        std::vector<sketch::EntityId> entities;
+        std::vector<std::uint32_t> constraints; // indices into Sketch::constraints
+        std::size_t equationEstimate{ 0 };      // rough work estimate used for scheduling
+    };
+
+    // Splits a sketch's active constraints into independent clusters using
+    // union-find over the entity ids named by each constraint's EntityRefs.
+    //
+    // Entities that no active constraint touches are left out, except arcs, whose
+    // start/end-on-circle equations always need solving.
+    class ConstraintGraph {
+    public:
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+        void build(const sketch::Sketch& sketch);
+
+        const std::vector<Cluster>& clusters() const { return m_clusters; }
+
+        // Constraints none of whose references resolve to an entity in the sketch.
+        const std::vector<std::uint32_t>& orphans() const { return m_orphans; }
+
+        // Cluster index of an entity, or npos if nothing constrains it.
+        std::size_t clusterOf(sketch::EntityId id) const;
+
+    private:
+        std::vector<Cluster> m_clusters;
+        std::vector<std::uint32_t> m_orphans;
+        std::unordered_map<sketch::EntityId, std::uint32_t> m_clusterOfEntity;
+
+        // Union-find scratch, kept to reuse its capacity between builds.
+        std::vector<std::uint32_t> m_parent;
+        std::vector<sketch::EntityId> m_denseIds;
+    };
+
+} // namespace domain::solver
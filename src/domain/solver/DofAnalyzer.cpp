@@ -0,0 +1,185 @@
+#include "domain/solver/DofAnalyzer.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+#include "domain/solver/ConstraintCompiler.h"
+
+namespace domain::solver {
+
+    using namespace domain::sketch;
+
+    namespace {
+
+        ConstraintHealth worse(ConstraintHealth a, ConstraintHealth b) {
+            auto rank = [](ConstraintHealth h) {
+                switch (h) {
+                case ConstraintHealth::Conflicting: return 2;
+                case ConstraintHealth::Redundant: return 1;
+                default: return 0;
+                }
+            };
+            return rank(b) > rank(a) ? b : a;
+        }
+
+    } // namespace
+
+    std::uint32_t DofAnalyzer::root(std::uint32_t param) {
+        while (m_parent[param] != param) {
+            m_parent[param] = m_parent[m_parent[param]];
+            param = m_parent[param];
+        }
+        return param;
+    }
+
+    void DofAnalyzer::unite(const Equation& eq) {
+        if (eq.paramCount == 0) return;
+        const std::uint32_t first = root(eq.p[0]);
+        for (int i = 1; i < eq.paramCount; ++i) {
+            const std::uint32_t other = root(eq.p[i]);
+            if (other != first) m_parent[other] = first;
+        }
+    }
+
+    ConstraintHealth DofAnalyzer::fold(const std::vector<Equation>& equations) {
+        const double* x = m_params.values().data();
+        ConstraintHealth health = ConstraintHealth::Ok;
+
+        std::array<double, kMaxEquationParams> grad{};
+        for (const Equation& eq : equations) {
+            const double r = evaluateEquation(eq, x, grad.data());
+
+            m_rowCols.assign(eq.p.begin(), eq.p.begin() + eq.paramCount);
+            m_rowVals.assign(grad.begin(), grad.begin() + eq.paramCount);
+            switch (m_qr.addRow(m_rowCols.data(), m_rowVals.data(), eq.paramCount, -r)) {
+            case IncrementalQR::RowOutcome::Independent: break;
+            case IncrementalQR::RowOutcome::Redundant: health = worse(health, ConstraintHealth::Redundant); break;
+            case IncrementalQR::RowOutcome::Conflicting: health = worse(health, ConstraintHealth::Conflicting); break;
+            }
+            unite(eq);
+        }
+        return health;
+    }
+
+    void DofAnalyzer::record(const Constraint& constraint, ConstraintHealth health) {
+        std::visit([&](auto&& c) {
+            m_health[c.meta.id] = health;
+            if (health == ConstraintHealth::Redundant) m_redundant.push_back(c.meta.id);
+            if (health == ConstraintHealth::Conflicting) m_conflicting.push_back(c.meta.id);
+            if (health == ConstraintHealth::Redundant || health == ConstraintHealth::Conflicting) {
+                for (const auto& r : c.refs) ++m_overConstrained[r.id];
+            }
+        }, constraint);
+    }
+
+    void DofAnalyzer::computeDof(const EntityParams& entity, EntityId id) {
+        m_rowCols.resize(entity.count);
+        std::iota(m_rowCols.begin(), m_rowCols.end(), entity.offset);
+        m_dof[id] = m_qr.freeDirections(m_rowCols.data(), m_rowCols.size());
+    }
+
+    void DofAnalyzer::analyze(const Sketch& sketch) {
+        ++m_revision;
+        m_params.gather(sketch.entities);
+        m_qr.reset(m_params.size());
+
+        m_dof.clear();
+        m_health.clear();
+        m_overConstrained.clear();
+        m_redundant.clear();
+        m_conflicting.clear();
+
+        m_parent.resize(m_params.size());
+        std::iota(m_parent.begin(), m_parent.end(), 0u);
+
+        // An entity's parameters always share a group.
+        m_entityOrder.clear();
+        for (const auto& [id, ep] : m_params.entities()) {
+            m_entityOrder.push_back(id);
+            for (std::uint32_t i = 1; i < ep.count; ++i) {
+                const std::uint32_t a = root(ep.offset);
+                const std::uint32_t b = root(ep.offset + i);
+                if (a != b) m_parent[b] = a;
+            }
+        }
+
+        for (EntityId id : sketch.entities.headers(EntityKind::Arc).ids) {
+            m_equations.clear();
+            compileIntrinsic(m_params, *m_params.find(id), m_equations);
+            fold(m_equations);
+        }
+
+        for (const auto& constraint : sketch.constraints) {
+            if (!isActiveConstraint(constraint)) {
+                record(constraint, ConstraintHealth::Inactive);
+                continue;
+            }
+            m_equations.clear();
+            if (!compileConstraint(constraint, m_params, m_equations)) {
+                record(constraint, ConstraintHealth::Unsupported);
+                continue;
+            }
+            record(constraint, fold(m_equations));
+        }
+
+        for (EntityId id : m_entityOrder) {
+            computeDof(*m_params.find(id), id);
+        }
+    }
+
+    void DofAnalyzer::addConstraint(const Sketch& sketch, std::size_t index) {
+        ++m_revision;
+        const Constraint& constraint = sketch.constraints[index];
+
+        const bool known = std::visit([&](auto&& c) {
+            return std::all_of(c.refs.begin(), c.refs.end(), [&](const EntityRef& r) { return m_params.find(r.id) != nullptr; });
+        }, constraint);
+        if (!known || m_parent.size() != m_params.size()) {
+            analyze(sketch);
+            return;
+        }
+
+        if (!isActiveConstraint(constraint)) {
+            record(constraint, ConstraintHealth::Inactive);
+            return;
+        }
+        m_equations.clear();
+        if (!compileConstraint(constraint, m_params, m_equations)) {
+            record(constraint, ConstraintHealth::Unsupported);
+            return;
+        }
+        record(constraint, fold(m_equations));
+
+        // Only the groups the new rows joined can have changed.
+        std::vector<std::uint32_t> groups;
+        for (const Equation& eq : m_equations) {
+            if (eq.paramCount == 0) continue;
+            const std::uint32_t g = root(eq.p[0]);
+            if (std::find(groups.begin(), groups.end(), g) == groups.end()) groups.push_back(g);
+        }
+        if (groups.empty()) return;
+
+        for (EntityId id : m_entityOrder) {
+            const EntityParams& ep = *m_params.find(id);
+            if (ep.count == 0) continue;
+            const std::uint32_t g = root(ep.offset);
+            if (std::find(groups.begin(), groups.end(), g) != groups.end()) computeDof(ep, id);
+        }
+    }
+
+    std::uint32_t DofAnalyzer::dof(EntityId id) const {
+        auto it = m_dof.find(id);
+        return it == m_dof.end() ? 0 : it->second;
+    }
+
+    ConstraintHealth DofAnalyzer::health(ConstraintId id) const {
+        auto it = m_health.find(id);
+        return it == m_health.end() ? ConstraintHealth::Inactive : it->second;
+    }
+
+    bool DofAnalyzer::isOverConstrained(EntityId id) const {
+        return m_overConstrained.find(id) != m_overConstrained.end();
+    }
+
+} // namespace domain::solver
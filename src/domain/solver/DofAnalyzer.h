@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "domain/SketchModel.h"
+#include "Equations.h"
+#include "IncrementalQR.h"
+#include "ParameterTable.h"
+
+namespace domain::solver {
+
+    enum class ConstraintHealth : std::uint8_t {
+        Ok,           // every equation raised the Jacobian rank
+        Redundant,    // some equation is implied by earlier constraints (consistent)
+        Conflicting,  // some equation contradicts earlier constraints
+        Unsupported,  // reference pattern the compiler does not understand
+        Inactive      // disabled, suppressed or driven
+    };
+
+    // Degrees-of-freedom and redundancy analysis of a sketch, linearised at its
+    // current geometry.
+    //
+    // Every constraint equation becomes one row of the Jacobian and is folded into
+    // an IncrementalQR in Sketch::constraints order (arc intrinsics first), so
+    // the constraint that first makes a row dependent is the one reported. An
+    // entity's remaining DOF is the number of its parameter directions that are
+    // not in the row space of the Jacobian.
+    //
+    // addConstraint() folds a new constraint into the existing factor instead of
+    // starting over, and only recomputes DOF for entities in the connected group
+    // the constraint touches. Geometry changes (a solve, a drag) invalidate the
+    // linearisation; call analyze() again afterwards.
+    class DofAnalyzer {
+    public:
+        void analyze(const sketch::Sketch& sketch);
+
+        // Incremental update for sketch.constraints[index], typically just appended.
+        // Falls back to analyze() if it references entities added since.
+        void addConstraint(const sketch::Sketch& sketch, std::size_t index);
+
+        // Remaining DOF of an entity; 0 means fully constrained. Unknown ids report 0.
+        std::uint32_t dof(sketch::EntityId id) const;
+        ConstraintHealth health(sketch::ConstraintId id) const;
+
+        // Entities referenced by a redundant or conflicting constraint.
+        bool isOverConstrained(sketch::EntityId id) const;
+
+        std::size_t totalDof() const { return m_params.size() - m_qr.rank(); }
+        std::size_t rank() const { return m_qr.rank(); }
+        const std::vector<sketch::ConstraintId>& redundant() const { return m_redundant; }
+        const std::vector<sketch::ConstraintId>& conflicting() const { return m_conflicting; }
+
+        // Bumped by every analyze() and addConstraint(), for caches of the results.
+        std::uint64_t revision() const { return m_revision; }
+
+    private:
+        ParameterTable m_params;
+        std::uint64_t m_revision{ 0 };
+        IncrementalQR m_qr;
+
+        std::unordered_map<sketch::EntityId, std::uint32_t> m_dof;
+        std::unordered_map<sketch::ConstraintId, ConstraintHealth> m_health;
+        std::unordered_map<sketch::EntityId, std::uint32_t> m_overConstrained; // reference counts
+        std::vector<sketch::ConstraintId> m_redundant;
+        std::vector<sketch::ConstraintId> m_conflicting;
+
+        // Union-find over parameters; a group is everything one chain of equations links.
+        std::vector<std::uint32_t> m_parent;
+        std::vector<sketch::EntityId> m_entityOrder;
+
+        std::vector<Equation> m_equations;
+        std::vector<std::uint32_t> m_rowCols;
+        std::vector<double> m_rowVals;
+
+        ConstraintHealth fold(const std::vector<Equation>& equations);
+        void record(const sketch::Constraint& constraint, ConstraintHealth health);
+        void unite(const Equation& eq);
+        std::uint32_t root(std::uint32_t param);
+        void computeDof(const EntityParams& entity, sketch::EntityId id);
+    };
+
+} // namespace domain::solver
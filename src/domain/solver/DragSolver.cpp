@@ -0,0 +1,338 @@
+#include "domain/solver/DragSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace domain::solver {
+
+    using namespace domain::sketch;
+
+    namespace {
+
+        // Keeps J M J^T positive definite when constraints are redundant.
+        constexpr double kRidge = 1e-10;
+
+        double maxAbs(const double* v, std::size_t n) {
+            double m = 0.0;
+            for (std::size_t i = 0; i < n; ++i) m = std::max(m, std::abs(v[i]));
+            return m;
+        }
+
+        double halfSquaredNorm(const std::vector<double>& v) {
+            double s = 0.0;
+            for (double x : v) s += x * x;
+            return 0.5 * s;
+        }
+
+        void consider(const Vec2& p, const Vec2& at, double& best, const DragHandle& candidate, DragHandle& out, bool& found) {
+            const double d = std::hypot(p.x - at.x, p.y - at.y);
+            if (d < best) {
+                best = d;
+                out = candidate;
+                found = true;
+            }
+        }
+
+        // Offers every drag handle of one visible, selectable entity.
+        void considerEntity(const EntityStore& store, EntityKind kind, std::uint32_t i, const Vec2& at,
+            double& best, DragHandle& out, bool& found) {
+            constexpr std::uint8_t kPickable = flags::Visible | flags::Selectable;
+            const HeaderColumns& hc = store.headers(kind);
+            if ((hc.flags[i] & kPickable) != kPickable) return;
+            const EntityId id = hc.ids[i];
+
+            switch (kind) {
+            case EntityKind::Point: {
+                const PointColumns& pc = store.points();
+                consider({ pc.x[i], pc.y[i] }, at, best, { id, EntityAnchor::Point }, out, found);
+                break;
+            }
+            case EntityKind::Line: {
+                const LineColumns& lc = store.lines();
+                const Vec2 a{ lc.ax[i], lc.ay[i] };
+                const Vec2 b{ lc.bx[i], lc.by[i] };
+                consider(a, at, best, { id, EntityAnchor::LineStart }, out, found);
+                consider(b, at, best, { id, EntityAnchor::LineEnd }, out, found);
+                consider({ 0.5 * (a.x + b.x), 0.5 * (a.y + b.y) }, at, best, { id, EntityAnchor::LineMid }, out, found);
+                break;
+            }
+            case EntityKind::Circle: {
+                const CircleColumns& cc = store.circles();
+                consider({ cc.cx[i], cc.cy[i] }, at, best, { id, EntityAnchor::Center }, out, found);
+                break;
+            }
+            case EntityKind::Arc: {
+                const ArcColumns& ac = store.arcs();
+                consider({ ac.cx[i], ac.cy[i] }, at, best, { id, EntityAnchor::Center }, out, found);
+                consider({ ac.sx[i], ac.sy[i] }, at, best, { id, EntityAnchor::Start }, out, found);
+                consider({ ac.ex[i], ac.ey[i] }, at, best, { id, EntityAnchor::End }, out, found);
+                break;
+            }
+            case EntityKind::Ellipse: {
+                const EllipseColumns& ec = store.ellipses();
+                consider({ ec.cx[i], ec.cy[i] }, at, best, { id, EntityAnchor::Center }, out, found);
+                break;
+            }
+            case EntityKind::Curve: {
+                const auto& cps = store.curves().controlPoints[i];
+                if (cps.empty()) break;
+                consider(cps.front(), at, best, { id, EntityAnchor::CurvePoint0 }, out, found);
+                consider(cps.back(), at, best, { id, EntityAnchor::CurvePoint1 }, out, found);
+                break;
+            }
+            }
+        }
+
+    } // namespace
+
+    bool pickDragHandle(const EntityStore& store, const Vec2& at, double radius, DragHandle& out) {
+        double best = radius;
+        bool found = false;
+        for (std::size_t k = 0; k < kEntityKindCount; ++k) {
+            const auto kind = static_cast<EntityKind>(k);
+            const auto n = static_cast<std::uint32_t>(store.count(kind));
+            for (std::uint32_t i = 0; i < n; ++i) considerEntity(store, kind, i, at, best, out, found);
+        }
+        return found;
+    }
+
+    bool pickDragHandle(const EntityStore& store, const SpatialIndex& index, const Vec2& at, double radius, DragHandle& out) {
+        // Every handle lies inside its entity's bounds, so the box around the
+        // pick circle finds all candidates. Visiting them in store order keeps
+        // the tie-breaking of the linear scan.
+        Box2 box;
+        box.expand(Vec2{ at.x - radius, at.y - radius });
+        box.expand(Vec2{ at.x + radius, at.y + radius });
+
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> candidates; // (kind, dense index)
+        index.query(box, [&](EntityId id, const Box2&) {
+            const EntityHandle h = store.getHandle(id);
+            candidates.emplace_back(static_cast<std::uint32_t>(h.kind), store.indexOf(h));
+        });
+        std::sort(candidates.begin(), candidates.end());
+
+        double best = radius;
+        bool found = false;
+        for (const auto& [kind, i] : candidates) {
+            considerEntity(store, static_cast<EntityKind>(kind), i, at, best, out, found);
+        }
+        return found;
+    }
+
+    bool DragSolver::resolveHandle(const EntityParams& entity) {
+        int n = 0;
+        const EntityAnchor anchor = m_handle.anchor;
+        auto add = [&](ParamIndex p) { m_handleParams[n++] = entity.offset + p; };
+
+        switch (entity.kind) {
+        case EntityKind::Point:
+            if (anchor == EntityAnchor::None || anchor == EntityAnchor::Point) add(layout::PointP);
+            break;
+        case EntityKind::Line:
+            if (anchor == EntityAnchor::LineStart) add(layout::LineA);
+            else if (anchor == EntityAnchor::LineEnd) add(layout::LineB);
+            else if (anchor == EntityAnchor::LineMid || anchor == EntityAnchor::None) {
+                add(layout::LineA);
+                add(layout::LineB);
+            }
+            break;
+        case EntityKind::Circle:
+            if (anchor == EntityAnchor::Center || anchor == EntityAnchor::None) add(layout::CircleCenter);
+            break;
+        case EntityKind::Arc:
+            if (anchor == EntityAnchor::Center || anchor == EntityAnchor::None) add(layout::ArcCenter);
+            else if (anchor == EntityAnchor::Start) add(layout::ArcStart);
+            else if (anchor == EntityAnchor::End) add(layout::ArcEnd);
+            break;
+        case EntityKind::Ellipse:
+            if (anchor == EntityAnchor::Center || anchor == EntityAnchor::None) add(layout::EllipseCenter);
+            break;
+        case EntityKind::Curve:
+            if (entity.count < 2) break;
+            if (anchor == EntityAnchor::CurvePoint0) add(0);
+            else if (anchor == EntityAnchor::CurvePoint1) add(entity.count - 2);
+            break;
+        }
+        m_handlePointCount = n;
+        return n > 0;
+    }
+
+    bool DragSolver::begin(Sketch& sketch, const DragHandle& handle, const DragOptions& options) {
+        end();
+
+        const auto& store = sketch.entities;
+        if (!store.contains(handle.entity)) return false;
+
+        m_graph.build(sketch);
+        const std::size_t cluster = m_graph.clusterOf(handle.entity);
+        if (cluster != ConstraintGraph::npos) {
+            const Cluster& c = m_graph.clusters()[cluster];
+            m_params.gather(store, c.entities);
+            compileCluster(sketch, c.entities, c.constraints, m_params, m_system);
+        }
+        else {
+            m_params.gather(store, std::vector<EntityId>{ handle.entity });
+            m_system.clear();
+        }
+
+        m_handle = handle;
+        m_options = options;
+
+        const EntityParams* ep = m_params.find(handle.entity);
+        if (!ep || !resolveHandle(*ep)) {
+            m_params.clear();
+            m_system.clear();
+            return false;
+        }
+
+        m_jacobian.build(m_system.equations, m_params.size());
+        m_residuals.resize(m_jacobian.rows());
+        m_trialResiduals.resize(m_jacobian.rows());
+        m_trialX = m_params.values();
+
+        m_reach = std::numeric_limits<double>::infinity();
+        m_lastResidual = 0.0;
+        if (!m_system.equations.empty()) {
+            m_jacobian.residuals(m_system.equations, m_trialX.data(), m_residuals.data());
+            m_lastResidual = maxAbs(m_residuals.data(), m_residuals.size());
+        }
+
+        const double handleWeight = 1.0 / std::max(options.handleStiffness, 1e-12);
+        const auto& columnParams = m_jacobian.columnParams();
+        m_columnWeights.assign(columnParams.size(), 1.0);
+        for (std::size_t c = 0; c < columnParams.size(); ++c) {
+            for (int i = 0; i < m_handlePointCount; ++i) {
+                const ParamIndex x = m_handleParams[i];
+                if (columnParams[c] == x || columnParams[c] == x + 1) m_columnWeights[c] = handleWeight;
+            }
+        }
+
+        m_active = true;
+        return true;
+    }
+
+    void DragSolver::end() {
+        m_active = false;
+        m_handlePointCount = 0;
+    }
+
+    void DragSolver::placeHandle(const Vec2& target) {
+        auto& x = m_params.values();
+        const Vec2 at = handlePosition();
+        for (int i = 0; i < m_handlePointCount; ++i) {
+            x[m_handleParams[i]] += target.x - at.x;
+            x[m_handleParams[i] + 1] += target.y - at.y;
+        }
+    }
+
+    Vec2 DragSolver::handlePosition() const {
+        const auto& x = m_params.values();
+        Vec2 at{};
+        for (int i = 0; i < m_handlePointCount; ++i) {
+            at.x += x[m_handleParams[i]];
+            at.y += x[m_handleParams[i] + 1];
+        }
+        at.x /= m_handlePointCount;
+        at.y /= m_handlePointCount;
+        return at;
+    }
+
+    void DragSolver::newton(Clock::time_point deadline, SolveResult& result) {
+        const auto& equations = m_system.equations;
+        auto& x = m_params.values();
+        const auto& columnParams = m_jacobian.columnParams();
+        const std::size_t cols = m_jacobian.cols();
+
+        m_jacobian.evaluate(equations, x.data(), m_residuals.data());
+        double cost = halfSquaredNorm(m_residuals);
+        result.residualNorm = maxAbs(m_residuals.data(), m_residuals.size());
+
+        for (int iter = 0; iter < m_options.maxIterations; ++iter) {
+            if (result.residualNorm <= m_options.residualTolerance) break;
+            ++result.iterations;
+
+            m_normal.solveMinNorm(m_jacobian, m_residuals, m_columnWeights, kRidge,
+                m_options.maxLinearIterations, m_options.linearTolerance, m_step, deadline);
+
+            // Backtrack along the step; only a lower residual is accepted.
+            bool accepted = false;
+            for (double alpha = 1.0; alpha >= 1.0 / 16.0; alpha *= 0.5) {
+                for (std::size_t c = 0; c < cols; ++c) {
+                    const ParamIndex p = columnParams[c];
+                    m_trialX[p] = x[p] + alpha * m_step[c];
+                }
+
+                m_jacobian.residuals(equations, m_trialX.data(), m_trialResiduals.data());
+                const double trialCost = halfSquaredNorm(m_trialResiduals);
+                if (trialCost < cost) {
+                    for (std::size_t c = 0; c < cols; ++c) {
+                        const ParamIndex p = columnParams[c];
+                        x[p] = m_trialX[p];
+                    }
+                    m_residuals.swap(m_trialResiduals);
+                    cost = trialCost;
+                    result.residualNorm = maxAbs(m_residuals.data(), m_residuals.size());
+                    accepted = true;
+                    break;
+                }
+            }
+
+            if (!accepted || Clock::now() >= deadline) break;
+            m_jacobian.evaluate(equations, x.data(), m_residuals.data());
+        }
+    }
+
+    SolveResult DragSolver::drag(Sketch& sketch, const Vec2& target) {
+        SolveResult result;
+        if (!m_active) return result;
+
+        const auto deadline = Clock::now() + std::chrono::microseconds(m_options.budgetMicros);
+
+        result.clusterCount = 1;
+        result.equationCount = m_system.equations.size();
+        result.parameterCount = m_jacobian.cols();
+        result.unsupported = m_system.unsupported;
+
+        if (m_system.equations.empty()) {
+            placeHandle(target);
+            m_params.scatter(sketch.entities);
+            result.status = SolveStatus::Converged;
+            return result;
+        }
+
+        // Move the handle as far towards the cursor as recent frames managed.
+        // If the cluster cannot be pulled back onto its constraints at least as
+        // well as last frame, restore last frame and try half the distance; the
+        // handle then catches up with the cursor over the next frames.
+        m_previous = m_params.values();
+        const Vec2 from = handlePosition();
+        const double distance = std::hypot(target.x - from.x, target.y - from.y);
+        const double accept = std::max(m_options.residualTolerance, m_lastResidual);
+        double move = std::min(distance, m_reach);
+        for (;;) {
+            const double t = distance > 0.0 ? move / distance : 0.0;
+            placeHandle({ from.x + t * (target.x - from.x), from.y + t * (target.y - from.y) });
+            newton(deadline, result);
+            if (result.residualNorm <= accept) {
+                m_reach = std::max(m_reach, 2.0 * move);
+                break;
+            }
+
+            m_params.values() = m_previous;
+            result.residualNorm = m_lastResidual;
+            move *= 0.5;
+            m_reach = move;
+            if (move < 1e-3 * distance || Clock::now() >= deadline) break;
+        }
+
+        m_lastResidual = result.residualNorm;
+        result.status = result.residualNorm <= m_options.residualTolerance
+            ? SolveStatus::Converged
+            : SolveStatus::NotConverged;
+
+        m_params.scatter(sketch.entities);
+        return result;
+    }
+
+} // namespace domain::solver
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "domain/SketchModel.h"
+#include "domain/SketchSpatialIndex.h"
+#include "ConstraintCompiler.h"
+#include "ConstraintGraph.h"
+#include "NormalEquations.h"
+#include "ParameterTable.h"
+#include "SolverTypes.h"
+#include "SparseJacobian.h"
+
+namespace domain::solver {
+
+    struct DragOptions {
+        std::int64_t budgetMicros{ 4000 };  // wall-clock budget per drag() call
+        int maxIterations{ 50 };            // Gauss-Newton iterations per drag() call
+        double residualTolerance{ 1e-9 };   // max |r_i| accepted as solved
+        double handleStiffness{ 100.0 };    // how much harder the dragged handle is to move than the rest
+
+        int maxLinearIterations{ 500 };
+        double linearTolerance{ 1e-6 };     // relative; Newton's quadratic convergence tolerates a loose inner solve
+    };
+
+    // A draggable location on an entity: a point, a line end or midpoint, a
+    // circle/arc/ellipse center, an arc end or a curve end.
+    struct DragHandle {
+        sketch::EntityId entity{};
+        sketch::EntityAnchor anchor{ sketch::EntityAnchor::None };
+    };
+
+    // Nearest visible, selectable handle within `radius` of `at`. Points win ties.
+    bool pickDragHandle(const sketch::EntityStore& store, const sketch::Vec2& at, double radius, DragHandle& out);
+    // Same, visiting only the entities the index finds near `at`.
+    bool pickDragHandle(const sketch::EntityStore& store, const sketch::SpatialIndex& index,
+        const sketch::Vec2& at, double radius, DragHandle& out);
+
+    // Interactive constraint solving while the user drags a handle.
+    //
+    // begin() isolates the cluster of constraints connected to the dragged
+    // entity and compiles it once. Every drag() call moves the handle onto the
+    // cursor, then warm-starts Gauss-Newton from the previous frame's solution
+    // to pull the cluster back onto its constraints, stopping when the time
+    // budget runs out. Steps are weighted minimum-norm, with the handle stiffer
+    // than everything else, so the rest of the cluster gives way first and an
+    // unreachable cursor drags the handle back to the nearest valid position.
+    // A step is accepted only if it lowers the residual, and a frame that ends
+    // worse than the previous one falls back to a shorter move, so whatever is
+    // written back is the best iterate seen; the next frame continues from it.
+    class DragSolver {
+    public:
+        // Returns false if the handle does not name a draggable entity location.
+        bool begin(sketch::Sketch& sketch, const DragHandle& handle, const DragOptions& options = {});
+
+        // Moves the handle towards `target` and writes the cluster back into the sketch.
+        SolveResult drag(sketch::Sketch& sketch, const sketch::Vec2& target);
+
+        void end();
+
+        bool active() const { return m_active; }
+        const DragHandle& handle() const { return m_handle; }
+        // Entities that drag() may move: the dragged entity's cluster.
+        const ParameterTable& parameters() const { return m_params; }
+
+    private:
+        using Clock = NormalEquationSolver::Clock;
+
+        bool m_active{ false };
+        DragHandle m_handle;
+        DragOptions m_options;
+
+        ConstraintGraph m_graph;
+        ParameterTable m_params;
+        EquationSystem m_system;
+        std::array<ParamIndex, 2> m_handleParams{}; // x parameter of each point the handle moves
+        int m_handlePointCount{ 0 };                // 2 for a line midpoint, else 1
+
+        SparseJacobian m_jacobian;
+        NormalEquationSolver m_normal;
+        std::vector<double> m_columnWeights;
+        std::vector<double> m_residuals;
+        std::vector<double> m_trialResiduals;
+        std::vector<double> m_trialX;
+        std::vector<double> m_step;
+
+        std::vector<double> m_previous; // last frame's accepted solution
+        double m_lastResidual{ 0.0 };
+        double m_reach{ 0.0 };          // largest handle move per frame that recently solved in budget
+
+        bool resolveHandle(const EntityParams& entity);
+        sketch::Vec2 handlePosition() const;
+        void placeHandle(const sketch::Vec2& target);
+        void newton(Clock::time_point deadline, SolveResult& result);
+    };
+
+} // namespace domain::solver
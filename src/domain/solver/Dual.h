@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cmath>
+#include <utility>
+
+// The kernels only vectorize once a whole residual expression is inlined into
+// one function, which default heuristics stop short of for 8-wide duals.
+#if defined(_MSC_VER)
+#define DUAL_INLINE __forceinline
+#else
+#define DUAL_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace domain::solver {
+
+    // Forward-mode dual number carrying N partial derivatives. Residual kernels
+    // are written once as templates and instantiated with double (value only)
+    // or Dual<N> (value and gradient); N is the equation's parameter count, so
+    // the derivative loops below have fixed trip counts and unroll/vectorize.
+    template <int N>
+    struct Dual {
+        // Derivatives first: keeps 16-byte loads of d from straddling v.
+        double d[N]{};
+        double v{ 0.0 };
+
+        constexpr Dual() = default;
+        constexpr Dual(double value) : v(value) {} // constants have zero derivative
+
+        // The I-th independent variable. I is a template argument so the seed
+        // is a compile-time unit vector.
+        template <int I>
+        static constexpr Dual variable(double value) {
+            Dual r(value);
+            r.d[I] = 1.0;
+            return r;
+        }
+    };
+
+    // Calls f(0) ... f(N-1) as straight-line code.
+    template <class F, int... I>
+    DUAL_INLINE constexpr void unrolled(F& f, std::integer_sequence<int, I...>) { (f(I), ...); }
+
+    template <int N, class F>
+    DUAL_INLINE constexpr void forEach(F&& f) { unrolled(f, std::make_integer_sequence<int, N>{}); }
+
+    inline constexpr double valueOf(double a) { return a; }
+    template <int N> DUAL_INLINE constexpr double valueOf(const Dual<N>& a) { return a.v; }
+
+    // ---- arithmetic ----
+
+    template <int N>
+    DUAL_INLINE constexpr Dual<N> operator-(const Dual<N>& a) {
+        Dual<N> r(-a.v);
+        forEach<N>([&](int i) { r.d[i] = -a.d[i]; });
+        return r;
+    }
+
+    template <int N>
+    DUAL_INLINE constexpr Dual<N> operator+(const Dual<N>& a, const Dual<N>& b) {
+        Dual<N> r(a.v + b.v);
+        forEach<N>([&](int i) { r.d[i] = a.d[i] + b.d[i]; });
+        return r;
+    }
+
+    template <int N>
+    DUAL_INLINE constexpr Dual<N> operator-(const Dual<N>& a, const Dual<N>& b) {
+        Dual<N> r(a.v - b.v);
+        forEach<N>([&](int i) { r.d[i] = a.d[i] - b.d[i]; });
+        return r;
+    }
+
+    template <int N>
+    DUAL_INLINE constexpr Dual<N> operator*(const Dual<N>& a, const Dual<N>& b) {
+        Dual<N> r(a.v * b.v);
+        forEach<N>([&](int i) { r.d[i] = a.d[i] * b.v + a.v * b.d[i]; });
+        return r;
+    }
+
+    template <int N>
+    DUAL_INLINE constexpr Dual<N> operator/(const Dual<N>& a, const Dual<N>& b) {
+        const double inv = 1.0 / b.v;
+        Dual<N> r(a.v * inv);
+        forEach<N>([&](int i) { r.d[i] = (a.d[i] - r.v * b.d[i]) * inv; });
+        return r;
+    }
+
+    template <int N> DUAL_INLINE constexpr Dual<N> operator+(const Dual<N>& a, double b) { Dual<N> r = a; r.v += b; return r; }
+    template <int N> DUAL_INLINE constexpr Dual<N> operator+(double a, const Dual<N>& b) { return b + a; }
+    template <int N> DUAL_INLINE constexpr Dual<N> operator-(const Dual<N>& a, double b) { Dual<N> r = a; r.v -= b; return r; }
+    template <int N> DUAL_INLINE constexpr Dual<N> operator-(double a, const Dual<N>& b) { return -b + a; }
+
+    template <int N>
+    DUAL_INLINE constexpr Dual<N> operator*(const Dual<N>& a, double b) {
+        Dual<N> r(a.v * b);
+        forEach<N>([&](int i) { r.d[i] = a.d[i] * b; });
+        return r;
+    }
+    template <int N> DUAL_INLINE constexpr Dual<N> operator*(double a, const Dual<N>& b) { return b * a; }
+    template <int N> DUAL_INLINE constexpr Dual<N> operator/(const Dual<N>& a, double b) { return a * (1.0 / b); }
+    template <int N> DUAL_INLINE constexpr Dual<N> operator/(double a, const Dual<N>& b) { return Dual<N>(a) / b; }
+
+    template <int N> DUAL_INLINE constexpr Dual<N>& operator+=(Dual<N>& a, const Dual<N>& b) { return a = a + b; }
+    template <int N> DUAL_INLINE constexpr Dual<N>& operator-=(Dual<N>& a, const Dual<N>& b) { return a = a - b; }
+    template <int N> DUAL_INLINE constexpr Dual<N>& operator+=(Dual<N>& a, double b) { a.v += b; return a; }
+    template <int N> DUAL_INLINE constexpr Dual<N>& operator-=(Dual<N>& a, double b) { a.v -= b; return a; }
+
+    // ---- functions (found by ADL next to the std:: overloads for double) ----
+
+    template <int N>
+    DUAL_INLINE Dual<N> sqrt(const Dual<N>& a) {
+        const double s = std::sqrt(a.v);
+        Dual<N> r(s);
+        const double k = 0.5 / s;
+        forEach<N>([&](int i) { r.d[i] = a.d[i] * k; });
+        return r;
+    }
+
+    template <int N>
+    DUAL_INLINE constexpr Dual<N> abs(const Dual<N>& a) {
+        return a.v < 0.0 ? -a : a;
+    }
+
+    // d(atan2(y, x)) = (x dy - y dx) / (x^2 + y^2); the denominator is floored
+    // so the derivative stays finite at the origin.
+    template <int N>
+    DUAL_INLINE Dual<N> atan2(const Dual<N>& y, const Dual<N>& x) {
+        Dual<N> r(std::atan2(y.v, x.v));
+        double n = x.v * x.v + y.v * y.v;
+        if (n < 1e-12) n = 1e-12;
+        const double inv = 1.0 / n;
+        forEach<N>([&](int i) { r.d[i] = (x.v * y.d[i] - y.v * x.d[i]) * inv; });
+        return r;
+    }
+
+} // namespace domain::solver
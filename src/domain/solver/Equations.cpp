@@ -0,0 +1,20 @@
+#include "domain/solver/Equations.h"
+
+#include "domain/solver/ResidualKernels.h"
+
+namespace domain::solver {
+
+    double evaluateEquation(const Equation& eq, const double* x, double* grad) {
+        return kernels::dispatch(eq.kind, [&](auto kind) {
+            return kernels::evaluate<decltype(kind)::value>(eq, x, grad);
+        });
+    }
+
+    void evaluateEquations(EquationKind kind, const Equation* equations, const std::uint32_t* rows, std::size_t count,
+                           const double* x, double* residuals, const std::uint32_t* rowPtr, double* values) {
+        kernels::dispatch(kind, [&](auto k) {
+            kernels::evaluateBatch<decltype(k)::value>(equations, rows, count, x, residuals, rowPtr, values);
+        });
+    }
+
+} // namespace domain::solver
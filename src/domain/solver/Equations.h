@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "domain/SketchIds.h"
+#include "SolverTypes.h"
+
+namespace domain::solver {
+
+    // Primitive scalar equations. Every sketch constraint is compiled into one or
+    // more of these; each reads a fixed, small set of entries of the parameter
+    // vector so the Jacobian sparsity pattern is known up front.
+    //
+    // Notation: points are consecutive (x,y) parameter pairs, r is a radius.
+    enum class EquationKind : std::uint8_t {
+        Linear,               // sum(k[i] * p[i]) - value                    (up to 4 params)
+        PointDistance,        // |P0 - P1| - value                           (P0 P1)
+        PointOnCircle,        // |P - C| - r                                 (P C r)
+        PointLineDistance,    // signedDistance(P, AB) - value               (P A B)
+        MidpointLineDistance, // signedDistance((P0 + P1) / 2, AB)           (P0 P1 A B)
+        LineCircleTangent,    // k[0] * signedDistance(C, AB) - r            (C r A B)
+        CircleCircleTangent,  // |C0 - C1| - (r0 + k[0] * r1)                (C0 r0 C1 r1)
+        Cross,                // cross(B0 - A0, B1 - A1) - value             (A0 B0 A1 B1)
+        Dot,                  // dot(B0 - A0, B1 - A1) - value               (A0 B0 A1 B1)
+        Angle,                // angle(B0 - A0, B1 - A1) - value, radians    (A0 B0 A1 B1)
+        EndCurvature,         // k[0]|cross(P1-P0, P2-P1)| / |P1-P0|^3 - 1/r (P0 P1 P2 r)
+        Count
+    };
+
+    inline constexpr int kMaxEquationParams = 8;
+
+    constexpr std::uint8_t equationParamCount(EquationKind kind) {
+        switch (kind) {
+        case EquationKind::Linear:               return 0; // variable, set by the compiler
+        case EquationKind::PointDistance:        return 4;
+        case EquationKind::PointOnCircle:        return 5;
+        case EquationKind::PointLineDistance:    return 6;
+        case EquationKind::MidpointLineDistance: return 8;
+        case EquationKind::LineCircleTangent:    return 7;
+        case EquationKind::CircleCircleTangent:  return 6;
+        case EquationKind::Cross:                return 8;
+        case EquationKind::Dot:                  return 8;
+        case EquationKind::Angle:                return 8;
+        case EquationKind::EndCurvature:         return 7;
+        case EquationKind::Count:                break;
+        }
+        return 0;
+    }
+
+    struct Equation {
+        EquationKind kind{ EquationKind::Linear };
+        std::uint8_t paramCount{ 0 };
+        std::array<ParamIndex, kMaxEquationParams> p{};
+        std::array<double, 4> k{};
+        double value{ 0.0 };
+        sketch::ConstraintId source{}; // 0 for intrinsic equations (e.g. arc end points on the arc)
+    };
+
+    // Evaluates the residual of `eq` at `x`. If `grad` is non-null it receives
+    // d(residual)/d(x[eq.p[i]]) for i < eq.paramCount. Parameter indices may repeat;
+    // callers must accumulate, not overwrite, when scattering the gradient.
+    //
+    // Residuals are the templated kernels in ResidualKernels.h; gradients come
+    // from forward-mode dual numbers rather than hand-written derivatives.
+    double evaluateEquation(const Equation& eq, const double* x, double* grad);
+
+    // Batched form: evaluates equations[rows[i]] for i < count, all of which must
+    // be of `kind`, writing residuals[rows[i]]. If `values` is non-null the
+    // gradient of row r goes to values + rowPtr[r]. One kernel serves the whole
+    // batch, so there is no per-equation dispatch.
+    void evaluateEquations(EquationKind kind, const Equation* equations, const std::uint32_t* rows, std::size_t count,
+                           const double* x, double* residuals, const std::uint32_t* rowPtr, double* values);
+
+} // namespace domain::solver
@@ -0,0 +1,167 @@
+#include "domain/solver/IncrementalQR.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace domain::solver {
+
+    namespace {
+
+        constexpr std::uint32_t kEnd = std::numeric_limits<std::uint32_t>::max();
+
+    } // namespace
+
+    void IncrementalQR::reset(std::size_t columns) {
+        m_pivots.clear();
+        m_pivots.resize(columns);
+        m_overlay.clear();
+        m_rank = 0;
+    }
+
+    void IncrementalQR::loadWork(const std::uint32_t* cols, const double* vals, std::size_t count, double rhs) {
+        m_work.clear();
+        m_work.rhs = rhs;
+
+        // Sort by column and sum duplicates.
+        m_order.resize(count);
+        std::iota(m_order.begin(), m_order.end(), std::size_t{ 0 });
+        std::sort(m_order.begin(), m_order.end(), [&](std::size_t a, std::size_t b) { return cols[a] < cols[b]; });
+
+        for (std::size_t i : m_order) {
+            if (!m_work.cols.empty() && m_work.cols.back() == cols[i]) {
+                m_work.vals.back() += vals[i];
+            }
+            else {
+                m_work.cols.push_back(cols[i]);
+                m_work.vals.push_back(vals[i]);
+            }
+        }
+    }
+
+    void IncrementalQR::rotate(Row& pivot, double drop) {
+        // Givens rotation zeroing the work row's leading entry against the pivot.
+        const double a = pivot.vals[0];
+        const double b = m_work.vals[0];
+        const double r = std::hypot(a, b);
+        const double c = a / r;
+        const double s = b / r;
+        const std::uint32_t lead = pivot.cols[0];
+
+        m_nextPivot.clear();
+        m_nextWork.clear();
+
+        std::size_t i = 0;
+        std::size_t k = 0;
+        while (i < pivot.cols.size() || k < m_work.cols.size()) {
+            const std::uint32_t ci = i < pivot.cols.size() ? pivot.cols[i] : kEnd;
+            const std::uint32_t ck = k < m_work.cols.size() ? m_work.cols[k] : kEnd;
+            const std::uint32_t col = std::min(ci, ck);
+            const double p = ci == col ? pivot.vals[i++] : 0.0;
+            const double w = ck == col ? m_work.vals[k++] : 0.0;
+
+            const double np = c * p + s * w;
+            const double nw = -s * p + c * w;
+            if (col == lead || np != 0.0) {
+                m_nextPivot.cols.push_back(col);
+                m_nextPivot.vals.push_back(col == lead ? r : np);
+            }
+            if (col != lead && std::abs(nw) > drop) {
+                m_nextWork.cols.push_back(col);
+                m_nextWork.vals.push_back(nw);
+            }
+        }
+        m_nextPivot.rhs = c * pivot.rhs + s * m_work.rhs;
+        m_nextWork.rhs = -s * pivot.rhs + c * m_work.rhs;
+
+        std::swap(pivot, m_nextPivot);
+        std::swap(m_work, m_nextWork);
+    }
+
+    IncrementalQR::RowOutcome IncrementalQR::addRow(const std::uint32_t* cols, const double* vals, std::size_t count, double rhs) {
+        loadWork(cols, vals, count, rhs);
+
+        double norm = 0.0;
+        for (double v : m_work.vals) norm += v * v;
+        const double threshold = m_rankTolerance * std::sqrt(norm);
+
+        while (!m_work.empty()) {
+            const std::uint32_t lead = m_work.cols[0];
+            Row& pivot = m_pivots[lead];
+
+            if (pivot.empty()) {
+                if (std::abs(m_work.vals[0]) > threshold) {
+                    std::swap(pivot, m_work);
+                    ++m_rank;
+                    return RowOutcome::Independent;
+                }
+                // Numerically zero leading entry: drop it and keep going.
+                m_work.cols.erase(m_work.cols.begin());
+                m_work.vals.erase(m_work.vals.begin());
+                continue;
+            }
+
+            rotate(pivot, threshold);
+        }
+
+        return std::abs(m_work.rhs) > m_residualTolerance ? RowOutcome::Conflicting : RowOutcome::Redundant;
+    }
+
+    std::uint32_t IncrementalQR::freeDirections(const std::uint32_t* cols, std::size_t count) {
+        // Membership in the row space does not need orthogonal updates, so plain
+        // Gaussian elimination against R suffices and R is never modified. Unit
+        // vectors that survive become temporary pivots in m_overlay.
+        m_overlay.clear();
+        std::uint32_t free = 0;
+
+        for (std::size_t n = 0; n < count; ++n) {
+            m_work.clear();
+            m_work.cols.push_back(cols[n]);
+            m_work.vals.push_back(1.0);
+
+            while (!m_work.empty()) {
+                const std::uint32_t lead = m_work.cols[0];
+
+                const Row* pivot = nullptr;
+                auto it = m_overlay.find(lead);
+                if (it != m_overlay.end()) pivot = &it->second;
+                else if (!m_pivots[lead].empty()) pivot = &m_pivots[lead];
+
+                if (!pivot) {
+                    if (std::abs(m_work.vals[0]) > m_rankTolerance) {
+                        m_overlay.emplace(lead, m_work);
+                        ++free;
+                        break;
+                    }
+                    m_work.cols.erase(m_work.cols.begin());
+                    m_work.vals.erase(m_work.vals.begin());
+                    continue;
+                }
+
+                // work -= (work[lead] / pivot[lead]) * pivot, dropping the leading column.
+                const double f = m_work.vals[0] / pivot->vals[0];
+                m_nextWork.clear();
+                std::size_t i = 1;
+                std::size_t k = 1;
+                while (i < pivot->cols.size() || k < m_work.cols.size()) {
+                    const std::uint32_t ci = i < pivot->cols.size() ? pivot->cols[i] : kEnd;
+                    const std::uint32_t ck = k < m_work.cols.size() ? m_work.cols[k] : kEnd;
+                    const std::uint32_t col = std::min(ci, ck);
+                    const double p = ci == col ? pivot->vals[i++] : 0.0;
+                    const double w = ck == col ? m_work.vals[k++] : 0.0;
+                    const double v = w - f * p;
+                    if (std::abs(v) > m_rankTolerance) {
+                        m_nextWork.cols.push_back(col);
+                        m_nextWork.vals.push_back(v);
+                    }
+                }
+                std::swap(m_work, m_nextWork);
+            }
+        }
+
+        m_overlay.clear();
+        return free;
+    }
+
+} // namespace domain::solver
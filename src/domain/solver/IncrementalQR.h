@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace domain::solver {
+
+    // Row-by-row sparse QR (George-Heath): the upper-triangular factor R is kept
+    // as one sparse row per pivot column, and each new row is folded in with
+    // Givens rotations. Q is never stored. A right-hand-side value travels with
+    // every row, so a row that eliminates to zero also tells whether it was
+    // consistent with the rows before it.
+    //
+    // Rank decisions are threshold based: after eliminating all existing pivots,
+    // a leading entry below rankTolerance * |original row| counts as zero. That
+    // makes the rank revealed in insertion order, so the later of two dependent
+    // rows is the one reported as redundant.
+    class IncrementalQR {
+    public:
+        enum class RowOutcome : std::uint8_t {
+            Independent,  // raised the rank
+            Redundant,    // linear combination of earlier rows, consistent right-hand side
+            Conflicting   // linear combination of earlier rows, right-hand side disagrees
+        };
+
+        void reset(std::size_t columns);
+        std::size_t columns() const { return m_pivots.size(); }
+        std::size_t rank() const { return m_rank; }
+
+        void setTolerances(double rank, double residual) {
+            m_rankTolerance = rank;
+            m_residualTolerance = residual;
+        }
+
+        // Folds in one row. Entries may be unsorted; repeated columns are summed.
+        RowOutcome addRow(const std::uint32_t* cols, const double* vals, std::size_t count, double rhs);
+
+        // Number of the unit vectors e_c (c in cols) that are independent of R
+        // and of each other, i.e. rank([R; E^T]) - rank(R). For the parameter
+        // block of one entity this is the entity's remaining degrees of freedom.
+        // R itself is left unchanged.
+        std::uint32_t freeDirections(const std::uint32_t* cols, std::size_t count);
+
+    private:
+        struct Row {
+            std::vector<std::uint32_t> cols; // sorted; cols[0] is the leading column
+            std::vector<double> vals;
+            double rhs{ 0.0 };
+
+            bool empty() const { return cols.empty(); }
+            void clear() {
+                cols.clear();
+                vals.clear();
+                rhs = 0.0;
+            }
+        };
+
+        std::vector<Row> m_pivots; // m_pivots[c] has leading column c, or is empty
+        std::size_t m_rank{ 0 };
+        double m_rankTolerance{ 1e-10 };
+        double m_residualTolerance{ 1e-7 };
+
+        // freeDirections() stages its temporary pivots here instead of touching m_pivots.
+        std::unordered_map<std::uint32_t, Row> m_overlay;
+
+        // Scratch rows, swapped rather than reallocated.
+        Row m_work;
+        Row m_nextPivot;
+        Row m_nextWork;
+        std::vector<std::size_t> m_order;
+
+        void loadWork(const std::uint32_t* cols, const double* vals, std::size_t count, double rhs);
+        // Rotates m_work against `pivot` (same leading column), removing that
+        // column from m_work; entries of m_work at or below `drop` are discarded.
+        void rotate(Row& pivot, double drop);
+    };
+
+} // namespace domain::solver
@@ -0,0 +1,138 @@
+#include "domain/solver/LevenbergMarquardt.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace domain::solver {
+
+    namespace {
+
+        double maxAbs(const std::vector<double>& v) {
+            double m = 0.0;
+            for (double x : v) m = std::max(m, std::abs(x));
+            return m;
+        }
+
+        double halfSquaredNorm(const std::vector<double>& v) {
+            double s = 0.0;
+            for (double x : v) s += x * x;
+            return 0.5 * s;
+        }
+
+    } // namespace
+
+    SolveResult LevenbergMarquardt::solve(const std::vector<Equation>& equations, std::vector<double>& x, const SolverOptions& options) {
+        SolveResult result;
+        result.equationCount = equations.size();
+
+        if (equations.empty()) {
+            result.status = SolveStatus::NothingToSolve;
+            return result;
+        }
+
+        m_jacobian.build(equations, x.size());
+        const std::size_t rows = m_jacobian.rows();
+        const std::size_t cols = m_jacobian.cols();
+        const auto& columnParams = m_jacobian.columnParams();
+        result.parameterCount = cols;
+
+        m_residuals.resize(rows);
+        m_trialResiduals.resize(rows);
+        m_gradient.resize(cols);
+        m_diag.resize(cols);
+        m_step.resize(cols);
+        m_trialX = x;
+
+        m_jacobian.evaluate(equations, x.data(), m_residuals.data());
+        double cost = halfSquaredNorm(m_residuals);
+        result.residualNorm = maxAbs(m_residuals);
+
+        double lambda = -1.0;
+        double nu = 2.0;
+        bool relinearize = false;
+
+        result.status = SolveStatus::NotConverged;
+        for (int iter = 0; iter < options.maxIterations; ++iter) {
+            if (result.residualNorm <= options.residualTolerance) {
+                result.status = SolveStatus::Converged;
+                break;
+            }
+            result.iterations = iter + 1;
+
+            if (relinearize) {
+                m_jacobian.evaluate(equations, x.data(), m_residuals.data());
+                relinearize = false;
+            }
+
+            m_jacobian.multiplyTransposed(m_residuals.data(), m_gradient.data());
+            m_jacobian.columnSquares(m_diag.data());
+
+            // Damping is the same for every column, scaled to the stiffest one.
+            // Scaling each column by its own diag(J^T J) instead lets a barely
+            // constrained coordinate take a huge step, which on an
+            // underdetermined sketch drags entities far from where they were.
+            const double maxDiag = *std::max_element(m_diag.begin(), m_diag.end());
+            const double scale = std::max(maxDiag, 1e-18);
+            if (lambda < 0.0) lambda = options.initialLambda;
+            const double mu = lambda * scale;
+
+            m_normal.solve(m_jacobian, m_gradient, m_diag, mu, options.maxLinearIterations, options.linearTolerance, m_step);
+
+            // Trial point and predicted reduction 0.5 * s^T (mu s - g).
+            double stepNorm = 0.0;
+            double xNorm = 0.0;
+            double predicted = 0.0;
+            for (std::size_t c = 0; c < cols; ++c) {
+                const ParamIndex p = columnParams[c];
+                m_trialX[p] = x[p] + m_step[c];
+                stepNorm += m_step[c] * m_step[c];
+                xNorm += x[p] * x[p];
+                predicted += m_step[c] * (mu * m_step[c] - m_gradient[c]);
+            }
+            predicted *= 0.5;
+            stepNorm = std::sqrt(stepNorm);
+            xNorm = std::sqrt(xNorm);
+
+            if (stepNorm <= options.stepTolerance * (xNorm + options.stepTolerance)) {
+                result.status = SolveStatus::Stalled;
+                break;
+            }
+
+            m_jacobian.residuals(equations, m_trialX.data(), m_trialResiduals.data());
+            const double trialCost = halfSquaredNorm(m_trialResiduals);
+            const double rho = predicted > 0.0 ? (cost - trialCost) / predicted : -1.0;
+
+            if (rho > 0.0) {
+                for (std::size_t c = 0; c < cols; ++c) {
+                    const ParamIndex p = columnParams[c];
+                    x[p] = m_trialX[p];
+                }
+                m_residuals.swap(m_trialResiduals);
+                cost = trialCost;
+                result.residualNorm = maxAbs(m_residuals);
+                relinearize = true;
+
+                const double t = 2.0 * rho - 1.0;
+                lambda *= std::max(1.0 / 3.0, 1.0 - t * t * t);
+                nu = 2.0;
+            } else {
+                for (std::size_t c = 0; c < cols; ++c) {
+                    const ParamIndex p = columnParams[c];
+                    m_trialX[p] = x[p];
+                }
+                lambda *= nu;
+                nu *= 2.0;
+                if (lambda > 1e16) {
+                    result.status = SolveStatus::Stalled;
+                    break;
+                }
+            }
+        }
+
+        if (result.status == SolveStatus::NotConverged && result.residualNorm <= options.residualTolerance) {
+            result.status = SolveStatus::Converged;
+        }
+        return result;
+    }
+
+} // namespace domain::solver
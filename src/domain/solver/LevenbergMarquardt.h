@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include "Equations.h"
+#include "NormalEquations.h"
+#include "SolverTypes.h"
+#include "SparseJacobian.h"
+
+namespace domain::solver {
+
+    // Sparse Levenberg-Marquardt least-squares solver.
+    //
+    // Each iteration solves the damped normal equations
+    //     (J^T J + lambda * m * I) dx = -J^T r,   m = max diag(J^T J)
+    // with NormalEquationSolver (preconditioned CG, J^T J is never formed).
+    // The damping is Levenberg's, not Marquardt's: every parameter is held
+    // back alike, so the step stays close to the minimum-norm one and free
+    // parameters of an underdetermined sketch barely move. lambda follows
+    // Nielsen's gain-ratio rule.
+    //
+    // The object owns all work buffers; reuse one instance across solves to avoid
+    // reallocating them.
+    class LevenbergMarquardt {
+    public:
+        // Solves in place on the full parameter vector x.
+        SolveResult solve(const std::vector<Equation>& equations, std::vector<double>& x, const SolverOptions& options);
+
+    private:
+        SparseJacobian m_jacobian;
+
+        std::vector<double> m_residuals;
+        std::vector<double> m_trialResiduals;
+        std::vector<double> m_trialX;
+        std::vector<double> m_gradient;
+        std::vector<double> m_diag;
+        std::vector<double> m_step;
+
+        NormalEquationSolver m_normal;
+    };
+
+} // namespace domain::solver
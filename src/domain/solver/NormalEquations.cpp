@@ -0,0 +1,142 @@
+#include "domain/solver/NormalEquations.h"
+
+#include <algorithm>
+
+namespace domain::solver {
+
+    namespace {
+
+        double dot(const std::vector<double>& a, const std::vector<double>& b) {
+            double s = 0.0;
+            for (std::size_t i = 0; i < a.size(); ++i) s += a[i] * b[i];
+            return s;
+        }
+
+    } // namespace
+
+    int NormalEquationSolver::solve(const SparseJacobian& jacobian, const std::vector<double>& gradient, const std::vector<double>& columnSquares,
+        double mu, int maxIterations, double tolerance, std::vector<double>& step, Clock::time_point deadline) {
+        const std::size_t n = jacobian.cols();
+
+        step.assign(n, 0.0);
+        m_residual.resize(n);
+        m_precond.resize(n);
+        m_direction.resize(n);
+        m_product.resize(n);
+        m_rows.resize(jacobian.rows());
+
+        // Start from s = 0.
+        for (std::size_t i = 0; i < n; ++i) {
+            m_residual[i] = -gradient[i];
+            m_precond[i] = 1.0 / (columnSquares[i] + mu);
+            m_direction[i] = m_residual[i] * m_precond[i];
+        }
+
+        double rz = 0.0;
+        for (std::size_t i = 0; i < n; ++i) rz += m_residual[i] * m_direction[i];
+
+        const double stop = tolerance * tolerance * std::max(1.0, dot(gradient, gradient));
+        const bool timed = deadline != Clock::time_point::max();
+
+        int it = 0;
+        for (; it < maxIterations; ++it) {
+            if (dot(m_residual, m_residual) <= stop) break;
+            // Clock reads are cheap next to two sparse products, but not free.
+            if (timed && (it & 7) == 7 && Clock::now() >= deadline) break;
+
+            jacobian.multiply(m_direction.data(), m_rows.data());
+            jacobian.multiplyTransposed(m_rows.data(), m_product.data());
+            for (std::size_t i = 0; i < n; ++i) m_product[i] += mu * m_direction[i];
+
+            const double pq = dot(m_direction, m_product);
+            if (pq <= 0.0) break;
+            const double alpha = rz / pq;
+
+            double rzNext = 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                step[i] += alpha * m_direction[i];
+                m_residual[i] -= alpha * m_product[i];
+                rzNext += m_residual[i] * m_residual[i] * m_precond[i];
+            }
+
+            const double beta = rzNext / rz;
+            rz = rzNext;
+            for (std::size_t i = 0; i < n; ++i) {
+                m_direction[i] = m_residual[i] * m_precond[i] + beta * m_direction[i];
+            }
+        }
+        return it;
+    }
+
+    int NormalEquationSolver::solveMinNorm(const SparseJacobian& jacobian, const std::vector<double>& residuals, const std::vector<double>& columnWeights,
+        double ridge, int maxIterations, double tolerance, std::vector<double>& step, Clock::time_point deadline) {
+        const std::size_t m = jacobian.rows();
+        const std::size_t n = jacobian.cols();
+        const auto& rowPtr = jacobian.rowPtr();
+        const auto& colIndex = jacobian.colIndex();
+        const auto& values = jacobian.values();
+
+        // Row-space vectors this time; m_product doubles as the column-space temporary.
+        m_residual.resize(m);
+        m_precond.resize(m);
+        m_direction.resize(m);
+        m_rows.resize(m);
+        m_rowSolution.assign(m, 0.0);
+        m_product.resize(n);
+
+        // Jacobi preconditioner diag(J M J^T) + ridge.
+        for (std::size_t r = 0; r < m; ++r) {
+            double d = ridge;
+            for (std::uint32_t e = rowPtr[r]; e < rowPtr[r + 1]; ++e) {
+                d += columnWeights[colIndex[e]] * values[e] * values[e];
+            }
+            m_precond[r] = d > 0.0 ? 1.0 / d : 0.0;
+        }
+
+        for (std::size_t r = 0; r < m; ++r) {
+            m_residual[r] = -residuals[r];
+            m_direction[r] = m_residual[r] * m_precond[r];
+        }
+
+        double rz = 0.0;
+        for (std::size_t r = 0; r < m; ++r) rz += m_residual[r] * m_direction[r];
+
+        const double stop = tolerance * tolerance * dot(residuals, residuals);
+        const bool timed = deadline != Clock::time_point::max();
+
+        int it = 0;
+        for (; it < maxIterations; ++it) {
+            if (dot(m_residual, m_residual) <= stop) break;
+            if (timed && (it & 7) == 7 && Clock::now() >= deadline) break;
+
+            // q = (J M J^T + ridge I) p
+            jacobian.multiplyTransposed(m_direction.data(), m_product.data());
+            for (std::size_t c = 0; c < n; ++c) m_product[c] *= columnWeights[c];
+            jacobian.multiply(m_product.data(), m_rows.data());
+            for (std::size_t r = 0; r < m; ++r) m_rows[r] += ridge * m_direction[r];
+
+            const double pq = dot(m_direction, m_rows);
+            if (pq <= 0.0) break;
+            const double alpha = rz / pq;
+
+            double rzNext = 0.0;
+            for (std::size_t r = 0; r < m; ++r) {
+                m_rowSolution[r] += alpha * m_direction[r];
+                m_residual[r] -= alpha * m_rows[r];
+                rzNext += m_residual[r] * m_residual[r] * m_precond[r];
+            }
+
+            const double beta = rzNext / rz;
+            rz = rzNext;
+            for (std::size_t r = 0; r < m; ++r) {
+                m_direction[r] = m_residual[r] * m_precond[r] + beta * m_direction[r];
+            }
+        }
+
+        step.resize(n);
+        jacobian.multiplyTransposed(m_rowSolution.data(), step.data());
+        for (std::size_t c = 0; c < n; ++c) step[c] *= columnWeights[c];
+        return it;
+    }
+
+} // namespace domain::solver
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "SparseJacobian.h"
+
+namespace domain::solver {
+
+    // Solves the damped normal equations
+    //     (J^T J + mu * I) s = -g
+    // with Jacobi-preconditioned conjugate gradients, using only J and J^T
+    // products (J^T J is never formed). Shared by the Levenberg-Marquardt and
+    // drag solvers.
+    class NormalEquationSolver {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // `columnSquares` is diag(J^T J), for the preconditioner; mu > 0.
+        // `step` is resized to J.cols(). Stops after maxIterations, once
+        // |residual| <= tolerance * max(1, |g|), or when `deadline` has passed.
+        // Returns the number of CG iterations run.
+        int solve(const SparseJacobian& jacobian, const std::vector<double>& gradient, const std::vector<double>& columnSquares,
+            double mu, int maxIterations, double tolerance, std::vector<double>& step,
+            Clock::time_point deadline = Clock::time_point::max());
+
+        // Weighted minimum-norm Gauss-Newton step for J s = -r: solves
+        //     (J M J^T + ridge * I) y = -r,   s = M J^T y
+        // in row space (CGNE), where M = diag(columnWeights) says how freely each
+        // unknown may move. With a small ridge this tolerates redundant rows.
+        // Stops once |residual| <= tolerance * |r| (relative, unlike solve()).
+        int solveMinNorm(const SparseJacobian& jacobian, const std::vector<double>& residuals, const std::vector<double>& columnWeights,
+            double ridge, int maxIterations, double tolerance, std::vector<double>& step,
+            Clock::time_point deadline = Clock::time_point::max());
+
+    private:
+        std::vector<double> m_residual;
+        std::vector<double> m_precond;
+        std::vector<double> m_direction;
+        std::vector<double> m_product;
+        std::vector<double> m_rows; // row space
+        std::vector<double> m_rowSolution; // solveMinNorm only
+    };
+
+} // namespace domain::solver
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace domain::solver {
+
+    // What the solver needs of a thread pool: a blocking parallel loop with
+    // per-thread slots. The application lends it the scheduler its background
+    // jobs run on, so both share the same threads.
+    class ParallelExecutor {
+    public:
+        virtual ~ParallelExecutor() = default;
+
+        // Number of distinct `slot` values passed to parallelFor callbacks.
+        // Size per-thread scratch with this.
+        virtual unsigned slotCount() const = 0;
+
+        // Calls fn(index, slot) for every index in [0, count), in chunks of `grain`
+        // consecutive indices, and blocks until all calls have returned. Calls
+        // running at the same time get different slots.
+        virtual void parallelFor(std::size_t count, std::size_t grain,
+            const std::function<void(std::size_t, unsigned)>& fn) = 0;
+    };
+
+} // namespace domain::solver
@@ -0,0 +1,230 @@
+#include "domain/solver/ParameterTable.h"
+
+namespace domain::solver {
+
+    using namespace domain::sketch;
+
+    namespace {
+
+        void setCurveEnds(EntityParams& ep, const EntityStore& store, std::uint32_t i) {
+            const BSpline spline = BSpline::fromStore(store, i);
+            ep.ends[0] = spline.end(false);
+            ep.ends[1] = spline.end(true);
+        }
+
+    } // namespace
+
+    EntityParams& ParameterTable::append(EntityId id, EntityHandle handle, std::uint32_t count) {
+        const auto offset = static_cast<ParamIndex>(m_values.size());
+        EntityParams& ep = m_entities.emplace(id, EntityParams{ handle.kind, handle, offset, count, {} }).first->second;
+        m_values.resize(m_values.size() + count);
+        return ep;
+    }
+
+    void ParameterTable::gather(const EntityStore& store) {
+        clear();
+
+        const PointColumns& pc = store.points();
+        const LineColumns& lc = store.lines();
+        const CircleColumns& cc = store.circles();
+        const ArcColumns& ac = store.arcs();
+        const EllipseColumns& ec = store.ellipses();
+        const CurveColumns& vc = store.curves();
+
+        std::size_t total = 2 * pc.size() + 4 * lc.size() + 3 * cc.size() + 7 * ac.size() + 5 * ec.size();
+        for (const auto& cps : vc.controlPoints) total += 2 * cps.size();
+        m_values.reserve(total);
+        m_entities.reserve(store.size());
+
+        auto appendAt = [&](EntityKind kind, std::uint32_t i, std::uint32_t count) {
+            const EntityParams& ep = append(store.headers(kind).ids[i], store.handleAt(kind, i), count);
+            return m_values.data() + ep.offset;
+        };
+
+        for (std::uint32_t i = 0; i < pc.size(); ++i) {
+            double* v = appendAt(EntityKind::Point, i, 2);
+            v[0] = pc.x[i]; v[1] = pc.y[i];
+        }
+
+        for (std::uint32_t i = 0; i < lc.size(); ++i) {
+            double* v = appendAt(EntityKind::Line, i, 4);
+            v[0] = lc.ax[i]; v[1] = lc.ay[i];
+            v[2] = lc.bx[i]; v[3] = lc.by[i];
+        }
+
+        for (std::uint32_t i = 0; i < cc.size(); ++i) {
+            double* v = appendAt(EntityKind::Circle, i, 3);
+            v[0] = cc.cx[i]; v[1] = cc.cy[i];
+            v[2] = cc.r[i];
+        }
+
+        for (std::uint32_t i = 0; i < ac.size(); ++i) {
+            double* v = appendAt(EntityKind::Arc, i, 7);
+            v[0] = ac.cx[i]; v[1] = ac.cy[i];
+            v[2] = ac.r[i];
+            v[3] = ac.sx[i]; v[4] = ac.sy[i];
+            v[5] = ac.ex[i]; v[6] = ac.ey[i];
+        }
+
+        for (std::uint32_t i = 0; i < ec.size(); ++i) {
+            double* v = appendAt(EntityKind::Ellipse, i, 5);
+            v[0] = ec.cx[i]; v[1] = ec.cy[i];
+            v[2] = ec.rx[i]; v[3] = ec.ry[i];
+            v[4] = ec.rotation[i];
+        }
+
+        for (std::uint32_t i = 0; i < vc.size(); ++i) {
+            const auto& cps = vc.controlPoints[i];
+            double* v = appendAt(EntityKind::Curve, i, 2 * static_cast<std::uint32_t>(cps.size()));
+            for (const auto& cp : cps) {
+                *v++ = cp.x;
+                *v++ = cp.y;
+            }
+            setCurveEnds(m_entities.at(store.headers(EntityKind::Curve).ids[i]), store, i);
+        }
+    }
+
+    void ParameterTable::appendEntity(const EntityStore& store, EntityId id) {
+        const EntityHandle h = store.getHandle(id);
+        const std::uint32_t i = store.indexOf(h);
+        // Resizing may move the values, so the pointer is taken after.
+        auto values = [&](std::uint32_t count) {
+            const EntityParams& ep = append(id, h, count);
+            return m_values.data() + ep.offset;
+        };
+        switch (h.kind) {
+        case EntityKind::Point: {
+            const PointColumns& pc = store.points();
+            double* v = values(2);
+            v[0] = pc.x[i]; v[1] = pc.y[i];
+            break;
+        }
+        case EntityKind::Line: {
+            const LineColumns& lc = store.lines();
+            double* v = values(4);
+            v[0] = lc.ax[i]; v[1] = lc.ay[i];
+            v[2] = lc.bx[i]; v[3] = lc.by[i];
+            break;
+        }
+        case EntityKind::Circle: {
+            const CircleColumns& cc = store.circles();
+            double* v = values(3);
+            v[0] = cc.cx[i]; v[1] = cc.cy[i];
+            v[2] = cc.r[i];
+            break;
+        }
+        case EntityKind::Arc: {
+            const ArcColumns& ac = store.arcs();
+            double* v = values(7);
+            v[0] = ac.cx[i]; v[1] = ac.cy[i];
+            v[2] = ac.r[i];
+            v[3] = ac.sx[i]; v[4] = ac.sy[i];
+            v[5] = ac.ex[i]; v[6] = ac.ey[i];
+            break;
+        }
+        case EntityKind::Ellipse: {
+            const EllipseColumns& ec = store.ellipses();
+            double* v = values(5);
+            v[0] = ec.cx[i]; v[1] = ec.cy[i];
+            v[2] = ec.rx[i]; v[3] = ec.ry[i];
+            v[4] = ec.rotation[i];
+            break;
+        }
+        case EntityKind::Curve: {
+            const auto& cps = store.curves().controlPoints[i];
+            double* v = values(2 * static_cast<std::uint32_t>(cps.size()));
+            for (const auto& cp : cps) {
+                *v++ = cp.x;
+                *v++ = cp.y;
+            }
+            setCurveEnds(m_entities.at(id), store, i);
+            break;
+        }
+        }
+    }
+
+    void ParameterTable::gather(const EntityStore& store, const std::vector<EntityId>& ids) {
+        clear();
+        m_values.reserve(4 * ids.size());
+        m_entities.reserve(ids.size());
+        for (EntityId id : ids) appendEntity(store, id);
+    }
+
+    bool ParameterTable::scatter(EntityStore& store) const {
+        if (!scatter(store, store.pendingVersion())) return false;
+        store.nextVersion();
+        return true;
+    }
+
+    bool ParameterTable::scatter(EntityStore& store, std::uint64_t version) const {
+        bool any = false;
+        for (const auto& [id, ep] : m_entities) {
+            const double* v = m_values.data() + ep.offset;
+            const std::uint32_t i = store.indexOf(ep.handle);
+            bool changed = false;
+            auto put = [&changed](double& slot, double value) {
+                if (slot != value) {
+                    slot = value;
+                    changed = true;
+                }
+            };
+            switch (ep.kind) {
+            case EntityKind::Point: {
+                PointColumns& pc = store.points();
+                put(pc.x[i], v[0]); put(pc.y[i], v[1]);
+                break;
+            }
+            case EntityKind::Line: {
+                LineColumns& lc = store.lines();
+                put(lc.ax[i], v[0]); put(lc.ay[i], v[1]);
+                put(lc.bx[i], v[2]); put(lc.by[i], v[3]);
+                break;
+            }
+            case EntityKind::Circle: {
+                CircleColumns& cc = store.circles();
+                put(cc.cx[i], v[0]); put(cc.cy[i], v[1]);
+                put(cc.r[i], v[2]);
+                break;
+            }
+            case EntityKind::Arc: {
+                ArcColumns& ac = store.arcs();
+                put(ac.cx[i], v[0]); put(ac.cy[i], v[1]);
+                put(ac.r[i], v[2]);
+                put(ac.sx[i], v[3]); put(ac.sy[i], v[4]);
+                put(ac.ex[i], v[5]); put(ac.ey[i], v[6]);
+                break;
+            }
+            case EntityKind::Ellipse: {
+                EllipseColumns& ec = store.ellipses();
+                put(ec.cx[i], v[0]); put(ec.cy[i], v[1]);
+                put(ec.rx[i], v[2]); put(ec.ry[i], v[3]);
+                put(ec.rotation[i], v[4]);
+                break;
+            }
+            case EntityKind::Curve: {
+                for (auto& cp : store.curves().controlPoints[i]) {
+                    put(cp.x, v[0]); put(cp.y, v[1]);
+                    v += 2;
+                }
+                break;
+            }
+            }
+            if (changed) {
+                store.markChanged(ep.handle, version);
+                any = true;
+            }
+        }
+        return any;
+    }
+
+    const EntityParams* ParameterTable::find(EntityId id) const {
+        auto it = m_entities.find(id);
+        return it == m_entities.end() ? nullptr : &it->second;
+    }
+
+    void ParameterTable::clear() {
+        m_values.clear();
+        m_entities.clear();
+    }
+
+} // namespace domain::solver
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "domain/SketchEntities.h"
+#include "domain/SketchSpline.h"
+#include "SolverTypes.h"
+
+namespace domain::solver {
+
+    // Offsets of each unknown inside an entity's parameter block.
+    namespace layout {
+        // Point: x y
+        inline constexpr ParamIndex PointP = 0;
+
+        // Line: ax ay bx by
+        inline constexpr ParamIndex LineA = 0;
+        inline constexpr ParamIndex LineB = 2;
+
+        // Circle: cx cy r
+        inline constexpr ParamIndex CircleCenter = 0;
+        inline constexpr ParamIndex CircleRadius = 2;
+
+        // Arc: cx cy r sx sy ex ey
+        inline constexpr ParamIndex ArcCenter = 0;
+        inline constexpr ParamIndex ArcRadius = 2;
+        inline constexpr ParamIndex ArcStart = 3;
+        inline constexpr ParamIndex ArcEnd = 5;
+
+        // Ellipse: cx cy rx ry rotation
+        inline constexpr ParamIndex EllipseCenter = 0;
+        inline constexpr ParamIndex EllipseRx = 2;
+        inline constexpr ParamIndex EllipseRy = 3;
+        inline constexpr ParamIndex EllipseRotation = 4;
+
+        // Curve: x0 y0 x1 y1 ... (one pair per control point)
+    }
+
+    struct EntityParams {
+        sketch::EntityKind kind{ sketch::EntityKind::Point };
+        sketch::EntityHandle handle; // stable across removal of other entities
+        ParamIndex offset{ 0 };      // first parameter in the packed vector
+        std::uint32_t count{ 0 };    // number of parameters
+
+        // Curves only: start and end shape. Knots, degree and weights are not
+        // unknowns, so this holds for the whole solve.
+        sketch::SplineEnd ends[2];
+    };
+
+    // Packs the continuous parameters of every entity in an EntityStore into one
+    // contiguous vector so the solver can work on plain arrays.
+    class ParameterTable {
+    public:
+        void gather(const sketch::EntityStore& store);
+        // Packs only the listed entities (ids must exist in the store).
+        void gather(const sketch::EntityStore& store, const std::vector<sketch::EntityId>& ids);
+        // Writes the values back, marking the entities whose values changed
+        // with `version` (see EntityStore::markChanged). Returns whether any did.
+        bool scatter(sketch::EntityStore& store, std::uint64_t version) const;
+        // Likewise under a new store version, which is taken only if something changed.
+        bool scatter(sketch::EntityStore& store) const;
+
+        const EntityParams* find(sketch::EntityId id) const;
+        const std::unordered_map<sketch::EntityId, EntityParams>& entities() const { return m_entities; }
+
+        std::vector<double>& values() { return m_values; }
+        const std::vector<double>& values() const { return m_values; }
+        std::size_t size() const { return m_values.size(); }
+
+        void clear();
+
+    private:
+        std::vector<double> m_values;
+        std::unordered_map<sketch::EntityId, EntityParams> m_entities;
+
+        EntityParams& append(sketch::EntityId id, sketch::EntityHandle handle, std::uint32_t count);
+        void appendEntity(const sketch::EntityStore& store, sketch::EntityId id);
+    };
+
+} // namespace domain::solver
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "Dual.h"
+#include "Equations.h"
+
+namespace domain::solver::kernels {
+
+    // One functor per EquationKind. Residual<K>::eval(v, eq) computes the
+    // residual from the equation's gathered parameters v[i] = x[eq.p[i]] and is
+    // a template over the scalar type, so the same source yields the value
+    // (T = double) and the exact gradient (T = Dual<kParams>). Nothing here is
+    // differentiated by hand.
+
+    inline constexpr double kPi = 3.14159265358979323846;
+    inline constexpr double kTiny = 1e-12;
+
+    template <class T>
+    struct V2 {
+        T x, y;
+    };
+
+    template <class T> DUAL_INLINE V2<T> pointAt(const T* v, int i) { return { v[i], v[i + 1] }; }
+    template <class T> DUAL_INLINE V2<T> operator-(const V2<T>& a, const V2<T>& b) { return { a.x - b.x, a.y - b.y }; }
+    template <class T> DUAL_INLINE T cross(const V2<T>& a, const V2<T>& b) { return a.x * b.y - a.y * b.x; }
+    template <class T> DUAL_INLINE T dot(const V2<T>& a, const V2<T>& b) { return a.x * b.x + a.y * b.y; }
+
+    // |a|. For (near) coincident points the value is within kTiny of the true
+    // length and the derivative points along +x, an arbitrary but stable
+    // direction so the solver can still pull them apart.
+    template <class T>
+    DUAL_INLINE T length(const V2<T>& a) {
+        using std::sqrt;
+        const T sq = dot(a, a);
+        if (valueOf(sq) > kTiny * kTiny) return sqrt(sq);
+        return a.x;
+    }
+
+    // |a|, floored at kTiny (as a constant) for use as a divisor.
+    template <class T>
+    DUAL_INLINE T safeLength(const V2<T>& a) {
+        using std::sqrt;
+        const T sq = dot(a, a);
+        if (valueOf(sq) < kTiny * kTiny) return T(kTiny);
+        return sqrt(sq);
+    }
+
+    // Signed distance of m (relative to A) from the line through A with direction d.
+    template <class T>
+    DUAL_INLINE T signedDistance(const V2<T>& d, const V2<T>& m) {
+        return cross(d, m) / safeLength(d);
+    }
+
+    template <EquationKind K>
+    struct Residual;
+
+    template <>
+    struct Residual<EquationKind::Linear> {
+        static constexpr int kParams = 4; // upper bound; eq.paramCount says how many are used
+        template <class T>
+        DUAL_INLINE static T eval(const T* v, const Equation& eq) {
+            // Unused terms have k == 0 and v == 0, so all four are summed unconditionally.
+            return eq.k[0] * v[0] + eq.k[1] * v[1] + eq.k[2] * v[2] + eq.k[3] * v[3] - eq.value;
+        }
+    };
+
+    template <>
+    struct Residual<EquationKind::PointDistance> {
+        static constexpr int kParams = 4;
+        template <class T>
+        DUAL_INLINE static T eval(const T* v, const Equation& eq) {
+            return length(pointAt(v, 0) - pointAt(v, 2)) - eq.value;
+        }
+    };
+
+    template <>
+    struct Residual<EquationKind::PointOnCircle> {
+        static constexpr int kParams = 5;
+        template <class T>
+        DUAL_INLINE static T eval(const T* v, const Equation&) {
+            return length(pointAt(v, 0) - pointAt(v, 2)) - v[4];
+        }
+    };
+
+    template <>
+    struct Residual<EquationKind::PointLineDistance> {
+        static constexpr int kParams = 6;
+        template <class T>
+        DUAL_INLINE static T eval(const T* v, const Equation& eq) {
+            const V2<T> p = pointAt(v, 0);
+            const V2<T> a = pointAt(v, 2);
+            const V2<T> b = pointAt(v, 4);
+            return signedDistance(b - a, p - a) - eq.value;
+        }
+    };
+
+    template <>
+    struct Residual<EquationKind::MidpointLineDistance> {
+        static constexpr int kParams = 8;
+        template <class T>
+        DUAL_INLINE static T eval(const T* v, const Equation& eq) {
+            const V2<T> mid{ 0.5 * (v[0] + v[2]), 0.5 * (v[1] + v[3]) };
+            const V2<T> a = pointAt(v, 4);
+            const V2<T> b = pointAt(v, 6);
+            return signedDistance(b - a, mid - a) - eq.value;
+        }
+    };
+
+    template <>
+    struct Residual<EquationKind::LineCircleTangent> {
+        static constexpr int kParams = 7;
+        template <class T>
+        DUAL_INLINE static T eval(const T* v, const Equation& eq) {
+            const V2<T> c = pointAt(v, 0);
+            const V2<T> a = pointAt(v, 3);
+            const V2<T> b = pointAt(v, 5);
+            return eq.k[0] * signedDistance(b - a, c - a) - v[2];
+        }
+    };
+
+    template <>
+    struct Residual<EquationKind::CircleCircleTangent> {
+        static constexpr int kParams = 6;
+        template <class T>
+        DUAL_INLINE static T eval(const T* v, const Equation& eq) {
+            return length(pointAt(v, 0) - pointAt(v, 3)) - (v[2] + eq.k[0] * v[5]);
+        }
+    };
+
+    template <>
+    struct Residual<EquationKind::Cross> {
+        static constexpr int kParams = 8;
+        template <class T>
+        DUAL_INLINE static T eval(const T* v, const Equation& eq) {
+            return cross(pointAt(v, 2) - pointAt(v, 0), pointAt(v, 6) - pointAt(v, 4)) - eq.value;
+        }
+    };
+
+    template <>
+    struct Residual<EquationKind::Dot> {
+        static constexpr int kParams = 8;
+        template <class T>
+        DUAL_INLINE static T eval(const T* v, const Equation& eq) {
+            return dot(pointAt(v, 2) - pointAt(v, 0), pointAt(v, 6) - pointAt(v, 4)) - eq.value;
+        }
+    };
+
+    template <>
+    struct Residual<EquationKind::Angle> {
+        static constexpr int kParams = 8;
+        template <class T>
+        DUAL_INLINE static T eval(const T* v, const Equation& eq) {
+            using std::atan2;
+            const V2<T> u = pointAt(v, 2) - pointAt(v, 0);
+            const V2<T> w = pointAt(v, 6) - pointAt(v, 4);
+            T r = atan2(cross(u, w), dot(u, w)) - eq.value;
+            while (valueOf(r) > kPi) r -= 2.0 * kPi;
+            while (valueOf(r) <= -kPi) r += 2.0 * kPi;
+            return r;
+        }
+    };
+
+    template <>
+    struct Residual<EquationKind::EndCurvature> {
+        static constexpr int kParams = 7;
+        template <class T>
+        DUAL_INLINE static T eval(const T* v, const Equation& eq) {
+            using std::abs;
+            // Curvature at a clamped spline end; eq.k[0] carries the factor its
+            // knots, degree and weights give (sketch::SplineEnd).
+            const V2<T> u = pointAt(v, 2) - pointAt(v, 0);
+            const V2<T> w = pointAt(v, 4) - pointAt(v, 2);
+            const T len = safeLength(u);
+            const T kappa = eq.k[0] * abs(cross(u, w)) / (len * len * len);
+            const T radius = std::abs(valueOf(v[6])) > kTiny ? v[6] : T(kTiny);
+            return kappa - 1.0 / radius;
+        }
+    };
+
+    // v[I] = x[eq.p[I]] seeded as the I-th variable; slots at or past `count` are zero.
+    template <int N, int... I>
+    DUAL_INLINE void seed(Dual<N>* v, const Equation& eq, const double* x, int count, std::integer_sequence<int, I...>) {
+        ((v[I] = Dual<N>::template variable<I>(I < count ? x[eq.p[I]] : 0.0)), ...);
+    }
+
+    // Value (grad == nullptr) or value and gradient of one equation of kind K.
+    template <EquationKind K>
+    DUAL_INLINE double evaluate(const Equation& eq, const double* x, double* grad) {
+        using R = Residual<K>;
+        constexpr int n = R::kParams;
+        const int count = K == EquationKind::Linear ? eq.paramCount : n;
+
+        if (!grad || K == EquationKind::Linear) {
+            double v[n]{};
+            for (int i = 0; i < count; ++i) v[i] = x[eq.p[i]];
+            if constexpr (K == EquationKind::Linear) {
+                // Constant gradient: the coefficients themselves.
+                if (grad) for (int i = 0; i < count; ++i) grad[i] = eq.k[i];
+            }
+            return R::eval(v, eq);
+        }
+
+        Dual<n> v[n];
+        seed(v, eq, x, count, std::make_integer_sequence<int, n>{});
+        const Dual<n> r = R::eval(v, eq);
+        for (int i = 0; i < count; ++i) grad[i] = r.d[i];
+        return r.v;
+    }
+
+    // Evaluates equations[rows[i]] for i < count, all of kind K. The kernel is
+    // fixed for the whole loop, so it inlines and the loop body has no dispatch.
+    template <EquationKind K>
+    inline void evaluateBatch(const Equation* equations, const std::uint32_t* rows, std::size_t count,
+                              const double* x, double* residuals, const std::uint32_t* rowPtr, double* values) {
+        if (values) {
+            for (std::size_t i = 0; i < count; ++i) {
+                const std::uint32_t row = rows[i];
+                residuals[row] = evaluate<K>(equations[row], x, values + rowPtr[row]);
+            }
+        }
+        else {
+            for (std::size_t i = 0; i < count; ++i) {
+                const std::uint32_t row = rows[i];
+                residuals[row] = evaluate<K>(equations[row], x, nullptr);
+            }
+        }
+    }
+
+    // Calls f(std::integral_constant<EquationKind, K>{}) for the runtime kind,
+    // turning one switch into a compile-time kernel choice.
+    template <class F>
+    inline decltype(auto) dispatch(EquationKind kind, F&& f) {
+        using E = EquationKind;
+        switch (kind) {
+        case E::PointDistance:        return f(std::integral_constant<E, E::PointDistance>{});
+        case E::PointOnCircle:        return f(std::integral_constant<E, E::PointOnCircle>{});
+        case E::PointLineDistance:    return f(std::integral_constant<E, E::PointLineDistance>{});
+        case E::MidpointLineDistance: return f(std::integral_constant<E, E::MidpointLineDistance>{});
+        case E::LineCircleTangent:    return f(std::integral_constant<E, E::LineCircleTangent>{});
+        case E::CircleCircleTangent:  return f(std::integral_constant<E, E::CircleCircleTangent>{});
+        case E::Cross:                return f(std::integral_constant<E, E::Cross>{});
+        case E::Dot:                  return f(std::integral_constant<E, E::Dot>{});
+        case E::Angle:                return f(std::integral_constant<E, E::Angle>{});
+        case E::EndCurvature:         return f(std::integral_constant<E, E::EndCurvature>{});
+        case E::Linear:
+        case E::Count:                break;
+        }
+        return f(std::integral_constant<E, E::Linear>{});
+    }
+
+} // namespace domain::solver::kernels
@@ -0,0 +1,93 @@
+#include "domain/solver/SketchSolver.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace domain::solver {
+
+    using namespace domain::sketch;
+
+    namespace {
+
+        int severity(SolveStatus s) {
+            switch (s) {
+            case SolveStatus::NothingToSolve: return 0;
+            case SolveStatus::Converged: return 1;
+            case SolveStatus::NotConverged: return 2;
+            case SolveStatus::Stalled: return 3;
+            }
+            return 0;
+        }
+
+    } // namespace
+
+    bool SketchSolver::solveCluster(Sketch& sketch, std::uint64_t version, const Cluster& cluster, ClusterWorkspace& ws,
+        const SolverOptions& options, SolveResult& result) {
+        ws.params.gather(sketch.entities, cluster.entities);
+        compileCluster(sketch, cluster.entities, cluster.constraints, ws.params, ws.system);
+
+        result = ws.lm.solve(ws.system.equations, ws.params.values(), options);
+        result.unsupported = ws.system.unsupported;
+
+        // Clusters own disjoint entities, so concurrent scatters never touch the same element.
+        return result.status != SolveStatus::NothingToSolve && ws.params.scatter(sketch.entities, version);
+    }
+
+    SolveResult SketchSolver::solve(Sketch& sketch, const SolverOptions& options) {
+        m_graph.build(sketch);
+        const auto& clusters = m_graph.clusters();
+
+        // Biggest clusters first so the long solves start early and small ones fill the gaps.
+        m_order.resize(clusters.size());
+        std::iota(m_order.begin(), m_order.end(), std::size_t{ 0 });
+        std::sort(m_order.begin(), m_order.end(), [&](std::size_t a, std::size_t b) {
+            return clusters[a].equationEstimate > clusters[b].equationEstimate;
+        });
+
+        m_clusterResults.assign(clusters.size(), SolveResult{});
+        m_clusterChanged.assign(clusters.size(), 0);
+
+        const bool parallel = m_pool && clusters.size() > 1;
+        const std::size_t slots = parallel ? m_pool->slotCount() : 1;
+        if (m_workspaces.size() < slots) m_workspaces.resize(slots);
+
+        // One version for every cluster's changes, taken only if there are any,
+        // so a solve that moves nothing does not look like an edit.
+        const std::uint64_t version = sketch.entities.pendingVersion();
+
+        if (parallel) {
+            // A few chunks per slot: enough to balance, few enough to keep queue traffic low.
+            const std::size_t grain = std::max<std::size_t>(1, m_order.size() / (8 * slots));
+            m_pool->parallelFor(m_order.size(), grain, [&](std::size_t i, unsigned slot) {
+                const std::size_t c = m_order[i];
+                m_clusterChanged[c] = solveCluster(sketch, version, clusters[c], m_workspaces[slot], options, m_clusterResults[c]);
+            });
+        }
+        else {
+            for (std::size_t c : m_order) {
+                m_clusterChanged[c] = solveCluster(sketch, version, clusters[c], m_workspaces[0], options, m_clusterResults[c]);
+            }
+        }
+
+        if (std::any_of(m_clusterChanged.begin(), m_clusterChanged.end(), [](std::uint8_t c) { return c != 0; })) {
+            sketch.entities.nextVersion();
+        }
+
+        SolveResult result;
+        result.clusterCount = clusters.size();
+        for (const auto& r : m_clusterResults) {
+            if (severity(r.status) > severity(result.status)) result.status = r.status;
+            result.iterations = std::max(result.iterations, r.iterations);
+            result.residualNorm = std::max(result.residualNorm, r.residualNorm);
+            result.equationCount += r.equationCount;
+            result.parameterCount += r.parameterCount;
+            result.unsupported.insert(result.unsupported.end(), r.unsupported.begin(), r.unsupported.end());
+        }
+
+        for (std::uint32_t ci : m_graph.orphans()) {
+            std::visit([&](auto&& c) { result.unsupported.push_back(c.meta.id); }, sketch.constraints[ci]);
+        }
+        return result;
+    }
+
+} // namespace domain::solver
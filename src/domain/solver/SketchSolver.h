@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "domain/SketchModel.h"
+#include "ConstraintCompiler.h"
+#include "ConstraintGraph.h"
+#include "LevenbergMarquardt.h"
+#include "ParallelExecutor.h"
+#include "ParameterTable.h"
+#include "SolverTypes.h"
+
+namespace domain::solver {
+
+    // Solves Sketch::constraints and writes the result back into the sketch's EntityStore.
+    //
+    // The constraint graph is split into connected clusters first; each cluster
+    // runs its own pipeline (gather entity parameters -> compile constraints into
+    // primitive equations -> sparse Levenberg-Marquardt -> scatter parameters).
+    // Clusters share no entities, so with a thread pool attached they are
+    // solved in parallel, largest first.
+    // Keep one instance around to reuse its buffers between solves.
+    class SketchSolver {
+    public:
+        // Optional; not owned. nullptr solves clusters on the calling thread.
+        void setThreadPool(ParallelExecutor* pool) { m_pool = pool; }
+
+        SolveResult solve(sketch::Sketch& sketch, const SolverOptions& options = {});
+
+        const ConstraintGraph& graph() const { return m_graph; }
+
+    private:
+        // Scratch for one cluster solve; one per pool slot.
+        struct ClusterWorkspace {
+            ParameterTable params;
+            EquationSystem system;
+            LevenbergMarquardt lm;
+        };
+
+        ParallelExecutor* m_pool{ nullptr };
+        ConstraintGraph m_graph;
+        std::vector<ClusterWorkspace> m_workspaces;
+        std::vector<std::size_t> m_order;
+        std::vector<SolveResult> m_clusterResults;
+        std::vector<std::uint8_t> m_clusterChanged; // whether the cluster's scatter wrote anything
+
+        // Returns whether the solve changed any value.
+        bool solveCluster(sketch::Sketch& sketch, std::uint64_t version, const Cluster& cluster, ClusterWorkspace& ws,
+            const SolverOptions& options, SolveResult& result);
+    };
+
+} // namespace domain::solver
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "domain/SketchIds.h"
+
+namespace domain::solver {
+
+    // Index into the packed parameter vector (see ParameterTable).
+    using ParamIndex = std::uint32_t;
+    inline constexpr ParamIndex kInvalidParam = std::numeric_limits<ParamIndex>::max();
+
+    enum class SolveStatus : std::uint8_t {
+        Converged,      // all residuals below tolerance
+        NotConverged,   // iteration budget exhausted before reaching tolerance
+        Stalled,        // no further progress possible (typically conflicting constraints)
+        NothingToSolve  // no enabled, driving constraints
+    };
+
+    struct SolverOptions {
+        int maxIterations{ 100 };
+        double residualTolerance{ 1e-9 };   // max |r_i| accepted as solved
+        double stepTolerance{ 1e-12 };      // relative step size treated as a stall
+        double initialLambda{ 1e-3 };       // LM damping; adds lambda * max diag(J^T J) to every column
+
+        // Inner conjugate-gradient solve of the damped normal equations.
+        int maxLinearIterations{ 200 };
+        double linearTolerance{ 1e-10 };
+    };
+
+    struct SolveResult {
+        SolveStatus status{ SolveStatus::NothingToSolve };
+        int iterations{ 0 };
+        double residualNorm{ 0.0 };         // max |r_i| at the returned solution
+        std::size_t equationCount{ 0 };
+        std::size_t parameterCount{ 0 };
+        std::size_t clusterCount{ 0 };      // independent sub-problems the sketch was split into
+
+        // Constraints whose reference pattern the compiler does not understand.
+        std::vector<sketch::ConstraintId> unsupported;
+    };
+
+} // namespace domain::solver
@@ -0,0 +1,110 @@
+#include "domain/solver/SparseJacobian.h"
+
+#include <algorithm>
+
+namespace domain::solver {
+
+    void SparseJacobian::build(const std::vector<Equation>& equations, std::size_t parameterCount) {
+        m_columnOf.assign(parameterCount, kInvalidParam);
+        m_params.clear();
+        m_rowPtr.resize(equations.size() + 1);
+        m_cols.clear();
+
+        std::size_t nnz = 0;
+        for (const auto& eq : equations) nnz += eq.paramCount;
+        m_cols.reserve(nnz);
+
+        m_rowPtr[0] = 0;
+        for (std::size_t i = 0; i < equations.size(); ++i) {
+            const auto& eq = equations[i];
+            for (int k = 0; k < eq.paramCount; ++k) {
+                const ParamIndex p = eq.p[k];
+                if (m_columnOf[p] == kInvalidParam) {
+                    m_columnOf[p] = static_cast<std::uint32_t>(m_params.size());
+                    m_params.push_back(p);
+                }
+                m_cols.push_back(m_columnOf[p]);
+            }
+            m_rowPtr[i + 1] = static_cast<std::uint32_t>(m_cols.size());
+        }
+
+        m_values.assign(m_cols.size(), 0.0);
+
+        // Counting sort of rows by kind; rows keep their order within a kind.
+        constexpr std::size_t kinds = static_cast<std::size_t>(EquationKind::Count);
+        m_kindStart.fill(0);
+        for (const auto& eq : equations) ++m_kindStart[static_cast<std::size_t>(eq.kind) + 1];
+        for (std::size_t k = 0; k < kinds; ++k) m_kindStart[k + 1] += m_kindStart[k];
+
+        m_kindRows.resize(equations.size());
+        std::array<std::uint32_t, kinds> next{};
+        std::copy(m_kindStart.begin(), m_kindStart.begin() + kinds, next.begin());
+        for (std::size_t i = 0; i < equations.size(); ++i) {
+            m_kindRows[next[static_cast<std::size_t>(equations[i].kind)]++] = static_cast<std::uint32_t>(i);
+        }
+    }
+
+    void SparseJacobian::evaluateBatches(const std::vector<Equation>& equations, const double* x, double* residuals, double* values) const {
+        constexpr std::size_t kinds = static_cast<std::size_t>(EquationKind::Count);
+        for (std::size_t k = 0; k < kinds; ++k) {
+            const std::uint32_t begin = m_kindStart[k];
+            const std::uint32_t end = m_kindStart[k + 1];
+            if (begin == end) continue;
+            evaluateEquations(static_cast<EquationKind>(k), equations.data(), m_kindRows.data() + begin, end - begin,
+                x, residuals, m_rowPtr.data(), values);
+        }
+    }
+
+    void SparseJacobian::evaluate(const std::vector<Equation>& equations, const double* x, double* residuals) {
+        evaluateBatches(equations, x, residuals, m_values.data());
+    }
+
+    void SparseJacobian::residuals(const std::vector<Equation>& equations, const double* x, double* residuals) const {
+        evaluateBatches(equations, x, residuals, nullptr);
+    }
+
+    void SparseJacobian::multiply(const double* v, double* out) const {
+        const std::size_t n = rows();
+        for (std::size_t i = 0; i < n; ++i) {
+            double sum = 0.0;
+            for (std::uint32_t k = m_rowPtr[i]; k < m_rowPtr[i + 1]; ++k) {
+                sum += m_values[k] * v[m_cols[k]];
+            }
+            out[i] = sum;
+        }
+    }
+
+    void SparseJacobian::multiplyTransposed(const double* v, double* out) const {
+        std::fill(out, out + cols(), 0.0);
+        const std::size_t n = rows();
+        for (std::size_t i = 0; i < n; ++i) {
+            const double vi = v[i];
+            if (vi == 0.0) continue;
+            for (std::uint32_t k = m_rowPtr[i]; k < m_rowPtr[i + 1]; ++k) {
+                out[m_cols[k]] += m_values[k] * vi;
+            }
+        }
+    }
+
+    void SparseJacobian::columnSquares(double* out) const {
+        // Duplicate entries in a row must be summed before squaring.
+        std::fill(out, out + cols(), 0.0);
+        const std::size_t n = rows();
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint32_t begin = m_rowPtr[i];
+            const std::uint32_t end = m_rowPtr[i + 1];
+            for (std::uint32_t k = begin; k < end; ++k) {
+                const std::uint32_t c = m_cols[k];
+                bool seen = false;
+                double sum = 0.0;
+                for (std::uint32_t j = begin; j < end; ++j) {
+                    if (m_cols[j] != c) continue;
+                    if (j < k) { seen = true; break; }
+                    sum += m_values[j];
+                }
+                if (!seen) out[c] += sum * sum;
+            }
+        }
+    }
+
+} // namespace domain::solver
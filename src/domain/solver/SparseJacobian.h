@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Equations.h"
+
+namespace domain::solver {
+
+    // Compressed-row Jacobian of an equation list. The sparsity pattern is built
+    // once from the equations; evaluate() then writes gradients straight into the
+    // value array, so re-linearising allocates nothing.
+    //
+    // Rows are also bucketed by EquationKind at build time, and evaluation runs
+    // one batch per kind so each kernel is chosen once per batch, not per row.
+    //
+    // Columns are compacted: only parameters referenced by at least one equation
+    // become unknowns. A parameter that appears twice in one equation produces two
+    // entries in the same column; all products below accumulate, so that is fine.
+    class SparseJacobian {
+    public:
+        void build(const std::vector<Equation>& equations, std::size_t parameterCount);
+
+        // Fills residuals (size rows()) and Jacobian values at x (full parameter vector).
+        void evaluate(const std::vector<Equation>& equations, const double* x, double* residuals);
+
+        // Residuals only.
+        void residuals(const std::vector<Equation>& equations, const double* x, double* residuals) const;
+
+        void multiply(const double* v, double* out) const;           // out = J v        (cols -> rows)
+        void multiplyTransposed(const double* v, double* out) const; // out = J^T v      (rows -> cols)
+        void columnSquares(double* out) const;                       // out = diag(J^T J)
+
+        std::size_t rows() const { return m_rowPtr.empty() ? 0 : m_rowPtr.size() - 1; }
+        std::size_t cols() const { return m_params.size(); }
+
+        // Compact column -> parameter index in the full vector.
+        const std::vector<ParamIndex>& columnParams() const { return m_params; }
+
+        const std::vector<std::uint32_t>& rowPtr() const { return m_rowPtr; }
+        const std::vector<std::uint32_t>& colIndex() const { return m_cols; }
+        const std::vector<double>& values() const { return m_values; }
+
+    private:
+        std::vector<std::uint32_t> m_rowPtr;
+        std::vector<std::uint32_t> m_cols;
+        std::vector<double> m_values;
+
+        std::vector<ParamIndex> m_params;       // column -> parameter
+        std::vector<std::uint32_t> m_kindRows;  // row indices grouped by kind
+        std::array<std::uint32_t, static_cast<std::size_t>(EquationKind::Count) + 1> m_kindStart{}; // kind -> range in m_kindRows
+        std::vector<std::uint32_t> m_columnOf;  // parameter -> column (or kInvalidParam)
+
+        void evaluateBatches(const std::vector<Equation>& equations, const double* x, double* residuals, double* values) const;
+    };
+
+} // namespace domain::solver
@@ -6,6 +6,9 @@
 #include "adapters/exporters/ObjExporter.h"
 #include "adapters/exporters/StlExporter.h"
 #include "adapters/rendering/OcctRenderer.h"
+#include "adapters/rendering/RenderThread.h"
+#include "adapters/rendering/OpenGlRenderer.h"
+#include "adapters/rendering/RendererRouter.h"
 #include "adapters/persistence/JsonSketchDocumentAdapter.h"
 #include <filesystem>
 #include <iostream>
@@ -25,7 +28,11 @@ int main(int argc, char** argv) {
         // Configure adapters following hexagonal architecture
         std::cout << "Configuring adapters...\n";
         app->setUIAdapter(std::make_unique<adapters::ImGuiAdapter>(app.get()));
-        app->setRenderer(std::make_unique<adapters::OcctRenderer>());
+        // OCCT draws on a thread of its own, so a slow view never stalls the UI;
+        // the embedded OpenGL view can be switched to from the viewport.
+        app->setRenderer(std::make_unique<adapters::RendererRouter>(
+            std::make_unique<adapters::RenderThread>(std::make_unique<adapters::OcctRenderer>()),
+            std::make_unique<adapters::OpenGlRenderer>()));
         app->addFileLoader(std::make_unique<adapters::StepFileLoader>());
         app->addExporter(std::make_unique<adapters::ObjExporter>());
         app->addExporter(std::make_unique<adapters::StlExporter>());
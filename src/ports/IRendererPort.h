@@ -42,19 +42,85 @@ namespace ports {
         LineStrip = 2,
     };
 
-    struct RenderPrimitive {
+    // Packed RGBA8: R in the low byte, so the bytes read R, G, B, A in memory
+    // and the value feeds a normalized unsigned-byte vertex attribute as is.
+    inline constexpr uint32_t PackRgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+        return uint32_t(r) | (uint32_t(g) << 8) | (uint32_t(b) << 16) | (uint32_t(a) << 24);
+    }
+
+    struct RenderVertex {
+        glm::vec3 position{ 0.0f };        // World-space position
+        uint32_t rgba = 0xFFFFFFFFu;       // See PackRgba
+    };
+
+    enum RenderRangeFlags : uint8_t {
+        RenderRangeDepthTest = 1 << 0,
+        RenderRangeConstruction = 1 << 1, // Draw dashed
+    };
+
+    // Vertices [first, first + count) of RenderScene::vertices, drawn as `kind`.
+    // A point or line list holds many primitives (one per point, one per
+    // vertex pair), a strip holds one; the k-th primitive's selection id is
+    // RenderScene::ids[firstId + k].
+    struct DrawRange {
+        uint32_t first = 0;
+        uint32_t count = 0;
+        uint32_t firstId = 0;
+        float size = 1.0f;                 // Point size or line width hint
         RenderPrimitiveKind kind = RenderPrimitiveKind::LineList;
-        std::vector<glm::vec3> positions; // World-space positions
-        uint32_t rgba = 0xFFFFFFFFu;      // Packed RGBA8
-        float size = 1.0f;               // Point size or line width hint
-        uint64_t selectionId = 0;        // For picking later
-        bool depthTest = true;
+        uint8_t flags = RenderRangeDepthTest;
+
+        uint32_t primitiveCount() const {
+            switch (kind) {
+            case RenderPrimitiveKind::PointList: return count;
+            case RenderPrimitiveKind::LineList: return count / 2;
+            default: return count > 0 ? 1u : 0u;
+            }
+        }
+    };
+
+    // An elliptical arc, center + cos(t) * axisU + sin(t) * axisV for t from
+    // startAngle to endAngle (either way round); circles and ellipses run a
+    // full turn. Backends generate the curve themselves, at the resolution
+    // its size on screen needs.
+    struct CurveInstance {
+        glm::vec3 center{ 0.0f };
+        float startAngle = 0.0f;
+        glm::vec3 axisU{ 1.0f, 0.0f, 0.0f }; // Scaled by the radius (or rx)
+        float endAngle = 6.28318530718f;
+        glm::vec3 axisV{ 0.0f, 1.0f, 0.0f }; // Scaled by the radius (or ry)
+        uint32_t rgba = 0xFFFFFFFFu;
+        uint32_t id = 0;                   // Selection id; 0 = none
+        float size = 1.0f;                 // Line width hint
+        uint8_t flags = RenderRangeDepthTest;
+    };
+
+    // Instances [first, first + count) of an instance array.
+    struct InstanceRange {
+        uint32_t first = 0;
+        uint32_t count = 0;
     };
 
     struct RenderScene {
-        // A renderer-agnostic scene: mostly for sketch overlays, gizmos, and debug drawing.
+        // A renderer-agnostic scene: mostly for sketch overlays, gizmos, and debug drawing,
+        // packed the way a GPU wants it. Points and lines share one vertex arena, with
+        // ranges batching the ones drawn with the same state; curves are instances.
         // OCCT renderer may ignore these for now.
-        std::vector<RenderPrimitive> primitives;
+        std::vector<RenderVertex> vertices;
+        std::vector<DrawRange> ranges;
+        std::vector<uint32_t> ids;         // Selection id per primitive, for picking; 0 = none
+        std::vector<CurveInstance> curves;
+
+        // Bumped by the producer for every new scene, so a backend can tell
+        // whether its uploaded copy is current without comparing contents.
+        uint64_t revision = 0;
+        uint64_t vertexRevision = 0;       // Last revision that changed vertices, ranges or ids
+
+        // The curves differ from those of revision curveBase only in
+        // changedCurves, so a backend holding that revision can patch just
+        // those instances. 0 means they all changed.
+        uint64_t curveBase = 0;
+        std::vector<InstanceRange> changedCurves;
 
         // Active sketch plane (optional). If enabled, renderers can draw a grid and use it
         // as a reference for sketch overlays.
@@ -65,6 +131,11 @@ namespace ports {
         float workplaneDepthBias = 0.25f;  // world units offset along plane normal
     };
 
+    // Scenes are published as immutable snapshots: the producer builds a new
+    // one when something changed and every backend keeps a reference to it,
+    // so handing a scene around never copies it.
+    using RenderSceneSnapshot = std::shared_ptr<const RenderScene>;
+
     class IRendererPort {
     public:
         virtual ~IRendererPort() = default;
@@ -81,8 +152,9 @@ namespace ports {
         virtual void* getFramebufferTexture() = 0;
         virtual void resize(int width, int height) = 0;
 
-        // Unified scene + camera (renderer-agnostic). Safe to call every frame.
-        virtual void setScene(const RenderScene& scene) = 0;
+        // Unified scene + camera (renderer-agnostic). Safe to call every frame;
+        // passing the snapshot already set is free.
+        virtual void setScene(RenderSceneSnapshot scene) = 0;
         virtual void setCameraState(const CameraState& camera) = 0;
         virtual CameraState getCameraState() const = 0;
         virtual RendererCapabilities getCapabilities() const = 0;
@@ -9,6 +9,9 @@ public:
     virtual bool initialize() = 0;
     virtual void shutdown() = 0;
     virtual bool shouldClose() = 0;
+    // Processes pending window events, first blocking for up to
+    // timeoutSeconds until one arrives; 0 only polls.
+    virtual void waitEvents(double timeoutSeconds) = 0;
     virtual void beginFrame() = 0;
     virtual void endFrame() = 0;
     virtual void render() = 0;
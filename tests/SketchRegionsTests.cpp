@@ -0,0 +1,76 @@
+#include <cmath>
+#include <cstdio>
+
+#include "domain/SketchRegions.h"
+
+using namespace domain::sketch;
+
+namespace {
+
+    int g_failures = 0;
+
+    void check(bool ok, const char* what) {
+        if (ok) return;
+        std::printf("FAILED: %s\n", what);
+        ++g_failures;
+    }
+
+    void addLine(EntityStore& store, EntityId id, Vec2 a, Vec2 b) {
+        Line2D l;
+        l.h.id = id;
+        l.a = a;
+        l.b = b;
+        store.addLine(l);
+    }
+
+    void addSquare(EntityStore& store) {
+        addLine(store, 1, { 0.0, 0.0 }, { 2.0, 0.0 });
+        addLine(store, 2, { 2.0, 0.0 }, { 2.0, 2.0 });
+        addLine(store, 3, { 2.0, 2.0 }, { 0.0, 2.0 });
+        addLine(store, 4, { 0.0, 2.0 }, { 0.0, 0.0 });
+    }
+
+    void checkOneSquare(const EntityStore& store, const char* what) {
+        RegionDetector detector;
+        const std::vector<Region>& regions = detector.update(store);
+        check(regions.size() == 1, what);
+        if (regions.size() == 1) check(std::abs(regions[0].outer->area - 4.0) < 1e-9, what);
+    }
+
+    // Overlapping collinear edges leave their shared vertices at the same
+    // angle; the square must still come out as one region.
+    void keepsProfileWithOverlappingEdges() {
+        {
+            EntityStore store;
+            addSquare(store);
+            addLine(store, 5, { 0.0, 0.0 }, { 2.0, 0.0 });
+            checkOneSquare(store, "square with its bottom line drawn twice");
+        }
+        {
+            EntityStore store;
+            addSquare(store);
+            addLine(store, 5, { 2.0, 0.0 }, { 0.0, 0.0 });
+            checkOneSquare(store, "square with its bottom line drawn twice, reversed");
+        }
+        {
+            EntityStore store;
+            addSquare(store);
+            addLine(store, 5, { 0.5, 0.0 }, { 1.5, 0.0 });
+            checkOneSquare(store, "square with a shorter line on an edge");
+        }
+        {
+            EntityStore store;
+            addSquare(store);
+            addLine(store, 5, { 1.0, 0.0 }, { 3.0, 0.0 });
+            checkOneSquare(store, "square with a line overhanging an edge");
+        }
+    }
+
+} // namespace
+
+int main() {
+    keepsProfileWithOverlappingEdges();
+
+    if (g_failures == 0) std::printf("SketchRegionsTests: all passed\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+#include <cmath>
+#include <cstdio>
+
+#include "domain/SketchModel.h"
+#include "domain/solver/SketchSolver.h"
+
+using namespace domain::sketch;
+using namespace domain::solver;
+
+namespace {
+
+    int g_failures = 0;
+
+    void check(bool ok, const char* what) {
+        if (ok) return;
+        std::printf("FAILED: %s\n", what);
+        ++g_failures;
+    }
+
+    double length(const Line2D& l) {
+        return std::hypot(l.b.x - l.a.x, l.b.y - l.a.y);
+    }
+
+    Line2D line(EntityId id, Vec2 a, Vec2 b) {
+        Line2D l;
+        l.h.id = id;
+        l.a = a;
+        l.b = b;
+        return l;
+    }
+
+    GeometricConstraint constraint(ConstraintId id, GeometricConstraintType type, std::vector<EntityRef> refs) {
+        GeometricConstraint c;
+        c.meta.id = id;
+        c.type = type;
+        c.refs = std::move(refs);
+        return c;
+    }
+
+    // Two lines forming an L, drawn roughly square, with Coincident +
+    // Horizontal + Perpendicular. The sketch is underdetermined: the solve
+    // should square it up where it is, not shrink one line to nothing and
+    // throw the other's free end far away.
+    void solvesLShapeWithoutDistortingIt() {
+        const Vec2 starts[][4] = {
+            { { 0.0, 0.0 }, { 3.0, 0.1 }, { 3.05, 0.0 }, { 3.1, 2.0 } },
+            { { 0.0, 0.0 }, { 3.0, 0.0 }, { 3.0, 0.0 }, { 3.3, 2.0 } },
+            { { 0.0, 0.0 }, { 3.0, 0.5 }, { 3.2, 0.1 }, { 2.5, 2.0 } },
+        };
+
+        for (const auto& s : starts) {
+            Sketch sketch;
+            sketch.entities.addLine(line(1, s[0], s[1]));
+            sketch.entities.addLine(line(2, s[2], s[3]));
+            sketch.constraints.push_back(constraint(1, GeometricConstraintType::Coincident,
+                { { 1, EntityAnchor::LineEnd }, { 2, EntityAnchor::LineStart } }));
+            sketch.constraints.push_back(constraint(2, GeometricConstraintType::Horizontal, { { 1, EntityAnchor::None } }));
+            sketch.constraints.push_back(constraint(3, GeometricConstraintType::Perpendicular,
+                { { 1, EntityAnchor::None }, { 2, EntityAnchor::None } }));
+
+            const double before1 = std::hypot(s[1].x - s[0].x, s[1].y - s[0].y);
+            const double before2 = std::hypot(s[3].x - s[2].x, s[3].y - s[2].y);
+
+            SketchSolver solver;
+            const SolveResult result = solver.solve(sketch);
+            check(result.status == SolveStatus::Converged, "L shape: solve converges");
+
+            const Line2D l1 = sketch.entities.line(sketch.entities.getHandle(1));
+            const Line2D l2 = sketch.entities.line(sketch.entities.getHandle(2));
+            check(std::abs(length(l1) - before1) < 0.25 * before1, "L shape: line 1 keeps its length");
+            check(std::abs(length(l2) - before2) < 0.25 * before2, "L shape: line 2 keeps its length");
+            check(std::abs(l1.a.y - l1.b.y) < 1e-6, "L shape: line 1 is horizontal");
+            check(std::abs(l2.a.x - l2.b.x) < 1e-6, "L shape: line 2 is perpendicular to it");
+        }
+    }
+
+} // namespace
+
+int main() {
+    solvesLShapeWithoutDistortingIt();
+
+    if (g_failures == 0) std::printf("SketchSolverTests: all passed\n");
+    return g_failures == 0 ? 0 : 1;
+}